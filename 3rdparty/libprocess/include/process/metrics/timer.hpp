@@ -87,6 +87,20 @@ public:
     return t;
   }
 
+  // Record a duration which was measured elsewhere, e.g., with a
+  // `Stopwatch` on a thread which is not managed by libprocess.
+  void record(const Duration& duration)
+  {
+    double value;
+
+    synchronized (data->lock) {
+      data->lastValue = T(duration).value();
+      value = data->lastValue.get();
+    }
+
+    push(value);
+  }
+
   // Time an asynchronous event.
   template <typename U>
   Future<U> time(const Future<U>& future)
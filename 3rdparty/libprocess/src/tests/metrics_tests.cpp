@@ -563,6 +563,13 @@ TEST_F(MetricsTest, Timer)
   // It is not an error to stop a timer that has already been stopped.
   timer.stop();
 
+  // Record a duration measured elsewhere.
+  timer.record(Microseconds(2));
+
+  value = timer.value();
+  AWAIT_READY(value);
+  EXPECT_DOUBLE_EQ(value.get(), static_cast<double>(Microseconds(2).ns()));
+
   AWAIT_READY(metrics::remove(timer));
 }
 
@@ -17,6 +17,10 @@
 #ifndef __COMMON_RESOURCE_QUANTITIES_HPP__
 #define __COMMON_RESOURCE_QUANTITIES_HPP__
 
+#include <stdint.h>
+
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,6 +28,7 @@
 #include <mesos/mesos.hpp>
 
 #include <stout/hashmap.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
@@ -118,10 +123,10 @@ public:
   ResourceQuantities& operator=(const ResourceQuantities& that) = default;
   ResourceQuantities& operator=(ResourceQuantities&& that) = default;
 
-  typedef std::vector<std::pair<std::string, Value::Scalar>>::const_iterator
-    iterator;
-  typedef std::vector<std::pair<std::string, Value::Scalar>>::const_iterator
-    const_iterator;
+  // Iterates over the entries in the alphabetical order of their names.
+  class const_iterator;
+
+  typedef const_iterator iterator;
 
   // NOTE: Non-`const` `iterator`, `begin()` and `end()` are __intentionally__
   // defined with `const` semantics in order to prevent mutation during
@@ -129,8 +134,8 @@ public:
   const_iterator begin();
   const_iterator end();
 
-  const_iterator begin() const { return quantities.begin(); }
-  const_iterator end() const { return quantities.end(); }
+  const_iterator begin() const;
+  const_iterator end() const;
 
   size_t size() const { return quantities.size(); };
 
@@ -140,6 +145,23 @@ public:
   // If the given name is absent, return zero.
   Value::Scalar get(const std::string& name) const;
 
+  // Returns the quantity of the resource with the given interned name
+  // identifier (see `src/common/resource_names.hpp`), or None if the
+  // resource is absent (i.e., its quantity is zero).
+  Option<double> find(uint32_t id) const;
+
+  // Calls `f(id, quantity)` for each entry, where `id` is the interned
+  // identifier of the resource name. Unlike iteration, this visits the
+  // entries in no particular order and does not compare names, hence
+  // it is the one to use on the hot paths (e.g., the sorters).
+  template <typename F>
+  void foreachEntry(F&& f) const
+  {
+    quantities.foreachEntry([&f](const Scalars::Entry& entry) {
+      f(entry.id, entry.pair.second.value());
+    });
+  }
+
   bool contains(const ResourceQuantities& quantities) const;
 
   bool operator==(const ResourceQuantities& quantities) const;
@@ -154,12 +176,142 @@ public:
 private:
   friend class ResourceLimits;
 
+  // Scalar values keyed by interned resource names, which is the storage
+  // shared with `ResourceLimits`.
+  //
+  // The first-class scalar resources (`cpus`, `disk`, `gpus`, `mem` and
+  // `network_bandwidth`) have a fixed slot each, while other names are
+  // kept in an overflow vector sorted by name. Values are kept in the
+  // fixed point representation used by `Value::Scalar` arithmetic, which
+  // is what operations compare and add, next to the `Value::Scalar` that
+  // iteration yields. Hence, operations do not allocate unless custom
+  // resource names are involved.
+  class Scalars
+  {
+  public:
+    struct Entry
+    {
+      Entry(uint32_t _id, const std::string& name)
+        : id(_id), value(0), pair(name, Value::Scalar()) {}
+
+      // Sets both the fixed point value and the `Value::Scalar`.
+      void set(long long _value);
+
+      uint32_t id;
+      long long value;
+
+      // The interned name and the value, as yielded by iteration.
+      std::pair<const std::string&, Value::Scalar> pair;
+    };
+
+    // Number of the fixed slots, whose indices are the reserved
+    // identifiers of the first-class scalar resource names.
+    static constexpr uint32_t SLOTS = 5;
+
+    Scalars();
+
+    Scalars(const Scalars& that) = default;
+    Scalars(Scalars&& that) = default;
+
+    // NOTE: `Entry` is not assignable since it refers to its interned
+    // name, so only the values of the fixed slots are assigned.
+    Scalars& operator=(const Scalars& that);
+    Scalars& operator=(Scalars&& that);
+
+    size_t size() const;
+    bool empty() const { return mask == 0 && custom.empty(); }
+
+    // Returns the entry with the given identifier, or nullptr if there
+    // is no such entry.
+    const Entry* find(uint32_t id) const;
+    Entry* find(uint32_t id);
+
+    // Inserts or overwrites an entry.
+    void set(uint32_t id, const std::string& name, long long value);
+
+    void erase(uint32_t id);
+
+    template <typename F>
+    void foreachEntry(F&& f) const
+    {
+      for (uint32_t id = 0; id < SLOTS; ++id) {
+        if (mask & (1u << id)) {
+          f(slots[id]);
+        }
+      }
+
+      for (const Entry& entry : custom) {
+        f(entry);
+      }
+    }
+
+    bool operator==(const Scalars& that) const;
+    bool operator!=(const Scalars& that) const { return !(*this == that); }
+
+  private:
+    friend class ResourceQuantities::const_iterator;
+
+    // Bit `i` is set iff the fixed slot `i` holds an entry.
+    uint8_t mask;
+    Entry slots[SLOTS];
+
+    // Entries with custom names, sorted by name.
+    std::vector<Entry> custom;
+  };
+
   void add(const std::string& name, const Value::Scalar& scalar);
   void add(const std::string& name, double value);
 
-  // List of name quantity pairs sorted by name.
-  // Arithmetic and comparison operations benefit from this sorting.
-  std::vector<std::pair<std::string, Value::Scalar>> quantities;
+  // Only positive quantities are stored.
+  Scalars quantities;
+};
+
+
+class ResourceQuantities::const_iterator
+{
+public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef std::pair<const std::string&, Value::Scalar> value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type* pointer;
+  typedef const value_type& reference;
+
+  reference operator*() const { return current->pair; }
+  pointer operator->() const { return &current->pair; }
+
+  const_iterator& operator++();
+  const_iterator operator++(int);
+
+  bool operator==(const const_iterator& that) const
+  {
+    return current == that.current;
+  }
+
+  bool operator!=(const const_iterator& that) const
+  {
+    return !(*this == that);
+  }
+
+private:
+  friend class ResourceQuantities;
+  friend class ResourceLimits;
+
+  // Returns an iterator to the first entry of `scalars`, or an end
+  // iterator if `scalars` is nullptr.
+  explicit const_iterator(const Scalars* _scalars);
+
+  // Points `current` at the next entry in alphabetical order, which is
+  // the first of the next fixed slot and the next custom entry.
+  void settle();
+
+  const Scalars* scalars;
+
+  // Indices of the next fixed slot and custom entry to visit.
+  uint32_t slot;
+  size_t custom;
+
+  // The current entry, or nullptr at the end.
+  const Scalars::Entry* current;
 };
 
 
@@ -212,10 +364,8 @@ public:
   ResourceLimits& operator=(const ResourceLimits& that) = default;
   ResourceLimits& operator=(ResourceLimits&& that) = default;
 
-  typedef std::vector<std::pair<std::string, Value::Scalar>>::const_iterator
-    iterator;
-  typedef std::vector<std::pair<std::string, Value::Scalar>>::const_iterator
-    const_iterator;
+  typedef ResourceQuantities::const_iterator iterator;
+  typedef ResourceQuantities::const_iterator const_iterator;
 
   // NOTE: Non-`const` `iterator`, `begin()` and `end()` are __intentionally__
   // defined with `const` semantics in order to prevent mutation during
@@ -223,8 +373,8 @@ public:
   const_iterator begin();
   const_iterator end();
 
-  const_iterator begin() const { return limits.begin(); }
-  const_iterator end() const { return limits.end(); }
+  const_iterator begin() const;
+  const_iterator end() const;
 
   size_t size() const { return limits.size(); };
 
@@ -235,6 +385,22 @@ public:
   // Note, `None()` implies that the limit of the resource is infinite.
   Option<Value::Scalar> get(const std::string& name) const;
 
+  // Returns the limit of the resource with the given interned name
+  // identifier (see `src/common/resource_names.hpp`), or None if there
+  // is no explicit limit for the resource.
+  Option<double> find(uint32_t id) const;
+
+  // Calls `f(id, limit)` for each explicit limit, where `id` is the
+  // interned identifier of the resource name, in no particular order.
+  template <typename F>
+  void foreachEntry(F&& f) const
+  {
+    limits.foreachEntry(
+        [&f](const ResourceQuantities::Scalars::Entry& entry) {
+          f(entry.id, entry.pair.second.value());
+        });
+  }
+
   // Due to the absence-means-infinite semantic of limits, absent entries,
   // intuitively, are considered to contain entries with finite scalar values.
   // For example:
@@ -256,9 +422,8 @@ private:
   // Note, the existing limit of the resource will be overwritten.
   void set(const std::string& name, const Value::Scalar& scalar);
 
-  // List of name limit pairs sorted by name.
-  // Arithmetic and comparison operations benefit from this sorting.
-  std::vector<std::pair<std::string, Value::Scalar>> limits;
+  // Limits keyed by interned resource names.
+  ResourceQuantities::Scalars limits;
 };
 
 
@@ -17,10 +17,14 @@
 #ifndef __RESOURCES_HPP__
 #define __RESOURCES_HPP__
 
+#include <stdint.h>
+
 #include <map>
 #include <iosfwd>
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/iterator/indirect_iterator.hpp>
@@ -61,6 +65,10 @@ namespace mesos {
 // Forward declaration.
 class ResourceConversion;
 
+namespace internal {
+class ResourcesIndex;
+} // namespace internal {
+
 
 // Helper functions.
 bool operator==(
@@ -102,6 +110,9 @@ private:
       if (resource.has_shared()) {
         sharedCount = 1;
       }
+
+      intern();
+      cacheValue();
     }
 
     /*implicit*/ Resource_(Resource&& _resource)
@@ -112,6 +123,9 @@ private:
       if (resource.has_shared()) {
         sharedCount = 1;
       }
+
+      intern();
+      cacheValue();
     }
 
     Resource_(const Resource_& resource_) = default;
@@ -156,10 +170,24 @@ private:
 
     // Friend classes and functions for access to private members.
     friend class Resources;
+    friend class internal::ResourcesIndex;
     friend std::ostream& operator<<(
         std::ostream& stream, const Resource_& resource_);
 
   private:
+    // Computes `nameId` and `metadataId` from `resource`. This must be
+    // called whenever the metadata of `resource` is modified in place.
+    void intern();
+
+    // Computes `scalar` and `ranges` from the value of `resource`.
+    void cacheValue();
+
+    // Tests whether this and `that` can be added or subtracted, using
+    // the interned identifiers to avoid comparing the protobufs where
+    // possible.
+    bool addable(const Resource_& that) const;
+    bool subtractable(const Resource_& that) const;
+
     // The protobuf Resource that is being managed.
     Resource resource;
 
@@ -167,6 +195,30 @@ private:
     // 'resource' is non-shared. This is an int so as to support arithmetic
     // operations involving subtraction.
     Option<int> sharedCount;
+
+    // Interned identifier of the resource name.
+    uint32_t nameId;
+
+    // Interned identifier of the type, `AllocationInfo`, stack of
+    // `ReservationInfo`, `RevocableInfo` and `ResourceProviderID` of the
+    // resource. Two resources with the same name and the same non-zero
+    // metadata identifier are addable and subtractable, which allows
+    // `Resources` arithmetic to combine them without comparing the
+    // protobufs. Zero denotes metadata which is not interned (e.g.,
+    // `DiskInfo` or `SharedInfo`), in which case the protobufs need to
+    // be compared.
+    uint32_t metadataId;
+
+    // The value of a SCALAR resource in the fixed point representation
+    // used for scalar arithmetic, which is kept in sync with `resource`
+    // to avoid converting the value on every operation.
+    long long scalar;
+
+    // The value of a RANGES resource as a flat, sorted vector of
+    // disjoint closed intervals, which is kept in sync with `resource`
+    // so that range arithmetic and containment checks are linear merges
+    // rather than sorting and coalescing the protobufs.
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
   };
 
 public:
@@ -649,14 +701,14 @@ public:
 
   const_iterator begin()
   {
-    return static_cast<const std::vector<Resource_Unsafe>&>(
+    return static_cast<const Storage&>(
                resourcesNoMutationWithoutExclusiveOwnership)
       .begin();
   }
 
   const_iterator end()
   {
-    return static_cast<const std::vector<Resource_Unsafe>&>(
+    return static_cast<const Storage&>(
                resourcesNoMutationWithoutExclusiveOwnership)
       .end();
   }
@@ -711,6 +763,8 @@ public:
   friend std::ostream& operator<<(
       std::ostream& stream, const Resource_& resource_);
 
+  friend class internal::ResourcesIndex;
+
 private:
   // Similar to 'contains(const Resource&)' but skips the validity
   // check. This can be used to avoid the performance overhead of
@@ -744,12 +798,78 @@ private:
 
   Resources& operator-=(const Resource_& that);
 
+  // The vector of resource objects of a `Resources`, which is shared
+  // between copies of the `Resources` until one of them is mutated.
+  //
+  // Reads go through the `const` methods. Any non-`const` access first
+  // copies the vector if it is shared with another `Resources`, which
+  // only copies the `shared_ptr`s of the resource objects. An empty
+  // `Resources` does not allocate a vector.
+  class Storage
+  {
+  public:
+    typedef std::vector<Resource_Unsafe>::iterator iterator;
+    typedef std::vector<Resource_Unsafe>::const_iterator const_iterator;
+
+    const_iterator begin() const { return get().begin(); }
+    const_iterator end() const { return get().end(); }
+
+    iterator begin() { return mutate().begin(); }
+    iterator end() { return mutate().end(); }
+
+    size_t size() const { return get().size(); }
+
+    const Resource_Unsafe& operator[](size_t i) const { return get()[i]; }
+    Resource_Unsafe& operator[](size_t i) { return mutate()[i]; }
+
+    const Resource_Unsafe& back() const { return get().back(); }
+    Resource_Unsafe& back() { return mutate().back(); }
+
+    void reserve(size_t n) { mutate().reserve(n); }
+
+    void push_back(const Resource_Unsafe& that) { mutate().push_back(that); }
+    void push_back(Resource_Unsafe&& that)
+    {
+      mutate().push_back(std::move(that));
+    }
+
+    void pop_back() { mutate().pop_back(); }
+
+    void insert(iterator position, const_iterator first, const_iterator last)
+    {
+      mutate().insert(position, first, last);
+    }
+
+  private:
+    const std::vector<Resource_Unsafe>& get() const
+    {
+      static const std::vector<Resource_Unsafe>* empty =
+        new std::vector<Resource_Unsafe>();
+
+      return resources ? *resources : *empty;
+    }
+
+    std::vector<Resource_Unsafe>& mutate()
+    {
+      if (!resources) {
+        resources = std::make_shared<std::vector<Resource_Unsafe>>();
+      } else if (resources.use_count() > 1) {
+        resources = std::make_shared<std::vector<Resource_Unsafe>>(*resources);
+      }
+
+      return *resources;
+    }
+
+    std::shared_ptr<std::vector<Resource_Unsafe>> resources;
+  };
+
   // Resources are stored using copy-on-write:
   //
-  //   (1) Copies are done by copying the `shared_ptr`. This
-  //       makes read-only filtering (e.g. `unreserved()`)
-  //       inexpensive as we do not have to perform copies
-  //       of the resource objects.
+  //   (1) Copies are done by copying the `shared_ptr` of the
+  //       `Storage` vector, which makes passing and storing
+  //       `Resources` O(1). Read-only filtering (e.g.
+  //       `unreserved()`) is inexpensive as well, as we do not
+  //       have to perform copies of the resource objects.
   //
   //   (2) When a write occurs:
   //      (a) If there's a single reference to the resource
@@ -768,7 +888,7 @@ private:
   //
   // TODO(mzhu): Consider using `boost::intrusive_ptr` for
   // possibly better performance.
-  std::vector<Resource_Unsafe> resourcesNoMutationWithoutExclusiveOwnership;
+  Storage resourcesNoMutationWithoutExclusiveOwnership;
 };
 
 
@@ -868,6 +988,7 @@ public:
   Option<PostValidation> postValidation;
 };
 
+
 } // namespace mesos {
 
 #endif // __RESOURCES_HPP__
@@ -50,6 +50,7 @@ hashset<string> AUTHORIZABLE_ENDPOINTS{
     "/files/debug",
     "/logging/toggle",
     "/metrics/snapshot",
+    "/monitor/perf",
     "/monitor/statistics"};
 
 
@@ -0,0 +1,74 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __COMMON_RESOURCE_NAMES_HPP__
+#define __COMMON_RESOURCE_NAMES_HPP__
+
+#include <stdint.h>
+
+#include <string>
+
+#include <stout/option.hpp>
+
+namespace mesos {
+namespace internal {
+
+// A process-wide registry of resource names, which interns them into
+// integer identifiers. These identifiers key `ResourceQuantities` and
+// `ResourceLimits`, and are compared by the arithmetic of `Resources`.
+//
+// The first-class scalar resources (`cpus`, `disk`, `gpus`, `mem` and
+// `network_bandwidth`) have reserved identifiers, starting at zero in
+// the alphabetical order of their names.
+//
+// NOTE: Interned names are never released, which is fine since the
+// number of distinct resource names in a cluster is small.
+class ResourceNames
+{
+public:
+  // Number of the reserved identifiers.
+  static constexpr uint32_t RESERVED = 5;
+
+  struct Name
+  {
+    uint32_t id;
+
+    // Interned names are stable, so they can be referred to.
+    const std::string* name;
+  };
+
+  // Returns the interned resource name, interning it if needed.
+  static Name intern(const std::string& name);
+
+  // Returns the interned resource name, or None if the name was never
+  // interned, in which case no collection holds an entry for it. Unlike
+  // `intern`, this does not grow the registry, so it is used for the
+  // lookups of names which may be arbitrary.
+  static Option<Name> lookup(const std::string& name);
+
+  // Returns the name with the given reserved identifier.
+  static const std::string& reserved(uint32_t id);
+
+private:
+  // Implements `intern` and `lookup`, only adding `name` to the
+  // registry if `insert` is true.
+  static Option<Name> find(const std::string& name, bool insert);
+};
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __COMMON_RESOURCE_NAMES_HPP__
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -26,13 +28,358 @@
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/numify.hpp>
+#include <stout/synchronized.hpp>
+
+#include "common/resource_names.hpp"
+#include "common/values.hpp"
 
 using std::ostream;
 using std::pair;
 using std::string;
 using std::vector;
 
+using mesos::internal::ResourceNames;
+
+using mesos::internal::values::convertToFixed;
+using mesos::internal::values::convertToFloating;
+
 namespace mesos {
+namespace internal {
+
+constexpr uint32_t ResourceNames::RESERVED;
+
+
+const string& ResourceNames::reserved(uint32_t id)
+{
+  // NOTE: These must be kept in alphabetical order, see `intern()`.
+  static const string* names = new string[RESERVED] {
+    "cpus", "disk", "gpus", "mem", "network_bandwidth"
+  };
+
+  CHECK_LT(id, RESERVED);
+  return names[id];
+}
+
+
+ResourceNames::Name ResourceNames::intern(const string& name)
+{
+  Option<Name> interned = find(name, true);
+  CHECK_SOME(interned);
+
+  return interned.get();
+}
+
+
+Option<ResourceNames::Name> ResourceNames::lookup(const string& name)
+{
+  return find(name, false);
+}
+
+
+Option<ResourceNames::Name> ResourceNames::find(
+    const string& name,
+    bool insert)
+{
+  // Resolve the reserved names without hashing.
+  for (uint32_t id = 0; id < RESERVED; ++id) {
+    if (name == reserved(id)) {
+      return Name{id, &reserved(id)};
+    }
+  }
+
+  // Each thread caches the names it has found, so that the shared
+  // table and its lock are only consulted for names which are new to
+  // the thread.
+  thread_local hashmap<string, Name> cache;
+
+  auto cached = cache.find(name);
+  if (cached != cache.end()) {
+    return cached->second;
+  }
+
+  static std::mutex* mutex = new std::mutex();
+  static hashmap<string, uint32_t>* ids = new hashmap<string, uint32_t>();
+
+  Name interned;
+
+  synchronized (mutex) {
+    auto it = ids->find(name);
+    if (it == ids->end()) {
+      if (!insert) {
+        return None();
+      }
+
+      it = ids->emplace(
+          name, static_cast<uint32_t>(RESERVED + ids->size())).first;
+    }
+
+    // The keys of the table are stable since entries are never erased.
+    interned = Name{it->second, &it->first};
+  }
+
+  cache.emplace(name, interned);
+  return interned;
+}
+
+} // namespace internal {
+
+
+constexpr uint32_t ResourceQuantities::Scalars::SLOTS;
+
+
+void ResourceQuantities::Scalars::Entry::set(long long _value)
+{
+  value = _value;
+  pair.second.set_value(convertToFloating(_value));
+}
+
+
+ResourceQuantities::Scalars::Scalars()
+  : mask(0),
+    slots{
+      {0, ResourceNames::reserved(0)},
+      {1, ResourceNames::reserved(1)},
+      {2, ResourceNames::reserved(2)},
+      {3, ResourceNames::reserved(3)},
+      {4, ResourceNames::reserved(4)}}
+{
+  static_assert(
+      SLOTS == ResourceNames::RESERVED,
+      "Each reserved resource name must have a fixed slot");
+}
+
+
+ResourceQuantities::Scalars& ResourceQuantities::Scalars::operator=(
+    const Scalars& that)
+{
+  if (this == &that) {
+    return *this;
+  }
+
+  mask = that.mask;
+
+  for (uint32_t id = 0; id < SLOTS; ++id) {
+    if (mask & (1u << id)) {
+      slots[id].value = that.slots[id].value;
+      slots[id].pair.second = that.slots[id].pair.second;
+    }
+  }
+
+  vector<Entry>(that.custom).swap(custom);
+
+  return *this;
+}
+
+
+ResourceQuantities::Scalars& ResourceQuantities::Scalars::operator=(
+    Scalars&& that)
+{
+  if (this == &that) {
+    return *this;
+  }
+
+  mask = that.mask;
+
+  for (uint32_t id = 0; id < SLOTS; ++id) {
+    if (mask & (1u << id)) {
+      slots[id].value = that.slots[id].value;
+      slots[id].pair.second = that.slots[id].pair.second;
+    }
+  }
+
+  custom.clear();
+  custom.swap(that.custom);
+
+  return *this;
+}
+
+
+size_t ResourceQuantities::Scalars::size() const
+{
+  size_t result = custom.size();
+
+  for (uint32_t id = 0; id < SLOTS; ++id) {
+    if (mask & (1u << id)) {
+      ++result;
+    }
+  }
+
+  return result;
+}
+
+
+const ResourceQuantities::Scalars::Entry* ResourceQuantities::Scalars::find(
+    uint32_t id) const
+{
+  if (id < SLOTS) {
+    return (mask & (1u << id)) ? &slots[id] : nullptr;
+  }
+
+  // Don't bother with a lookup table since
+  // we don't expect a large number of custom names.
+  for (const Entry& entry : custom) {
+    if (entry.id == id) {
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+
+ResourceQuantities::Scalars::Entry* ResourceQuantities::Scalars::find(
+    uint32_t id)
+{
+  return const_cast<Entry*>(static_cast<const Scalars*>(this)->find(id));
+}
+
+
+void ResourceQuantities::Scalars::set(
+    uint32_t id,
+    const string& name,
+    long long value)
+{
+  if (id < SLOTS) {
+    mask |= (1u << id);
+    slots[id].set(value);
+    return;
+  }
+
+  Entry* entry = find(id);
+  if (entry != nullptr) {
+    entry->set(value);
+    return;
+  }
+
+  // Since `Entry` is not assignable, the custom entries are copied
+  // around the new one rather than shifted. This is fine given the
+  // small number of custom names.
+  vector<Entry> result;
+  result.reserve(custom.size() + 1);
+
+  auto it = custom.begin();
+  for (; it != custom.end() && it->pair.first < name; ++it) {
+    result.push_back(*it);
+  }
+
+  result.emplace_back(id, name);
+  result.back().set(value);
+
+  for (; it != custom.end(); ++it) {
+    result.push_back(*it);
+  }
+
+  custom.swap(result);
+}
+
+
+void ResourceQuantities::Scalars::erase(uint32_t id)
+{
+  if (id < SLOTS) {
+    mask &= ~(1u << id);
+    return;
+  }
+
+  // Since `Entry` is not assignable, the remaining custom entries are
+  // copied rather than shifted, see `set()`.
+  if (find(id) == nullptr) {
+    return;
+  }
+
+  vector<Entry> result;
+  result.reserve(custom.size() - 1);
+
+  for (const Entry& entry : custom) {
+    if (entry.id != id) {
+      result.push_back(entry);
+    }
+  }
+
+  custom.swap(result);
+}
+
+
+bool ResourceQuantities::Scalars::operator==(const Scalars& that) const
+{
+  if (mask != that.mask || custom.size() != that.custom.size()) {
+    return false;
+  }
+
+  for (uint32_t id = 0; id < SLOTS; ++id) {
+    if ((mask & (1u << id)) && slots[id].value != that.slots[id].value) {
+      return false;
+    }
+  }
+
+  // The custom entries of both are sorted by name.
+  for (size_t i = 0; i < custom.size(); ++i) {
+    if (custom[i].id != that.custom[i].id ||
+        custom[i].value != that.custom[i].value) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+ResourceQuantities::const_iterator::const_iterator(const Scalars* _scalars)
+  : scalars(_scalars), slot(0), custom(0), current(nullptr)
+{
+  if (scalars != nullptr) {
+    settle();
+  }
+}
+
+
+void ResourceQuantities::const_iterator::settle()
+{
+  while (slot < Scalars::SLOTS && !(scalars->mask & (1u << slot))) {
+    ++slot;
+  }
+
+  const Scalars::Entry* fixed =
+    slot < Scalars::SLOTS ? &scalars->slots[slot] : nullptr;
+
+  const Scalars::Entry* other =
+    custom < scalars->custom.size() ? &scalars->custom[custom] : nullptr;
+
+  // Both the fixed slots and the custom entries are sorted by name.
+  if (fixed == nullptr) {
+    current = other;
+  } else if (other == nullptr || fixed->pair.first < other->pair.first) {
+    current = fixed;
+  } else {
+    current = other;
+  }
+}
+
+
+ResourceQuantities::const_iterator&
+ResourceQuantities::const_iterator::operator++()
+{
+  CHECK_NOTNULL(current);
+
+  if (slot < Scalars::SLOTS && current == &scalars->slots[slot]) {
+    ++slot;
+  } else {
+    ++custom;
+  }
+
+  settle();
+
+  return *this;
+}
+
+
+ResourceQuantities::const_iterator
+ResourceQuantities::const_iterator::operator++(int)
+{
+  const_iterator result = *this;
+  ++(*this);
+  return result;
+}
+
 
 // This function tries to be consistent with `Resources::fromSimpleString()`.
 // We trim the whitespace around the pair and in the number but whitespace in
@@ -131,12 +478,7 @@ ResourceQuantities ResourceQuantities::fromResources(const Resources& resources)
 }
 
 
-ResourceQuantities::ResourceQuantities()
-{
-  // Pre-reserve space for first-class resources.
-  // [cpus, disk, gpus, mem, ports]
-  quantities.reserve(5u);
-}
+ResourceQuantities::ResourceQuantities() {}
 
 
 ResourceQuantities::ResourceQuantities(
@@ -152,70 +494,75 @@ ResourceQuantities::ResourceQuantities(
 
 ResourceQuantities::const_iterator ResourceQuantities::begin()
 {
-  return static_cast<const std::vector<std::pair<std::string, Value::Scalar>>&>(
-             quantities)
-    .begin();
+  return const_iterator(&quantities);
 }
 
 
 ResourceQuantities::const_iterator ResourceQuantities::end()
 {
-  return static_cast<const std::vector<std::pair<std::string, Value::Scalar>>&>(
-             quantities)
-    .end();
+  return const_iterator(nullptr);
+}
+
+
+ResourceQuantities::const_iterator ResourceQuantities::begin() const
+{
+  return const_iterator(&quantities);
+}
+
+
+ResourceQuantities::const_iterator ResourceQuantities::end() const
+{
+  return const_iterator(nullptr);
 }
 
 
 Value::Scalar ResourceQuantities::get(const string& name) const
 {
-  // Don't bother binary searching since
-  // we don't expect a large number of elements.
-  foreach (auto& quantity, quantities) {
-    if (quantity.first == name) {
-      return quantity.second;
-    } else if (quantity.first > name) {
-      // We can return early since we keep names in alphabetical order.
-      break;
-    }
+  Value::Scalar result;
+
+  // A name which was never interned has no entry, and looking it up
+  // must not intern it.
+  Option<ResourceNames::Name> interned = ResourceNames::lookup(name);
+  if (interned.isNone()) {
+    return result;
+  }
+
+  const Scalars::Entry* quantity = quantities.find(interned->id);
+
+  if (quantity != nullptr) {
+    result = quantity->pair.second;
   }
 
-  return Value::Scalar();
+  return result;
+}
+
+
+Option<double> ResourceQuantities::find(uint32_t id) const
+{
+  const Scalars::Entry* quantity = quantities.find(id);
+
+  if (quantity == nullptr) {
+    return None();
+  }
+
+  return quantity->pair.second.value();
 }
 
 
 bool ResourceQuantities::contains(const ResourceQuantities& right) const
 {
-  size_t leftIndex = 0u;
-  size_t rightIndex = 0u;
+  bool result = true;
 
-  // Since quantities are sorted in alphabetical order, we can walk them
-  // at the same time.
-  while (leftIndex < size() && rightIndex < right.size()) {
-    const pair<string, Value::Scalar>& left_ = quantities.at(leftIndex);
-    const pair<string, Value::Scalar>& right_ = right.quantities.at(rightIndex);
+  right.quantities.foreachEntry([&](const Scalars::Entry& quantity) {
+    const Scalars::Entry* left = quantities.find(quantity.id);
 
-    if (left_.first < right_.first) {
-      // Item exists in the left but not in the right.
-      ++leftIndex;
-    } else if (left_.first > right_.first) {
-      // Item exists in the right but not in the left.
-      return false;
-    } else {
-      // Item exists in both left and right.
-      if (left_.second < right_.second) {
-        return false;
-      }
-      ++leftIndex;
-      ++rightIndex;
+    // Absent items in the left are zero.
+    if (left == nullptr || left->value < quantity.value) {
+      result = false;
     }
-  }
-
-  // Right contains items that left does not have.
-  if (rightIndex < right.size()) {
-    return false;
-  }
+  });
 
-  return true;
+  return result;
 }
 
 
@@ -234,37 +581,15 @@ bool ResourceQuantities::operator!=(const ResourceQuantities& that) const
 ResourceQuantities& ResourceQuantities::operator+=(
     const ResourceQuantities& right)
 {
-  size_t leftIndex = 0u;
-  size_t rightIndex = 0u;
-
-  // Since quantities are sorted in alphabetical order, we can walk them
-  // at the same time.
-  while (leftIndex < size() && rightIndex < right.size()) {
-    pair<string, Value::Scalar>& left_ = quantities.at(leftIndex);
-    const pair<string, Value::Scalar>& right_ = right.quantities.at(rightIndex);
-
-    if (left_.first < right_.first) {
-      // Item exists in the left but not in the right.
-      ++leftIndex;
-    } else if (left_.first > right_.first) {
-      // Item exists in the right but not in the left.
-      // Insert absent entries in the alphabetical order.
-      quantities.insert(quantities.begin() + leftIndex, right_);
-      ++leftIndex;
-      ++rightIndex;
+  right.quantities.foreachEntry([this](const Scalars::Entry& quantity) {
+    Scalars::Entry* left = quantities.find(quantity.id);
+
+    if (left != nullptr) {
+      left->set(left->value + quantity.value);
     } else {
-      // Item exists in both left and right.
-      left_.second += right_.second;
-      ++leftIndex;
-      ++rightIndex;
+      quantities.set(quantity.id, quantity.pair.first, quantity.value);
     }
-  }
-
-  // Copy the remaining items in `right`.
-  while (rightIndex < right.size()) {
-    quantities.push_back(right.quantities.at(rightIndex));
-    ++rightIndex;
-  }
+  });
 
   return *this;
 }
@@ -273,35 +598,28 @@ ResourceQuantities& ResourceQuantities::operator+=(
 ResourceQuantities& ResourceQuantities::operator-=(
     const ResourceQuantities& right)
 {
-  size_t leftIndex = 0u;
-  size_t rightIndex = 0u;
-
-  // Since quantities are sorted in alphabetical order, we can walk them
-  // at the same time.
-  while (leftIndex < size() && rightIndex < right.size()) {
-    pair<string, Value::Scalar>& left_ = quantities.at(leftIndex);
-    const pair<string, Value::Scalar>& right_ = right.quantities.at(rightIndex);
-
-    if (left_.first < right_.first) {
-      // Item exists in the left but not in the right.
-      ++leftIndex;
-    } else if (left_.first > right_.first) {
-      // Item exists in the right but not in the left (i.e. 0), this
-      // would result in a negative entry, so skip it.
-      ++rightIndex;
+  // Entries are erased below while iterating over `right`.
+  if (this == &right) {
+    quantities = Scalars();
+    return *this;
+  }
+
+  right.quantities.foreachEntry([this](const Scalars::Entry& quantity) {
+    Scalars::Entry* left = quantities.find(quantity.id);
+
+    // Items absent in the left (i.e. 0) would result
+    // in a negative entry, so skip them.
+    if (left == nullptr) {
+      return;
+    }
+
+    if (left->value <= quantity.value) {
+      // Drop negative and zero entries.
+      quantities.erase(quantity.id);
     } else {
-      // Item exists in both left and right.
-      if (left_.second <= right_.second) {
-        // Drop negative and zero entries.
-        quantities.erase(quantities.begin() + leftIndex);
-        ++rightIndex;
-      } else {
-        left_.second -= right_.second;
-        ++leftIndex;
-        ++rightIndex;
-      }
+      left->set(left->value - quantity.value);
     }
-  }
+  });
 
   return *this;
 }
@@ -329,27 +647,21 @@ void ResourceQuantities::add(const string& name, const Value::Scalar& scalar)
 {
   CHECK_GE(scalar, Value::Scalar());
 
+  const long long value = convertToFixed(scalar.value());
+
   // Ignore adding zero.
-  if (scalar == Value::Scalar()) {
+  if (value == 0) {
     return;
   }
 
-  // Find the location to insert while maintaining
-  // alphabetical ordering. Don't bother binary searching
-  // since we don't expect a large number of quantities.
-  auto it = quantities.begin();
-  for (; it != quantities.end(); ++it) {
-    if (it->first == name) {
-      it->second += scalar;
-      return;
-    }
+  const ResourceNames::Name interned = ResourceNames::intern(name);
 
-    if (it->first > name) {
-      break;
-    }
+  Scalars::Entry* quantity = quantities.find(interned.id);
+  if (quantity != nullptr) {
+    quantity->set(quantity->value + value);
+  } else {
+    quantities.set(interned.id, *interned.name, value);
   }
-
-  it = quantities.insert(it, std::make_pair(name, scalar));
 }
 
 
@@ -407,12 +719,7 @@ Try<ResourceLimits> ResourceLimits::fromString(const string& text)
 }
 
 
-ResourceLimits::ResourceLimits()
-{
-  // Pre-reserve space for first-class resources.
-  // [cpus, disk, gpus, mem, ports]
-  limits.reserve(5u);
-}
+ResourceLimits::ResourceLimits() {}
 
 
 ResourceLimits::ResourceLimits(
@@ -428,70 +735,74 @@ ResourceLimits::ResourceLimits(
 
 ResourceLimits::const_iterator ResourceLimits::begin()
 {
-  return static_cast<const std::vector<std::pair<std::string, Value::Scalar>>&>(
-           limits)
-    .begin();
+  return const_iterator(&limits);
 }
 
 
 ResourceLimits::const_iterator ResourceLimits::end()
 {
-  return static_cast<const std::vector<std::pair<std::string, Value::Scalar>>&>(
-           limits)
-    .end();
+  return const_iterator(nullptr);
 }
 
 
-Option<Value::Scalar> ResourceLimits::get(const string& name) const
+ResourceLimits::const_iterator ResourceLimits::begin() const
 {
-  // Don't bother binary searching since
-  // we don't expect a large number of elements.
-  foreach (auto&& limit, limits) {
-    if (limit.first == name) {
-      return limit.second;
-    } else if (limit.first > name) {
-      // We can return early since we keep names in alphabetical order.
-      break;
-    }
-  }
+  return const_iterator(&limits);
+}
+
 
-  return None();
+ResourceLimits::const_iterator ResourceLimits::end() const
+{
+  return const_iterator(nullptr);
 }
 
 
-bool ResourceLimits::contains(const ResourceLimits& right) const
+Option<Value::Scalar> ResourceLimits::get(const string& name) const
 {
-  size_t leftIndex = 0u;
-  size_t rightIndex = 0u;
+  Option<ResourceNames::Name> interned = ResourceNames::lookup(name);
+  if (interned.isNone()) {
+    return None();
+  }
 
-  // Since limits are sorted in alphabetical order, we can walk them
-  // at the same time.
-  while (leftIndex < size() && rightIndex < right.size()) {
-    const pair<string, Value::Scalar>& left_ = limits.at(leftIndex);
-    const pair<string, Value::Scalar>& right_ = right.limits.at(rightIndex);
+  const ResourceQuantities::Scalars::Entry* limit = limits.find(interned->id);
 
-    if (left_.first < right_.first) {
-      // Left has a finite limit but right has no limit.
-      return false;
-    } else if (left_.first > right_.first) {
-      // Left has a no limit but right has finite limit.
-      ++rightIndex;
-    } else {
-      // Left and right both have finite limits.
-      if (left_.second < right_.second) {
-        return false;
-      }
-      leftIndex++;
-      rightIndex++;
-    }
+  if (limit == nullptr) {
+    return None();
   }
 
-  if (leftIndex < size()) {
-    // Left has finite limits for resources that right has no limits for.
-    return false;
+  return limit->pair.second;
+}
+
+
+Option<double> ResourceLimits::find(uint32_t id) const
+{
+  const ResourceQuantities::Scalars::Entry* limit = limits.find(id);
+
+  if (limit == nullptr) {
+    return None();
   }
 
-  return true;
+  return limit->pair.second.value();
+}
+
+
+bool ResourceLimits::contains(const ResourceLimits& right) const
+{
+  bool result = true;
+
+  limits.foreachEntry(
+      [&](const ResourceQuantities::Scalars::Entry& left) {
+        const ResourceQuantities::Scalars::Entry* right_ =
+          right.limits.find(left.id);
+
+        // Left has a finite limit but right has no limit,
+        // or both have finite limits and left is smaller.
+        if (right_ == nullptr || left.value < right_->value) {
+          result = false;
+        }
+      });
+
+  return result;
 }
 
 
@@ -507,50 +818,35 @@ bool ResourceLimits::operator!=(const ResourceLimits& that) const
 }
 
 
-// TODO(mzhu): Given the friendship, optimize this to be one pass.
 bool ResourceLimits::contains(const ResourceQuantities& quantities) const
 {
-  foreachpair (const string& name, const Value::Scalar& quantity, quantities) {
-    Option<Value::Scalar> limit = get(name);
+  bool result = true;
 
-    if (limit.isSome() && *limit < quantity) {
-      return false;
-    }
-  }
+  quantities.quantities.foreachEntry(
+      [&](const ResourceQuantities::Scalars::Entry& quantity) {
+        const ResourceQuantities::Scalars::Entry* limit =
+          limits.find(quantity.id);
 
-  return true;
+        if (limit != nullptr && limit->value < quantity.value) {
+          result = false;
+        }
+      });
+
+  return result;
 }
 
 
 ResourceLimits& ResourceLimits::operator-=(const ResourceQuantities& quantities)
 {
-  size_t limitsIndex = 0u;
-  size_t quantitiesIndex = 0u;
-
-  // Since both limits and quantities are sorted in alphabetical order, we can
-  // walk them at the same time.
-  while (limitsIndex < size() && quantitiesIndex < quantities.size()) {
-    pair<string, Value::Scalar>& limit = limits.at(limitsIndex);
-    const pair<string, Value::Scalar>& quantity =
-      quantities.quantities.at(quantitiesIndex);
-
-    if (limit.first < quantity.first) {
-      // Item exists in limits but not in quantities i.e.
-      // finite limit minus zero quantity.
-      ++limitsIndex;
-    } else if (limit.first > quantity.first) {
-      // Item exists in quantities but not in limits i.e.
-      // infinite limit minus finite quantity.
-      ++quantitiesIndex;
-    } else {
-      // Item exists in both limits and quantities i.e.
-      // finite limits minus finite quantity.
-      limit.second = std::max(limit.second - quantity.second,
-                              Value::Scalar());
-      ++limitsIndex;
-      ++quantitiesIndex;
-    }
-  }
+  quantities.quantities.foreachEntry(
+      [this](const ResourceQuantities::Scalars::Entry& quantity) {
+        ResourceQuantities::Scalars::Entry* limit = limits.find(quantity.id);
+
+        // Infinite limits minus finite quantities remain infinite.
+        if (limit != nullptr) {
+          limit->set(std::max(limit->value - quantity.value, 0LL));
+        }
+      });
 
   return *this;
 }
@@ -568,23 +864,10 @@ ResourceLimits ResourceLimits::operator-(
 void ResourceLimits::set(
     const std::string& name, const Value::Scalar& scalar)
 {
-  // Find the location to insert while maintaining
-  // alphabetical ordering. Don't bother binary searching
-  // since we don't expect a large number of limits.
-  auto it = limits.begin();
-  for (; it != limits.end(); ++it) {
-    if (it->first == name) {
-      // Overwrite if it exists.
-      it->second = scalar;
-      return;
-    }
-
-    if (it->first > name) {
-      break;
-    }
-  }
+  // Overwrite if it exists.
+  const ResourceNames::Name interned = ResourceNames::intern(name);
 
-  it = limits.insert(it, std::make_pair(name, scalar));
+  limits.set(interned.id, *interned.name, convertToFixed(scalar.value()));
 }
 
 
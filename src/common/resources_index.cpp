@@ -0,0 +1,218 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include <ostream>
+#include <vector>
+
+#include <stout/foreach.hpp>
+#include <stout/stringify.hpp>
+
+#include "common/resources_index.hpp"
+
+using std::ostream;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+
+ResourcesIndex::ResourcesIndex(const Resources& resources)
+{
+  *this += resources;
+}
+
+
+uint64_t ResourcesIndex::key(const Resource_& resource_)
+{
+  return (static_cast<uint64_t>(resource_.nameId) << 32) |
+         resource_.metadataId;
+}
+
+
+bool ResourcesIndex::contains(const Resources& that) const
+{
+  // Resources whose metadata are not interned are checked against their
+  // bucket all at once, so that a persistent volume is not matched more
+  // than once (see `Resources::contains()`).
+  LinkedHashMap<uint64_t, Resources> groups;
+
+  foreach (
+      const Resource_Unsafe& resource_,
+      that.resourcesNoMutationWithoutExclusiveOwnership) {
+    const uint64_t key = ResourcesIndex::key(*resource_);
+
+    if (!buckets.contains(key)) {
+      return false;
+    }
+
+    if (resource_->metadataId == 0) {
+      groups[key].add(resource_);
+    } else if (!buckets.at(key)._contains(*resource_)) {
+      return false;
+    }
+  }
+
+  foreachpair (uint64_t key, const Resources& group, groups) {
+    if (!buckets.at(key).contains(group)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+Try<Nothing> ResourcesIndex::apply(
+    const vector<ResourceConversion>& conversions)
+{
+  // A single conversion without post validation, which is the common
+  // case, can be checked before modifying the index in place.
+  if (conversions.size() == 1 && conversions[0].postValidation.isNone()) {
+    const ResourceConversion& conversion = conversions[0];
+
+    if (!contains(conversion.consumed)) {
+      return Error(
+          stringify(*this) + " does not contain " +
+          stringify(conversion.consumed));
+    }
+
+    *this -= conversion.consumed;
+    *this += conversion.converted;
+
+    return Nothing();
+  }
+
+  ResourcesIndex result = *this;
+
+  foreach (const ResourceConversion& conversion, conversions) {
+    if (!result.contains(conversion.consumed)) {
+      return Error(
+          stringify(result) + " does not contain " +
+          stringify(conversion.consumed));
+    }
+
+    result -= conversion.consumed;
+    result += conversion.converted;
+
+    if (conversion.postValidation.isSome()) {
+      Try<Nothing> validation =
+        conversion.postValidation.get()(result.resources());
+
+      if (validation.isError()) {
+        return Error(validation.error());
+      }
+    }
+  }
+
+  *this = std::move(result);
+
+  return Nothing();
+}
+
+
+ResourcesIndex& ResourcesIndex::operator+=(const Resources& that)
+{
+  foreach (
+      const Resource_Unsafe& resource_,
+      that.resourcesNoMutationWithoutExclusiveOwnership) {
+    buckets[key(*resource_)].add(resource_);
+  }
+
+  return *this;
+}
+
+
+ResourcesIndex& ResourcesIndex::operator-=(const Resources& that)
+{
+  foreach (
+      const Resource_Unsafe& resource_,
+      that.resourcesNoMutationWithoutExclusiveOwnership) {
+    const uint64_t key = ResourcesIndex::key(*resource_);
+
+    if (buckets.contains(key)) {
+      Resources& bucket = buckets.at(key);
+      bucket.subtract(*resource_);
+
+      if (bucket.empty()) {
+        buckets.erase(key);
+      }
+    }
+  }
+
+  return *this;
+}
+
+
+Resources ResourcesIndex::shared() const
+{
+  Resources result;
+
+  // Shared resources are never interned.
+  foreachpair (uint64_t key, const Resources& bucket, buckets) {
+    if ((key & 0xffffffff) == 0) {
+      result += bucket.shared();
+    }
+  }
+
+  return result;
+}
+
+
+Resources ResourcesIndex::nonShared() const
+{
+  Resources result;
+
+  foreachpair (uint64_t key, const Resources& bucket, buckets) {
+    const Resources nonShared =
+      (key & 0xffffffff) == 0 ? bucket.nonShared() : bucket;
+
+    // Resources of different buckets can never be combined, so they are
+    // appended without looking for an addable resource object.
+    result.resourcesNoMutationWithoutExclusiveOwnership.insert(
+        result.resourcesNoMutationWithoutExclusiveOwnership.end(),
+        nonShared.resourcesNoMutationWithoutExclusiveOwnership.begin(),
+        nonShared.resourcesNoMutationWithoutExclusiveOwnership.end());
+  }
+
+  return result;
+}
+
+
+Resources ResourcesIndex::resources() const
+{
+  Resources result;
+
+  foreachvalue (const Resources& bucket, buckets) {
+    // Resources of different buckets can never be combined, so they are
+    // appended without looking for an addable resource object.
+    result.resourcesNoMutationWithoutExclusiveOwnership.insert(
+        result.resourcesNoMutationWithoutExclusiveOwnership.end(),
+        bucket.resourcesNoMutationWithoutExclusiveOwnership.begin(),
+        bucket.resourcesNoMutationWithoutExclusiveOwnership.end());
+  }
+
+  return result;
+}
+
+
+ostream& operator<<(ostream& stream, const ResourcesIndex& index)
+{
+  return stream << index.resources();
+}
+
+} // namespace internal {
+} // namespace mesos {
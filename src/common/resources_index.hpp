@@ -0,0 +1,90 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __COMMON_RESOURCES_INDEX_HPP__
+#define __COMMON_RESOURCES_INDEX_HPP__
+
+#include <stdint.h>
+
+#include <iosfwd>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <stout/linkedhashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+
+/**
+ * An index of resources keyed by the name and the metadata (i.e., the
+ * allocation, the reservations and the revocability) of the resources.
+ *
+ * `Resources` checks containment and subtracts by comparing every pair
+ * of resource objects, which is quadratic when the same resources are
+ * checked against many others, e.g., when validating a batch of
+ * operations against offered resources. The index instead locates the
+ * resource object matching each resource in constant time. Resources
+ * whose metadata are not interned (e.g., disk and shared resources) are
+ * grouped by name and compared with the other resources of that name.
+ */
+class ResourcesIndex
+{
+public:
+  ResourcesIndex() = default;
+
+  /*implicit*/ ResourcesIndex(const Resources& resources);
+
+  // Checks if the indexed resources contain `that`, with the same
+  // semantics as `Resources::contains()`.
+  bool contains(const Resources& that) const;
+
+  // Applies the conversions in order, failing if the indexed resources
+  // do not contain the consumed resources of a conversion. The index is
+  // left unchanged on failure.
+  Try<Nothing> apply(const std::vector<ResourceConversion>& conversions);
+
+  ResourcesIndex& operator+=(const Resources& that);
+  ResourcesIndex& operator-=(const Resources& that);
+
+  bool empty() const { return buckets.empty(); }
+
+  Resources shared() const;
+  Resources nonShared() const;
+
+  // Returns the indexed resources.
+  Resources resources() const;
+
+private:
+  typedef Resources::Resource_ Resource_;
+  typedef Resources::Resource_Unsafe Resource_Unsafe;
+
+  static uint64_t key(const Resource_& resource_);
+
+  // The resources of each key. There is a single resource object in the
+  // bucket of interned metadata, since such resources are combined.
+  LinkedHashMap<uint64_t, Resources> buckets;
+};
+
+
+std::ostream& operator<<(std::ostream& stream, const ResourcesIndex& index);
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __COMMON_RESOURCES_INDEX_HPP__
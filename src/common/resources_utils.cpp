@@ -15,13 +15,16 @@
 // limitations under the License.
 
 #include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/stringify.hpp>
 
+#include "common/resource_names.hpp"
 #include "common/resources_utils.hpp"
 
 using std::vector;
 
 using google::protobuf::Descriptor;
+using google::protobuf::FieldDescriptor;
 using google::protobuf::Message;
 using google::protobuf::RepeatedPtrField;
 
@@ -374,6 +377,27 @@ void convertResourceFormat(Resource* resource, ResourceFormat format)
         }
         // Resource with a single reservation.
         case 1: {
+          if (format == PRE_RESERVATION_REFINEMENT) {
+            // Since the "post-reservation-refinement" fields are cleared,
+            // the reservation is moved rather than copied. Its `type` and
+            // `role` do not exist in the "pre-reservation-refinement"
+            // format and are cleared.
+            Resource::ReservationInfo* reservation =
+              resource->mutable_reservation();
+
+            reservation->Swap(resource->mutable_reservations(0));
+            resource->clear_reservations();
+            resource->mutable_role()->swap(*reservation->mutable_role());
+
+            if (reservation->type() == Resource::ReservationInfo::DYNAMIC) {
+              reservation->clear_type();
+              reservation->clear_role();
+            } else {
+              resource->clear_reservation();
+            }
+            break;
+          }
+
           const Resource::ReservationInfo& source = resource->reservations(0);
 
           if (source.type() == Resource::ReservationInfo::DYNAMIC) {
@@ -387,10 +411,6 @@ void convertResourceFormat(Resource* resource, ResourceFormat format)
           }
 
           resource->set_role(source.role());
-
-          if (format == PRE_RESERVATION_REFINEMENT) {
-            resource->clear_reservations();
-          }
           break;
         }
         // Resource with refined reservations.
@@ -404,6 +424,13 @@ void convertResourceFormat(Resource* resource, ResourceFormat format)
       break;
     }
     case POST_RESERVATION_REFINEMENT: {
+      // Fast path for resources which are already in the
+      // "post-reservation-refinement" format (including unreserved
+      // resources in any format), which is the common case.
+      if (!resource->has_role() && !resource->has_reservation()) {
+        return;
+      }
+
       if (resource->reservations_size() > 0) {
         // In this case, we're either already in
         // the "post-reservation-refinement" format,
@@ -427,16 +454,17 @@ void convertResourceFormat(Resource* resource, ResourceFormat format)
       Resource::ReservationInfo* reservation = resource->add_reservations();
 
       // Check the `Resource.reservation` to determine whether
-      // we have a static or dynamic reservation.
+      // we have a static or dynamic reservation. The reservation
+      // and the role are moved since they are cleared afterwards.
       if (!resource->has_reservation()) {
         reservation->set_type(Resource::ReservationInfo::STATIC);
       } else {
-        reservation->CopyFrom(resource->reservation());
+        reservation->Swap(resource->mutable_reservation());
         resource->clear_reservation();
         reservation->set_type(Resource::ReservationInfo::DYNAMIC);
       }
 
-      reservation->set_role(resource->role());
+      reservation->mutable_role()->swap(*resource->mutable_role());
       resource->clear_role();
       break;
     }
@@ -466,42 +494,100 @@ void convertResourceFormat(
 
 namespace internal {
 
-// Given a protobuf descriptor `descriptor`, recursively populates the provided
-// `result` where the keys are the message descriptors within `descriptor`'s
-// schema (including itself), and the corresponding value is `true` if the key
-// contains a `mesos::Resource`, and `false` otherwise.
-static void precomputeResourcesContainment(
-    const Descriptor* descriptor,
-    hashmap<const Descriptor*, bool>* result)
+// Returns whether messages of the type described by `descriptor`
+// can contain a `mesos::Resource`, either directly or within nested
+// messages.
+//
+// The result is computed at once for all the message types reachable
+// from `descriptor`, iterating to a fixed point to account for
+// recursive message types. Since descriptors live as long as the
+// process, results are cached by each thread.
+static bool containsResources(const Descriptor* descriptor)
 {
   CHECK_NOTNULL(descriptor);
-  CHECK_NOTNULL(result);
 
-  if (result->contains(descriptor)) {
-    return;
-  }
+  thread_local hashmap<const Descriptor*, bool> cache;
 
-  if (descriptor == mesos::Resource::descriptor()) {
-    result->insert({descriptor, true});
+  auto cached = cache.find(descriptor);
+  if (cached != cache.end()) {
+    return cached->second;
   }
 
-  result->insert({descriptor, false});
-  for (int i = 0; i < descriptor->field_count(); ++i) {
-    // `message_type()` returns `nullptr` if the field is not a message type.
-    const Descriptor* messageDescriptor = descriptor->field(i)->message_type();
-    if (messageDescriptor == nullptr) {
+  // Collect the message types reachable from `descriptor`
+  // for which the result is not cached yet.
+  vector<const Descriptor*> descriptors;
+  hashset<const Descriptor*> visited;
+  vector<const Descriptor*> stack = {descriptor};
+
+  while (!stack.empty()) {
+    const Descriptor* current = stack.back();
+    stack.pop_back();
+
+    if (visited.contains(current) || cache.contains(current)) {
       continue;
     }
-    precomputeResourcesContainment(messageDescriptor, result);
-    result->at(descriptor) |= result->at(messageDescriptor);
+
+    visited.insert(current);
+    descriptors.push_back(current);
+
+    for (int i = 0; i < current->field_count(); ++i) {
+      // `message_type()` returns `nullptr` if the field is not a message.
+      const Descriptor* messageDescriptor = current->field(i)->message_type();
+      if (messageDescriptor != nullptr) {
+        stack.push_back(messageDescriptor);
+      }
+    }
+  }
+
+  hashmap<const Descriptor*, bool> result;
+  foreach (const Descriptor* current, descriptors) {
+    result[current] = current == mesos::Resource::descriptor();
+  }
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    foreach (const Descriptor* current, descriptors) {
+      if (result.at(current)) {
+        continue;
+      }
+
+      for (int i = 0; i < current->field_count(); ++i) {
+        const Descriptor* messageDescriptor = current->field(i)->message_type();
+        if (messageDescriptor == nullptr) {
+          continue;
+        }
+
+        if (cache.contains(messageDescriptor)
+              ? cache.at(messageDescriptor)
+              : result.at(messageDescriptor)) {
+          result[current] = true;
+          changed = true;
+          break;
+        }
+      }
+    }
   }
+
+  foreachpair (const Descriptor* current, bool contains, result) {
+    cache[current] = contains;
+  }
+
+  return cache.at(descriptor);
 }
 
 
+// Converts all resources within `message` in a single pass. Fields
+// holding `Resource`s are converted as a whole by `convertResources`,
+// and messages which cannot contain resources are skipped.
+//
+// NOTE: The conversion is done in place, which also works for arena
+// allocated messages.
 static Try<Nothing> convertResourcesImpl(
     Message* message,
     Try<Nothing> (*convertResource)(mesos::Resource* resource),
-    const hashmap<const Descriptor*, bool>& resourcesContainment)
+    Try<Nothing> (*convertResources)(RepeatedPtrField<mesos::Resource>*))
 {
   CHECK_NOTNULL(message);
 
@@ -514,11 +600,10 @@ static Try<Nothing> convertResourcesImpl(
   const google::protobuf::Reflection* reflection = message->GetReflection();
 
   for (int i = 0; i < descriptor->field_count(); ++i) {
-    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    const FieldDescriptor* field = descriptor->field(i);
     const Descriptor* messageDescriptor = field->message_type();
 
-    if (messageDescriptor == nullptr ||
-        !resourcesContainment.at(messageDescriptor)) {
+    if (messageDescriptor == nullptr || !containsResources(messageDescriptor)) {
       continue;
     }
 
@@ -527,7 +612,17 @@ static Try<Nothing> convertResourcesImpl(
         Try<Nothing> result = convertResourcesImpl(
             reflection->MutableMessage(message, field),
             convertResource,
-            resourcesContainment);
+            convertResources);
+
+        if (result.isError()) {
+          return result;
+        }
+      }
+    } else if (messageDescriptor == mesos::Resource::descriptor()) {
+      if (reflection->FieldSize(*message, field) > 0) {
+        Try<Nothing> result = convertResources(
+            reflection->MutableRepeatedPtrField<mesos::Resource>(
+                message, field));
 
         if (result.isError()) {
           return result;
@@ -540,7 +635,7 @@ static Try<Nothing> convertResourcesImpl(
         Try<Nothing> result = convertResourcesImpl(
             reflection->MutableRepeatedMessage(message, field, j),
             convertResource,
-            resourcesContainment);
+            convertResources);
 
         if (result.isError()) {
           return result;
@@ -577,12 +672,7 @@ void upgradeResources(Message* message)
 {
   CHECK_NOTNULL(message);
 
-  const Descriptor* descriptor = message->GetDescriptor();
-
-  hashmap<const Descriptor*, bool> resourcesContainment;
-  internal::precomputeResourcesContainment(descriptor, &resourcesContainment);
-
-  if (!resourcesContainment.at(descriptor)) {
+  if (!internal::containsResources(message->GetDescriptor())) {
     return;
   }
 
@@ -592,7 +682,10 @@ void upgradeResources(Message* message)
         upgradeResource(resource);
         return Nothing();
       },
-      resourcesContainment);
+      [](RepeatedPtrField<Resource>* resources) -> Try<Nothing> {
+        upgradeResources(resources);
+        return Nothing();
+      });
 }
 
 
@@ -891,17 +984,12 @@ Try<Nothing> downgradeResources(Message* message)
 {
   CHECK_NOTNULL(message);
 
-  const Descriptor* descriptor = message->GetDescriptor();
-
-  hashmap<const Descriptor*, bool> resourcesContainment;
-  internal::precomputeResourcesContainment(descriptor, &resourcesContainment);
-
-  if (!resourcesContainment.at(descriptor)) {
+  if (!internal::containsResources(message->GetDescriptor())) {
     return Nothing();
   }
 
   return internal::convertResourcesImpl(
-      message, downgradeResource, resourcesContainment);
+      message, downgradeResource, downgradeResources);
 }
 
 
@@ -918,9 +1006,15 @@ Resources shrinkResources(const Resources& resources, ResourceQuantities target)
 
   Resources result;
   foreach (Resource& resource, resourceVector) {
-    Value::Scalar scalar = target.get(resource.name());
+    // The target is looked up by the interned name identifier, since
+    // this is called on the quota headroom path of every allocation.
+    Option<internal::ResourceNames::Name> name =
+      internal::ResourceNames::lookup(resource.name());
 
-    if (scalar == Value::Scalar()) {
+    Option<double> quantity =
+      name.isSome() ? target.find(name->id) : Option<double>::none();
+
+    if (quantity.isNone()) {
       // Resource that has zero quantity is dropped (shrunk to zero).
       continue;
     }
@@ -928,6 +1022,9 @@ Resources shrinkResources(const Resources& resources, ResourceQuantities target)
     // Target can only be explicitly specified for scalar resources.
     CHECK_EQ(Value::SCALAR, resource.type()) << " Resources: " << resources;
 
+    Value::Scalar scalar;
+    scalar.set_value(quantity.get());
+
     if (Resources::shrink(&resource, scalar)) {
       target -= ResourceQuantities::fromScalarResource(resource);
       result += std::move(resource);
@@ -951,7 +1048,11 @@ Resources shrinkResources(const Resources& resources, ResourceLimits target)
 
   Resources result;
   foreach (Resource resource, resourceVector) {
-    Option<Value::Scalar> limit = target.get(resource.name());
+    Option<internal::ResourceNames::Name> name =
+      internal::ResourceNames::lookup(resource.name());
+
+    Option<double> limit =
+      name.isSome() ? target.find(name->id) : Option<double>::none();
 
     if (limit.isNone()) {
       // Resource that has infinite limit is kept as is.
@@ -962,7 +1063,10 @@ Resources shrinkResources(const Resources& resources, ResourceLimits target)
     // Target can only be explicitly specified for scalar resources.
     CHECK_EQ(Value::SCALAR, resource.type()) << " Resources: " << resources;
 
-    if (Resources::shrink(&resource, *limit)) {
+    Value::Scalar scalar;
+    scalar.set_value(limit.get());
+
+    if (Resources::shrink(&resource, scalar)) {
       target -= ResourceQuantities::fromScalarResource(resource);
       result += std::move(resource);
     }
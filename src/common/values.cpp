@@ -38,40 +38,17 @@
 using std::max;
 using std::min;
 using std::ostream;
+using std::pair;
 using std::string;
 using std::vector;
 
+using mesos::internal::values::convertToFixed;
+using mesos::internal::values::convertToFloating;
 using mesos::internal::values::intervalSetToRanges;
 using mesos::internal::values::rangesToIntervalSet;
 
 namespace mesos {
 
-// We manipulate scalar values by converting them from floating point to a
-// fixed point representation, doing a calculation, and then converting
-// the result back to floating point. We deliberately only preserve three
-// decimal digits of precision in the fixed point representation. This
-// ensures that client applications see predictable numerical behavior, at
-// the expense of sacrificing some precision.
-
-static long long convertToFixed(double floatValue)
-{
-  return std::llround(floatValue * 1000);
-}
-
-
-static double convertToFloating(long long fixedValue)
-{
-  // NOTE: We do the conversion from fixed point via integer division
-  // and then modulus, rather than a single floating point division.
-  // This ensures that we only apply floating point division to inputs
-  // in the range [0,999], which is easier to check for correctness.
-  double quotient = static_cast<double>(fixedValue / 1000);
-  double remainder = static_cast<double>(fixedValue % 1000) / 1000.0;
-
-  return quotient + remainder;
-}
-
-
 ostream& operator<<(ostream& stream, const Value::Scalar& scalar)
 {
   // Output the scalar's full significant digits and save the old
@@ -752,6 +729,123 @@ Try<Value> parse(const string& text)
   return Error("Unexpected '[' found");
 }
 
+
+// Appends `interval` to the flat ranges `result`, merging it with the
+// last interval of `result` if they overlap or are adjacent. Intervals
+// must be appended in the order of their lower bounds.
+static void append(
+    FlatRanges* result,
+    const pair<uint64_t, uint64_t>& interval)
+{
+  if (!result->empty() &&
+      (result->back().second == std::numeric_limits<uint64_t>::max() ||
+       interval.first <= result->back().second + 1)) {
+    result->back().second = max(result->back().second, interval.second);
+  } else {
+    result->push_back(interval);
+  }
+}
+
+
+FlatRanges add(const FlatRanges& left, const FlatRanges& right)
+{
+  if (left.empty()) {
+    return right;
+  }
+
+  if (right.empty()) {
+    return left;
+  }
+
+  FlatRanges result;
+  result.reserve(left.size() + right.size());
+
+  auto itLeft = left.begin();
+  auto itRight = right.begin();
+
+  while (itLeft != left.end() && itRight != right.end()) {
+    if (itLeft->first <= itRight->first) {
+      append(&result, *itLeft++);
+    } else {
+      append(&result, *itRight++);
+    }
+  }
+
+  for (; itLeft != left.end(); ++itLeft) {
+    append(&result, *itLeft);
+  }
+
+  for (; itRight != right.end(); ++itRight) {
+    append(&result, *itRight);
+  }
+
+  return result;
+}
+
+
+FlatRanges subtract(const FlatRanges& left, const FlatRanges& right)
+{
+  if (left.empty() || right.empty()) {
+    return left;
+  }
+
+  FlatRanges result;
+  result.reserve(left.size() + right.size());
+
+  auto itRight = right.begin();
+
+  for (pair<uint64_t, uint64_t> interval : left) {
+    // Skip the intervals of `right` which end before this interval.
+    while (itRight != right.end() && itRight->second < interval.first) {
+      ++itRight;
+    }
+
+    // Cut the intervals of `right` which overlap with this interval
+    // out of it. The last of them may also overlap with the next
+    // interval of `left`, so we do not advance past it.
+    auto it = itRight;
+    for (; it != right.end() && it->first <= interval.second; ++it) {
+      if (it->first > interval.first) {
+        result.emplace_back(interval.first, it->first - 1);
+      }
+
+      if (it->second >= interval.second) {
+        break;
+      }
+
+      interval.first = it->second + 1;
+    }
+
+    if (it == right.end() || it->first > interval.second) {
+      result.push_back(interval);
+    }
+  }
+
+  return result;
+}
+
+
+bool contains(const FlatRanges& left, const FlatRanges& right)
+{
+  auto itLeft = left.begin();
+
+  foreach (const auto& interval, right) {
+    // Since `left` is coalesced, `interval` can only be covered by
+    // the first interval of `left` which does not end before it.
+    while (itLeft != left.end() && itLeft->second < interval.first) {
+      ++itLeft;
+    }
+
+    if (itLeft == left.end() ||
+        itLeft->first > interval.first ||
+        itLeft->second < interval.second) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 } // namespace values {
 } // namespace internal {
 } // namespace mesos {
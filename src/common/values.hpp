@@ -17,8 +17,13 @@
 #ifndef __COMMON_VALUES_HPP__
 #define __COMMON_VALUES_HPP__
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <mesos/mesos.hpp>
@@ -31,6 +36,31 @@ namespace mesos {
 namespace internal {
 namespace values {
 
+// We manipulate scalar values by converting them from floating point to a
+// fixed point representation, doing a calculation, and then converting
+// the result back to floating point. We deliberately only preserve three
+// decimal digits of precision in the fixed point representation. This
+// ensures that client applications see predictable numerical behavior, at
+// the expense of sacrificing some precision.
+inline long long convertToFixed(double floatValue)
+{
+  return std::llround(floatValue * 1000);
+}
+
+
+inline double convertToFloating(long long fixedValue)
+{
+  // NOTE: We do the conversion from fixed point via integer division
+  // and then modulus, rather than a single floating point division.
+  // This ensures that we only apply floating point division to inputs
+  // in the range [0,999], which is easier to check for correctness.
+  double quotient = static_cast<double>(fixedValue / 1000);
+  double remainder = static_cast<double>(fixedValue % 1000) / 1000.0;
+
+  return quotient + remainder;
+}
+
+
 // Convert Ranges value to IntervalSet value.
 template <typename T>
 Try<IntervalSet<T>> rangesToIntervalSet(const Value::Ranges& ranges)
@@ -98,6 +128,97 @@ Value::Ranges intervalSetToRanges(const IntervalSet<T>& set)
   return ranges;
 }
 
+
+// A flat representation of range values: a vector of disjoint and
+// non-adjacent closed intervals, sorted by their bounds. Operations on
+// flat ranges are linear merges over contiguous memory.
+typedef std::vector<std::pair<uint64_t, uint64_t>> FlatRanges;
+
+
+// Returns the union of two flat ranges.
+FlatRanges add(const FlatRanges& left, const FlatRanges& right);
+
+
+// Returns `left` without the intervals covered by `right`.
+FlatRanges subtract(const FlatRanges& left, const FlatRanges& right);
+
+
+// Returns true if every interval of `right` is covered by `left`.
+bool contains(const FlatRanges& left, const FlatRanges& right);
+
+
+// Converts a `Value::Ranges` (v0 or v1) into flat ranges by sorting and
+// coalescing its intervals.
+template <typename Ranges>
+FlatRanges toFlatRanges(const Ranges& ranges)
+{
+  FlatRanges intervals;
+  intervals.reserve(ranges.range_size());
+
+  for (int i = 0; i < ranges.range_size(); ++i) {
+    intervals.emplace_back(ranges.range(i).begin(), ranges.range(i).end());
+  }
+
+  if (std::is_sorted(intervals.begin(), intervals.end())) {
+    // Fast path for ranges which are already coalesced, which is the
+    // case for all ranges produced by the arithmetic operators.
+    bool coalesced = true;
+    for (size_t i = 1; i < intervals.size(); ++i) {
+      if (intervals[i - 1].second == std::numeric_limits<uint64_t>::max() ||
+          intervals[i].first <= intervals[i - 1].second + 1) {
+        coalesced = false;
+        break;
+      }
+    }
+
+    if (coalesced) {
+      return intervals;
+    }
+  } else {
+    std::sort(intervals.begin(), intervals.end());
+  }
+
+  FlatRanges result;
+  result.reserve(intervals.size());
+
+  for (const std::pair<uint64_t, uint64_t>& interval : intervals) {
+    if (!result.empty() &&
+        (result.back().second == std::numeric_limits<uint64_t>::max() ||
+         interval.first <= result.back().second + 1)) {
+      result.back().second = std::max(result.back().second, interval.second);
+    } else {
+      result.push_back(interval);
+    }
+  }
+
+  return result;
+}
+
+
+// Overwrites the `Value::Ranges` (v0 or v1) `ranges` with the flat
+// ranges `intervals`, reusing the existing range messages.
+template <typename Ranges>
+void fromFlatRanges(const FlatRanges& intervals, Ranges* ranges)
+{
+  const int count = static_cast<int>(intervals.size());
+
+  if (count < ranges->range_size()) {
+    ranges->mutable_range()->DeleteSubrange(
+        count, ranges->range_size() - count);
+  }
+
+  ranges->mutable_range()->Reserve(count);
+
+  for (int i = 0; i < count; ++i) {
+    if (i >= ranges->range_size()) {
+      ranges->add_range();
+    }
+
+    ranges->mutable_range(i)->set_begin(intervals[i].first);
+    ranges->mutable_range(i)->set_end(intervals[i].second);
+  }
+}
+
 } // namespace values {
 } // namespace internal {
 } // namespace mesos {
@@ -0,0 +1,1050 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sys/statfs.h>
+#include <sys/types.h>
+
+// This header include must be enclosed in an `extern "C"` block to
+// workaround a bug in glibc <= 2.12 (see MESOS-7378).
+//
+// TODO(gilbert): Remove this when we no longer support glibc <= 2.12.
+extern "C" {
+#include <sys/sysmacros.h>
+}
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <process/after.hpp>
+#include <process/loop.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "linux/cgroups2.hpp"
+#include "linux/fs.hpp"
+
+using namespace mesos::internal;
+
+using process::Break;
+using process::Continue;
+using process::ControlFlow;
+using process::Failure;
+using process::Future;
+
+using std::list;
+using std::set;
+using std::string;
+using std::vector;
+
+// Defined in 'linux/magic.h' since Linux 4.5.
+#ifndef CGROUP2_SUPER_MAGIC
+#define CGROUP2_SUPER_MAGIC 0x63677270
+#endif
+
+namespace cgroups2 {
+
+namespace internal {
+
+// Parse a limit which is either a number or "max" (i.e., unlimited).
+Try<Option<uint64_t>> parseLimit(const string& value)
+{
+  const string trimmed = strings::trim(value);
+
+  if (trimmed == "max") {
+    return None();
+  }
+
+  Try<uint64_t> limit = numify<uint64_t>(trimmed);
+  if (limit.isError()) {
+    return Error("Failed to parse limit '" + trimmed + "': " + limit.error());
+  }
+
+  return limit.get();
+}
+
+
+string stringifyLimit(const Option<uint64_t>& limit)
+{
+  return limit.isSome() ? stringify(limit.get()) : "max";
+}
+
+
+// Parse a line of "<key>=<value>" pairs following a leading token,
+// as found in the pressure and io control files.
+Try<hashmap<string, string>> parseKeyedLine(const vector<string>& tokens)
+{
+  hashmap<string, string> result;
+
+  for (size_t i = 1; i < tokens.size(); i++) {
+    vector<string> pair = strings::split(tokens[i], "=");
+    if (pair.size() != 2) {
+      return Error("Unexpected token '" + tokens[i] + "'");
+    }
+
+    result[pair[0]] = pair[1];
+  }
+
+  return result;
+}
+
+} // namespace internal {
+
+
+Try<bool> mounted(const string& hierarchy)
+{
+  if (!os::exists(hierarchy)) {
+    return false;
+  }
+
+  struct statfs buffer;
+  if (::statfs(hierarchy.c_str(), &buffer) < 0) {
+    return ErrnoError("Failed to statfs '" + hierarchy + "'");
+  }
+
+  if (buffer.f_type != CGROUP2_SUPER_MAGIC) {
+    return false;
+  }
+
+  // Make sure that the path is the root of the hierarchy rather than
+  // a cgroup within it, which holds no 'cgroup.type' control file.
+  return !os::exists(path::join(hierarchy, "cgroup.type"));
+}
+
+
+Result<string> hierarchy()
+{
+  Try<fs::MountTable> table = fs::MountTable::read("/proc/self/mounts");
+  if (table.isError()) {
+    return Error("Failed to read the mount table: " + table.error());
+  }
+
+  foreach (const fs::MountTable::Entry& entry, table->entries) {
+    if (entry.type == "cgroup2") {
+      return entry.dir;
+    }
+  }
+
+  return None();
+}
+
+
+Try<Nothing> create(
+    const string& hierarchy,
+    const string& cgroup,
+    bool recursive)
+{
+  const string path = path::join(hierarchy, cgroup);
+
+  Try<Nothing> mkdir = os::mkdir(path, recursive);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create directory '" + path + "': " + mkdir.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> remove(const string& hierarchy, const string& cgroup)
+{
+  const string path = path::join(hierarchy, cgroup);
+
+  // Do NOT recursively remove cgroups.
+  Try<Nothing> rmdir = os::rmdir(path, false);
+  if (rmdir.isError()) {
+    return Error("Failed to remove cgroup '" + path + "': " + rmdir.error());
+  }
+
+  return Nothing();
+}
+
+
+bool exists(const string& hierarchy, const string& cgroup)
+{
+  return os::exists(path::join(hierarchy, cgroup));
+}
+
+
+Try<vector<string>> get(const string& hierarchy, const string& cgroup)
+{
+  Try<list<string>> entries = os::ls(path::join(hierarchy, cgroup));
+  if (entries.isError()) {
+    return Error(
+        "Failed to list cgroup '" + path::join(hierarchy, cgroup) + "': " +
+        entries.error());
+  }
+
+  vector<string> cgroups;
+
+  foreach (const string& entry, entries.get()) {
+    const string child = path::join(cgroup, entry);
+
+    if (!os::stat::isdir(path::join(hierarchy, child))) {
+      continue;
+    }
+
+    Try<vector<string>> descendants = get(hierarchy, child);
+    if (descendants.isError()) {
+      return Error(descendants.error());
+    }
+
+    foreach (const string& descendant, descendants.get()) {
+      cgroups.push_back(descendant);
+    }
+
+    cgroups.push_back(strings::trim(child, "/"));
+  }
+
+  return cgroups;
+}
+
+
+Try<string> read(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control)
+{
+  return os::read(path::join(hierarchy, cgroup, control));
+}
+
+
+Try<Nothing> write(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control,
+    const string& value)
+{
+  return os::write(path::join(hierarchy, cgroup, control), value);
+}
+
+
+Try<hashmap<string, uint64_t>> stat(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> contents = read(hierarchy, cgroup, control);
+  if (contents.isError()) {
+    return Error(
+        "Failed to read '" + control + "': " + contents.error());
+  }
+
+  hashmap<string, uint64_t> result;
+
+  foreach (const string& line, strings::tokenize(contents.get(), "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.size() != 2) {
+      return Error("Unexpected line format in '" + control + "': " + line);
+    }
+
+    Try<uint64_t> value = numify<uint64_t>(tokens[1]);
+    if (value.isError()) {
+      return Error("Unexpected line format in '" + control + "': " + line);
+    }
+
+    result[tokens[0]] = value.get();
+  }
+
+  return result;
+}
+
+
+Try<set<pid_t>> processes(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "cgroup.procs");
+  if (contents.isError()) {
+    return Error("Failed to read 'cgroup.procs': " + contents.error());
+  }
+
+  set<pid_t> pids;
+
+  foreach (const string& line, strings::tokenize(contents.get(), "\n")) {
+    Try<pid_t> pid = numify<pid_t>(strings::trim(line));
+    if (pid.isError()) {
+      return Error("Failed to parse '" + line + "': " + pid.error());
+    }
+
+    pids.insert(pid.get());
+  }
+
+  return pids;
+}
+
+
+Try<Nothing> assign(const string& hierarchy, const string& cgroup, pid_t pid)
+{
+  return write(hierarchy, cgroup, "cgroup.procs", stringify(pid));
+}
+
+
+Result<string> cgroup(pid_t pid)
+{
+  const string path = path::join("/proc", stringify(pid), "cgroup");
+
+  Try<string> contents = os::read(path);
+  if (contents.isError()) {
+    return Error("Failed to read '" + path + "': " + contents.error());
+  }
+
+  // Each line is of the form "N:subsystems:cgroup". The entry of the
+  // unified hierarchy always has hierarchy ID 0 and no subsystems.
+  foreach (const string& line, strings::tokenize(contents.get(), "\n")) {
+    if (strings::startsWith(line, "0::")) {
+      return line.substr(3);
+    }
+  }
+
+  return None();
+}
+
+
+Try<bool> populated(const string& hierarchy, const string& cgroup)
+{
+  Try<hashmap<string, uint64_t>> events =
+    stat(hierarchy, cgroup, "cgroup.events");
+
+  if (events.isError()) {
+    return Error(events.error());
+  }
+
+  if (!events->contains("populated")) {
+    return Error("Missing 'populated' in 'cgroup.events'");
+  }
+
+  return events->at("populated") != 0;
+}
+
+
+// Returns true if the freezing of the given cgroup has completed, i.e.,
+// all of its processes are stopped, as reported by 'cgroup.events'.
+static Try<bool> frozen(const string& hierarchy, const string& cgroup)
+{
+  Try<hashmap<string, uint64_t>> events =
+    stat(hierarchy, cgroup, "cgroup.events");
+
+  if (events.isError()) {
+    return Error(events.error());
+  }
+
+  if (!events->contains("frozen")) {
+    return Error("Missing 'frozen' in 'cgroup.events'");
+  }
+
+  return events->at("frozen") != 0;
+}
+
+
+Try<Nothing> kill(const string& hierarchy, const string& cgroup)
+{
+  if (os::exists(path::join(hierarchy, cgroup, "cgroup.kill"))) {
+    return write(hierarchy, cgroup, "cgroup.kill", "1");
+  }
+
+  // Freezing the cgroup also freezes its descendants, which prevents
+  // the processes from forking while they are signaled. A SIGKILL is
+  // delivered to frozen processes once they are thawed.
+  Try<Nothing> freeze = write(hierarchy, cgroup, "cgroup.freeze", "1");
+  if (freeze.isError()) {
+    return Error("Failed to freeze cgroup: " + freeze.error());
+  }
+
+  // The freezing is asynchronous: a process can still fork until the
+  // kernel reports 'frozen 1', so we wait for it before listing the
+  // processes. We do not wait forever though, e.g., for a process in
+  // an uninterruptible sleep, since `destroy()` kills again the
+  // processes which escaped.
+  Duration waited = Duration::zero();
+
+  while (waited < FREEZE_TIMEOUT) {
+    Try<bool> _frozen = frozen(hierarchy, cgroup);
+    if (_frozen.isError()) {
+      return Error("Failed to check whether cgroup is frozen: " +
+                   _frozen.error());
+    }
+
+    if (_frozen.get()) {
+      break;
+    }
+
+    os::sleep(FREEZE_POLL_INTERVAL);
+    waited += FREEZE_POLL_INTERVAL;
+  }
+
+  Try<vector<string>> cgroups = get(hierarchy, cgroup);
+  if (cgroups.isError()) {
+    return Error(cgroups.error());
+  }
+
+  cgroups->push_back(cgroup);
+
+  foreach (const string& _cgroup, cgroups.get()) {
+    Try<set<pid_t>> pids = processes(hierarchy, _cgroup);
+    if (pids.isError()) {
+      return Error("Failed to get processes of cgroup: " + pids.error());
+    }
+
+    foreach (pid_t pid, pids.get()) {
+      // Ignore processes which have already terminated.
+      if (::kill(pid, SIGKILL) == -1 && errno != ESRCH) {
+        return ErrnoError("Failed to kill process " + stringify(pid));
+      }
+    }
+  }
+
+  Try<Nothing> thaw = write(hierarchy, cgroup, "cgroup.freeze", "0");
+  if (thaw.isError()) {
+    return Error("Failed to thaw cgroup: " + thaw.error());
+  }
+
+  return Nothing();
+}
+
+
+Future<Nothing> destroy(const string& hierarchy, const string& cgroup)
+{
+  if (!exists(hierarchy, cgroup)) {
+    return Nothing();
+  }
+
+  Try<Nothing> kill = cgroups2::kill(hierarchy, cgroup);
+  if (kill.isError()) {
+    return Failure(
+        "Failed to kill the processes of cgroup '" + cgroup + "': " +
+        kill.error());
+  }
+
+  return process::loop(
+      []() {
+        return process::after(DESTROY_POLL_INTERVAL);
+      },
+      [=](const Nothing&) -> Future<ControlFlow<Nothing>> {
+        Try<bool> populated = cgroups2::populated(hierarchy, cgroup);
+        if (populated.isError()) {
+          return Failure(
+              "Failed to check whether cgroup '" + cgroup +
+              "' is populated: " + populated.error());
+        }
+
+        if (populated.get()) {
+          // Kill the processes which were forked while the previous
+          // kill was in progress, if any.
+          Try<Nothing> kill = cgroups2::kill(hierarchy, cgroup);
+          if (kill.isError()) {
+            return Failure(
+                "Failed to kill the processes of cgroup '" + cgroup +
+                "': " + kill.error());
+          }
+
+          return Continue();
+        }
+
+        // The descendants are returned in post-order, i.e., children
+        // before their parents.
+        Try<vector<string>> cgroups = get(hierarchy, cgroup);
+        if (cgroups.isError()) {
+          return Failure(cgroups.error());
+        }
+
+        cgroups->push_back(cgroup);
+
+        foreach (const string& _cgroup, cgroups.get()) {
+          Try<Nothing> remove = cgroups2::remove(hierarchy, _cgroup);
+          if (remove.isError()) {
+            return Failure(remove.error());
+          }
+        }
+
+        return Break();
+      });
+}
+
+
+namespace controllers {
+
+Try<set<string>> available(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "cgroup.controllers");
+  if (contents.isError()) {
+    return Error(
+        "Failed to read 'cgroup.controllers': " + contents.error());
+  }
+
+  vector<string> controllers = strings::tokenize(contents.get(), " \n");
+  return set<string>(controllers.begin(), controllers.end());
+}
+
+
+Try<set<string>> enabled(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "cgroup.subtree_control");
+  if (contents.isError()) {
+    return Error(
+        "Failed to read 'cgroup.subtree_control': " + contents.error());
+  }
+
+  vector<string> controllers = strings::tokenize(contents.get(), " \n");
+  return set<string>(controllers.begin(), controllers.end());
+}
+
+
+Try<Nothing> enable(
+    const string& hierarchy,
+    const string& cgroup,
+    const set<string>& controllers)
+{
+  vector<string> tokens;
+  foreach (const string& controller, controllers) {
+    tokens.push_back("+" + controller);
+  }
+
+  Try<Nothing> write = cgroups2::write(
+      hierarchy, cgroup, "cgroup.subtree_control", strings::join(" ", tokens));
+
+  if (write.isError()) {
+    return Error(
+        "Failed to enable controllers " + stringify(controllers) +
+        " in 'cgroup.subtree_control': " + write.error());
+  }
+
+  return Nothing();
+}
+
+} // namespace controllers {
+
+
+namespace pressure {
+
+Try<Pressure> parse(const string& value)
+{
+  Option<Stall> some;
+  Option<Stall> full;
+
+  foreach (const string& line, strings::tokenize(value, "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    Try<hashmap<string, string>> fields = internal::parseKeyedLine(tokens);
+    if (fields.isError()) {
+      return Error("Failed to parse '" + line + "': " + fields.error());
+    }
+
+    const vector<string> keys = {"avg10", "avg60", "avg300", "total"};
+
+    foreach (const string& key, keys) {
+      if (!fields->contains(key)) {
+        return Error("Missing '" + key + "' in '" + line + "'");
+      }
+    }
+
+    Try<double> avg10 = numify<double>(fields->at("avg10"));
+    Try<double> avg60 = numify<double>(fields->at("avg60"));
+    Try<double> avg300 = numify<double>(fields->at("avg300"));
+    Try<uint64_t> total = numify<uint64_t>(fields->at("total"));
+
+    if (avg10.isError() || avg60.isError() || avg300.isError() ||
+        total.isError()) {
+      return Error("Failed to parse '" + line + "'");
+    }
+
+    Stall stall;
+    stall.avg10 = avg10.get();
+    stall.avg60 = avg60.get();
+    stall.avg300 = avg300.get();
+    stall.total = Microseconds(static_cast<int64_t>(total.get()));
+
+    if (tokens[0] == "some") {
+      some = stall;
+    } else if (tokens[0] == "full") {
+      full = stall;
+    } else {
+      return Error("Unexpected line '" + line + "'");
+    }
+  }
+
+  if (some.isNone()) {
+    return Error("Missing the 'some' line");
+  }
+
+  return Pressure{some.get(), full};
+}
+
+
+Try<Pressure> read(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& resource)
+{
+  const string control = resource + ".pressure";
+
+  Try<string> contents = cgroups2::read(hierarchy, cgroup, control);
+  if (contents.isError()) {
+    return Error("Failed to read '" + control + "': " + contents.error());
+  }
+
+  return parse(contents.get());
+}
+
+} // namespace pressure {
+
+
+namespace cpu {
+
+Try<Nothing> weight(
+    const string& hierarchy,
+    const string& cgroup,
+    uint64_t weight)
+{
+  if (weight < MIN_WEIGHT || weight > MAX_WEIGHT) {
+    return Error(
+        "Expected a weight within [" + stringify(MIN_WEIGHT) + ", " +
+        stringify(MAX_WEIGHT) + "], got " + stringify(weight));
+  }
+
+  return write(hierarchy, cgroup, "cpu.weight", stringify(weight));
+}
+
+
+Try<uint64_t> weight(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "cpu.weight");
+  if (contents.isError()) {
+    return Error("Failed to read 'cpu.weight': " + contents.error());
+  }
+
+  return numify<uint64_t>(strings::trim(contents.get()));
+}
+
+
+Try<Nothing> max(
+    const string& hierarchy,
+    const string& cgroup,
+    const BandwidthLimit& limit)
+{
+  Option<uint64_t> quota;
+  if (limit.quota.isSome()) {
+    quota = static_cast<uint64_t>(limit.quota->us());
+  }
+
+  return write(
+      hierarchy,
+      cgroup,
+      "cpu.max",
+      internal::stringifyLimit(quota) + " " +
+        stringify(static_cast<uint64_t>(limit.period.us())));
+}
+
+
+Try<BandwidthLimit> max(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "cpu.max");
+  if (contents.isError()) {
+    return Error("Failed to read 'cpu.max': " + contents.error());
+  }
+
+  // Expected format: "<quota|max> <period>".
+  vector<string> tokens = strings::tokenize(contents.get(), " \n");
+  if (tokens.size() != 2) {
+    return Error("Unexpected format of 'cpu.max': " + contents.get());
+  }
+
+  Try<Option<uint64_t>> quota = internal::parseLimit(tokens[0]);
+  if (quota.isError()) {
+    return Error(quota.error());
+  }
+
+  Try<uint64_t> period = numify<uint64_t>(tokens[1]);
+  if (period.isError()) {
+    return Error("Failed to parse period: " + period.error());
+  }
+
+  BandwidthLimit limit;
+  limit.period = Microseconds(static_cast<int64_t>(period.get()));
+
+  if (quota->isSome()) {
+    limit.quota = Microseconds(static_cast<int64_t>(quota->get()));
+  }
+
+  return limit;
+}
+
+
+Try<Stats> stats(const string& hierarchy, const string& cgroup)
+{
+  Try<hashmap<string, uint64_t>> stat =
+    cgroups2::stat(hierarchy, cgroup, "cpu.stat");
+
+  if (stat.isError()) {
+    return Error(stat.error());
+  }
+
+  const vector<string> keys = {"usage_usec", "user_usec", "system_usec"};
+
+  foreach (const string& key, keys) {
+    if (!stat->contains(key)) {
+      return Error("Missing '" + key + "' in 'cpu.stat'");
+    }
+  }
+
+  Stats stats;
+  stats.usage = Microseconds(static_cast<int64_t>(stat->at("usage_usec")));
+  stats.user = Microseconds(static_cast<int64_t>(stat->at("user_usec")));
+  stats.system = Microseconds(static_cast<int64_t>(stat->at("system_usec")));
+
+  if (stat->contains("nr_periods")) {
+    stats.periods = stat->at("nr_periods");
+  }
+
+  if (stat->contains("nr_throttled")) {
+    stats.throttled = stat->at("nr_throttled");
+  }
+
+  if (stat->contains("throttled_usec")) {
+    stats.throttledTime =
+      Microseconds(static_cast<int64_t>(stat->at("throttled_usec")));
+  }
+
+  return stats;
+}
+
+} // namespace cpu {
+
+
+namespace memory {
+
+Try<Bytes> usage(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "memory.current");
+  if (contents.isError()) {
+    return Error("Failed to read 'memory.current': " + contents.error());
+  }
+
+  Try<uint64_t> usage = numify<uint64_t>(strings::trim(contents.get()));
+  if (usage.isError()) {
+    return Error("Failed to parse 'memory.current': " + usage.error());
+  }
+
+  return Bytes(usage.get());
+}
+
+
+Result<Bytes> swap(const string& hierarchy, const string& cgroup)
+{
+  if (!os::exists(path::join(hierarchy, cgroup, "memory.swap.current"))) {
+    return None();
+  }
+
+  Try<string> contents = read(hierarchy, cgroup, "memory.swap.current");
+  if (contents.isError()) {
+    return Error(
+        "Failed to read 'memory.swap.current': " + contents.error());
+  }
+
+  Try<uint64_t> swap = numify<uint64_t>(strings::trim(contents.get()));
+  if (swap.isError()) {
+    return Error("Failed to parse 'memory.swap.current': " + swap.error());
+  }
+
+  return Bytes(swap.get());
+}
+
+
+static Try<Nothing> setLimit(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control,
+    const Option<Bytes>& limit)
+{
+  Option<uint64_t> bytes;
+  if (limit.isSome()) {
+    bytes = limit->bytes();
+  }
+
+  return write(hierarchy, cgroup, control, internal::stringifyLimit(bytes));
+}
+
+
+static Try<Option<Bytes>> getLimit(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control)
+{
+  Try<string> contents = read(hierarchy, cgroup, control);
+  if (contents.isError()) {
+    return Error("Failed to read '" + control + "': " + contents.error());
+  }
+
+  Try<Option<uint64_t>> limit = internal::parseLimit(contents.get());
+  if (limit.isError()) {
+    return Error(limit.error());
+  }
+
+  if (limit->isNone()) {
+    return None();
+  }
+
+  return Bytes(limit->get());
+}
+
+
+Try<Nothing> max(
+    const string& hierarchy,
+    const string& cgroup,
+    const Option<Bytes>& limit)
+{
+  return setLimit(hierarchy, cgroup, "memory.max", limit);
+}
+
+
+Try<Option<Bytes>> max(const string& hierarchy, const string& cgroup)
+{
+  return getLimit(hierarchy, cgroup, "memory.max");
+}
+
+
+Try<Nothing> high(
+    const string& hierarchy,
+    const string& cgroup,
+    const Option<Bytes>& limit)
+{
+  return setLimit(hierarchy, cgroup, "memory.high", limit);
+}
+
+
+Try<Option<Bytes>> high(const string& hierarchy, const string& cgroup)
+{
+  return getLimit(hierarchy, cgroup, "memory.high");
+}
+
+
+Try<hashmap<string, uint64_t>> stats(
+    const string& hierarchy,
+    const string& cgroup)
+{
+  return cgroups2::stat(hierarchy, cgroup, "memory.stat");
+}
+
+} // namespace memory {
+
+
+namespace io {
+
+static Try<dev_t> parseDevice(const string& value)
+{
+  vector<string> numbers = strings::split(value, ":");
+  if (numbers.size() != 2) {
+    return Error("Unexpected device number '" + value + "'");
+  }
+
+  Try<unsigned int> major = numify<unsigned int>(numbers[0]);
+  Try<unsigned int> minor = numify<unsigned int>(numbers[1]);
+
+  if (major.isError() || minor.isError()) {
+    return Error("Unexpected device number '" + value + "'");
+  }
+
+  return makedev(major.get(), minor.get());
+}
+
+
+Try<Nothing> max(
+    const string& hierarchy,
+    const string& cgroup,
+    dev_t device,
+    const Limits& limits)
+{
+  const string value =
+    stringify(major(device)) + ":" + stringify(minor(device)) +
+    " rbps=" + internal::stringifyLimit(limits.rbps) +
+    " wbps=" + internal::stringifyLimit(limits.wbps) +
+    " riops=" + internal::stringifyLimit(limits.riops) +
+    " wiops=" + internal::stringifyLimit(limits.wiops);
+
+  return write(hierarchy, cgroup, "io.max", value);
+}
+
+
+Try<hashmap<dev_t, Limits>> max(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "io.max");
+  if (contents.isError()) {
+    return Error("Failed to read 'io.max': " + contents.error());
+  }
+
+  hashmap<dev_t, Limits> result;
+
+  foreach (const string& line, strings::tokenize(contents.get(), "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    Try<dev_t> device = parseDevice(tokens[0]);
+    if (device.isError()) {
+      return Error(device.error());
+    }
+
+    Try<hashmap<string, string>> fields = internal::parseKeyedLine(tokens);
+    if (fields.isError()) {
+      return Error("Failed to parse '" + line + "': " + fields.error());
+    }
+
+    Limits limits;
+
+    foreachpair (const string& key, const string& value, fields.get()) {
+      Try<Option<uint64_t>> limit = internal::parseLimit(value);
+      if (limit.isError()) {
+        return Error(limit.error());
+      }
+
+      if (key == "rbps") {
+        limits.rbps = limit.get();
+      } else if (key == "wbps") {
+        limits.wbps = limit.get();
+      } else if (key == "riops") {
+        limits.riops = limit.get();
+      } else if (key == "wiops") {
+        limits.wiops = limit.get();
+      }
+    }
+
+    result[device.get()] = limits;
+  }
+
+  return result;
+}
+
+
+Try<vector<Stats>> parse(const string& value)
+{
+  vector<Stats> result;
+
+  foreach (const string& line, strings::tokenize(value, "\n")) {
+    vector<string> tokens = strings::tokenize(line, " ");
+    if (tokens.empty()) {
+      continue;
+    }
+
+    Try<dev_t> device = parseDevice(tokens[0]);
+    if (device.isError()) {
+      return Error(device.error());
+    }
+
+    Try<hashmap<string, string>> fields = internal::parseKeyedLine(tokens);
+    if (fields.isError()) {
+      return Error("Failed to parse '" + line + "': " + fields.error());
+    }
+
+    Stats stats = {device.get(), 0, 0, 0, 0, 0, 0};
+
+    // Unknown keys are skipped since the kernel may report more, e.g.
+    // the 'cost.*' statistics of the io cost controller.
+    foreachpair (const string& key, const string& field, fields.get()) {
+      uint64_t* target = nullptr;
+
+      if (key == "rbytes") {
+        target = &stats.rbytes;
+      } else if (key == "wbytes") {
+        target = &stats.wbytes;
+      } else if (key == "dbytes") {
+        target = &stats.dbytes;
+      } else if (key == "rios") {
+        target = &stats.rios;
+      } else if (key == "wios") {
+        target = &stats.wios;
+      } else if (key == "dios") {
+        target = &stats.dios;
+      } else {
+        continue;
+      }
+
+      Try<uint64_t> number = numify<uint64_t>(field);
+      if (number.isError()) {
+        return Error("Failed to parse '" + line + "': " + number.error());
+      }
+
+      *target = number.get();
+    }
+
+    result.push_back(stats);
+  }
+
+  return result;
+}
+
+
+Try<vector<Stats>> stats(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "io.stat");
+  if (contents.isError()) {
+    return Error("Failed to read 'io.stat': " + contents.error());
+  }
+
+  return parse(contents.get());
+}
+
+} // namespace io {
+
+
+namespace pids {
+
+Try<uint64_t> current(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "pids.current");
+  if (contents.isError()) {
+    return Error("Failed to read 'pids.current': " + contents.error());
+  }
+
+  return numify<uint64_t>(strings::trim(contents.get()));
+}
+
+
+Try<Nothing> max(
+    const string& hierarchy,
+    const string& cgroup,
+    const Option<uint64_t>& limit)
+{
+  return write(hierarchy, cgroup, "pids.max", internal::stringifyLimit(limit));
+}
+
+
+Try<Option<uint64_t>> max(const string& hierarchy, const string& cgroup)
+{
+  Try<string> contents = read(hierarchy, cgroup, "pids.max");
+  if (contents.isError()) {
+    return Error("Failed to read 'pids.max': " + contents.error());
+  }
+
+  return internal::parseLimit(contents.get());
+}
+
+} // namespace pids {
+
+} // namespace cgroups2 {
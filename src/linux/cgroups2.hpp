@@ -0,0 +1,467 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CGROUPS2_HPP__
+#define __CGROUPS2_HPP__
+
+#include <stdint.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <process/future.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/result.hpp>
+#include <stout/try.hpp>
+
+// Support for the cgroups v2 "unified" hierarchy. See
+// <kernel-source>/Documentation/admin-guide/cgroup-v2.rst for details.
+//
+// The notations of `linux/cgroups.hpp` apply, with the following
+// differences:
+//
+// Hierarchy  - There is a single hierarchy to which all controllers
+//              are attached (e.g., '/sys/fs/cgroup').
+// Controller - The cgroups v2 name of a subsystem. A controller is
+//              only available in a cgroup if it is enabled in the
+//              'cgroup.subtree_control' of the parent cgroup.
+//
+// Except for the root cgroup, processes can only be assigned to
+// cgroups which do not distribute controllers to child cgroups (the
+// "no internal process" rule). Callers thus typically assign the
+// processes to a leaf cgroup, see `LEAF`.
+namespace cgroups2 {
+
+// The name of the leaf cgroup holding the processes of a cgroup whose
+// controllers are also distributed to child cgroups.
+const std::string LEAF = "leaf";
+
+
+// Interval at which `destroy()` checks whether a cgroup is emptied.
+const Duration DESTROY_POLL_INTERVAL = Milliseconds(10);
+
+
+// Interval at which `kill()` checks whether a cgroup is frozen, and how
+// long it waits for it before signaling the processes regardless.
+const Duration FREEZE_POLL_INTERVAL = Milliseconds(1);
+const Duration FREEZE_TIMEOUT = Milliseconds(100);
+
+
+// Returns true if the given hierarchy root is mounted as a cgroups v2
+// file system, i.e., the unified hierarchy.
+// @param   hierarchy   Path to the hierarchy root.
+// @return  True if the unified hierarchy is mounted at the given path.
+//          False if the path does not exist or is not a cgroups v2 mount.
+//          Error if the operation fails.
+Try<bool> mounted(const std::string& hierarchy);
+
+
+// Returns the mount point of the unified hierarchy, looked up in the
+// mount table of the current process.
+// @return  The path of the hierarchy root if it is mounted.
+//          None if the unified hierarchy is not mounted.
+//          Error if the operation fails.
+Result<std::string> hierarchy();
+
+
+// Create a cgroup in the given hierarchy. Unlike `cgroups::create`,
+// no control files are inherited from the parent cgroup.
+// @param   hierarchy   Path to the hierarchy root.
+// @param   cgroup      Path to the cgroup relative to the hierarchy root.
+// @param   recursive   Will create nested cgroups.
+// @return  Some if the operation succeeds.
+//          Error if the operation fails.
+Try<Nothing> create(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    bool recursive = false);
+
+
+// Remove an empty cgroup from the given hierarchy. The cgroup will
+// NOT be removed recursively.
+Try<Nothing> remove(const std::string& hierarchy, const std::string& cgroup);
+
+
+// Returns true if the given cgroup exists in the given hierarchy.
+bool exists(const std::string& hierarchy, const std::string& cgroup);
+
+
+// Return all the cgroups under the given cgroup of the given hierarchy,
+// excluding the given cgroup itself. Like `cgroups::get`, we use a
+// post-order walk to ease the removal of cgroups.
+Try<std::vector<std::string>> get(
+    const std::string& hierarchy,
+    const std::string& cgroup = "/");
+
+
+// Read a control file of the given cgroup.
+Try<std::string> read(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+// Write a control file of the given cgroup.
+Try<Nothing> write(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::string& control,
+    const std::string& value);
+
+
+// Parse a flat keyed control file (e.g., 'cpu.stat', 'memory.stat',
+// 'cgroup.events') of the form "<key> <value>\n..." into a map.
+Try<hashmap<std::string, uint64_t>> stat(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::string& control);
+
+
+// Return the set of process IDs which are directly in the given
+// cgroup (i.e., not in its descendants).
+Try<std::set<pid_t>> processes(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Assign the given process, and all of its threads, to the given cgroup.
+Try<Nothing> assign(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    pid_t pid);
+
+
+// Returns the cgroup of the given process in the unified hierarchy,
+// relative to the hierarchy root (with a leading '/'), as reported by
+// '/proc/<pid>/cgroup'. None if the process is not in a cgroups v2
+// hierarchy, e.g., on a host using the legacy hierarchies only.
+Result<std::string> cgroup(pid_t pid);
+
+
+// Returns true if the given cgroup or any of its descendants contains
+// live processes, as reported by 'cgroup.events'.
+Try<bool> populated(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Send SIGKILL to all the processes of the given cgroup and its
+// descendants. This uses 'cgroup.kill' if the kernel supports it
+// (5.14+), or otherwise freezes the cgroup while the processes are
+// signaled so that they cannot fork in the meantime. The processes
+// are signaled once the cgroup is frozen, or after `FREEZE_TIMEOUT`.
+Try<Nothing> kill(const std::string& hierarchy, const std::string& cgroup);
+
+
+// Kill all the processes of the given cgroup and its descendants, wait
+// for the cgroup to be emptied and then remove the cgroup along with
+// its descendants. The processes are killed again on every check, so
+// that a process which escaped a previous kill does not keep the cgroup
+// populated. The returned future can be discarded, e.g., upon a
+// timeout, which stops the wait.
+process::Future<Nothing> destroy(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+namespace controllers {
+
+// Returns the controllers which are available in the given cgroup
+// from 'cgroup.controllers'.
+Try<std::set<std::string>> available(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Returns the controllers which are distributed to the child cgroups
+// of the given cgroup from 'cgroup.subtree_control'.
+Try<std::set<std::string>> enabled(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Distribute the given controllers to the child cgroups of the given
+// cgroup using 'cgroup.subtree_control'. The controllers must be
+// available in the given cgroup.
+Try<Nothing> enable(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::set<std::string>& controllers);
+
+} // namespace controllers {
+
+
+// Pressure stall information (PSI) of a resource. This is only
+// available if the kernel is built with 'CONFIG_PSI' (4.20+). See
+// <kernel-source>/Documentation/accounting/psi.rst for details.
+namespace pressure {
+
+// The share of wall time (in percent) over the last 10, 60 and 300
+// seconds during which tasks were stalled on a resource, along with
+// the total stall time.
+struct Stall
+{
+  double avg10;
+  double avg60;
+  double avg300;
+  Duration total;
+};
+
+
+// The stall information of the "some" line (i.e., at least one task
+// was stalled) and, when reported, of the "full" line (i.e., all
+// non-idle tasks were stalled at once).
+struct Pressure
+{
+  Stall some;
+  Option<Stall> full;
+};
+
+
+// Parse the contents of a '<resource>.pressure' file, e.g.:
+//   some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+//   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+Try<Pressure> parse(const std::string& value);
+
+
+// Returns the pressure of the given resource ("cpu", "memory" or
+// "io") for the given cgroup.
+Try<Pressure> read(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const std::string& resource);
+
+} // namespace pressure {
+
+
+// Cpu controls.
+namespace cpu {
+
+// The default and the range of 'cpu.weight'.
+const uint64_t DEFAULT_WEIGHT = 100;
+const uint64_t MIN_WEIGHT = 1;
+const uint64_t MAX_WEIGHT = 10000;
+
+
+// Sets the proportional share of cpu using 'cpu.weight'.
+Try<Nothing> weight(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    uint64_t weight);
+
+
+// Returns the proportional share of cpu from 'cpu.weight'.
+Try<uint64_t> weight(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// The cpu bandwidth limit of 'cpu.max': the cgroup may consume up to
+// `quota` of cpu time in each `period`, or is not limited if `quota`
+// is None.
+struct BandwidthLimit
+{
+  Option<Duration> quota;
+  Duration period;
+};
+
+
+// Sets the cpu bandwidth limit using 'cpu.max'.
+Try<Nothing> max(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const BandwidthLimit& limit);
+
+
+// Returns the cpu bandwidth limit from 'cpu.max'.
+Try<BandwidthLimit> max(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Encapsulates the information of 'cpu.stat'. The throttling
+// information is only reported when the cpu controller is enabled.
+struct Stats
+{
+  Duration usage;
+  Duration user;
+  Duration system;
+
+  Option<uint64_t> periods;
+  Option<uint64_t> throttled;
+  Option<Duration> throttledTime;
+};
+
+
+// Returns the cpu statistics of the given cgroup from 'cpu.stat'.
+Try<Stats> stats(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+} // namespace cpu {
+
+
+// Memory controls.
+namespace memory {
+
+// Returns the memory usage of the given cgroup and its descendants
+// from 'memory.current'.
+Try<Bytes> usage(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Returns the swap usage of the given cgroup and its descendants from
+// 'memory.swap.current', or None if swap accounting is disabled.
+Result<Bytes> swap(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Sets the hard memory limit using 'memory.max'. Processes of the
+// cgroup are OOM killed when the limit cannot be honored. A limit of
+// None removes the limit.
+Try<Nothing> max(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const Option<Bytes>& limit);
+
+
+// Returns the hard memory limit from 'memory.max', None if unlimited.
+Try<Option<Bytes>> max(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Sets the memory throttling limit using 'memory.high'. Processes of
+// the cgroup are throttled and put under heavy reclaim pressure above
+// this limit, but are never OOM killed because of it. A limit of None
+// removes the limit.
+Try<Nothing> high(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const Option<Bytes>& limit);
+
+
+// Returns the memory throttling limit from 'memory.high', None if
+// unlimited.
+Try<Option<Bytes>> high(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Returns the memory statistics of the given cgroup from
+// 'memory.stat', e.g. "anon", "file", "file_mapped" or "unevictable".
+Try<hashmap<std::string, uint64_t>> stats(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+} // namespace memory {
+
+
+// Io controls.
+namespace io {
+
+// The io limits of a device in 'io.max'. A None field is not limited.
+struct Limits
+{
+  Option<uint64_t> rbps;
+  Option<uint64_t> wbps;
+  Option<uint64_t> riops;
+  Option<uint64_t> wiops;
+};
+
+
+// Sets the io limits of the given block device using 'io.max'.
+Try<Nothing> max(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    dev_t device,
+    const Limits& limits);
+
+
+// Returns the io limits of the block devices which are limited in
+// 'io.max'.
+Try<hashmap<dev_t, Limits>> max(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// The io statistics of a block device in 'io.stat'.
+struct Stats
+{
+  dev_t device;
+
+  uint64_t rbytes;
+  uint64_t wbytes;
+  uint64_t dbytes;
+  uint64_t rios;
+  uint64_t wios;
+  uint64_t dios;
+};
+
+
+// Parse the contents of an 'io.stat' file, e.g.:
+//   8:16 rbytes=1459200 wbytes=314773504 rios=192 wios=353 dbytes=0 dios=0
+Try<std::vector<Stats>> parse(const std::string& value);
+
+
+// Returns the io statistics of the block devices used by the given
+// cgroup from 'io.stat'.
+Try<std::vector<Stats>> stats(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+} // namespace io {
+
+
+// Pids controls.
+namespace pids {
+
+// Returns the number of processes and threads of the given cgroup and
+// its descendants from 'pids.current'.
+Try<uint64_t> current(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+
+// Sets the limit of the number of processes and threads using
+// 'pids.max'. A limit of None removes the limit.
+Try<Nothing> max(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    const Option<uint64_t>& limit);
+
+
+// Returns the limit of the number of processes and threads from
+// 'pids.max', None if unlimited.
+Try<Option<uint64_t>> max(
+    const std::string& hierarchy,
+    const std::string& cgroup);
+
+} // namespace pids {
+
+} // namespace cgroups2 {
+
+#endif // __CGROUPS2_HPP__
@@ -18,10 +18,14 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <linux/perf_event.h>
+
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <algorithm>
 #include <list>
 #include <sstream>
 #include <string>
@@ -39,6 +43,8 @@
 #include <stout/os.hpp>
 #include <stout/strings.hpp>
 
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
 #include <stout/os/signals.hpp>
 
 #include "common/status_utils.hpp"
@@ -476,4 +482,292 @@ Try<hashmap<string, mesos::PerfStatistics>> parse(
   return statistics;
 }
 
+
+namespace internal {
+
+struct Event
+{
+  uint32_t type;
+  uint64_t config;
+};
+
+
+// The events which can be counted natively, by their name in the
+// output of `perf stat`.
+static const hashmap<string, Event>& events()
+{
+  static const hashmap<string, Event>* events = new hashmap<string, Event>({
+    {"cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES}},
+    {"instructions", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS}},
+    {"cache-references",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES}},
+    {"cache-misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}},
+    {"branches", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS}},
+    {"branch-misses", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}},
+    {"bus-cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BUS_CYCLES}},
+    {"stalled-cycles-frontend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND}},
+    {"stalled-cycles-backend",
+     {PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND}},
+    {"ref-cycles", {PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES}},
+    {"cpu-clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK}},
+    {"task-clock", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK}},
+    {"page-faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS}},
+    {"minor-faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN}},
+    {"major-faults", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ}},
+    {"context-switches",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}},
+    {"cpu-migrations", {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS}},
+    {"alignment-faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_ALIGNMENT_FAULTS}},
+    {"emulation-faults",
+     {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_EMULATION_FAULTS}},
+  });
+
+  return *events;
+}
+
+
+static Try<int, ErrnoError> open(
+    const Event& event,
+    int cgroup,
+    int cpu)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.read_format =
+    PERF_FORMAT_TOTAL_TIME_ENABLED |
+    PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  // NOTE: There is no glibc wrapper for perf_event_open(2).
+  int fd = ::syscall(
+      __NR_perf_event_open,
+      &attr,
+      cgroup,
+      cpu,
+      -1,
+      PERF_FLAG_PID_CGROUP | PERF_FLAG_FD_CLOEXEC);
+
+  if (fd == -1) {
+    return ErrnoError();
+  }
+
+  return fd;
+}
+
+} // namespace internal {
+
+
+bool CgroupCounters::supported(const set<string>& events)
+{
+  foreach (const string& event, events) {
+    if (!internal::events().contains(event)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+Try<Owned<CgroupCounters>> CgroupCounters::open(
+    const string& cgroup,
+    const set<string>& _events)
+{
+  const vector<string> events(_events.begin(), _events.end());
+
+  if (events.empty()) {
+    return Error("No events to count");
+  }
+
+  foreach (const string& event, events) {
+    if (!internal::events().contains(event)) {
+      return Error("Unsupported event '" + event + "'");
+    }
+  }
+
+  long cpus = ::sysconf(_SC_NPROCESSORS_CONF);
+  if (cpus <= 0) {
+    return ErrnoError("Failed to get the number of CPUs");
+  }
+
+  Try<int> cgroupFd = os::open(cgroup, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (cgroupFd.isError()) {
+    return Error("Failed to open '" + cgroup + "': " + cgroupFd.error());
+  }
+
+  // NOTE: Every event is counted by a counter of its own rather than
+  // in a group. A group is only scheduled when all of its events fit
+  // in the hardware counters at once, so a group with more hardware
+  // events than the PMU has counters would never count.
+  vector<vector<int>> fds(events.size());
+
+  Option<Error> error;
+
+  for (int cpu = 0; cpu < cpus && error.isNone(); cpu++) {
+    for (size_t i = 0; i < events.size(); i++) {
+      Try<int, ErrnoError> fd = internal::open(
+          internal::events().at(events[i]), cgroupFd.get(), cpu);
+
+      // CPUs which are not online cannot be counted on.
+      if (fd.isError() && i == 0 && fd.error().code == ENODEV) {
+        break;
+      }
+
+      if (fd.isError()) {
+        error = Error(
+            "Failed to open a counter for '" + events[i] + "' on CPU " +
+            stringify(cpu) + ": " + fd.error().message);
+        break;
+      }
+
+      fds[i].push_back(fd.get());
+    }
+  }
+
+  os::close(cgroupFd.get());
+
+  if (error.isNone() && fds[0].empty()) {
+    error = Error("No CPU to count on");
+  }
+
+  if (error.isSome()) {
+    foreach (const vector<int>& counters, fds) {
+      foreach (int fd, counters) {
+        os::close(fd);
+      }
+    }
+
+    return error.get();
+  }
+
+  return Owned<CgroupCounters>(new CgroupCounters(events, fds));
+}
+
+
+CgroupCounters::CgroupCounters(
+    const vector<string>& _events,
+    const vector<vector<int>>& _fds)
+  : events(_events),
+    fds(_fds),
+    previous(Clock::now())
+{
+  foreach (const vector<int>& counters, fds) {
+    values.push_back(vector<Value>(counters.size(), Value{0, 0, 0}));
+  }
+}
+
+
+CgroupCounters::~CgroupCounters()
+{
+  foreach (const vector<int>& counters, fds) {
+    foreach (int fd, counters) {
+      os::close(fd);
+    }
+  }
+}
+
+
+Try<mesos::PerfStatistics> CgroupCounters::read()
+{
+  vector<vector<Value>> current(fds.size());
+
+  for (size_t i = 0; i < fds.size(); i++) {
+    foreach (int fd, fds[i]) {
+      // The layout of a read, see perf_event_open(2).
+      uint64_t buffer[3];
+
+      ssize_t length = ::read(fd, buffer, sizeof(buffer));
+      if (length == -1) {
+        return ErrnoError("Failed to read perf counters");
+      }
+
+      if (static_cast<size_t>(length) != sizeof(buffer)) {
+        return Error("Unexpected size of perf counters");
+      }
+
+      current[i].push_back(Value{buffer[0], buffer[1], buffer[2]});
+    }
+  }
+
+  const Time now = Clock::now();
+
+  mesos::PerfStatistics statistics;
+  statistics.set_timestamp(previous.secs());
+  statistics.set_duration((now - previous).secs());
+
+  const google::protobuf::Reflection* reflection =
+    statistics.GetReflection();
+
+  vector<string> unscheduled;
+
+  for (size_t i = 0; i < events.size(); i++) {
+    const google::protobuf::FieldDescriptor* field =
+      statistics.GetDescriptor()->FindFieldByName(
+          internal::normalize(events[i]));
+
+    if (field == nullptr) {
+      return Error("Unexpected event '" + events[i] + "'");
+    }
+
+    double count = 0.0;
+    uint64_t enabled = 0;
+    uint64_t running = 0;
+
+    for (size_t cpu = 0; cpu < current[i].size(); cpu++) {
+      const Value& value = current[i][cpu];
+      const Value& last = values[i][cpu];
+
+      // The counters are multiplexed if there are more events than
+      // hardware counters, in which case we extrapolate the counts
+      // over the time the cgroup was running on the CPU, like
+      // `perf stat` does.
+      if (value.running > last.running) {
+        count += static_cast<double>(value.value - last.value) *
+          (value.enabled - last.enabled) / (value.running - last.running);
+      }
+
+      enabled += value.enabled - last.enabled;
+      running += value.running - last.running;
+    }
+
+    // A counter which was enabled but never scheduled on the PMU did
+    // not count anything, so we leave the event out of the sample
+    // rather than report a count of 0.
+    if (enabled > 0 && running == 0) {
+      unscheduled.push_back(events[i]);
+      continue;
+    }
+
+    switch (field->type()) {
+      // The clocks are counted in nanoseconds, but reported in
+      // milliseconds by `perf stat`.
+      case google::protobuf::FieldDescriptor::TYPE_DOUBLE:
+        reflection->SetDouble(&statistics, field, count / 1000000.0);
+        break;
+      case google::protobuf::FieldDescriptor::TYPE_UINT64:
+        reflection->SetUInt64(
+            &statistics, field, static_cast<uint64_t>(count));
+        break;
+      default:
+        return Error("Unsupported perf field type for '" + events[i] + "'");
+    }
+  }
+
+  if (!unscheduled.empty()) {
+    LOG(WARNING) << "The perf counters of '" << strings::join(",", unscheduled)
+                 << "' were not scheduled during the sample, e.g., since "
+                 << "the hardware counters are used by other events";
+  }
+
+  values = current;
+  previous = now;
+
+  return statistics;
+}
+
 } // namespace perf {
@@ -21,11 +21,15 @@
 
 #include <set>
 #include <string>
+#include <vector>
 
 #include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/time.hpp>
 
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/try.hpp>
 #include <stout/version.hpp>
 
 // For PerfStatistics protobuf.
@@ -65,6 +69,59 @@ Try<Version> parseVersion(const std::string& output);
 Try<hashmap<std::string, mesos::PerfStatistics>> parse(
     const std::string& output);
 
+
+// Counts perf events for all processes in a perf_event cgroup using
+// perf_event_open(2), without running the `perf` binary. The counters
+// are kept open on each CPU and count continuously, so a sample costs
+// one read(2) per event and CPU.
+class CgroupCounters
+{
+public:
+  // Returns whether all the given events can be counted natively.
+  // Only the generic hardware and software events are supported,
+  // e.g., `cycles` or `context-switches`.
+  static bool supported(const std::set<std::string>& events);
+
+  // Starts counting the given events for the cgroup at the given path,
+  // e.g., /sys/fs/cgroup/perf_event/mesos/test.
+  static Try<process::Owned<CgroupCounters>> open(
+      const std::string& cgroup,
+      const std::set<std::string>& events);
+
+  ~CgroupCounters();
+
+  // Returns the counts since the previous read, or since the counters
+  // were opened, scaled for the time the counters were multiplexed.
+  // The events whose counters were not scheduled at all since the
+  // previous read are left unset in the returned statistics.
+  Try<mesos::PerfStatistics> read();
+
+private:
+  CgroupCounters(
+      const std::vector<std::string>& events,
+      const std::vector<std::vector<int>>& fds);
+
+  CgroupCounters(const CgroupCounters&) = delete;
+  CgroupCounters& operator=(const CgroupCounters&) = delete;
+
+  const std::vector<std::string> events;
+
+  // The file descriptors of the counters of each event, one per CPU.
+  const std::vector<std::vector<int>> fds;
+
+  // A read of a counter, see perf_event_open(2).
+  struct Value
+  {
+    uint64_t value;
+    uint64_t enabled;
+    uint64_t running;
+  };
+
+  // The values of the counters of each event at the previous read.
+  std::vector<std::vector<Value>> values;
+  process::Time previous;
+};
+
 } // namespace perf {
 
 #endif // __PERF_HPP__
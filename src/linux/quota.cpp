@@ -0,0 +1,313 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <fts.h>
+
+#include <sys/ioctl.h>
+#include <sys/quota.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <string>
+
+#include <stout/check.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+
+#include <stout/os/close.hpp>
+#include <stout/os/open.hpp>
+#include <stout/os/stat.hpp>
+
+#include "linux/fs.hpp"
+#include "linux/quota.hpp"
+
+using std::string;
+
+// Manually define this for old kernels. Compatible with the one in
+// <linux/quota.h>.
+#ifndef PRJQUOTA
+#define PRJQUOTA 2
+#endif
+
+// Defined in <linux/fs.h> since Linux 4.5, which we do not include
+// since it conflicts with <sys/mount.h>.
+#ifndef FS_IOC_FSGETXATTR
+struct fsxattr
+{
+  uint32_t fsx_xflags;
+  uint32_t fsx_extsize;
+  uint32_t fsx_nextents;
+  uint32_t fsx_projid;
+  uint32_t fsx_cowextsize;
+  unsigned char fsx_pad[8];
+};
+
+#define FS_IOC_FSGETXATTR _IOR('X', 31, struct fsxattr)
+#define FS_IOC_FSSETXATTR _IOW('X', 32, struct fsxattr)
+#endif
+
+#ifndef FS_XFLAG_PROJINHERIT
+#define FS_XFLAG_PROJINHERIT 0x00000200
+#endif
+
+namespace mesos {
+namespace internal {
+namespace quota {
+
+// The project ID of files which are not assigned a project.
+static constexpr uint32_t NON_PROJECT_ID = 0u;
+
+
+Result<string> getDevice(const string& path)
+{
+  struct stat stat;
+  if (::stat(path.c_str(), &stat) == -1) {
+    return ErrnoError("Failed to stat '" + path + "'");
+  }
+
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::read(None(), false);
+  if (table.isError()) {
+    return Error("Failed to read mount table: " + table.error());
+  }
+
+  foreach (const fs::MountInfoTable::Entry& entry, table->entries) {
+    if (entry.devno == stat.st_dev && path::absolute(entry.source)) {
+      return entry.source;
+    }
+  }
+
+  return None();
+}
+
+
+static Try<Nothing> setProjectId(
+    const string& path,
+    const struct stat& stat,
+    uint32_t projectId)
+{
+  int flags = O_NOFOLLOW | O_RDONLY | O_CLOEXEC;
+
+  // Directories require O_DIRECTORY.
+  flags |= S_ISDIR(stat.st_mode) ? O_DIRECTORY : 0;
+
+  Try<int> fd = os::open(path, flags);
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  struct fsxattr attr;
+  if (::ioctl(fd.get(), FS_IOC_FSGETXATTR, &attr) == -1) {
+    ErrnoError error("Failed to get attributes of '" + path + "'");
+    os::close(fd.get());
+    return error;
+  }
+
+  attr.fsx_projid = projectId;
+
+  // Only directories take the inherit flag, which makes the files
+  // created in them inherit their project ID.
+  if (projectId != NON_PROJECT_ID && S_ISDIR(stat.st_mode)) {
+    attr.fsx_xflags |= FS_XFLAG_PROJINHERIT;
+  } else {
+    attr.fsx_xflags &= ~FS_XFLAG_PROJINHERIT;
+  }
+
+  if (::ioctl(fd.get(), FS_IOC_FSSETXATTR, &attr) == -1) {
+    ErrnoError error("Failed to set attributes of '" + path + "'");
+    os::close(fd.get());
+    return error;
+  }
+
+  os::close(fd.get());
+  return Nothing();
+}
+
+
+static Try<Nothing> setProjectIdRecursively(
+    const string& directory,
+    uint32_t projectId)
+{
+  if (os::stat::islink(directory) || !os::stat::isdir(directory)) {
+    return Error(directory + " is not a directory");
+  }
+
+  char* directory_[] = {const_cast<char*>(directory.c_str()), nullptr};
+
+  FTS* tree = ::fts_open(
+      directory_, FTS_NOCHDIR | FTS_PHYSICAL | FTS_XDEV, nullptr);
+
+  if (tree == nullptr) {
+    return ErrnoError("Failed to open '" + directory + "'");
+  }
+
+  errno = 0;
+
+  for (FTSENT* node = ::fts_read(tree);
+       node != nullptr; node = ::fts_read(tree)) {
+    // Bind mounts on the same device (e.g., persistent volumes) are
+    // not detected by FTS_XDEV. Like the `disk/xfs` isolator, we rely
+    // on renaming a directory into its own child failing with EXDEV
+    // when a mount is crossed.
+    if (node->fts_info == FTS_D && node->fts_level > 0) {
+      CHECK_EQ(-1, ::rename(
+          path::join(node->fts_path, "..").c_str(), node->fts_path));
+
+      if (errno == EXDEV) {
+        ::fts_set(tree, node, FTS_SKIP);
+        errno = 0;
+        continue;
+      }
+
+      errno = 0;
+    }
+
+    if (node->fts_info == FTS_D || node->fts_info == FTS_F) {
+      Try<Nothing> status = setProjectId(
+          node->fts_path, *node->fts_statp, projectId);
+
+      if (status.isError()) {
+        ::fts_close(tree);
+        return Error(status.error());
+      }
+    }
+  }
+
+  if (errno != 0) {
+    ErrnoError error("Failed to traverse '" + directory + "'");
+    ::fts_close(tree);
+    return error;
+  }
+
+  if (::fts_close(tree) != 0) {
+    return ErrnoError("Failed to stop traversing file system");
+  }
+
+  return Nothing();
+}
+
+
+Try<bool> isProjectQuotaEnabled(const string& path)
+{
+  Result<string> device = getDevice(path);
+  if (device.isError()) {
+    return Error(device.error());
+  }
+
+  if (device.isNone()) {
+    return false;
+  }
+
+  struct dqinfo info;
+
+  if (::quotactl(QCMD(Q_GETINFO, PRJQUOTA),
+                 device->c_str(),
+                 0,
+                 reinterpret_cast<caddr_t>(&info)) == -1) {
+    // ESRCH means that project quotas are not turned on, the others
+    // that the filesystem or the kernel does not support them.
+    if (errno == ESRCH ||
+        errno == ENOSYS ||
+        errno == EINVAL ||
+        errno == ENOTBLK ||
+        errno == ENODEV ||
+        errno == ENOENT) {
+      return false;
+    }
+
+    return ErrnoError("Failed to get the project quota state of '" +
+                      device.get() + "'");
+  }
+
+  return true;
+}
+
+
+Result<uint32_t> getProjectId(const string& path)
+{
+  struct stat stat;
+  if (::lstat(path.c_str(), &stat) == -1) {
+    return ErrnoError("Failed to access '" + path + "'");
+  }
+
+  int flags = O_NOFOLLOW | O_RDONLY | O_CLOEXEC;
+  flags |= S_ISDIR(stat.st_mode) ? O_DIRECTORY : 0;
+
+  Try<int> fd = os::open(path, flags);
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  struct fsxattr attr;
+  if (::ioctl(fd.get(), FS_IOC_FSGETXATTR, &attr) == -1) {
+    ErrnoError error("Failed to get attributes of '" + path + "'");
+    os::close(fd.get());
+    return error;
+  }
+
+  os::close(fd.get());
+
+  if (attr.fsx_projid == NON_PROJECT_ID) {
+    return None();
+  }
+
+  return attr.fsx_projid;
+}
+
+
+Try<Nothing> setProjectId(const string& directory, uint32_t projectId)
+{
+  if (projectId == NON_PROJECT_ID) {
+    return Error("Invalid project ID '0'");
+  }
+
+  return setProjectIdRecursively(directory, projectId);
+}
+
+
+Try<Nothing> clearProjectId(const string& directory)
+{
+  return setProjectIdRecursively(directory, NON_PROJECT_ID);
+}
+
+
+Try<Bytes> getProjectUsage(const string& device, uint32_t projectId)
+{
+  struct dqblk quota;
+
+  if (::quotactl(QCMD(Q_GETQUOTA, PRJQUOTA),
+                 device.c_str(),
+                 projectId,
+                 reinterpret_cast<caddr_t>(&quota)) == -1) {
+    // There is no quota record for projects which never charged any
+    // space on the filesystem.
+    if (errno == ESRCH || errno == ENOENT) {
+      return Bytes(0);
+    }
+
+    return ErrnoError("Failed to get quota for project ID " +
+                      stringify(projectId) + " on '" + device + "'");
+  }
+
+  return Bytes(quota.dqb_curspace);
+}
+
+} // namespace quota {
+} // namespace internal {
+} // namespace mesos {
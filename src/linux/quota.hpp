@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __LINUX_QUOTA_HPP__
+#define __LINUX_QUOTA_HPP__
+
+#include <stdint.h>
+
+#include <string>
+
+#include <stout/bytes.hpp>
+#include <stout/nothing.hpp>
+#include <stout/result.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace quota {
+
+// Filesystem-independent project quotas. Unlike the `xfs` utilities
+// of the `disk/xfs` isolator, these use the generic VFS interfaces
+// (the 'FS_IOC_FS[GS]ETXATTR' ioctls and the 'Q_GETQUOTA' quotactl
+// command), so they work on any filesystem supporting project quotas,
+// e.g., ext4 (mounted with 'prjquota') and XFS (mounted with
+// 'pquota'). Project IDs require Linux 4.5+.
+
+
+// Returns the block device of the filesystem containing the given
+// path, which is the special file expected by quotactl(2), or None if
+// the filesystem is not backed by a device known to the mount table.
+// This reads the whole mount table, so callers querying the usage of
+// a project repeatedly should resolve the device once.
+Result<std::string> getDevice(const std::string& path);
+
+
+// Returns whether project quota accounting is enabled on the
+// filesystem containing the given path. This is false for filesystems
+// which do not support project quotas or are not backed by a block
+// device (e.g., tmpfs or overlayfs).
+Try<bool> isProjectQuotaEnabled(const std::string& path);
+
+
+// Returns the project ID of the given file or directory, or None if
+// it is not assigned a project (i.e., the project ID is 0).
+Result<uint32_t> getProjectId(const std::string& path);
+
+
+// Recursively assigns the given project ID to the directory and all
+// the files and directories under it, without crossing mount points.
+// Directories are also marked so that new files inherit the project.
+Try<Nothing> setProjectId(const std::string& directory, uint32_t projectId);
+
+
+// Recursively removes the project ID assignment of the directory and
+// all the files and directories under it.
+Try<Nothing> clearProjectId(const std::string& directory);
+
+
+// Returns the disk space charged to the given project on the
+// filesystem of the given block device, as returned by `getDevice`.
+// This is a single kernel query regardless of the number of files in
+// the project.
+//
+// NOTE: The usage is as current as the filesystem's quota accounting,
+// which does not require the data to be synced to disk.
+Try<Bytes> getProjectUsage(const std::string& device, uint32_t projectId);
+
+} // namespace quota {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __LINUX_QUOTA_HPP__
@@ -34,6 +34,8 @@
 #include <stout/option.hpp>
 #include <stout/strings.hpp>
 
+#include "common/resource_names.hpp"
+
 using std::set;
 using std::string;
 using std::vector;
@@ -66,7 +68,13 @@ DRFSorter::~DRFSorter()
 void DRFSorter::initialize(
     const Option<set<string>>& _fairnessExcludeResourceNames)
 {
-  fairnessExcludeResourceNames = _fairnessExcludeResourceNames;
+  fairnessExcludeResourceIds.clear();
+
+  if (_fairnessExcludeResourceNames.isSome()) {
+    foreach (const string& name, _fairnessExcludeResourceNames.get()) {
+      fairnessExcludeResourceIds.insert(ResourceNames::intern(name).id);
+    }
+  }
 }
 
 
@@ -630,23 +638,24 @@ double DRFSorter::calculateShare(const Node* node) const
   // currently does not take into account resources that are not
   // scalars.
 
-  foreachpair (const string& resourceName,
-               const Value::Scalar& scalar,
-               total_.totals) {
+  // Match the resources by their interned name identifiers, since
+  // this is called for every node whose allocation changes.
+  total_.totals.foreachEntry([&](uint32_t id, double total) {
     // Filter out the resources excluded from fair sharing.
-    if (fairnessExcludeResourceNames.isSome() &&
-        fairnessExcludeResourceNames->count(resourceName) > 0) {
-      continue;
+    if (fairnessExcludeResourceIds.contains(id)) {
+      return;
     }
 
-    if (scalar.value() <= 0.0) {
-      continue;
+    if (total <= 0.0) {
+      return;
     }
 
-    Value::Scalar allocation = node->allocation.totals.get(resourceName);
+    Option<double> allocation = node->allocation.totals.find(id);
 
-    share = std::max(share, allocation.value() / scalar.value());
-  }
+    if (allocation.isSome()) {
+      share = std::max(share, allocation.get() / total);
+    }
+  });
 
   return share / getWeight(node);
 }
@@ -29,6 +29,7 @@
 
 #include <stout/check.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
 #include <stout/option.hpp>
 
 #include "master/allocator/mesos/sorter/drf/metrics.hpp"
@@ -126,8 +127,9 @@ private:
   // internal node in the tree (not a client).
   Node* find(const std::string& clientPath) const;
 
-  // Resources (by name) that will be excluded from fair sharing.
-  Option<std::set<std::string>> fairnessExcludeResourceNames;
+  // Resources (by interned name identifier, see
+  // `common/resource_names.hpp`) that will be excluded from fair sharing.
+  hashset<uint32_t> fairnessExcludeResourceIds;
 
   // If true, sort() will recalculate all shares and resort the tree.
   bool dirty = false;
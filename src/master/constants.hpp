@@ -183,6 +183,12 @@ const Quota DEFAULT_QUOTA;
 // Default weight for a role.
 constexpr double DEFAULT_WEIGHT = 1.0;
 
+// Maximum number of offers sent to an HTTP framework in a single
+// `OFFERS` event. Larger batches of offers are split across several
+// events so that each of them is serialized and written out in bounded
+// chunks.
+constexpr size_t MAX_OFFERS_PER_HTTP_EVENT = 1000;
+
 } // namespace master {
 } // namespace internal {
 } // namespace mesos {
@@ -24,6 +24,8 @@
 #include "master/constants.hpp"
 #include "master/flags.hpp"
 
+#include "master/resources/network_bandwidth.hpp"
+
 using std::string;
 
 mesos::internal::master::Flags::Flags()
@@ -163,6 +165,19 @@ mesos::internal::master::Flags::Flags()
       "By default, agents will be removed as soon as they fail the health\n"
       "checks. The value is of the form `(Number of agents)/(Duration)`.");
 
+  add(&Flags::agent_reregistration_rate_limit,
+      "agent_reregistration_rate_limit",
+      "The maximum rate (e.g., `100/1secs`, `1000/1mins`, etc) at which\n"
+      "agent re-registrations are admitted by the master. Re-registrations\n"
+      "beyond this rate are queued (see the\n"
+      "`master/slave_reregistrations_queued` metric) instead of being\n"
+      "processed immediately, which keeps the master responsive to other\n"
+      "messages when all agents reregister at once after a master\n"
+      "failover. The rate should be chosen such that all agents known to\n"
+      "the registry can be admitted within `--agent_reregister_timeout`.\n"
+      "By default, re-registrations are not rate limited. The value is of\n"
+      "the form `(Number of agents)/(Duration)`.");
+
   add(&Flags::webui_dir,
       "webui_dir",
       "Directory path of the webui files/assets",
@@ -732,6 +747,20 @@ mesos::internal::master::Flags::Flags()
       "frameworks.",
       true);
 
+  add(&Flags::parallel_message_ingestion,
+      "parallel_message_ingestion",
+      "If true, scheduler calls, `UpdateSlaveMessage`s and calls to the\n"
+      "scheduler and operator HTTP APIs are decoded and validated against\n"
+      "their schema on worker threads, and only the part of their handling\n"
+      "which depends on the master's state runs on the master actor.\n"
+      "Events are still processed in the order in which the master\n"
+      "received them, i.e., messages once they have passed the framework\n"
+      "rate limiters, and HTTP requests once they have been authenticated.\n"
+      "Messages and HTTP requests which are sent concurrently, e.g., by a\n"
+      "scheduler driver and an operator, are not ordered with respect to\n"
+      "each other.",
+      false);
+
   add(&Flags::domain,
       "domain",
       "Domain that the master belongs to. Mesos currently only supports\n"
@@ -772,4 +801,40 @@ mesos::internal::master::Flags::Flags()
       "network_bandwidth_enforcement",
       "Enable the network bandwidth enforcement.",
       false);
+
+  add(&Flags::network_bandwidth_formula,
+      "network_bandwidth_formula",
+      "The formula computing the network bandwidth of the tasks which do\n"
+      "not declare any, when `--network_bandwidth_enforcement` is set.\n"
+      "The bandwidth of a task is its share of the CPUs of its agent\n"
+      "applied to a pool of bandwidth, which is either the floor\n"
+      "(`floor_share`) or the network bandwidth declared by the agent\n"
+      "(`agent_share`). This can be overridden per agent with the\n"
+      "`network_bandwidth_formula` attribute.",
+      "floor_share",
+      [](const string& value) -> Option<Error> {
+        Try<mesos::resources::NetworkBandwidthPolicy::Formula> formula =
+          mesos::resources::NetworkBandwidthPolicy::parse(value);
+
+        if (formula.isError()) {
+          return Error(formula.error());
+        }
+
+        return None();
+      });
+
+  add(&Flags::network_bandwidth_floor,
+      "network_bandwidth_floor",
+      "The pool of network bandwidth (in Mbps) used by the `floor_share`\n"
+      "formula, and by the `agent_share` formula for agents which do not\n"
+      "declare any network bandwidth. This can be overridden per agent\n"
+      "with the `network_bandwidth_floor` attribute.",
+      mesos::resources::DEFAULT_NETWORK_BANDWIDTH_FLOOR,
+      [](double value) -> Option<Error> {
+        if (value < 0) {
+          return Error("Expected a non-negative network bandwidth floor");
+        }
+
+        return None();
+      });
 }
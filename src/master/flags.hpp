@@ -58,6 +58,7 @@ public:
   Duration agent_reregister_timeout;
   std::string recovery_agent_removal_limit;
   Option<std::string> agent_removal_rate_limit;
+  Option<std::string> agent_reregistration_rate_limit;
   std::string webui_dir;
   Option<Path> whitelist;
   std::string role_sorter;
@@ -105,6 +106,7 @@ public:
   size_t registry_max_agent_count;
   bool require_agent_domain;
   bool publish_per_framework_metrics;
+  bool parallel_message_ingestion;
   Option<DomainInfo> domain;
 
   // The following flags are executable specific (e.g., since we only
@@ -122,6 +124,8 @@ public:
   // If set, its output is expected to be a valid parseable IP string.
   Option<std::string> ip_discovery_command;
   bool network_bandwidth_enforcement;
+  std::string network_bandwidth_formula;
+  double network_bandwidth_floor;
 
 #ifdef ENABLE_PORT_MAPPING_ISOLATOR
   Option<size_t> max_executors_per_agent;
@@ -141,6 +141,7 @@ void Framework::addTask(Task* task)
     const Resources resources = task->resources();
     totalUsedResources += resources;
     usedResources[task->slave_id()] += resources;
+    master->roleTree.addAllocated(resources);
 
     // It's possible that we're not tracking the task's role for
     // this framework if the role is absent from the framework's
@@ -177,6 +178,8 @@ void Framework::recoverResources(Task* task)
     usedResources.erase(task->slave_id());
   }
 
+  master->roleTree.removeAllocated(task->resources());
+
   // If we are no longer subscribed to the role to which these resources are
   // being returned to, and we have no more resources allocated to us for that
   // role, stop tracking the framework under the role.
@@ -247,6 +250,7 @@ void Framework::addOffer(Offer* offer)
   offers.insert(offer);
   totalOfferedResources += offer->resources();
   offeredResources[offer->slave_id()] += offer->resources();
+  master->roleTree.addOffered(offer->resources());
 }
 
 
@@ -261,6 +265,8 @@ void Framework::removeOffer(Offer* offer)
     offeredResources.erase(offer->slave_id());
   }
 
+  master->roleTree.removeOffered(offer->resources());
+
   offers.erase(offer);
 }
 
@@ -308,6 +314,7 @@ void Framework::addExecutor(
   executors[slaveId][executorInfo.executor_id()] = executorInfo;
   totalUsedResources += executorInfo.resources();
   usedResources[slaveId] += executorInfo.resources();
+  master->roleTree.addAllocated(executorInfo.resources());
 
   // It's possible that we're not tracking the task's role for
   // this framework if the role is absent from the framework's
@@ -341,6 +348,8 @@ void Framework::removeExecutor(
     usedResources.erase(slaveId);
   }
 
+  master->roleTree.removeAllocated(executorInfo.resources());
+
   // If we are no longer subscribed to the role to which these resources are
   // being returned to, and we have no more resources allocated to us for that
   // role, stop tracking the framework under the role.
@@ -398,6 +407,7 @@ void Framework::addOperation(Operation* operation)
 
     totalUsedResources += consumed.get();
     usedResources[slaveId] += consumed.get();
+    master->roleTree.addAllocated(consumed.get());
 
     // It's possible that we're not tracking the role from the
     // resources in the operation for this framework if the role is
@@ -456,6 +466,8 @@ void Framework::recoverResources(Operation* operation)
     usedResources.erase(slaveId);
   }
 
+  master->roleTree.removeAllocated(consumed.get());
+
   // If we are no longer subscribed to the role to which these
   // resources are being returned to, and we have no more resources
   // allocated to us for that role, stop tracking the framework
@@ -158,6 +158,74 @@ using process::http::Request;
 using process::Owned;
 
 
+// Deserializes the body of a request to one of the v1 API endpoints
+// into `call`, returning the response to send if this fails.
+template <typename Call>
+static Option<Response> parseCall(const Request& request, Call* call)
+{
+  // TODO(anand): Content type values are case-insensitive.
+  Option<string> contentType = request.headers.get("Content-Type");
+
+  if (contentType.isNone()) {
+    return BadRequest("Expecting 'Content-Type' to be present");
+  }
+
+  if (contentType.get() == APPLICATION_PROTOBUF) {
+    if (!call->ParseFromString(request.body)) {
+      return BadRequest("Failed to parse body into Call protobuf");
+    }
+  } else if (contentType.get() == APPLICATION_JSON) {
+    Try<JSON::Value> value = JSON::parse(request.body);
+
+    if (value.isError()) {
+      return BadRequest("Failed to parse body into JSON: " + value.error());
+    }
+
+    Try<Call> parse = ::protobuf::parse<Call>(value.get());
+
+    if (parse.isError()) {
+      return BadRequest("Failed to convert JSON into Call protobuf: " +
+                        parse.error());
+    }
+
+    *call = std::move(parse.get());
+  } else {
+    return UnsupportedMediaType(
+        string("Expecting 'Content-Type' of ") +
+        APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
+  }
+
+  return None();
+}
+
+
+Future<Response> Master::Http::ingest(
+    const Request& request,
+    const lambda::function<
+        lambda::function<Future<Response>()>(const Request&)>& decode) const
+{
+  if (!master->flags.parallel_message_ingestion) {
+    return decode(request)();
+  }
+
+  // The request is copied since it does not outlive the handler, and
+  // shared rather than copied into each of the closures below since
+  // its body can be large.
+  std::shared_ptr<const Request> shared(new Request(request));
+  std::shared_ptr<Promise<Response>> promise(new Promise<Response>());
+
+  master->ingest([decode, shared, promise]() -> lambda::function<void()> {
+    const lambda::function<Future<Response>()> apply = decode(*shared);
+
+    return [apply, shared, promise]() {
+      promise->associate(apply());
+    };
+  });
+
+  return promise->future();
+}
+
+
 string Master::Http::API_HELP()
 {
   return HELP(
@@ -217,49 +285,46 @@ Future<Response> Master::Http::api(
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::master::Call v1Call;
+  // Deserializing and validating the call does not depend on the
+  // master's state, see `ingest()`.
+  // NOTE: The returned continuation refers to the request passed to
+  // `decode`, which `ingest()` keeps alive until it is invoked.
+  auto decode = [this, principal](const Request& request)
+      -> lambda::function<Future<Response>()> {
+    v1::master::Call v1Call;
 
-  // TODO(anand): Content type values are case-insensitive.
-  Option<string> contentType = request.headers.get("Content-Type");
+    Option<Response> error = parseCall(request, &v1Call);
 
-  if (contentType.isNone()) {
-    return BadRequest("Expecting 'Content-Type' to be present");
-  }
-
-  if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
-      return BadRequest("Failed to parse body into Call protobuf");
+    if (error.isSome()) {
+      const Response response = error.get();
+      return [response]() -> Future<Response> { return response; };
     }
-  } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
 
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
-    }
+    std::shared_ptr<mesos::master::Call> call(
+        new mesos::master::Call(devolve(v1Call)));
 
-    Try<v1::master::Call> parse =
-      ::protobuf::parse<v1::master::Call>(value.get());
+    Option<Error> validationError = validation::master::call::validate(*call);
 
-    if (parse.isError()) {
-      return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
+    if (validationError.isSome()) {
+      const Response response = BadRequest(
+          "Failed to validate master::Call: " + validationError->message);
+      return [response]() -> Future<Response> { return response; };
     }
 
-    v1Call = parse.get();
-  } else {
-    return UnsupportedMediaType(
-        string("Expecting 'Content-Type' of ") +
-        APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
-  }
-
-  mesos::master::Call call = devolve(v1Call);
+    return [this, &request, principal, call]() {
+      return _api(request, principal, std::move(*call));
+    };
+  };
 
-  Option<Error> error = validation::master::call::validate(call);
+  return ingest(request, decode);
+}
 
-  if (error.isSome()) {
-    return BadRequest("Failed to validate master::Call: " + error->message);
-  }
 
+Future<Response> Master::Http::_api(
+    const Request& request,
+    const Option<Principal>& principal,
+    mesos::master::Call&& call) const
+{
   LOG(INFO) << "Processing call " << call.type();
 
   ContentType acceptType;
@@ -508,50 +573,48 @@ Future<Response> Master::Http::scheduler(
     return MethodNotAllowed({"POST"}, request.method);
   }
 
-  v1::scheduler::Call v1Call;
-
-  // TODO(anand): Content type values are case-insensitive.
-  Option<string> contentType = request.headers.get("Content-Type");
-
-  if (contentType.isNone()) {
-    return BadRequest("Expecting 'Content-Type' to be present");
-  }
+  // Deserializing and validating the call does not depend on the
+  // master's state, see `ingest()`.
+  // NOTE: The returned continuation refers to the request passed to
+  // `decode`, which `ingest()` keeps alive until it is invoked.
+  auto decode = [this, principal](const Request& request)
+      -> lambda::function<Future<Response>()> {
+    v1::scheduler::Call v1Call;
 
-  if (contentType.get() == APPLICATION_PROTOBUF) {
-    if (!v1Call.ParseFromString(request.body)) {
-      return BadRequest("Failed to parse body into Call protobuf");
-    }
-  } else if (contentType.get() == APPLICATION_JSON) {
-    Try<JSON::Value> value = JSON::parse(request.body);
+    Option<Response> error = parseCall(request, &v1Call);
 
-    if (value.isError()) {
-      return BadRequest("Failed to parse body into JSON: " + value.error());
+    if (error.isSome()) {
+      const Response response = error.get();
+      return [response]() -> Future<Response> { return response; };
     }
 
-    Try<v1::scheduler::Call> parse =
-      ::protobuf::parse<v1::scheduler::Call>(value.get());
+    std::shared_ptr<scheduler::Call> call(
+        new scheduler::Call(devolve(v1Call)));
 
-    if (parse.isError()) {
-      return BadRequest("Failed to convert JSON into Call protobuf: " +
-                        parse.error());
-    }
+    Option<Error> validationError =
+      validation::scheduler::call::validate(*call, principal);
 
-    v1Call = parse.get();
-  } else {
-    return UnsupportedMediaType(
-        string("Expecting 'Content-Type' of ") +
-        APPLICATION_JSON + " or " + APPLICATION_PROTOBUF);
-  }
+    return [this, &request, principal, call, validationError]()
+        -> Future<Response> {
+      if (validationError.isSome()) {
+        master->metrics->incrementInvalidSchedulerCalls(*call);
+        return BadRequest(
+            "Failed to validate scheduler::Call: " + validationError->message);
+      }
 
-  scheduler::Call call = devolve(v1Call);
+      return _scheduler(request, principal, std::move(*call));
+    };
+  };
 
-  Option<Error> error = validation::scheduler::call::validate(call, principal);
+  return ingest(request, decode);
+}
 
-  if (error.isSome()) {
-    master->metrics->incrementInvalidSchedulerCalls(call);
-    return BadRequest("Failed to validate scheduler::Call: " + error->message);
-  }
 
+Future<Response> Master::Http::_scheduler(
+    const Request& request,
+    const Option<Principal>& principal,
+    scheduler::Call&& call) const
+{
   ContentType acceptType;
 
   // Ideally this handler would be consistent with the Operator API handler
@@ -2977,6 +3040,8 @@ string Master::Http::TASKS_HELP()
         ">        offset=VALUE         Starts task list at offset.",
         ">        order=(asc|desc)     Ascending or descending sort order "
         "(default is descending).",
+        ">        state=VALUE          Only return tasks in this state "
+        "(e.g., TASK_RUNNING).",
         ">        task_id=VALUE        Only return tasks with this ID "
         "(should be used together with parameter 'framework_id')."
         ""),
@@ -45,6 +45,7 @@
 
 #include <mesos/scheduler/scheduler.hpp>
 
+#include <process/async.hpp>
 #include <process/check.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
@@ -81,6 +82,7 @@
 #include "common/build.hpp"
 #include "common/http.hpp"
 #include "common/protobuf_utils.hpp"
+#include "common/resources_index.hpp"
 #include "common/status_utils.hpp"
 
 #include "credentials/credentials.hpp"
@@ -333,6 +335,12 @@ Master::Master(
 {
   slaves.limiter = _slaveRemovalLimiter;
 
+  // NOTE: The formula has already been validated when loading the flags.
+  networkBandwidthPolicy = resources::NetworkBandwidthPolicy(
+      CHECK_NOTERROR(resources::NetworkBandwidthPolicy::parse(
+          flags.network_bandwidth_formula)),
+      flags.network_bandwidth_floor);
+
   // NOTE: We populate 'info_' here instead of inside 'initialize()'
   // because 'StandaloneMasterDetector' needs access to the info.
 
@@ -687,6 +695,44 @@ void Master::initialize()
               << flags.agent_removal_rate_limit.get();
   }
 
+  if (flags.agent_reregistration_rate_limit.isSome()) {
+    // TODO(vinod): Move this parsing logic to flags once we have a
+    // 'Rate' abstraction in stout.
+    vector<string> tokens =
+      strings::tokenize(flags.agent_reregistration_rate_limit.get(), "/");
+
+    if (tokens.size() != 2) {
+      EXIT(EXIT_FAILURE)
+        << "Invalid agent_reregistration_rate_limit: "
+        << flags.agent_reregistration_rate_limit.get()
+        << ". Format is <Number of agents>/<Duration>";
+    }
+
+    Try<int> permits = numify<int>(tokens[0]);
+    if (permits.isError() || permits.get() <= 0) {
+      EXIT(EXIT_FAILURE)
+        << "Invalid agent_reregistration_rate_limit: "
+        << flags.agent_reregistration_rate_limit.get()
+        << ". Format is <Number of agents>/<Duration>"
+        << (permits.isError() ? ": " + permits.error() : "");
+    }
+
+    Try<Duration> duration = Duration::parse(tokens[1]);
+    if (duration.isError() || duration.get() <= Duration::zero()) {
+      EXIT(EXIT_FAILURE)
+        << "Invalid agent_reregistration_rate_limit: "
+        << flags.agent_reregistration_rate_limit.get()
+        << ". Format is <Number of agents>/<Duration>"
+        << (duration.isError() ? ": " + duration.error() : "");
+    }
+
+    slaves.reregistrationLimiter = Owned<RateLimiter>(
+        new RateLimiter(permits.get(), duration.get()));
+
+    LOG(INFO) << "Agent re-registration is rate limited to "
+              << flags.agent_reregistration_rate_limit.get();
+  }
+
   // If "--roles" is set, configure the role whitelist.
   // TODO(neilc): Remove support for explicit roles in ~Mesos 0.32.
   if (flags.roles.isSome()) {
@@ -898,6 +944,11 @@ void Master::initialize()
       &AuthenticateMessage::pid);
 
   // Setup HTTP routes.
+  //
+  // NOTE: Calls to the scheduler and operator HTTP APIs are ordered
+  // with respect to messages by `Http::ingest()`. The handlers of the
+  // other endpoints which require authentication are wrapped by
+  // `ordered()` for the same purpose.
   route("/api/v1",
         // TODO(benh): Is this authentication realm sufficient or do
         // we need some kind of hybrid if we expect both schedulers
@@ -926,38 +977,38 @@ void Master::initialize()
   route("/create-volumes",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::CREATE_VOLUMES_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.createVolumes(request, principal);
-        });
+        }));
   route("/destroy-volumes",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::DESTROY_VOLUMES_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.destroyVolumes(request, principal);
-        });
+        }));
   route("/frameworks",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::FRAMEWORKS_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.frameworks(request, principal)
             .onReady([request](const process::http::Response& response) {
               logResponse(request, response);
             });
-        });
+        }));
   route("/flags",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::FLAGS_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.flags(request, principal);
-        });
+        }));
   route("/health",
         Http::HEALTH_HELP(),
         [this](const process::http::Request& request) {
@@ -971,129 +1022,129 @@ void Master::initialize()
   route("/reserve",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::RESERVE_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.reserve(request, principal);
-        });
+        }));
   route("/roles",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::ROLES_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.roles(request, principal);
-        });
+        }));
   route("/teardown",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::TEARDOWN_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.teardown(request, principal);
-        });
+        }));
   route("/slaves",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::SLAVES_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.slaves(request, principal)
             .onReady([request](const process::http::Response& response) {
               logResponse(request, response);
             });
-        });
+        }));
   route("/state",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::STATE_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.state(request, principal)
             .onReady([request](const process::http::Response& response) {
               logResponse(request, response);
             });
-        });
+        }));
   route("/state-summary",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::STATESUMMARY_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.stateSummary(request, principal)
             .onReady([request](const process::http::Response& response) {
               logResponse(request, response);
             });
-        });
+        }));
   route("/tasks",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::TASKS_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.tasks(request, principal)
             .onReady([request](const process::http::Response& response) {
               logResponse(request, response);
             });
-        });
+        }));
   route("/maintenance/schedule",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::MAINTENANCE_SCHEDULE_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.maintenanceSchedule(request, principal);
-        });
+        }));
   route("/maintenance/status",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::MAINTENANCE_STATUS_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.maintenanceStatus(request, principal);
-        });
+        }));
   route("/machine/down",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::MACHINE_DOWN_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.machineDown(request, principal);
-        });
+        }));
   route("/machine/up",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::MACHINE_UP_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.machineUp(request, principal);
-        });
+        }));
   route("/unreserve",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::UNRESERVE_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.unreserve(request, principal);
-        });
+        }));
   route("/weights",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::WEIGHTS_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.weights(request, principal);
-        });
+        }));
 
   // Deprecated routes:
   route("/quota",
         READWRITE_HTTP_AUTHENTICATION_REALM,
         Http::QUOTA_HELP(),
-        [this](const process::http::Request& request,
-               const Option<Principal>& principal) {
+        ordered([this](const process::http::Request& request,
+                       const Option<Principal>& principal) {
           logRequest(request);
           return http.quota(request, principal);
-        });
+        }));
 
   // Provide HTTP assets from a "webui" directory. This is either
   // specified via flags (which is necessary for running out of the
@@ -1605,6 +1656,100 @@ void Master::throttled(
 
 
 void Master::_consume(MessageEvent&& event)
+{
+  if (flags.parallel_message_ingestion) {
+    // Scheduler calls (e.g., an `ACCEPT` with many operations) and
+    // agent resource updates can be large, so they are deserialized
+    // and validated on a worker thread. Only the part of handling them
+    // which depends on the master's state runs on the master actor.
+    static const string schedulerCall = scheduler::Call().GetTypeName();
+    static const string updateSlaveMessage =
+      UpdateSlaveMessage().GetTypeName();
+
+    if (event.message.name == schedulerCall) {
+      const UPID from = event.message.from;
+      std::shared_ptr<string> body(new string(std::move(event.message.body)));
+
+      // See `__consume()` for why the principal is obtained up front.
+      const Option<string> principal = frameworks.principals.contains(from)
+        ? frameworks.principals[from]
+        : Option<string>::none();
+
+      ingest([this, from, body, principal]() -> lambda::function<void()> {
+        std::shared_ptr<scheduler::Call> call(new scheduler::Call());
+
+        if (!call->ParseFromString(*body)) {
+          return [from]() {
+            LOG(WARNING) << "Failed to deserialize '" << schedulerCall
+                         << "' from " << from;
+          };
+        }
+
+        Option<Error> error = validation::scheduler::call::validate(*call);
+
+        return [this, from, call, error, principal]() {
+          if (error.isSome()) {
+            metrics->incrementInvalidSchedulerCalls(*call);
+            drop(from, *call, error->message);
+          } else {
+            _receive(from, std::move(*call));
+          }
+
+          if (principal.isSome() &&
+              metrics->frameworks.contains(principal.get())) {
+            Counter messages_processed =
+              metrics->frameworks.get(principal.get()).get()
+                ->messages_processed;
+            ++messages_processed;
+          }
+        };
+      });
+
+      return;
+    }
+
+    if (event.message.name == updateSlaveMessage) {
+      const UPID from = event.message.from;
+      std::shared_ptr<string> body(new string(std::move(event.message.body)));
+
+      ingest([this, from, body]() -> lambda::function<void()> {
+        std::shared_ptr<UpdateSlaveMessage> message(new UpdateSlaveMessage());
+
+        if (!message->ParseFromString(*body)) {
+          return [from]() {
+            LOG(WARNING) << "Failed to deserialize '" << updateSlaveMessage
+                         << "' from " << from;
+          };
+        }
+
+        upgradeResources(message.get());
+
+        return [this, message]() {
+          _updateSlave(std::move(*message));
+        };
+      });
+
+      return;
+    }
+  }
+
+  // Preserve the order with respect to events which are still being
+  // decoded.
+  if (!ingested.empty()) {
+    std::shared_ptr<MessageEvent> pending(new MessageEvent(std::move(event)));
+
+    enqueue([this, pending]() {
+      __consume(std::move(*pending));
+    });
+
+    return;
+  }
+
+  __consume(std::move(event));
+}
+
+
+void Master::__consume(MessageEvent&& event)
 {
   // Obtain the principal before processing the Message because the
   // mapping may be deleted in handling 'UnregisterFrameworkMessage'
@@ -1656,10 +1801,111 @@ void Master::exceededCapacity(
 
 void Master::_consume(ExitedEvent&& event)
 {
+  // Preserve the order with respect to messages from the same
+  // process which are still being decoded.
+  if (!ingested.empty()) {
+    std::shared_ptr<ExitedEvent> pending(new ExitedEvent(std::move(event)));
+
+    enqueue([this, pending]() {
+      Process<Master>::consume(std::move(*pending));
+    });
+
+    return;
+  }
+
   Process<Master>::consume(std::move(event));
 }
 
 
+void Master::ingest(const lambda::function<lambda::function<void()>()>& decode)
+{
+  std::shared_ptr<IngestedEvent> event(new IngestedEvent());
+  ingested.push_back(event);
+
+  ++metrics->ingestion_decode_queued;
+
+  metrics->ingestion_decode_latency.time(process::async(decode))
+    .onAny(defer(self(), &Self::_ingest, event, lambda::_1));
+}
+
+
+void Master::_ingest(
+    const std::shared_ptr<IngestedEvent>& event,
+    const Future<lambda::function<void()>>& apply)
+{
+  --metrics->ingestion_decode_queued;
+
+  if (apply.isReady()) {
+    event->apply = apply.get();
+  } else {
+    // The event is dropped, but it must still be removed from the
+    // queue so that it does not block the events behind it.
+    LOG(ERROR) << "Failed to decode event: "
+               << (apply.isFailed() ? apply.failure() : "discarded");
+
+    event->apply = []() {};
+  }
+
+  ++metrics->ingestion_apply_queued;
+  metrics->ingestion_apply_latency.time(event->applied.future());
+
+  applyIngested();
+}
+
+
+void Master::enqueue(const lambda::function<void()>& apply)
+{
+  CHECK(!ingested.empty());
+
+  std::shared_ptr<IngestedEvent> event(new IngestedEvent());
+  event->apply = apply;
+  ingested.push_back(event);
+
+  ++metrics->ingestion_apply_queued;
+  metrics->ingestion_apply_latency.time(event->applied.future());
+}
+
+
+process::ProcessBase::AuthenticatedHttpRequestHandler Master::ordered(
+    const AuthenticatedHttpRequestHandler& handler)
+{
+  return [this, handler](
+      const process::http::Request& request,
+      const Option<Principal>& principal) -> Future<process::http::Response> {
+    if (ingested.empty()) {
+      return handler(request, principal);
+    }
+
+    // The request is copied since it does not outlive the handler.
+    std::shared_ptr<const process::http::Request> shared(
+        new process::http::Request(request));
+
+    std::shared_ptr<Promise<process::http::Response>> promise(
+        new Promise<process::http::Response>());
+
+    enqueue([handler, shared, principal, promise]() {
+      promise->associate(handler(*shared, principal));
+    });
+
+    return promise->future();
+  };
+}
+
+
+void Master::applyIngested()
+{
+  while (!ingested.empty() && ingested.front()->apply.isSome()) {
+    std::shared_ptr<IngestedEvent> event = ingested.front();
+    ingested.pop_front();
+
+    --metrics->ingestion_apply_queued;
+
+    event->apply.get()();
+    event->applied.set(Nothing());
+  }
+}
+
+
 void fail(const string& message, const string& failure)
 {
   LOG(FATAL) << message << ": " << failure;
@@ -2037,7 +2283,8 @@ void Master::recoveredSlavesTimeout(const Registry& registry)
     // has started but not yet finished reregistering. In either
     // case, we don't want to try to remove it.
     if (!slaves.recovered.contains(slave.info().id()) ||
-        slaves.reregistering.contains(slave.info().id())) {
+        slaves.reregistering.contains(slave.info().id()) ||
+        slaves.admitting.contains(slave.info().id())) {
       continue;
     }
 
@@ -2416,6 +2663,14 @@ void Master::receive(
     return;
   }
 
+  _receive(from, std::move(call));
+}
+
+
+void Master::_receive(
+    const UPID& from,
+    scheduler::Call&& call)
+{
   if (call.type() == scheduler::Call::SUBSCRIBE) {
     subscribe(from, std::move(*call.mutable_subscribe()));
     return;
@@ -3582,7 +3837,7 @@ vector<string> Master::knownRoles() const
     // In terms of building a complete set of known roles, we have to visit:
     //   (1) all entries of `roles` (which means there are frameworks
     //       subscribed to a role or have allocations to a role)
-    //   (2) all reservation roles
+    //   (2) all reservation roles (as tracked in the role tree)
     //   (3) all roles with configured weights or quotas
     //   (4) all ancestor roles of (1), (2), and (3).
 
@@ -3591,10 +3846,11 @@ vector<string> Master::knownRoles() const
       insertAncestors(role);
     }
 
-    foreachvalue (Slave* slave, this->slaves.registered) {
-      foreachkey (const string& role, slave->totalResources.reservations()) {
+    // NOTE: The role tree also contains the ancestors of the roles
+    // with resources.
+    foreach (const string& role, this->roleTree.roles()) {
+      if (!this->roleTree.get(role).reserved.empty()) {
         roleList.insert(role);
-        insertAncestors(role);
       }
     }
 
@@ -3625,61 +3881,29 @@ bool Master::isWhitelistedRole(const string& name) const
 
 ResourceQuantities Master::RoleResourceBreakdown::offered() const
 {
-  ResourceQuantities result;
-
-  foreachvalue (Framework* framework, master->frameworks.registered) {
-    result += ResourceQuantities::fromResources(
-        framework->totalOfferedResources.allocatedToRoleSubtree(role));
-  }
-
-  return result;
+  return master->roleTree.get(role).offered;
 }
 
 
 ResourceQuantities Master::RoleResourceBreakdown::allocated() const
 {
-  ResourceQuantities result;
-
-  foreachvalue (Framework* framework, master->frameworks.registered) {
-    result += ResourceQuantities::fromResources(
-        framework->totalUsedResources.allocatedToRoleSubtree(role));
-  }
-
-  return result;
+  return master->roleTree.get(role).allocated;
 }
 
 
 ResourceQuantities Master::RoleResourceBreakdown::reserved() const
 {
-  ResourceQuantities result;
-
-  foreachvalue (Slave* slave, master->slaves.registered) {
-    result += ResourceQuantities::fromResources(
-        slave->totalResources.reservedToRoleSubtree(role));
-  }
-
-  return result;
+  return master->roleTree.get(role).reserved;
 }
 
 
 ResourceQuantities Master::RoleResourceBreakdown::consumedQuota() const
 {
-  ResourceQuantities unallocatedReservation;
-
-  foreachvalue (Slave* slave, master->slaves.registered) {
-    ResourceQuantities totalReservation = ResourceQuantities::fromResources(
-        slave->totalResources.reservedToRoleSubtree(role));
+  const RoleTree::Quantities& quantities = master->roleTree.get(role);
 
-    ResourceQuantities usedReservation;
-    foreachvalue (const Resources& r, slave->usedResources) {
-      usedReservation += ResourceQuantities::fromResources(
-          r.reservedToRoleSubtree(role));
-    }
-
-    unallocatedReservation += totalReservation - usedReservation;
-  }
-
-  return allocated() + unallocatedReservation;
+  // Unallocated reservations are also considered consumed.
+  return quantities.allocated +
+    (quantities.reserved - quantities.allocatedReservations);
 }
 
 
@@ -4524,8 +4748,7 @@ void Master::accept(
     foreach (Offer::Operation& operation, operations) {
       Option<Error> error;
       if(flags.network_bandwidth_enforcement) {
-        error = resources::enforceNetworkBandwidthAllocation(
-              slave->totalResources, operation);
+        error = networkBandwidthPolicy.enforce(slave->id, operation);
         if(error.isSome()) {
           LOG(WARNING) << "[NETWORK BANDWIDTH]:" <<
                           error.get().message;
@@ -5029,8 +5252,9 @@ void Master::_accept(
   // We maintain the "running remaining" resources here to support pipelining of
   // speculative operations (e.g., RESERVE), which would modify the remaining
   // resources. Resources consumed by non-speculative operations (e.g., LAUNCH)
-  // are removed from the remaining resources.
-  Resources remainingResources = offeredResources;
+  // are removed from the remaining resources. They are indexed so that each
+  // operation is checked against them without comparing every resource pair.
+  ResourcesIndex remainingResources = offeredResources;
 
   // Converted resources from volume resizes. These converted resources are not
   // put into `remainingResources`, so no other operations can consume them.
@@ -5045,6 +5269,12 @@ void Master::_accept(
   // of tasks involving shared resources. See comments in the LAUNCH case below.
   Resources remainingSharedResources = offeredResources.shared();
 
+  // The resources available to the tasks of LAUNCH operations, i.e., the
+  // non-shared remaining resources and the remaining shared resources (see
+  // the LAUNCH case below). They are only recomputed when operations other
+  // than LAUNCH modify the remaining resources.
+  Option<ResourcesIndex> launchResources;
+
   // Maintain a list of resource conversions to pass to the allocator
   // as a result of operations. Note that:
   // 1) We drop invalid operations.
@@ -5065,6 +5295,10 @@ void Master::_accept(
       _authorizations->begin(), _authorizations->end());
 
   foreach (const Offer::Operation& operation, accept.operations()) {
+    if (operation.type() != Offer::Operation::LAUNCH) {
+      launchResources = None();
+    }
+
     switch (operation.type()) {
       // The RESERVE operation allows a principal to reserve resources.
       case Offer::Operation::RESERVE: {
@@ -5120,14 +5354,12 @@ void Master::_accept(
           continue;
         }
 
-        Try<Resources> resources = remainingResources.apply(_conversions.get());
-        if (resources.isError()) {
-          drop(framework, operation, resources.error());
+        Try<Nothing> applied = remainingResources.apply(_conversions.get());
+        if (applied.isError()) {
+          drop(framework, operation, applied.error());
           continue;
         }
 
-        remainingResources = resources.get();
-
         LOG(INFO) << "Applying RESERVE operation for resources "
                   << operation.reserve().resources() << " from framework "
                   << *framework << " to agent " << *slave;
@@ -5187,14 +5419,12 @@ void Master::_accept(
           continue;
         }
 
-        Try<Resources> resources = remainingResources.apply(_conversions.get());
-        if (resources.isError()) {
-          drop(framework, operation, resources.error());
+        Try<Nothing> applied = remainingResources.apply(_conversions.get());
+        if (applied.isError()) {
+          drop(framework, operation, applied.error());
           continue;
         }
 
-        remainingResources = resources.get();
-
         LOG(INFO) << "Applying UNRESERVE operation for resources "
                   << operation.unreserve().resources() << " from framework "
                   << *framework << " to agent " << *slave;
@@ -5264,13 +5494,12 @@ void Master::_accept(
           continue;
         }
 
-        Try<Resources> resources = remainingResources.apply(_conversions.get());
-        if (resources.isError()) {
-          drop(framework, operation, resources.error());
+        Try<Nothing> applied = remainingResources.apply(_conversions.get());
+        if (applied.isError()) {
+          drop(framework, operation, applied.error());
           continue;
         }
 
-        remainingResources = resources.get();
         remainingSharedResources = remainingResources.shared();
 
         LOG(INFO) << "Applying CREATE operation for volumes "
@@ -5358,13 +5587,12 @@ void Master::_accept(
           continue;
         }
 
-        Try<Resources> resources = remainingResources.apply(_conversions.get());
-        if (resources.isError()) {
-          drop(framework, operation, resources.error());
+        Try<Nothing> applied = remainingResources.apply(_conversions.get());
+        if (applied.isError()) {
+          drop(framework, operation, applied.error());
           continue;
         }
 
-        remainingResources = resources.get();
         remainingSharedResources = remainingResources.shared();
 
         LOG(INFO) << "Applying DESTROY operation for volumes "
@@ -5616,8 +5844,12 @@ void Master::_accept(
           // than those being offered. e.g., 2 tasks can be launched on 1 copy
           // of a shared persistent volume from the offer; 3 tasks can be
           // launched on 2 copies of a shared persistent volume from 2 offers.
-          Resources available =
-            remainingResources.nonShared() + remainingSharedResources;
+          if (launchResources.isNone()) {
+            launchResources = ResourcesIndex(remainingResources.nonShared());
+            launchResources.get() += remainingSharedResources;
+          }
+
+          const ResourcesIndex& available = launchResources.get();
 
           Option<Error> error =
             validation::task::validate(task, framework, slave, available);
@@ -5693,6 +5925,9 @@ void Master::_accept(
 
             remainingResources -= consumed;
 
+            // The remaining shared resources are left unchanged.
+            launchResources.get() -= consumed.nonShared();
+
             RunTaskMessage message;
             message.mutable_framework()->MergeFrom(framework->info);
 
@@ -6155,8 +6390,9 @@ void Master::_accept(
   // in the future, their results are not in the remaining resources, so we add
   // them back here. Remove this once the operations become non-speculative.
   Resources speculativelyConverted =
-    remainingResources + resizedResources - offeredResources;
-  Resources implicitlyDeclined = remainingResources - speculativelyConverted;
+    remainingResources.resources() + resizedResources - offeredResources;
+  Resources implicitlyDeclined =
+    remainingResources.resources() - speculativelyConverted;
 
   // Prevent any allocations from occurring during resource recovery below.
   allocator->pause();
@@ -7418,7 +7654,8 @@ void Master::reregisterSlave(
   // However, this should very rarely happen in practice, and nobody seems to
   // have complained about it so far.
   const SlaveInfo& slaveInfo = reregisterSlaveMessage.slave();
-  if (slaves.reregistering.contains(slaveInfo.id())) {
+  if (slaves.reregistering.contains(slaveInfo.id()) ||
+      slaves.admitting.contains(slaveInfo.id())) {
     LOG(INFO)
       << "Ignoring reregister agent message from agent "
       << slaveInfo.id() << " at " << from << " ("
@@ -7446,30 +7683,103 @@ void Master::reregisterSlave(
     return;
   }
 
-  Option<Error> error =
-    validation::master::message::reregisterSlave(reregisterSlaveMessage);
+  LOG(INFO) << "Received reregister agent message from agent "
+            << slaveInfo.id() << " at " << from << " ("
+            << slaveInfo.hostname() << ")";
 
-  if (error.isSome()) {
+  slaves.admitting.insert(slaveInfo.id());
+
+  // NOTE: After a master failover every agent reregisters at about the
+  // same time. To keep the master responsive we (1) validate and
+  // upgrade the (potentially large) message on a worker thread rather
+  // than on the master actor, and (2) only then admit at most
+  // `--agent_reregistration_rate_limit` re-registrations and queue the
+  // rest, so that invalid re-registrations are dropped without waiting
+  // for (and consuming) a permit. The message is moved into a
+  // `shared_ptr` to avoid copying it between the two.
+  shared_ptr<ReregisterSlaveMessage> message(new ReregisterSlaveMessage());
+  message->Swap(&reregisterSlaveMessage);
+
+  Future<Option<Error>> validated =
+    process::async([message]() -> Option<Error> {
+      Option<Error> error =
+        validation::master::message::reregisterSlave(*message);
+
+      if (error.isNone()) {
+        // Update all resources passed by the agent to
+        // `POST_RESERVATION_REFINEMENT` format. We do this as early as
+        // possible so that we only use a single format inside master,
+        // and downgrade again if necessary when they leave the master
+        // (e.g. when writing to the registry).
+        upgradeResources(message.get());
+      }
+
+      return error;
+    });
+
+  validated
+    .then(defer(self(), &Self::queueSlaveReregistration, lambda::_1))
+    .onAny(defer(self(),
+                 &Self::admitSlaveReregistration,
+                 from,
+                 message,
+                 lambda::_1));
+}
+
+
+Future<Option<Error>> Master::queueSlaveReregistration(
+    const Option<Error>& error)
+{
+  if (error.isSome() || slaves.reregistrationLimiter.isNone()) {
+    return error;
+  }
+
+  ++metrics->slave_reregistrations_queued;
+
+  return metrics->slave_reregistration_admission_delay.time(
+      slaves.reregistrationLimiter.get()->acquire())
+    .onAny(defer(self(), [this](const Future<Nothing>&) {
+      --metrics->slave_reregistrations_queued;
+    }))
+    .then([]() -> Option<Error> { return None(); });
+}
+
+
+void Master::admitSlaveReregistration(
+    const UPID& from,
+    const shared_ptr<ReregisterSlaveMessage>& message,
+    const Future<Option<Error>>& validation)
+{
+  const SlaveInfo& slaveInfo = message->slave();
+  CHECK(slaves.admitting.contains(slaveInfo.id()));
+  CHECK(!slaves.reregistering.contains(slaveInfo.id()));
+
+  slaves.admitting.erase(slaveInfo.id());
+
+  if (!validation.isReady()) {
     LOG(WARNING) << "Dropping re-registration of agent at " << from
-                 << " because it sent an invalid re-registration: "
-                 << error->message;
+                 << " because it could not be admitted: "
+                 << (validation.isFailed() ? validation.failure()
+                                           : "discarded");
+    return;
+  }
 
+  if (validation->isSome()) {
+    LOG(WARNING) << "Dropping re-registration of agent at " << from
+                 << " because it sent an invalid re-registration: "
+                 << validation->get().message;
     return;
   }
 
-  LOG(INFO) << "Received reregister agent message from agent "
-            << slaveInfo.id() << " at " << from << " ("
-            << slaveInfo.hostname() << ")";
+  VLOG(1) << "Admitted re-registration of agent " << slaveInfo.id()
+          << " at " << from << " (" << slaveInfo.hostname() << ")";
 
   // TODO(bevers): Create a guard object calling `insert()` in its constructor
   // and `erase()` in its destructor, to avoid the manual bookkeeping.
   slaves.reregistering.insert(slaveInfo.id());
 
-  // Update all resources passed by the agent to `POST_RESERVATION_REFINEMENT`
-  // format. We do this as early as possible so that we only use a single
-  // format inside master, and downgrade again if necessary when they leave the
-  // master (e.g. when writing to the registry).
-  upgradeResources(&reregisterSlaveMessage);
+  ReregisterSlaveMessage reregisterSlaveMessage;
+  reregisterSlaveMessage.Swap(message.get());
 
   // Note that the principal may be empty if authentication is not
   // required. Also it is passed along because it may be removed from
@@ -7685,7 +7995,7 @@ void Master::_reregisterSlave(
           std::move(reregisterSlaveMessage),
           true);
     } else {
-      registrar->apply(Owned<RegistryOperation>(new UpdateSlave(slaveInfo)))
+      readmitSlave(slaveInfo, true)
         .onAny(defer(self(),
             &Self::___reregisterSlave,
             pid,
@@ -7708,7 +8018,7 @@ void Master::_reregisterSlave(
           std::move(reregisterSlaveMessage),
           true);
     } else {
-      registrar->apply(Owned<RegistryOperation>(new UpdateSlave(slaveInfo)))
+      readmitSlave(slaveInfo, true)
         .onAny(defer(self(),
             &Self::__reregisterSlave,
             pid,
@@ -7724,8 +8034,7 @@ void Master::_reregisterSlave(
     VLOG(1) << "Consulting registry about agent " << slaveInfo.id()
             << " at " << pid << "(" << slaveInfo.hostname() << ")";
 
-    registrar->apply(Owned<RegistryOperation>(
-        new MarkSlaveReachable(slaveInfo)))
+    readmitSlave(slaveInfo, false)
       .onAny(defer(self(),
           &Self::__reregisterSlave,
           pid,
@@ -7735,6 +8044,72 @@ void Master::_reregisterSlave(
 }
 
 
+Future<bool> Master::readmitSlave(const SlaveInfo& slaveInfo, bool admitted)
+{
+  Owned<Promise<bool>> promise(new Promise<bool>());
+  Future<bool> future = promise->future();
+
+  slaves.readmissions.push_back({slaveInfo, admitted, promise});
+
+  // NOTE: After a master failover, agents reregister faster than their
+  // registry updates are stored. Rather than applying one operation
+  // per agent, each of which scans the registry, we apply the updates
+  // requested while the registrar is busy in one `ReadmitSlaves`.
+  if (!slaves.readmitting) {
+    readmitSlaves();
+  }
+
+  return future;
+}
+
+
+void Master::readmitSlaves()
+{
+  if (slaves.readmissions.empty()) {
+    slaves.readmitting = false;
+    return;
+  }
+
+  slaves.readmitting = true;
+
+  vector<SlaveInfo> updated;
+  vector<SlaveInfo> reachable;
+  vector<Owned<Promise<bool>>> promises;
+
+  foreach (const Slaves::Readmission& readmission, slaves.readmissions) {
+    if (readmission.admitted) {
+      updated.push_back(readmission.info);
+    } else {
+      reachable.push_back(readmission.info);
+    }
+
+    promises.push_back(readmission.promise);
+  }
+
+  slaves.readmissions.clear();
+
+  VLOG(1) << "Updating the registry for " << promises.size()
+          << " reregistering agents";
+
+  registrar->apply(Owned<RegistryOperation>(
+      new ReadmitSlaves(updated, reachable)))
+    .onAny(defer(self(), &Self::_readmitSlaves, promises, lambda::_1));
+}
+
+
+void Master::_readmitSlaves(
+    const vector<Owned<Promise<bool>>>& promises,
+    const Future<bool>& result)
+{
+  foreach (const Owned<Promise<bool>>& promise, promises) {
+    promise->associate(result);
+  }
+
+  // Apply the updates which were requested in the meantime, if any.
+  readmitSlaves();
+}
+
+
 void Master::__reregisterSlave(
     const UPID& pid,
     ReregisterSlaveMessage&& reregisterSlaveMessage,
@@ -7751,8 +8126,7 @@ void Master::__reregisterSlave(
 
   CHECK(!future.isDiscarded());
 
-  // Neither the `UpdateSlave` nor `MarkSlaveReachable` registry operations
-  // should ever fail.
+  // The `ReadmitSlaves` registry operation should never fail.
   CHECK(future.get());
 
   if (slaves.markingGone.contains(slaveInfo.id())) {
@@ -8091,6 +8465,7 @@ void Master::___reregisterSlave(
   // ignore duplicate exited events for disconnected slaves.
   // See: https://issues.apache.org/jira/browse/MESOS-675
   slave->pid = pid;
+  slave->cachedOfferTemplate = None();
   link(slave->pid);
 
   const string& version = reregisterSlaveMessage.version();
@@ -8143,6 +8518,8 @@ void Master::___reregisterSlave(
     slave->totalResources,
     agentCapabilities);
 
+  networkBandwidthPolicy.addSlave(slave->info, slave->totalResources);
+
   const vector<ExecutorInfo> executorInfos =
     google::protobuf::convert(reregisterSlaveMessage.executor_infos());
   const vector<Task> tasks =
@@ -8347,10 +8724,16 @@ void Master::updateFramework(
 
 void Master::updateSlave(UpdateSlaveMessage&& message)
 {
-  ++metrics->messages_update_slave;
-
   upgradeResources(&message);
 
+  _updateSlave(std::move(message));
+}
+
+
+void Master::_updateSlave(UpdateSlaveMessage&& message)
+{
+  ++metrics->messages_update_slave;
+
   const SlaveID& slaveId = message.slave_id();
 
   if (slaves.removed.get(slaveId).isSome()) {
@@ -8824,12 +9207,15 @@ void Master::updateSlave(UpdateSlaveMessage&& message)
     }
   }
 
+  slave->updateRoleTree();
+
   if (reconcile.operations_size() > 0) {
     send(slave->pid, reconcile);
   }
 
   // Now update the agent's state and total resources in the allocator.
   allocator->updateSlave(slaveId, slave->info, slave->totalResources);
+  networkBandwidthPolicy.addSlave(slave->info, slave->totalResources);
 
   // Then rescind outstanding offers affected by the update.
   // NOTE: Need a copy of offers because the offers are removed inside the loop.
@@ -9430,7 +9816,8 @@ Future<bool> Master::markUnreachable(
 
   // The slave might be in the process of reregistering without
   // the marking unreachable having been canceled.
-  if (slaves.reregistering.contains(slave.id())) {
+  if (slaves.reregistering.contains(slave.id()) ||
+      slaves.admitting.contains(slave.id())) {
     LOG(INFO) << "Skipping transition of agent"
               << " " << slave.id() << " (" << slave.hostname() << ")"
               << " to unreachable because it is reregistering";
@@ -10287,6 +10674,13 @@ void Master::offer(
   vector<OfferID> offerIds;
   offerIds.reserve(offersEstimate);
 
+  // All offers made here expire at the same time, so they share
+  // a single timer which is started once all of them were created.
+  std::shared_ptr<OfferBatch> batch;
+  if (flags.offer_timeout.isSome()) {
+    batch.reset(new OfferBatch());
+  }
+
   foreachkey (const string& role, resources) {
     foreachpair (const SlaveID& slaveId,
                  const Resources& offered,
@@ -10343,28 +10737,12 @@ void Master::offer(
       // separate offers, so that rescinding offers with revocable
       // resources does not affect offers with regular resources.
 
-      // TODO(bmahler): Set "https" if only "https" is supported.
-      mesos::URL url;
-      url.set_scheme("http");
-      url.mutable_address()->set_hostname(slave->info.hostname());
-      url.mutable_address()->set_ip(stringify(slave->pid.address.ip));
-      url.mutable_address()->set_port(slave->pid.address.port);
-      url.set_path("/" + slave->pid.id);
-
-      Offer* offer = new Offer();
+      Offer* offer = new Offer(slave->offerTemplate());
       offer->mutable_id()->MergeFrom(newOfferId());
       offer->mutable_framework_id()->MergeFrom(framework->id());
-      offer->mutable_slave_id()->MergeFrom(slave->id);
-      offer->set_hostname(slave->info.hostname());
-      offer->mutable_url()->MergeFrom(url);
       offer->mutable_resources()->MergeFrom(offered);
-      offer->mutable_attributes()->MergeFrom(slave->info.attributes());
       offer->mutable_allocation_info()->set_role(role);
 
-      if (slave->info.has_domain()) {
-        offer->mutable_domain()->MergeFrom(slave->info.domain());
-      }
-
       // Add all framework's executors running on this slave.
       if (slave->executors.contains(framework->id())) {
         const hashmap<ExecutorID, ExecutorInfo>& executors =
@@ -10387,13 +10765,9 @@ void Master::offer(
       framework->addOffer(offer);
       slave->addOffer(offer);
 
-      if (flags.offer_timeout.isSome()) {
-        // Rescind the offer after the timeout elapses.
-        offerTimers[offer->id()] =
-          delay(flags.offer_timeout.get(),
-                self(),
-                &Self::offerTimeout,
-                offer->id());
+      if (batch.get() != nullptr) {
+        batch->offerIds.insert(offer->id());
+        offerBatches[offer->id()] = batch;
       }
 
       // TODO(jieyu): For now, we strip 'ephemeral_ports' resource from
@@ -10450,9 +10824,43 @@ void Master::offer(
     return;
   }
 
+  if (batch.get() != nullptr) {
+    // Rescind the offers after the timeout elapses.
+    batch->timer =
+      delay(flags.offer_timeout.get(), self(), &Self::offerTimeout, batch);
+  }
+
   LOG(INFO) << "Sending offers " << offerIds << " to framework " << *framework;
 
   framework->metrics.offers_sent += message.offers().size();
+
+  // Large batches of offers are sent to HTTP frameworks in several
+  // events to bound the size of each event which has to be serialized
+  // and written to the framework's stream at once.
+  if (framework->http.isSome() &&
+      static_cast<size_t>(message.offers().size()) >
+        MAX_OFFERS_PER_HTTP_EVENT) {
+    for (int i = 0; i < message.offers().size();
+         i += MAX_OFFERS_PER_HTTP_EVENT) {
+      const int end = std::min(
+          message.offers().size(),
+          i + static_cast<int>(MAX_OFFERS_PER_HTTP_EVENT));
+
+      ResourceOffersMessage chunk;
+      chunk.mutable_offers()->Reserve(end - i);
+      chunk.mutable_pids()->Reserve(end - i);
+
+      for (int j = i; j < end; ++j) {
+        *chunk.add_offers() = std::move(*message.mutable_offers(j));
+        chunk.add_pids(std::move(*message.mutable_pids(j)));
+      }
+
+      framework->send(chunk);
+    }
+
+    return;
+  }
+
   framework->send(message);
 }
 
@@ -10995,6 +11403,8 @@ void Master::recoverFramework(
 
           slave->totalResources += consumedUnallocated;
           slave->usedResources[framework->id()] += consumed.get();
+          slave->updateRoleTree();
+          roleTree.addAllocatedReservations(consumed.get());
 
           hashmap<FrameworkID, Resources> usedResources;
           usedResources.put(framework->id(), consumed.get());
@@ -11431,6 +11841,7 @@ void Master::removeFramework(Framework* framework)
   // still in use by the (now removed) framework.
   foreach (Slave* slave, slavesWithOrphanOperations) {
     allocator->updateSlave(slave->id, slave->info, slave->totalResources);
+    networkBandwidthPolicy.addSlave(slave->info, slave->totalResources);
 
     // NOTE: Even though we are modifying the slave's total resources, we
     // do not need to rescind any offers because the resources removed cannot
@@ -11613,6 +12024,8 @@ void Master::addSlave(
       slave->totalResources,
       slave->usedResources);
 
+  networkBandwidthPolicy.addSlave(slave->info, slave->totalResources);
+
   if (!subscribers.subscribed.empty()) {
     subscribers.send(protobuf::master::event::createAgentAdded(
         *slave,
@@ -11714,6 +12127,7 @@ void Master::_removeSlave(
   // recoverResources() below are therefore required, even though
   // the slave is already removed.
   allocator->removeSlave(slave->id);
+  networkBandwidthPolicy.removeSlave(slave->id);
 
   // Transition the tasks to lost and remove them.
   foreachkey (const FrameworkID& frameworkId, utils::copy(slave->tasks)) {
@@ -11854,6 +12268,7 @@ void Master::__removeSlave(
   // recoverResources() below are therefore required, even though
   // the slave is already removed.
   allocator->removeSlave(slave->id);
+  networkBandwidthPolicy.removeSlave(slave->id);
 
   // Transition tasks to TASK_UNREACHABLE/TASK_GONE_BY_OPERATOR/TASK_LOST
   // and remove them. We only use TASK_UNREACHABLE/TASK_GONE_BY_OPERATOR if
@@ -12049,7 +12464,11 @@ void Master::updateTask(Task* task, const StatusUpdate& update)
       framework->metrics.incrementTaskState(updateState);
     }
 
+    const TaskState previousState = task->state();
+
     task->set_state(updateState);
+
+    taskStates.update(task, previousState);
   }
 
   // If this is a (health) check status update, always forward it to
@@ -12414,7 +12833,9 @@ void Master::updateOperation(
     // If we've added resources to the agent's total, the allocator
     // must be informed about the new totals.
     if (updated) {
+      slave->updateRoleTree();
       allocator->updateSlave(slave->id, slave->info, slave->totalResources);
+      networkBandwidthPolicy.addSlave(slave->info, slave->totalResources);
     }
 
   } else {
@@ -12695,13 +13116,22 @@ void Master::_apply(
 }
 
 
-void Master::offerTimeout(const OfferID& offerId)
+void Master::offerTimeout(const std::shared_ptr<OfferBatch>& batch)
 {
-  Offer* offer = getOffer(offerId);
-  if (offer != nullptr) {
-    allocator->recoverResources(
-        offer->framework_id(), offer->slave_id(), offer->resources(), None());
-    removeOffer(offer, true);
+  // Copy the offer IDs since removing the offers updates the batch.
+  const hashset<OfferID> offerIds = batch->offerIds;
+
+  foreach (const OfferID& offerId, offerIds) {
+    Offer* offer = getOffer(offerId);
+    if (offer != nullptr) {
+      allocator->recoverResources(
+          offer->framework_id(),
+          offer->slave_id(),
+          offer->resources(),
+          None());
+
+      removeOffer(offer, true);
+    }
   }
 }
 
@@ -12734,11 +13164,17 @@ void Master::removeOffer(Offer* offer, bool rescind)
     framework->send(message);
   }
 
-  // Remove and cancel offer removal timers. Canceling the Timers is
-  // only done to avoid having too many active Timers in libprocess.
-  if (offerTimers.contains(offer->id())) {
-    Clock::cancel(offerTimers[offer->id()]);
-    offerTimers.erase(offer->id());
+  // Remove the offer from its batch and cancel the batch's timer once
+  // all of its offers are gone. Canceling the Timers is only done to
+  // avoid having too many active Timers in libprocess.
+  if (offerBatches.contains(offer->id())) {
+    std::shared_ptr<OfferBatch> batch = offerBatches.at(offer->id());
+    offerBatches.erase(offer->id());
+
+    batch->offerIds.erase(offer->id());
+    if (batch->offerIds.empty()) {
+      Clock::cancel(batch->timer);
+    }
   }
 
   // Delete it.
@@ -13005,16 +13441,7 @@ double Master::_tasks_staging()
     count += framework->pendingTasks.size();
   }
 
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_STAGING) {
-          count++;
-        }
-      }
-    }
-  }
+  count += taskStates.count(TASK_STAGING);
 
   return count;
 }
@@ -13022,39 +13449,13 @@ double Master::_tasks_staging()
 
 double Master::_tasks_starting()
 {
-  double count = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_STARTING) {
-          count++;
-        }
-      }
-    }
-  }
-
-  return count;
+  return static_cast<double>(taskStates.count(TASK_STARTING));
 }
 
 
 double Master::_tasks_running()
 {
-  double count = 0.0;
-
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_RUNNING) {
-          count++;
-        }
-      }
-    }
-  }
-
-  return count;
+  return static_cast<double>(taskStates.count(TASK_RUNNING));
 }
 
 
@@ -13076,20 +13477,65 @@ double Master::_tasks_unreachable()
 
 double Master::_tasks_killing()
 {
-  double count = 0.0;
+  return static_cast<double>(taskStates.count(TASK_KILLING));
+}
 
-  foreachvalue (Slave* slave, slaves.registered) {
-    typedef hashmap<TaskID, Task*> TaskMap;
-    foreachvalue (const TaskMap& tasks, slave->tasks) {
-      foreachvalue (const Task* task, tasks) {
-        if (task->state() == TASK_KILLING) {
-          count++;
-        }
-      }
-    }
+
+void Master::TaskStates::add(Task* task)
+{
+  CHECK_NOTNULL(task);
+
+  tasks[task->state()].insert(task);
+}
+
+
+void Master::TaskStates::update(Task* task, const TaskState& previous)
+{
+  CHECK_NOTNULL(task);
+
+  // NOTE: Only tasks stored on registered agents are indexed. Others,
+  // e.g., the unreachable tasks of a framework, are not tracked here.
+  if (task->state() == previous ||
+      !tasks.contains(previous) ||
+      !tasks.at(previous).contains(task)) {
+    return;
   }
 
-  return count;
+  tasks[previous].erase(task);
+  if (tasks[previous].empty()) {
+    tasks.erase(previous);
+  }
+
+  tasks[task->state()].insert(task);
+}
+
+
+void Master::TaskStates::remove(Task* task)
+{
+  CHECK_NOTNULL(task);
+
+  CHECK(tasks.contains(task->state()) &&
+        tasks.at(task->state()).contains(task))
+    << "Unknown task " << task->task_id() << " in state " << task->state();
+
+  tasks[task->state()].erase(task);
+  if (tasks[task->state()].empty()) {
+    tasks.erase(task->state());
+  }
+}
+
+
+size_t Master::TaskStates::count(const TaskState& state) const
+{
+  return tasks.contains(state) ? tasks.at(state).size() : 0u;
+}
+
+
+const hashset<Task*>& Master::TaskStates::get(const TaskState& state) const
+{
+  static const hashset<Task*>* empty = new hashset<Task*>();
+
+  return tasks.contains(state) ? tasks.at(state) : *empty;
 }
 
 
@@ -13456,6 +13902,7 @@ Slave::Slave(
   // NOTE: This should be validated during slave recovery.
   CHECK_SOME(resources);
   totalResources = resources.get();
+  updateRoleTree();
 
   foreach (ExecutorInfo& executorInfo, executorInfos) {
     CHECK(executorInfo.has_framework_id());
@@ -13473,6 +13920,13 @@ Slave::~Slave()
   if (reregistrationTimer.isSome()) {
     process::Clock::cancel(reregistrationTimer.get());
   }
+
+  master->roleTree.removeReserved(roleTreeReservations);
+  master->roleTree.removeCapacity(roleTreeCapacity);
+
+  foreachvalue (const Resources& resources, usedResources) {
+    master->roleTree.removeAllocatedReservations(resources);
+  }
 }
 
 
@@ -13511,8 +13965,11 @@ void Slave::addTask(Task* task)
     << "Task '" << taskId << "' of framework " << frameworkId
     << " added in TASK_UNREACHABLE state";
 
+  master->taskStates.add(task);
+
   if (!protobuf::isTerminalState(task->state())) {
     usedResources[frameworkId] += resources;
+    master->roleTree.addAllocatedReservations(resources);
   }
 }
 
@@ -13534,6 +13991,8 @@ void Slave::recoverResources(Task* task)
   if (usedResources[frameworkId].empty()) {
     usedResources.erase(frameworkId);
   }
+
+  master->roleTree.removeAllocatedReservations(task->resources());
 }
 
 
@@ -13560,6 +14019,8 @@ void Slave::removeTask(Task* task)
     if (usedResources[frameworkId].empty()) {
       usedResources.erase(frameworkId);
     }
+
+    master->roleTree.removeAllocatedReservations(task->resources());
   }
 
   tasks[frameworkId].erase(taskId);
@@ -13568,6 +14029,8 @@ void Slave::removeTask(Task* task)
   }
 
   killedTasks.remove(frameworkId, taskId);
+
+  master->taskStates.remove(task);
 }
 
 
@@ -13600,6 +14063,7 @@ void Slave::addOperation(Operation* operation)
     CHECK(operation->has_framework_id());
 
     usedResources[operation->framework_id()] += consumed.get();
+    master->roleTree.addAllocatedReservations(consumed.get());
   }
 }
 
@@ -13630,6 +14094,8 @@ void Slave::recoverResources(Operation* operation)
   if (usedResources[frameworkId].empty()) {
     usedResources.erase(frameworkId);
   }
+
+  master->roleTree.removeAllocatedReservations(consumed.get());
 }
 
 
@@ -13668,6 +14134,7 @@ void Slave::removeOperation(Operation* operation)
       // `allocator->updateSlave()` in `Master::updateSlave()`.
       // This means we do not need to update the allocator in this method.
       totalResources += consumedUnallocated;
+      updateRoleTree();
     }
   } else {
     // Recover the resource used by this operation.
@@ -13743,6 +14210,7 @@ void Slave::markOperationAsOrphan(Operation* operation)
     << "Unknown resources from orphan operation: " << consumedUnallocated;
 
   totalResources -= consumedUnallocated;
+  updateRoleTree();
 }
 
 
@@ -13762,6 +14230,34 @@ Operation* Slave::getOperation(const UUID& uuid) const
 }
 
 
+const Offer& Slave::offerTemplate()
+{
+  if (cachedOfferTemplate.isNone()) {
+    // TODO(bmahler): Set "https" if only "https" is supported.
+    mesos::URL url;
+    url.set_scheme("http");
+    url.mutable_address()->set_hostname(info.hostname());
+    url.mutable_address()->set_ip(stringify(pid.address.ip));
+    url.mutable_address()->set_port(pid.address.port);
+    url.set_path("/" + pid.id);
+
+    Offer offer;
+    offer.mutable_slave_id()->CopyFrom(id);
+    offer.set_hostname(info.hostname());
+    offer.mutable_url()->CopyFrom(url);
+    offer.mutable_attributes()->CopyFrom(info.attributes());
+
+    if (info.has_domain()) {
+      offer.mutable_domain()->CopyFrom(info.domain());
+    }
+
+    cachedOfferTemplate = std::move(offer);
+  }
+
+  return cachedOfferTemplate.get();
+}
+
+
 void Slave::addOffer(Offer* offer)
 {
   CHECK(!offers.contains(offer)) << "Duplicate offer " << offer->id();
@@ -13821,6 +14317,7 @@ void Slave::addExecutor(const FrameworkID& frameworkId,
 
   executors[frameworkId][executorInfo.executor_id()] = executorInfo;
   usedResources[frameworkId] += executorInfo.resources();
+  master->roleTree.addAllocatedReservations(executorInfo.resources());
 }
 
 
@@ -13830,12 +14327,15 @@ void Slave::removeExecutor(const FrameworkID& frameworkId,
   CHECK(hasExecutor(frameworkId, executorId))
     << "Unknown executor '" << executorId << "' of framework " << frameworkId;
 
-  usedResources[frameworkId] -=
-    executors[frameworkId][executorId].resources();
+  const Resources resources = executors[frameworkId][executorId].resources();
+
+  usedResources[frameworkId] -= resources;
   if (usedResources[frameworkId].empty()) {
     usedResources.erase(frameworkId);
   }
 
+  master->roleTree.removeAllocatedReservations(resources);
+
   executors[frameworkId].erase(executorId);
   if (executors[frameworkId].empty()) {
     executors.erase(frameworkId);
@@ -13843,12 +14343,30 @@ void Slave::removeExecutor(const FrameworkID& frameworkId,
 }
 
 
+void Slave::updateRoleTree()
+{
+  const Resources reservations = totalResources.reserved();
+  const ResourceQuantities capacity = ResourceQuantities::fromScalarResources(
+      totalResources.nonRevocable().scalars());
+
+  master->roleTree.removeReserved(roleTreeReservations);
+  master->roleTree.addReserved(reservations);
+
+  master->roleTree.removeCapacity(roleTreeCapacity);
+  master->roleTree.addCapacity(capacity);
+
+  roleTreeReservations = reservations;
+  roleTreeCapacity = capacity;
+}
+
+
 void Slave::apply(const vector<ResourceConversion>& conversions)
 {
   Try<Resources> resources = totalResources.apply(conversions);
   CHECK_SOME(resources);
 
   totalResources = resources.get();
+  updateRoleTree();
 
   checkpointedResources = totalResources.filter(needCheckpointing);
 
@@ -13893,12 +14411,14 @@ Try<Nothing> Slave::update(
   capabilities = _capabilities;
   info = _info;
   checkpointedResources = _checkpointedResources;
+  cachedOfferTemplate = None();
 
   // There is a short window here where `totalResources` can have an old value,
   // but it should be relatively short because the agent will send
   // an `UpdateSlaveMessage` with the new total resources immediately after
   // reregistering in this case.
   totalResources = resources.get();
+  updateRoleTree();
 
   resourceVersion = _resourceVersion;
 
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 
+#include <deque>
 #include <list>
 #include <memory>
 #include <set>
@@ -83,6 +84,8 @@
 #include "master/flags.hpp"
 #include "master/machine.hpp"
 #include "master/metrics.hpp"
+#include "master/resources/network_bandwidth.hpp"
+#include "master/role_tree.hpp"
 #include "master/validation.hpp"
 
 #include "messages/messages.hpp"
@@ -166,6 +169,12 @@ Slave(Master* const _master,
 
   Operation* getOperation(const UUID& uuid) const;
 
+  // Returns the part of an offer which only depends on this agent
+  // (its ID, hostname, URL, attributes and domain). It is built once
+  // and copied into each offer rather than rebuilt from `info` and
+  // `pid` for every offer.
+  const Offer& offerTemplate();
+
   void addOffer(Offer* offer);
 
   void removeOffer(Offer* offer);
@@ -186,6 +195,11 @@ Slave(Master* const _master,
       const FrameworkID& frameworkId,
       const ExecutorID& executorId);
 
+  // Updates the reservations and capacity of this agent in the
+  // master's role tree. Must be called whenever `totalResources`
+  // changes.
+  void updateRoleTree();
+
   void apply(const std::vector<ResourceConversion>& conversions);
 
   Try<Nothing> update(
@@ -316,6 +330,15 @@ Slave(Master* const _master,
 
   SlaveObserver* observer;
 
+  // Cached result of `offerTemplate()`. Must be reset whenever `info`
+  // or `pid` change.
+  Option<Offer> cachedOfferTemplate;
+
+  // The reservations and capacity of this agent as last accounted for
+  // in the master's role tree, see `updateRoleTree()`.
+  Resources roleTreeReservations;
+  ResourceQuantities roleTreeCapacity;
+
   // Time when this agent was last asked to drain. This field
   // is empty if the agent is not currently draining or drained.
   Option<process::Time> estimatedDrainStartTime;
@@ -437,6 +460,19 @@ public:
       const process::UPID& from,
       ReregisterSlaveMessage&& incomingMessage);
 
+  // Continuation of `reregisterSlave()` once the message has been
+  // validated and upgraded off the master actor. Valid re-registrations
+  // wait here for a permit if `--agent_reregistration_rate_limit` is set.
+  process::Future<Option<Error>> queueSlaveReregistration(
+      const Option<Error>& error);
+
+  // Continuation of `reregisterSlave()` once the re-registration has
+  // been validated and admitted.
+  void admitSlaveReregistration(
+      const process::UPID& from,
+      const std::shared_ptr<ReregisterSlaveMessage>& message,
+      const process::Future<Option<Error>>& validation);
+
   void unregisterSlave(
       const process::UPID& from,
       const SlaveID& slaveId);
@@ -460,6 +496,10 @@ public:
 
   void updateSlave(UpdateSlaveMessage&& message);
 
+  // Continuation of `updateSlave()` once the message has been
+  // upgraded to the post-reservation-refinement format.
+  void _updateSlave(UpdateSlaveMessage&& message);
+
   void updateUnavailability(
       const MachineID& machineId,
       const Option<Unavailability>& unavailability);
@@ -550,6 +590,50 @@ protected:
   // Continuations of consume().
   void _consume(process::MessageEvent&& event);
   void _consume(process::ExitedEvent&& event);
+  void __consume(process::MessageEvent&& event);
+
+  // Decodes and validates an event on a worker thread via `decode`,
+  // and then invokes the continuation returned by `decode` on the
+  // master actor. Continuations are invoked in the order in which
+  // events were ingested; events which are consumed while earlier
+  // ones are still being decoded are queued behind them (see
+  // `--parallel_message_ingestion`).
+  //
+  // NOTE: The order is the one in which the master actor consumes the
+  // events, which holds across messages, exited events and HTTP
+  // requests (see `ordered()`). Messages are consumed once they have
+  // passed the framework rate limiters, and HTTP requests once they
+  // have been authenticated, so a message and an HTTP request which
+  // are sent concurrently, i.e., over different connections, are not
+  // ordered with respect to each other.
+  void ingest(const lambda::function<lambda::function<void()>()>& decode);
+
+  struct IngestedEvent
+  {
+    // Set once the event has been decoded.
+    Option<lambda::function<void()>> apply;
+
+    // Completed once the event has been applied, used to time how
+    // long it waited to be applied.
+    process::Promise<Nothing> applied;
+  };
+
+  void _ingest(
+      const std::shared_ptr<IngestedEvent>& event,
+      const process::Future<lambda::function<void()>>& apply);
+
+  // Queues a continuation which does not need to be decoded behind
+  // the events that are still being decoded.
+  void enqueue(const lambda::function<void()>& apply);
+
+  // Returns an HTTP handler which invokes `handler` once the events
+  // which the master consumed before the request have been applied.
+  AuthenticatedHttpRequestHandler ordered(
+      const AuthenticatedHttpRequestHandler& handler);
+
+  // Invokes the continuations at the head of the ingestion queue
+  // which are ready.
+  void applyIngested();
 
   // Helper method invoked when the capacity for a framework
   // principal is exceeded.
@@ -589,6 +673,19 @@ protected:
       ReregisterSlaveMessage&& incomingMessage,
       const process::Future<bool>& updated);
 
+  // Updates the registry for a reregistering agent: the `SlaveInfo` of
+  // an `admitted` agent is updated, other agents are marked reachable.
+  // Updates requested while a batch is being applied by the registrar
+  // are applied together in the next batch (see `ReadmitSlaves`).
+  process::Future<bool> readmitSlave(const SlaveInfo& slaveInfo, bool admitted);
+
+  // Applies the pending `readmitSlave()` requests as one batch.
+  void readmitSlaves();
+
+  void _readmitSlaves(
+      const std::vector<process::Owned<process::Promise<bool>>>& promises,
+      const process::Future<bool>& result);
+
   void updateSlaveFrameworks(
       Slave* slave,
       const std::vector<FrameworkInfo>& frameworks);
@@ -984,8 +1081,19 @@ protected:
       const process::UPID& acknowledgee,
       Framework* framework);
 
-  // Remove an offer after specified timeout
-  void offerTimeout(const OfferID& offerId);
+  // Offers made in a single call to `offer()` expire at the same
+  // time, so they share a single timer (see `--offer_timeout`).
+  struct OfferBatch
+  {
+    process::Timer timer;
+
+    // The offers of this batch which have not been removed yet. The
+    // timer is canceled once this becomes empty.
+    hashset<OfferID> offerIds;
+  };
+
+  // Remove the offers of a batch after the specified timeout.
+  void offerTimeout(const std::shared_ptr<OfferBatch>& batch);
 
   // Remove an offer and optionally rescind the offer as well.
   void removeOffer(Offer* offer, bool rescind = false);
@@ -1047,6 +1155,11 @@ private:
       const process::UPID& from,
       mesos::scheduler::Call&& call);
 
+  // Continuation of `receive()` once the call has been validated.
+  void _receive(
+      const process::UPID& from,
+      mesos::scheduler::Call&& call);
+
   void subscribe(
       StreamingHttpConnection<v1::scheduler::Event> http,
       mesos::scheduler::Call::Subscribe&& subscribe);
@@ -1193,10 +1306,11 @@ private:
    */
   bool isWhitelistedRole(const std::string& name) const;
 
-  // TODO(bmahler): Store a role tree rather than the existing
-  // `roles` map which does not track the tree correctly (it does
-  // not insert ancestor entries, nor does it track roles if there
-  // are reservations but no frameworks related to them).
+  // Per-role resource breakdown, aggregated over the role's subtree.
+  // This is a view into the master's `roleTree`.
+  //
+  // TODO(bmahler): Use the role tree rather than the existing `roles`
+  // map for tracking the frameworks of each role as well.
   struct RoleResourceBreakdown
   {
   public:
@@ -1289,7 +1403,7 @@ private:
     // registered agents, including resources from resource providers
     // as well as reservations (both static and dynamic ones).
     static Option<Error> overcommitCheck(
-        const std::vector<Resources>& agents,
+        const ResourceQuantities& capacity,
         const hashmap<std::string, Quota>& quotas,
         const mesos::quota::QuotaInfo& request);
 
@@ -1655,6 +1769,30 @@ private:
     static std::string WEIGHTS_HELP();
 
   private:
+    // Deserializes and validates the API call of `request` using
+    // `decode`, and then applies it by invoking the continuation
+    // returned by `decode`. Decoding happens on a worker thread if
+    // `--parallel_message_ingestion` is set, see `Master::ingest()`, in
+    // which case `decode` is passed a copy of `request` which lives
+    // until the continuation has been invoked.
+    process::Future<process::http::Response> ingest(
+        const process::http::Request& request,
+        const lambda::function<
+            lambda::function<process::Future<process::http::Response>()>(
+                const process::http::Request&)>& decode) const;
+
+    // Continuations of `api()` and `scheduler()` once the call has been
+    // deserialized and validated.
+    process::Future<process::http::Response> _api(
+        const process::http::Request& request,
+        const Option<process::http::authentication::Principal>& principal,
+        mesos::master::Call&& call) const;
+
+    process::Future<process::http::Response> _scheduler(
+        const process::http::Request& request,
+        const Option<process::http::authentication::Principal>& principal,
+        mesos::scheduler::Call&& call) const;
+
     JSON::Object __flags() const;
 
     class FlagsError; // Forward declaration.
@@ -2082,6 +2220,11 @@ private:
     hashset<process::UPID> registering;
     hashset<SlaveID> reregistering;
 
+    // Agents whose re-registration is being validated or waiting for
+    // admission (see `--agent_reregistration_rate_limit`). They are
+    // moved to `reregistering` once admitted.
+    hashset<SlaveID> admitting;
+
     // Registered slaves are indexed by SlaveID and UPID. Note that
     // iteration is supported but is exposed as iteration over a
     // hashmap<SlaveID, Slave*> since it is tedious to convert
@@ -2213,6 +2356,24 @@ private:
     // NOTE: Using a 'shared_ptr' here is OK because 'RateLimiter' is
     // a wrapper around libprocess process which is thread safe.
     Option<std::shared_ptr<process::RateLimiter>> limiter;
+
+    // This rate limiter is used to limit the admission of agent
+    // re-registrations, see `--agent_reregistration_rate_limit`.
+    Option<process::Owned<process::RateLimiter>> reregistrationLimiter;
+
+    // Registry updates of reregistering agents which are waiting for
+    // the batch being applied by the registrar, see `readmitSlave()`.
+    struct Readmission
+    {
+      SlaveInfo info;
+      bool admitted;
+      process::Owned<process::Promise<bool>> promise;
+    };
+
+    std::vector<Readmission> readmissions;
+
+    // Whether a batch of `readmissions` is being applied.
+    bool readmitting = false;
   } slaves;
 
   struct Frameworks
@@ -2245,6 +2406,36 @@ private:
     Option<process::Owned<BoundedRateLimiter>> defaultLimiter;
   } frameworks;
 
+  // Secondary index over the tasks stored on registered agents, keyed
+  // by their latest state. It is maintained by `Slave::addTask()`,
+  // `Slave::removeTask()` and `Master::updateTask()` so that looking up
+  // the tasks in a given state (e.g., for the task state metrics or the
+  // `state` filter of the '/tasks' endpoint) costs time proportional to
+  // the number of matching tasks rather than to the size of the cluster.
+  //
+  // NOTE: The other lookups which would otherwise require a scan are
+  // already indexed elsewhere: frameworks by role in `Role::frameworks`
+  // and the frameworks with tasks on an agent in `Slave::tasks`.
+  struct TaskStates
+  {
+    void add(Task* task);
+    void update(Task* task, const TaskState& previous);
+    void remove(Task* task);
+
+    size_t count(const TaskState& state) const;
+
+    // Returns the tasks in the given state, or an empty set if none.
+    const hashset<Task*>& get(const TaskState& state) const;
+
+  private:
+    hashmap<TaskState, hashset<Task*>> tasks;
+  } taskStates;
+
+  // Events which are being decoded on worker threads, or which were
+  // consumed while earlier events were still being decoded, in the
+  // order in which they will be applied. See `ingest()`.
+  std::deque<std::shared_ptr<IngestedEvent>> ingested;
+
   struct Subscribers
   {
     Subscribers(Master* _master, size_t maxSubscribers)
@@ -2325,7 +2516,7 @@ private:
   Subscribers subscribers;
 
   hashmap<OfferID, Offer*> offers;
-  hashmap<OfferID, process::Timer> offerTimers;
+  hashmap<OfferID, std::shared_ptr<OfferBatch>> offerBatches;
 
   hashmap<OfferID, InverseOffer*> inverseOffers;
   hashmap<OfferID, process::Timer> inverseOfferTimers;
@@ -2336,6 +2527,16 @@ private:
   // (e.g. some tasks and/or executors are consuming resources under the role).
   hashmap<std::string, Role*> roles;
 
+  // Offered, allocated and reserved resources aggregated by role
+  // subtree, and the cluster capacity considered by quota validation.
+  // Kept up to date by `Framework` and `Slave`.
+  RoleTree roleTree;
+
+  // Computes the network bandwidth of tasks launched without any when
+  // `--network_bandwidth_enforcement` is set. Agents are added to it
+  // whenever they register or their total resources change.
+  mesos::resources::NetworkBandwidthPolicy networkBandwidthPolicy;
+
   // Configured role whitelist if using the (deprecated) "explicit
   // roles" feature. If this is `None`, any role is allowed.
   Option<hashset<std::string>> roleWhitelist;
@@ -2407,6 +2608,11 @@ private:
     return static_cast<double>(offers.size());
   }
 
+  double _slave_reregistrations_in_progress()
+  {
+    return static_cast<double>(slaves.reregistering.size());
+  }
+
   double _event_queue_messages()
   {
     return static_cast<double>(eventCount<process::MessageEvent>());
@@ -202,6 +202,16 @@ Metrics::Metrics(const Master& master)
     event_queue_http_requests(
         "master/event_queue_http_requests",
         defer(master, &Master::_event_queue_http_requests)),
+    ingestion_decode_queued(
+        "master/ingestion/decode_queued"),
+    ingestion_apply_queued(
+        "master/ingestion/apply_queued"),
+    ingestion_decode_latency(
+        "master/ingestion/decode_latency",
+        Hours(1)),
+    ingestion_apply_latency(
+        "master/ingestion/apply_latency",
+        Hours(1)),
     slave_registrations(
         "master/slave_registrations"),
     slave_reregistrations(
@@ -214,6 +224,14 @@ Metrics::Metrics(const Master& master)
         "master/slave_removals/reason_unregistered"),
     slave_removals_reason_registered(
         "master/slave_removals/reason_registered"),
+    slave_reregistrations_in_progress(
+        "master/slave_reregistrations_in_progress",
+        defer(master, &Master::_slave_reregistrations_in_progress)),
+    slave_reregistrations_queued(
+        "master/slave_reregistrations_queued"),
+    slave_reregistration_admission_delay(
+        "master/slave_reregistration_admission_delay",
+        Hours(1)),
     slave_shutdowns_scheduled(
         "master/slave_shutdowns_scheduled"),
     slave_shutdowns_completed(
@@ -317,6 +335,11 @@ Metrics::Metrics(const Master& master)
   process::metrics::add(event_queue_dispatches);
   process::metrics::add(event_queue_http_requests);
 
+  process::metrics::add(ingestion_decode_queued);
+  process::metrics::add(ingestion_apply_queued);
+  process::metrics::add(ingestion_decode_latency);
+  process::metrics::add(ingestion_apply_latency);
+
   process::metrics::add(slave_registrations);
   process::metrics::add(slave_reregistrations);
   process::metrics::add(slave_removals);
@@ -324,6 +347,10 @@ Metrics::Metrics(const Master& master)
   process::metrics::add(slave_removals_reason_unregistered);
   process::metrics::add(slave_removals_reason_registered);
 
+  process::metrics::add(slave_reregistrations_in_progress);
+  process::metrics::add(slave_reregistrations_queued);
+  process::metrics::add(slave_reregistration_admission_delay);
+
   process::metrics::add(slave_shutdowns_scheduled);
   process::metrics::add(slave_shutdowns_completed);
   process::metrics::add(slave_shutdowns_canceled);
@@ -501,6 +528,11 @@ Metrics::~Metrics()
   process::metrics::remove(event_queue_dispatches);
   process::metrics::remove(event_queue_http_requests);
 
+  process::metrics::remove(ingestion_decode_queued);
+  process::metrics::remove(ingestion_apply_queued);
+  process::metrics::remove(ingestion_decode_latency);
+  process::metrics::remove(ingestion_apply_latency);
+
   process::metrics::remove(slave_registrations);
   process::metrics::remove(slave_reregistrations);
   process::metrics::remove(slave_removals);
@@ -508,6 +540,10 @@ Metrics::~Metrics()
   process::metrics::remove(slave_removals_reason_unregistered);
   process::metrics::remove(slave_removals_reason_registered);
 
+  process::metrics::remove(slave_reregistrations_in_progress);
+  process::metrics::remove(slave_reregistrations_queued);
+  process::metrics::remove(slave_reregistration_admission_delay);
+
   process::metrics::remove(slave_shutdowns_scheduled);
   process::metrics::remove(slave_shutdowns_completed);
   process::metrics::remove(slave_shutdowns_canceled);
@@ -26,6 +26,9 @@
 #include <process/metrics/pull_gauge.hpp>
 #include <process/metrics/push_gauge.hpp>
 #include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
+
+#include <stout/duration.hpp>
 
 #include <stout/hashmap.hpp>
 
@@ -234,6 +237,14 @@ struct Metrics
   process::metrics::PullGauge event_queue_dispatches;
   process::metrics::PullGauge event_queue_http_requests;
 
+  // Message ingestion metrics, see `--parallel_message_ingestion`.
+  // Events are first decoded on a worker thread and then wait to be
+  // applied on the master actor, in the order they were received.
+  process::metrics::PushGauge ingestion_decode_queued;
+  process::metrics::PushGauge ingestion_apply_queued;
+  process::metrics::Timer<Milliseconds> ingestion_decode_latency;
+  process::metrics::Timer<Milliseconds> ingestion_apply_latency;
+
   // Successful registry operations.
   process::metrics::Counter slave_registrations;
   process::metrics::Counter slave_reregistrations;
@@ -242,6 +253,12 @@ struct Metrics
   process::metrics::Counter slave_removals_reason_unregistered;
   process::metrics::Counter slave_removals_reason_registered;
 
+  // Agent re-registration admission metrics. Re-registrations are
+  // queued for admission if `--agent_reregistration_rate_limit` is set.
+  process::metrics::PullGauge slave_reregistrations_in_progress;
+  process::metrics::PushGauge slave_reregistrations_queued;
+  process::metrics::Timer<Milliseconds> slave_reregistration_admission_delay;
+
   // Slave observer metrics.
   //
   // TODO(neilc): The `slave_shutdowns_xxx` metrics are deprecated and
@@ -195,7 +195,7 @@ private:
 
 
 Option<Error> Master::QuotaHandler::overcommitCheck(
-    const vector<Resources>& agents,
+    const ResourceQuantities& capacity,
     const hashmap<string, Quota>& quotas,
     const QuotaInfo& request)
 {
@@ -216,13 +216,6 @@ Option<Error> Master::QuotaHandler::overcommitCheck(
   }();
 
   // Determine whether quota overcommits the cluster.
-  ResourceQuantities capacity;
-
-  foreach (const Resources& agent, agents) {
-    capacity += ResourceQuantities::fromScalarResources(
-        agent.nonRevocable().scalars());
-  }
-
   if (!capacity.contains(totalGuarantees)) {
     // TODO(bmahler): Specialize this message based on whether
     // this request leads to the overcommit vs the quota was
@@ -529,11 +522,9 @@ Future<http::Response> Master::QuotaHandler::update(
   // Because we currently exclude them, the calculated capacity
   // is 0 immediately after a failover and slowly works its way
   // up to the pre-failover capacity as the agents re-register.
-  ResourceQuantities clusterCapacity;
-  foreachvalue (const Slave* agent, master->slaves.registered) {
-    clusterCapacity += ResourceQuantities::fromScalarResources(
-        agent->totalResources.nonRevocable().scalars());
-  }
+  //
+  // The capacity is maintained incrementally by the role tree.
+  const ResourceQuantities& clusterCapacity = master->roleTree.capacity();
 
   if (!clusterCapacity.contains(quotaTree.totalGuarantees())) {
     if (call.update_quota().force()) {
@@ -858,16 +849,10 @@ Future<http::Response> Master::QuotaHandler::__set(
     // Because we currently exclude them, the calculated capacity
     // is 0 immediately after a failover and slowly works its way
     // up to the pre-failover capacity as the agents re-register.
-    vector<Resources> agents;
-    agents.reserve(master->slaves.registered.size());
-
-    foreachvalue (const Slave* agent, master->slaves.registered) {
-      agents.push_back(agent->totalResources);
-    }
-
-    // Validate whether quota overcommits the cluster capacity.
+    //
+    // The capacity is maintained incrementally by the role tree.
     Option<Error> error = overcommitCheck(
-        agents,
+        master->roleTree.capacity(),
         master->quotas,
         quotaInfo);
 
@@ -35,9 +35,11 @@
 
 #include "common/build.hpp"
 #include "common/http.hpp"
+#include "common/protobuf_utils.hpp"
 
 using process::Owned;
 
+using process::http::BadRequest;
 using process::http::OK;
 
 using mesos::authorization::VIEW_EXECUTOR;
@@ -1166,69 +1168,119 @@ process::http::Response Master::ReadOnlyHandler::tasks(
   Option<string> frameworkId = query.get("framework_id");
   Option<string> taskId = query.get("task_id");
 
-  IDAcceptor<FrameworkID> selectFrameworkId(frameworkId);
-  IDAcceptor<TaskID> selectTaskId(taskId);
-
-  // Construct framework list with both active and completed frameworks.
-  vector<const Framework*> frameworks;
-  foreachvalue (Framework* framework, master->frameworks.registered) {
-    // Skip unauthorized frameworks or frameworks without matching
-    // framework ID.
-    if (!selectFrameworkId.accept(framework->id()) ||
-        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-      continue;
+  Option<TaskState> state = None();
+  if (query.get("state").isSome()) {
+    TaskState state_;
+    if (!TaskState_Parse(query.get("state").get(), &state_)) {
+      return BadRequest(
+          "Failed to parse query parameter 'state': Unknown task state '" +
+          query.get("state").get() + "'");
     }
 
-    frameworks.push_back(framework);
+    state = state_;
   }
 
-  foreachvalue (const Owned<Framework>& framework,
-                master->frameworks.completed) {
-    // Skip unauthorized frameworks or frameworks without matching
-    // framework ID.
-    if (!selectFrameworkId.accept(framework->id()) ||
-        !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
-     continue;
-    }
+  IDAcceptor<FrameworkID> selectFrameworkId(frameworkId);
+  IDAcceptor<TaskID> selectTaskId(taskId);
 
-    frameworks.push_back(framework.get());
-  }
+  auto selectState = [&state](const Task& task) {
+    return state.isNone() || task.state() == state.get();
+  };
 
-  // Construct task list with both running,
-  // completed and unreachable tasks.
   vector<const Task*> tasks;
-  foreach (const Framework* framework, frameworks) {
-    foreachvalue (Task* task, framework->tasks) {
-      CHECK_NOTNULL(task);
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+
+  if (state.isSome() &&
+      !protobuf::isTerminalState(state.get()) &&
+      state.get() != TASK_UNREACHABLE) {
+    // Tasks in a non-terminal, reachable state are only stored on
+    // registered agents and can be looked up in the task state index
+    // without iterating over all tasks of all frameworks.
+    foreach (const Task* task, master->taskStates.get(state.get())) {
+      if (!selectFrameworkId.accept(task->framework_id()) ||
+          !selectTaskId.accept(task->task_id())) {
+        continue;
+      }
+
+      Option<Framework*> framework =
+        master->frameworks.registered.get(task->framework_id());
+
+      // Skip tasks of frameworks which have not yet reregistered
+      // as well as unauthorized frameworks and tasks.
+      if (framework.isNone() ||
+          !approvers->approved<VIEW_FRAMEWORK>(framework.get()->info) ||
+          !approvers->approved<VIEW_TASK>(*task, framework.get()->info)) {
         continue;
       }
 
       tasks.push_back(task);
     }
-
-    foreachvalue (
-        const Owned<Task>& task,
-        framework->unreachableTasks) {
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+  } else {
+    // Construct framework list with both active and completed frameworks.
+    vector<const Framework*> frameworks;
+    foreachvalue (Framework* framework, master->frameworks.registered) {
+      // Skip unauthorized frameworks or frameworks without matching
+      // framework ID.
+      if (!selectFrameworkId.accept(framework->id()) ||
+          !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
         continue;
       }
 
-      tasks.push_back(task.get());
+      frameworks.push_back(framework);
     }
 
-    foreach (const Owned<Task>& task, framework->completedTasks) {
-      // Skip unauthorized tasks or tasks without matching task ID.
-      if (!selectTaskId.accept(task->task_id()) ||
-          !approvers->approved<VIEW_TASK>(*task, framework->info)) {
-        continue;
+    foreachvalue (const Owned<Framework>& framework,
+                  master->frameworks.completed) {
+      // Skip unauthorized frameworks or frameworks without matching
+      // framework ID.
+      if (!selectFrameworkId.accept(framework->id()) ||
+          !approvers->approved<VIEW_FRAMEWORK>(framework->info)) {
+       continue;
+      }
+
+      frameworks.push_back(framework.get());
+    }
+
+    // Construct task list with both running,
+    // completed and unreachable tasks.
+    foreach (const Framework* framework, frameworks) {
+      foreachvalue (Task* task, framework->tasks) {
+        CHECK_NOTNULL(task);
+        // Skip unauthorized tasks or tasks without matching task ID
+        // or state.
+        if (!selectTaskId.accept(task->task_id()) ||
+            !selectState(*task) ||
+            !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+          continue;
+        }
+
+        tasks.push_back(task);
       }
 
-      tasks.push_back(task.get());
+      foreachvalue (
+          const Owned<Task>& task,
+          framework->unreachableTasks) {
+        // Skip unauthorized tasks or tasks without matching task ID
+        // or state.
+        if (!selectTaskId.accept(task->task_id()) ||
+            !selectState(*task) ||
+            !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+          continue;
+        }
+
+        tasks.push_back(task.get());
+      }
+
+      foreach (const Owned<Task>& task, framework->completedTasks) {
+        // Skip unauthorized tasks or tasks without matching task ID
+        // or state.
+        if (!selectTaskId.accept(task->task_id()) ||
+            !selectState(*task) ||
+            !approvers->approved<VIEW_TASK>(*task, framework->info)) {
+          continue;
+        }
+
+        tasks.push_back(task.get());
+      }
     }
   }
 
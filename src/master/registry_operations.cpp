@@ -14,13 +14,21 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
 #include <stout/check.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 
 #include "master/registry_operations.hpp"
 
 #include "common/protobuf_utils.hpp"
 #include "common/resources_utils.hpp"
 
+using std::vector;
+
+using google::protobuf::RepeatedPtrField;
+
 namespace mesos {
 namespace internal {
 namespace master {
@@ -215,6 +223,144 @@ Try<bool> MarkSlaveReachable::perform(
 }
 
 
+ReadmitSlaves::ReadmitSlaves(
+    const vector<SlaveInfo>& _updated,
+    const vector<SlaveInfo>& _reachable)
+  : updated(_updated),
+    reachable(_reachable)
+{
+  foreach (const SlaveInfo& info, updated) {
+    CHECK(info.has_id()) << "SlaveInfo is missing the 'id' field";
+  }
+
+  foreach (const SlaveInfo& info, reachable) {
+    CHECK(info.has_id()) << "SlaveInfo is missing the 'id' field";
+  }
+}
+
+
+Try<bool> ReadmitSlaves::perform(
+    Registry* registry,
+    hashset<SlaveID>* slaveIDs)
+{
+  bool mutation = false;
+
+  // Index the admitted slaves once, rather than scanning them for each
+  // updated slave as `UpdateSlave` does. The index is complete before
+  // any slave is added below, so the pointers remain valid.
+  hashmap<SlaveID, Registry::Slave*> admitted;
+
+  if (!updated.empty()) {
+    for (int i = 0; i < registry->slaves().slaves().size(); i++) {
+      Registry::Slave* slave = registry->mutable_slaves()->mutable_slaves(i);
+      admitted[slave->info().id()] = slave;
+    }
+  }
+
+  // Fail before mutating the registry, so that a failed batch leaves
+  // it untouched like a failed `UpdateSlave` does.
+  foreach (const SlaveInfo& info, updated) {
+    if (!slaveIDs->contains(info.id())) {
+      return Error("Agent " + stringify(info.id()) + " not yet admitted");
+    }
+
+    if (!admitted.contains(info.id())) {
+      // Should not happen.
+      return Error("Failed to find agent " + stringify(info.id()));
+    }
+  }
+
+  foreach (SlaveInfo info, updated) {
+    Registry::Slave* slave = admitted.at(info.id());
+
+    // See `UpdateSlave::perform()` for why the resources are upgraded
+    // for the comparison and downgraded for the update.
+    SlaveInfo previousInfo(slave->info());
+    upgradeResources(&previousInfo);
+
+    if (info == previousInfo) {
+      continue; // No mutation.
+    }
+
+    CHECK_SOME(downgradeResources(&info));
+
+    slave->mutable_info()->CopyFrom(info);
+    mutation = true;
+  }
+
+  // Slaves which are already admitted need no changes to become
+  // reachable, see `MarkSlaveReachable::perform()`.
+  hashset<SlaveID> readmitted;
+  foreach (const SlaveInfo& info, reachable) {
+    if (!slaveIDs->contains(info.id())) {
+      readmitted.insert(info.id());
+    }
+  }
+
+  if (readmitted.empty()) {
+    return mutation;
+  }
+
+  // Remove the readmitted slaves from the unreachable list in a single
+  // pass, preserving the order of the remaining slaves.
+  hashmap<SlaveID, Registry::UnreachableSlave> unreachable;
+
+  RepeatedPtrField<Registry::UnreachableSlave>* slaves =
+    registry->mutable_unreachable()->mutable_slaves();
+
+  int kept = 0;
+  for (int i = 0; i < slaves->size(); i++) {
+    const Registry::UnreachableSlave& slave = slaves->Get(i);
+
+    if (readmitted.contains(slave.id())) {
+      unreachable[slave.id()] = slave;
+      continue;
+    }
+
+    if (kept != i) {
+      slaves->SwapElements(kept, i);
+    }
+
+    ++kept;
+  }
+
+  slaves->DeleteSubrange(kept, slaves->size() - kept);
+
+  foreach (SlaveInfo info, reachable) {
+    // Skip slaves which are already admitted, including the ones
+    // which appear more than once in the batch.
+    if (slaveIDs->contains(info.id())) {
+      continue;
+    }
+
+    Registry::Slave slave;
+
+    Option<Registry::UnreachableSlave> previous = unreachable.get(info.id());
+    if (previous.isSome()) {
+      // Copy the draining and deactivation states.
+      if (previous->has_drain_info()) {
+        slave.mutable_drain_info()->CopyFrom(previous->drain_info());
+      }
+
+      slave.set_deactivated(previous->deactivated());
+    } else {
+      LOG(WARNING) << "Allowing UNKNOWN agent to reregister: " << info;
+    }
+
+    CHECK_SOME(downgradeResources(&info));
+
+    slave.mutable_info()->CopyFrom(info);
+
+    registry->mutable_slaves()->add_slaves()->CopyFrom(slave);
+    slaveIDs->insert(info.id());
+
+    mutation = true;
+  }
+
+  return mutation;
+}
+
+
 Prune::Prune(
     const hashset<SlaveID>& _toRemoveUnreachable,
     const hashset<SlaveID>& _toRemoveGone)
@@ -17,9 +17,13 @@
 #ifndef __MASTER_REGISTRY_OPERATIONS_HPP__
 #define __MASTER_REGISTRY_OPERATIONS_HPP__
 
+#include <vector>
+
 #include <mesos/mesos.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <stout/hashset.hpp>
+
 #include "master/registrar.hpp"
 
 
@@ -92,6 +96,27 @@ private:
 };
 
 
+// Apply the registry updates of a batch of reregistering slaves: the
+// SlaveInfo of each `updated` slave is updated (see `UpdateSlave`) and
+// each `reachable` slave is added back to the list of admitted slaves
+// (see `MarkSlaveReachable`). Unlike applying these operations one by
+// one, the registry is only scanned once for the whole batch.
+class ReadmitSlaves : public RegistryOperation
+{
+public:
+  ReadmitSlaves(
+      const std::vector<SlaveInfo>& _updated,
+      const std::vector<SlaveInfo>& _reachable);
+
+protected:
+  Try<bool> perform(Registry* registry, hashset<SlaveID>* slaveIDs) override;
+
+private:
+  std::vector<SlaveInfo> updated;
+  std::vector<SlaveInfo> reachable;
+};
+
+
 class Prune : public RegistryOperation
 {
 public:
@@ -14,15 +14,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <string>
 
+#include <glog/logging.h>
+
 #include <google/protobuf/repeated_field.h>
 
 #include "master/resources/network_bandwidth.hpp"
 
 #include <mesos/resources.hpp>
 
-#include "slave/slave.hpp"
+#include <stout/foreach.hpp>
+#include <stout/stringify.hpp>
 
 namespace mesos {
 namespace resources {
@@ -31,8 +35,6 @@ using namespace std;
 
 using google::protobuf::RepeatedPtrField;
 
-using mesos::internal::slave::Slave;
-
 const double EPSYLON = 0.001;
 
 const string NETWORK_BANDWIDTH_LABEL_NAME = "NETWORK_BANDWIDTH_RESOURCE";
@@ -108,59 +110,6 @@ Option<Resource> findResource(
 }
 
 
-/**
- * @brief Compute the amount of network bandwidth relative to
- *   the share of reserved CPU and the network bandwidth declared on the
- *   slave.
- *
- * @param slaveTotalResources The global resources advertised by the slave.
- * @return The amount of network bandwidth relative to the share of reserved
- *   CPU.
- */
-Try<Option<double>> computeNetworkBandwidthBasedOnShareOfCpu(
-  const RepeatedPtrField<Resource>& taskResources,
-  const Resources& slaveTotalResources) {
-  // The following constant is defining the total amount of network bandwidth
-  // pool to allocate from when a task does not define network bandwidth
-  // reservation.
-  // This constant is in Mbps and is completely specific to Criteo.
-  //
-  // Note: We need to make sure network bandwidth advertised by the slaves has
-  // the same unit.
-  //
-  // TODO(clems4ever): make this parameterizable with a flag.
-  double DEFAULT_ALLOCATABLE_NETWORK_BANDWIDTH_IN_MBPS = 2000;
-
-  Option<double> totalCpus = slaveTotalResources.cpus();
-  Option<Resource> reservedCpus = findResource(
-    taskResources,
-    CPUS_RESOURCE_NAME);
-
-  if(totalCpus.isNone()) {
-    return Error("No CPU advertised by the slave. " \
-                 "Cannot deduce network bandwidth.");
-  }
-
-  if(reservedCpus.isNone() || !reservedCpus.get().has_scalar() ||
-     !reservedCpus.get().scalar().has_value()) {
-    return Error("No CPU declared in the task. " \
-                 "Cannot deduce network bandwidth.");
-  }
-
-  // We protect ourselves from a division by 0 even though it should not
-  // happen since a resource cannot be equal to 0. It would be filtered out
-  // when injected in Resources. Plus, it is unlikely that a slave declares 0
-  // or close to 0 cpus.
-  if(std::abs(totalCpus.get()) < EPSYLON) {
-    return 0.0;
-  }
-
-  return reservedCpus.get().scalar().value() /
-    totalCpus.get() *
-    DEFAULT_ALLOCATABLE_NETWORK_BANDWIDTH_IN_MBPS;
-}
-
-
 /**
  * @brief Get an amount of network bandwidth, if any, from a set of labels.
  *
@@ -194,10 +143,40 @@ Try<Option<double>> getNetworkBandwidthFromLabel(
   return None();
 }
 
+
 /**
- * @brief Enforce network bandwidth allocation for a given task.
+ * @brief Compute the network bandwidth allocated per CPU of a slave.
  *
  * @param slaveTotalResources The resources declared on the slave.
+ * @param pool The network bandwidth to share between the CPUs, in Mbps.
+ * @return The network bandwidth per CPU, None if the slave does not
+ *   advertise any CPU.
+ */
+Option<double> computeNetworkBandwidthPerCpu(
+  const Resources& slaveTotalResources,
+  double pool) {
+  Option<double> totalCpus = slaveTotalResources.cpus();
+  if (totalCpus.isNone()) {
+    return None();
+  }
+
+  // We protect ourselves from a division by 0 even though it should not
+  // happen since a resource cannot be equal to 0. It would be filtered out
+  // when injected in Resources. Plus, it is unlikely that a slave declares 0
+  // or close to 0 cpus.
+  if (std::abs(totalCpus.get()) < EPSYLON) {
+    return 0.0;
+  }
+
+  return pool / totalCpus.get();
+}
+
+
+/**
+ * @brief Enforce network bandwidth allocation for a given task.
+ *
+ * @param bandwidthPerCpu The network bandwidth allocated per CPU of the
+ *   slave the task is launched on, None if it does not advertise any CPU.
  * @param task The task to enforce network bandwidth for.
  * @return Nothing if no enforcement is done or if it is successful, otherwise
  *  an Error.
@@ -205,7 +184,7 @@ Try<Option<double>> getNetworkBandwidthFromLabel(
  * TODO(clems4ever): Be able to consume role resources as well as unreserved.
  */
 Try<Nothing> enforceNetworkBandwidthAllocation(
-  const Resources& slaveTotalResources,
+  const Option<double>& bandwidthPerCpu,
   TaskInfo& task)
 {
   // We first check if network bandwidth is already declared. In that case
@@ -247,73 +226,181 @@ Try<Nothing> enforceNetworkBandwidthAllocation(
 
   // At this point, we enforce the network bandwidth allocation by reserving
   // network bandwidth relative to the share of CPU reserved on the slave.
-  Try<Option<double>> defaultNetworkBandwidth =
-      computeNetworkBandwidthBasedOnShareOfCpu(
-        task.resources(),
-        slaveTotalResources);
-
-  if (defaultNetworkBandwidth.isError()) {
-    return Error(defaultNetworkBandwidth.error());
+  if (bandwidthPerCpu.isNone()) {
+    return Error("No CPU advertised by the slave. " \
+                 "Cannot deduce network bandwidth.");
   }
 
-  if (defaultNetworkBandwidth.get().isSome()) {
-    addNetworkBandwidth(
-      task,
-      defaultNetworkBandwidth.get().get(),
-      taskRole);
+  Option<Resource> reservedCpus = findResource(
+    task.resources(),
+    CPUS_RESOURCE_NAME);
+
+  if(reservedCpus.isNone() || !reservedCpus.get().has_scalar() ||
+     !reservedCpus.get().scalar().has_value()) {
+    return Error("No CPU declared in the task. " \
+                 "Cannot deduce network bandwidth.");
   }
+
+  addNetworkBandwidth(
+    task,
+    reservedCpus.get().scalar().value() * bandwidthPerCpu.get(),
+    taskRole);
   return Nothing();
 }
 
+
 /**
  * @brief Enforce network bandwidth allocation for an operation, i.e., either
  *   at task or a task group (see header for more details).
  *
- * @param slaveTotalResources The resources declared on the slave.
- * @param operation The operation to enforce network bandwidth for.
+ * @param bandwidthPerCpu The network bandwidth allocated per CPU of the
+ *   slave the operation is applied on.
+ * @param tasks The tasks launched by the operation.
  * @return None if no enforcement is done or if it is successful, otherwise
  *  an Error.
  */
 Option<Error> enforceNetworkBandwidthAllocation(
-  const Resources& slaveTotalResources,
-  Offer::Operation& operation)
+  const Option<double>& bandwidthPerCpu,
+  RepeatedPtrField<TaskInfo>& tasks)
 {
+  foreach (TaskInfo& task, tasks) {
+    Try<Nothing> result =
+      enforceNetworkBandwidthAllocation(bandwidthPerCpu, task);
+    if (result.isError()) {
+      return result.error();
+    }
+  }
+
+  return None();
+}
+
+
+/**
+ * @brief Get the tasks launched by an operation.
+ *
+ * @param operation The operation to get the tasks of.
+ * @return The tasks of a LAUNCH or LAUNCH_GROUP operation, otherwise nullptr.
+ */
+RepeatedPtrField<TaskInfo>* getTasks(Offer::Operation& operation) {
   switch (operation.type()) {
     case Offer::Operation::LAUNCH: {
-      foreach (
-        TaskInfo& task, *operation.mutable_launch()->mutable_task_infos()) {
-        Try<Nothing> result = resources::enforceNetworkBandwidthAllocation(
-          slaveTotalResources, task);
-        if (result.isError()) {
-          return result.error();
-        }
-      }
-
-      break;
+      return operation.mutable_launch()->mutable_task_infos();
     }
     case Offer::Operation::LAUNCH_GROUP: {
-      TaskGroupInfo* taskGroup =
-        operation.mutable_launch_group()->mutable_task_group();
-
-      // Mutate `TaskInfo` to include `ExecutorInfo` to make it easy
-      // for operator API and WebUI to get access to the corresponding
-      // executor for tasks in the task group.
-      foreach (TaskInfo& task, *taskGroup->mutable_tasks()) {
-        Try<Nothing> result = resources::enforceNetworkBandwidthAllocation(
-          slaveTotalResources, task);
-        if (result.isError()) {
-          return result.error();
-        }
-      }
-
-      break;
+      return operation.mutable_launch_group()
+        ->mutable_task_group()->mutable_tasks();
     }
     default: {
-      // No-op.
-      break;
+      return nullptr;
     }
   }
-  return None();
+}
+
+
+const string NETWORK_BANDWIDTH_FORMULA_ATTRIBUTE = "network_bandwidth_formula";
+const string NETWORK_BANDWIDTH_FLOOR_ATTRIBUTE = "network_bandwidth_floor";
+
+
+Try<NetworkBandwidthPolicy::Formula> NetworkBandwidthPolicy::parse(
+  const string& formula)
+{
+  if (formula == "floor_share") {
+    return FLOOR_SHARE;
+  } else if (formula == "agent_share") {
+    return AGENT_SHARE;
+  }
+
+  return Error("Unknown network bandwidth formula '" + formula + "'");
+}
+
+
+NetworkBandwidthPolicy::NetworkBandwidthPolicy(
+  Formula _formula,
+  double _floor)
+  : formula(_formula),
+    floor(_floor) {}
+
+
+void NetworkBandwidthPolicy::addSlave(
+  const SlaveInfo& slaveInfo,
+  const Resources& slaveTotalResources)
+{
+  Formula slaveFormula = formula;
+  double slaveFloor = floor;
+
+  foreach (const Attribute& attribute, slaveInfo.attributes()) {
+    if (attribute.name() == NETWORK_BANDWIDTH_FORMULA_ATTRIBUTE &&
+        attribute.type() == Value::TEXT) {
+      Try<Formula> parsed = parse(attribute.text().value());
+      if (parsed.isError()) {
+        LOG(WARNING) << "Ignoring attribute of agent " << slaveInfo.id()
+                     << ": " << parsed.error();
+      } else {
+        slaveFormula = parsed.get();
+      }
+    } else if (attribute.name() == NETWORK_BANDWIDTH_FLOOR_ATTRIBUTE &&
+               attribute.type() == Value::SCALAR) {
+      slaveFloor = attribute.scalar().value();
+    }
+  }
+
+  // The pool of network bandwidth to allocate from when a task does not
+  // define network bandwidth reservation. It is in Mbps.
+  //
+  // Note: We need to make sure network bandwidth advertised by the slaves has
+  // the same unit.
+  double pool = slaveFloor;
+  if (slaveFormula == AGENT_SHARE) {
+    Option<Value::Scalar> bandwidth =
+      slaveTotalResources.get<Value::Scalar>(NETWORK_BANDWIDTH_RESOURCE_NAME);
+
+    if (bandwidth.isSome()) {
+      pool = bandwidth->value();
+    }
+  }
+
+  slaves[slaveInfo.id()] =
+    computeNetworkBandwidthPerCpu(slaveTotalResources, pool);
+}
+
+
+void NetworkBandwidthPolicy::removeSlave(const SlaveID& slaveId)
+{
+  slaves.erase(slaveId);
+}
+
+
+Option<Error> NetworkBandwidthPolicy::enforce(
+  const SlaveID& slaveId,
+  Offer::Operation& operation)
+{
+  RepeatedPtrField<TaskInfo>* tasks = getTasks(operation);
+  if (tasks == nullptr) {
+    return None();
+  }
+
+  if (!slaves.contains(slaveId)) {
+    return Error("Unknown agent " + stringify(slaveId));
+  }
+
+  return enforceNetworkBandwidthAllocation(slaves.at(slaveId), *tasks);
+}
+
+
+Option<Error> enforceNetworkBandwidthAllocation(
+  const Resources& slaveTotalResources,
+  Offer::Operation& operation)
+{
+  RepeatedPtrField<TaskInfo>* tasks = getTasks(operation);
+  if (tasks == nullptr) {
+    return None();
+  }
+
+  return enforceNetworkBandwidthAllocation(
+    computeNetworkBandwidthPerCpu(
+      slaveTotalResources,
+      DEFAULT_NETWORK_BANDWIDTH_FLOOR),
+    *tasks);
 }
 
 } // namespace resources {
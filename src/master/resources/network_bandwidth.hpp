@@ -17,36 +17,112 @@
 #ifndef __MASTER_RESOURCES_NETWORK_BANDWIDTH_HPP__
 #define __MASTER_RESOURCES_NETWORK_BANDWIDTH_HPP__
 
+#include <string>
+
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
+#include <mesos/type_utils.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
 namespace resources {
 
 /**
- * @brief Enforce network bandwidth reservation for a given task.
- *
- * We ensure every task has a default allocated network bandwidth on slaves
- * declaring network bandwidth.
- * The amount of allocated network bandwidth is either provided by the
- * scheduler via resources or labels. Otherwise it is computed and added to the
- * task. The computation is the following:
+ * The amount of network bandwidth, in Mbps, tasks get a share of by
+ * default. 2000 is equivalent to 2Gbps which is the lowest common amount
+ * of network bandwidth available on each agent in the entire Criteo
+ * infrastructure.
+ */
+constexpr double DEFAULT_NETWORK_BANDWIDTH_FLOOR = 2000;
+
+
+/**
+ * @brief Policy computing the network bandwidth allocated to the tasks
+ *   which do not declare any.
  *
- * TaskNetworkBandwidth = TaskCpus / SlaveCpus * 2000.
+ * The bandwidth of a task is its share of the CPUs of the slave applied
+ * to a pool of network bandwidth which depends on the formula:
  *
- * This computation is definitely Criteo specific and could be anything else.
- * 2000 is equivalent to 2Gbps which is the lowest common amount of network
- * bandwidth available on each agent in the entire Criteo infrastructure.
- * We set a constant here, for 2 reasons: backward compatibility and ensure
- * two instances of the same app have the same limit.
+ * floor_share: TaskNetworkBandwidth = TaskCpus / SlaveCpus * Floor.
+ * agent_share: TaskNetworkBandwidth = TaskCpus / SlaveCpus * SlaveBandwidth,
+ *   where SlaveBandwidth is the network bandwidth declared by the slave, or
+ *   the floor if it does not declare any.
  *
- * TODO(clems4ever): make this value customizable by flag.
+ * The formula and the floor are set by master flags and can be overridden
+ * per slave with the `network_bandwidth_formula` (text) and
+ * `network_bandwidth_floor` (scalar) attributes.
  *
- * Note: this amount of network bandwidth is taken out from unreserved
- *       resources since we don't take roles into account yet.
+ * The bandwidth per CPU of a slave is computed when it is added to the
+ * policy, so that launching many tasks does not scan the resources of the
+ * slave over and over.
+ */
+class NetworkBandwidthPolicy
+{
+public:
+  enum Formula
+  {
+    FLOOR_SHARE,
+    AGENT_SHARE
+  };
+
+  static Try<Formula> parse(const std::string& formula);
+
+  explicit NetworkBandwidthPolicy(
+    Formula formula = FLOOR_SHARE,
+    double floor = DEFAULT_NETWORK_BANDWIDTH_FLOOR);
+
+  /**
+   * @brief Add or update a slave. This must be called whenever a slave
+   *   registers or its total resources change.
+   *
+   * @param slaveInfo The info of the slave, holding its attributes.
+   * @param slaveTotalResources The resources declared on the slave.
+   */
+  void addSlave(
+    const SlaveInfo& slaveInfo,
+    const Resources& slaveTotalResources);
+
+  void removeSlave(const SlaveID& slaveId);
+
+  /**
+   * @brief Enforce network bandwidth reservation for the tasks of an
+   *   operation launched on a given slave.
+   *
+   * We ensure every task has a default allocated network bandwidth on
+   * slaves declaring network bandwidth. The amount of allocated network
+   * bandwidth is either provided by the scheduler via resources or labels.
+   * Otherwise it is computed by the policy and added to the task.
+   *
+   * Note: this amount of network bandwidth is taken out from unreserved
+   *       resources since we don't take roles into account yet.
+   *
+   * @param slaveId The slave the operation is applied on.
+   * @param operation The operation for which to enforce network bandwidth
+   *   reservation for.
+   * @return None if enforcement is not applied or successful otherwise an
+   *         Error.
+   */
+  Option<Error> enforce(
+    const SlaveID& slaveId,
+    Offer::Operation& operation);
+
+private:
+  Formula formula;
+  double floor;
+
+  // The network bandwidth allocated per CPU of each slave, None if the
+  // slave does not advertise any CPU.
+  hashmap<SlaveID, Option<double>> slaves;
+};
+
+
+/**
+ * @brief Enforce network bandwidth reservation for a given operation with
+ *   the default policy (see `NetworkBandwidthPolicy`).
  *
  * @param slaveTotalResources The resources declared on the slave.
  * @param operation The operation for which to enforce network bandwidth
@@ -61,4 +137,4 @@ Option<Error> enforceNetworkBandwidthAllocation(
 } // namespace resources {
 } // namespace mesos {
 
-#endif // __MASTER_METRICS_HPP__
+#endif // __MASTER_RESOURCES_NETWORK_BANDWIDTH_HPP__
@@ -0,0 +1,154 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "master/role_tree.hpp"
+
+#include <mesos/roles.hpp>
+
+#include <stout/foreach.hpp>
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+void RoleTree::addOffered(const Resources& resources)
+{
+  update(&Quantities::offered, resources.allocations(), true);
+}
+
+
+void RoleTree::removeOffered(const Resources& resources)
+{
+  update(&Quantities::offered, resources.allocations(), false);
+}
+
+
+void RoleTree::addAllocated(const Resources& resources)
+{
+  update(&Quantities::allocated, resources.allocations(), true);
+}
+
+
+void RoleTree::removeAllocated(const Resources& resources)
+{
+  update(&Quantities::allocated, resources.allocations(), false);
+}
+
+
+void RoleTree::addReserved(const Resources& resources)
+{
+  update(&Quantities::reserved, resources.reservations(), true);
+}
+
+
+void RoleTree::removeReserved(const Resources& resources)
+{
+  update(&Quantities::reserved, resources.reservations(), false);
+}
+
+
+void RoleTree::addAllocatedReservations(const Resources& resources)
+{
+  update(&Quantities::allocatedReservations, resources.reservations(), true);
+}
+
+
+void RoleTree::removeAllocatedReservations(const Resources& resources)
+{
+  update(&Quantities::allocatedReservations, resources.reservations(), false);
+}
+
+
+void RoleTree::addCapacity(const ResourceQuantities& quantities)
+{
+  capacity_ += quantities;
+}
+
+
+void RoleTree::removeCapacity(const ResourceQuantities& quantities)
+{
+  capacity_ -= quantities;
+}
+
+
+const RoleTree::Quantities& RoleTree::get(const string& role) const
+{
+  static const Quantities* empty = new Quantities();
+
+  auto it = quantities.find(role);
+  if (it == quantities.end()) {
+    return *empty;
+  }
+
+  return it->second;
+}
+
+
+vector<string> RoleTree::roles() const
+{
+  vector<string> result;
+  result.reserve(quantities.size());
+
+  foreachkey (const string& role, quantities) {
+    result.push_back(role);
+  }
+
+  return result;
+}
+
+
+void RoleTree::update(
+    ResourceQuantities Quantities::*field,
+    const hashmap<string, Resources>& resources,
+    bool add)
+{
+  foreachpair (const string& role, const Resources& resources_, resources) {
+    const ResourceQuantities delta =
+      ResourceQuantities::fromResources(resources_);
+
+    if (delta.empty()) {
+      continue;
+    }
+
+    vector<string> subtrees = roles::ancestors(role);
+    subtrees.push_back(role);
+
+    foreach (const string& subtree, subtrees) {
+      if (add) {
+        quantities[subtree].*field += delta;
+        continue;
+      }
+
+      auto it = quantities.find(subtree);
+      if (it == quantities.end()) {
+        continue;
+      }
+
+      it->second.*field -= delta;
+
+      if (it->second.empty()) {
+        quantities.erase(it);
+      }
+    }
+  }
+}
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
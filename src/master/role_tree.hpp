@@ -0,0 +1,108 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MASTER_ROLE_TREE_HPP__
+#define __MASTER_ROLE_TREE_HPP__
+
+#include <string>
+#include <vector>
+
+#include <mesos/resource_quantities.hpp>
+#include <mesos/resources.hpp>
+
+#include <stout/hashmap.hpp>
+
+namespace mesos {
+namespace internal {
+namespace master {
+
+// Tracks the resources of the cluster by role, aggregated over role
+// subtrees: the entry of a role accounts for the resources of the role
+// itself and of all of its descendants. The master updates the tree
+// incrementally as resources are offered, allocated and reserved, so
+// that per-role breakdowns (e.g., for '/roles', `GET_ROLES` and the
+// quota handlers) do not need to scan all frameworks and agents.
+//
+// Offered and allocated resources are accounted to their allocation
+// role, reserved resources to their reservation role.
+class RoleTree
+{
+public:
+  struct Quantities
+  {
+    bool empty() const
+    {
+      return offered.empty() &&
+             allocated.empty() &&
+             reserved.empty() &&
+             allocatedReservations.empty();
+    }
+
+    ResourceQuantities offered;
+    ResourceQuantities allocated;
+    ResourceQuantities reserved;
+
+    // The subset of `reserved` which is allocated, i.e., used by
+    // tasks, executors or operations.
+    ResourceQuantities allocatedReservations;
+  };
+
+  void addOffered(const Resources& resources);
+  void removeOffered(const Resources& resources);
+
+  void addAllocated(const Resources& resources);
+  void removeAllocated(const Resources& resources);
+
+  void addReserved(const Resources& resources);
+  void removeReserved(const Resources& resources);
+
+  void addAllocatedReservations(const Resources& resources);
+  void removeAllocatedReservations(const Resources& resources);
+
+  // Tracks the non-revocable scalar resources of all registered
+  // agents, which are the capacity considered by quota validation.
+  void addCapacity(const ResourceQuantities& quantities);
+  void removeCapacity(const ResourceQuantities& quantities);
+
+  // Returns the aggregated quantities of the subtree of `role`.
+  // These are empty if no resources are tracked for the subtree.
+  const Quantities& get(const std::string& role) const;
+
+  // Returns the roles for which resources are tracked, including
+  // the ancestors of such roles.
+  std::vector<std::string> roles() const;
+
+  const ResourceQuantities& capacity() const { return capacity_; }
+
+private:
+  // Adds or subtracts the quantities of `resources` to or from
+  // `field` of each role and its ancestors.
+  void update(
+      ResourceQuantities Quantities::*field,
+      const hashmap<std::string, Resources>& resources,
+      bool add);
+
+  // Roles with empty quantities are not stored.
+  hashmap<std::string, Quantities> quantities;
+
+  ResourceQuantities capacity_;
+};
+
+} // namespace master {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MASTER_ROLE_TREE_HPP__
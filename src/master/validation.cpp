@@ -1580,7 +1580,7 @@ Option<Error> validateExecutor(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const ResourcesIndex& offered)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
@@ -1691,7 +1691,7 @@ Option<Error> validate(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const ResourcesIndex& offered)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
@@ -1798,7 +1798,7 @@ Option<Error> validateExecutor(
     const ExecutorInfo& executor,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const ResourcesIndex& offered)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
@@ -1909,7 +1909,7 @@ Option<Error> validate(
     const ExecutorInfo& executor,
     Framework* framework,
     Slave* slave,
-    const Resources& offered)
+    const ResourcesIndex& offered)
 {
   CHECK_NOTNULL(framework);
   CHECK_NOTNULL(slave);
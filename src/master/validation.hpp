@@ -34,6 +34,7 @@
 #include <stout/option.hpp>
 
 #include "common/protobuf_utils.hpp"
+#include "common/resources_index.hpp"
 
 namespace mesos {
 namespace internal {
@@ -202,7 +203,7 @@ Option<Error> validate(
     const TaskInfo& task,
     Framework* framework,
     Slave* slave,
-    const Resources& offered);
+    const ResourcesIndex& offered);
 
 
 // Functions in this namespace are only exposed for testing.
@@ -242,7 +243,7 @@ Option<Error> validate(
     const ExecutorInfo& executor,
     Framework* framework,
     Slave* slave,
-    const Resources& offered);
+    const ResourcesIndex& offered);
 
 
 // Functions in this namespace are only exposed for testing.
@@ -0,0 +1,465 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <mesos/mesos.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "slave/checkpoint_store.hpp"
+#include "slave/paths.hpp"
+
+using std::list;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace state {
+
+// Returns the patterns of the checkpoint files kept in the store, which
+// are the paths of the checkpoints with wildcards in place of the IDs.
+//
+// NOTE: The forked pids of executors are not kept in the store since
+// they are written by the containerizers rather than the agent.
+static vector<string> patterns(const string& metaDir)
+{
+  SlaveID slaveId;
+  slaveId.set_value("*");
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("*");
+
+  ExecutorID executorId;
+  executorId.set_value("*");
+
+  ContainerID containerId;
+  containerId.set_value("*");
+
+  TaskID taskId;
+  taskId.set_value("*");
+
+  return {
+    paths::getSlaveInfoPath(metaDir, slaveId),
+    paths::getDrainConfigPath(metaDir, slaveId),
+    paths::getFrameworkInfoPath(metaDir, slaveId, frameworkId),
+    paths::getFrameworkPidPath(metaDir, slaveId, frameworkId),
+    paths::getExecutorInfoPath(metaDir, slaveId, frameworkId, executorId),
+    paths::getLibprocessPidPath(
+        metaDir, slaveId, frameworkId, executorId, containerId),
+    paths::getTaskInfoPath(
+        metaDir, slaveId, frameworkId, executorId, containerId, taskId)
+  };
+}
+
+
+Try<shared_ptr<CheckpointStore>> CheckpointStore::create(
+    const string& metaDir)
+{
+  const string path = paths::getCheckpointStorePath(metaDir);
+
+  Try<Nothing> mkdir = os::mkdir(metaDir);
+  if (mkdir.isError()) {
+    return Error(
+        "Failed to create directory '" + metaDir + "': " + mkdir.error());
+  }
+
+  leveldb::Options options;
+  options.create_if_missing = true;
+
+  leveldb::DB* db = nullptr;
+
+  leveldb::Status status = leveldb::DB::Open(options, path, &db);
+  if (!status.ok()) {
+    return Error(
+        "Failed to open checkpoint store at '" + path + "': " +
+        status.ToString());
+  }
+
+  shared_ptr<CheckpointStore> store(new CheckpointStore(metaDir, db));
+
+  Try<Nothing> load = store->load();
+  if (load.isError()) {
+    return Error("Failed to load checkpoint store: " + load.error());
+  }
+
+  Try<Nothing> migrate = store->migrate();
+  if (migrate.isError()) {
+    return Error("Failed to import checkpoint files: " + migrate.error());
+  }
+
+  Try<Nothing> prune = store->prune();
+  if (prune.isError()) {
+    return Error("Failed to prune checkpoint store: " + prune.error());
+  }
+
+  return store;
+}
+
+
+CheckpointStore::CheckpointStore(const string& _metaDir, leveldb::DB* _db)
+  : metaDir(_metaDir),
+    prefix(path::join(
+        Path(paths::getLatestSlavePath(_metaDir)).dirname(), "")),
+    db(_db)
+{
+  foreach (const string& pattern, patterns(metaDir)) {
+    basenames.insert(Path(pattern).basename());
+  }
+}
+
+
+CheckpointStore::~CheckpointStore()
+{
+  delete db;
+}
+
+
+bool CheckpointStore::manages(const string& path) const
+{
+  return key(path).isSome();
+}
+
+
+Option<string> CheckpointStore::get(const string& path) const
+{
+  Option<string> key_ = key(path);
+  if (key_.isNone()) {
+    return None();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto entry = entries.find(key_.get());
+  if (entry == entries.end()) {
+    return None();
+  }
+
+  return entry->second;
+}
+
+
+Try<Nothing> CheckpointStore::put(
+    const string& path,
+    const string& data,
+    bool sync)
+{
+  Option<string> key_ = key(path);
+  if (key_.isNone()) {
+    return Error("'" + path + "' is not kept in the checkpoint store");
+  }
+
+  leveldb::WriteOptions options;
+  options.sync = sync;
+
+  // NOTE: We hold the lock across the write so that the entries in
+  // memory are updated in the same order as the database.
+  std::lock_guard<std::mutex> lock(mutex);
+
+  leveldb::Status status = db->Put(options, key_.get(), data);
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  entries[key_.get()] = data;
+
+  return Nothing();
+}
+
+
+Try<Nothing> CheckpointStore::put(
+    const hashmap<string, string>& checkpoints,
+    bool sync)
+{
+  leveldb::WriteBatch batch;
+  hashmap<string, string> updated;
+
+  foreachpair (const string& path, const string& data, checkpoints) {
+    Option<string> key_ = key(path);
+    if (key_.isNone()) {
+      return Error("'" + path + "' is not kept in the checkpoint store");
+    }
+
+    batch.Put(key_.get(), data);
+    updated[key_.get()] = data;
+  }
+
+  leveldb::WriteOptions options;
+  options.sync = sync;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  leveldb::Status status = db->Write(options, &batch);
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  foreachpair (const string& key_, const string& data, updated) {
+    entries[key_] = data;
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> CheckpointStore::remove(const string& path)
+{
+  Option<string> key_ = key(path);
+  if (key_.isNone()) {
+    return Error("'" + path + "' is not kept in the checkpoint store");
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  leveldb::Status status = db->Delete(leveldb::WriteOptions(), key_.get());
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  entries.erase(key_.get());
+
+  return Nothing();
+}
+
+
+list<string> CheckpointStore::list(const string& directory) const
+{
+  std::list<string> result;
+
+  Option<string> relative_ = relative(directory);
+  if (relative_.isNone()) {
+    return result;
+  }
+
+  // The keys of the entries under the directory share this prefix, so
+  // they are adjacent in `entries`, and so are those of each of its
+  // subdirectories.
+  const string start = path::join(relative_.get(), "");
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  Option<string> last;
+
+  for (auto iterator = entries.lower_bound(start);
+       iterator != entries.end() &&
+         strings::startsWith(iterator->first, start);
+       ++iterator) {
+    const size_t separator = iterator->first.find('/', start.size());
+
+    // Skip the checkpoints of the directory itself.
+    if (separator == string::npos) {
+      continue;
+    }
+
+    const string name =
+      iterator->first.substr(start.size(), separator - start.size());
+
+    if (last != name) {
+      result.push_back(path::join(directory, name));
+      last = name;
+    }
+  }
+
+  return result;
+}
+
+
+Try<Nothing> CheckpointStore::load()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  leveldb::Iterator* iterator = db->NewIterator(leveldb::ReadOptions());
+
+  for (iterator->SeekToFirst(); iterator->Valid(); iterator->Next()) {
+    entries[iterator->key().ToString()] = iterator->value().ToString();
+  }
+
+  leveldb::Status status = iterator->status();
+
+  delete iterator;
+
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> CheckpointStore::migrate()
+{
+  leveldb::WriteBatch batch;
+  hashmap<string, string> imported;
+  vector<string> files;
+
+  foreach (const string& pattern, patterns(metaDir)) {
+    Try<std::list<string>> matches = os::glob(pattern);
+    if (matches.isError()) {
+      return Error(
+          "Failed to find files matching '" + pattern + "': " +
+          matches.error());
+    }
+
+    foreach (const string& file, matches.get()) {
+      Option<string> key_ = key(file);
+      if (key_.isNone()) {
+        continue;
+      }
+
+      // Like recovery, we skip the 'latest' symlinks, which point to
+      // directories we see anyway.
+      bool latest = false;
+      foreach (const string& token, strings::tokenize(key_.get(), "/")) {
+        latest = latest || token == paths::LATEST_SYMLINK;
+      }
+
+      if (latest) {
+        continue;
+      }
+
+      Try<string> data = os::read(file);
+      if (data.isError()) {
+        return Error("Failed to read '" + file + "': " + data.error());
+      }
+
+      // NOTE: The files take precedence over the entries in the store,
+      // since they are only written while the agent checkpoints into
+      // files, i.e., after the entries.
+      batch.Put(key_.get(), data.get());
+      imported[key_.get()] = data.get();
+      files.push_back(file);
+    }
+  }
+
+  if (files.empty()) {
+    return Nothing();
+  }
+
+  leveldb::WriteOptions options;
+  options.sync = true;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  leveldb::Status status = db->Write(options, &batch);
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  foreachpair (const string& key_, const string& data, imported) {
+    entries[key_] = data;
+  }
+
+  // The files are only removed once the entries are synced to disk, so
+  // a failure in between imports them again on the next start.
+  foreach (const string& file, files) {
+    Try<Nothing> rm = os::rm(file);
+    if (rm.isError()) {
+      return Error("Failed to remove '" + file + "': " + rm.error());
+    }
+  }
+
+  LOG(INFO) << "Imported " << files.size() << " checkpoint files into the "
+            << "checkpoint store at '" << metaDir << "'";
+
+  return Nothing();
+}
+
+
+Try<Nothing> CheckpointStore::prune()
+{
+  leveldb::WriteBatch batch;
+  vector<string> pruned;
+
+  // Most directories hold several checkpoints, so we only check once
+  // whether each of them still exists.
+  hashmap<string, bool> directories;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  foreachkey (const string& key_, entries) {
+    const string directory = Path(key_).dirname();
+
+    if (!directories.contains(directory)) {
+      directories[directory] = os::exists(path::join(metaDir, directory));
+    }
+
+    if (!directories.at(directory)) {
+      batch.Delete(key_);
+      pruned.push_back(key_);
+    }
+  }
+
+  if (pruned.empty()) {
+    return Nothing();
+  }
+
+  leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+  if (!status.ok()) {
+    return Error(status.ToString());
+  }
+
+  foreach (const string& key_, pruned) {
+    entries.erase(key_);
+  }
+
+  VLOG(1) << "Removed " << pruned.size() << " entries of garbage collected "
+          << "directories from the checkpoint store at '" << metaDir << "'";
+
+  return Nothing();
+}
+
+
+Option<string> CheckpointStore::key(const string& path) const
+{
+  if (!strings::startsWith(path, prefix) ||
+      !basenames.contains(Path(path).basename())) {
+    return None();
+  }
+
+  return path.substr(metaDir.size() + 1);
+}
+
+
+Option<string> CheckpointStore::relative(const string& directory) const
+{
+  if (!strings::startsWith(directory, path::join(metaDir, ""))) {
+    return None();
+  }
+
+  return strings::remove(
+      directory.substr(metaDir.size() + 1), "/", strings::SUFFIX);
+}
+
+} // namespace state {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
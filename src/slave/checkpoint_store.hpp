@@ -0,0 +1,140 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_CHECKPOINT_STORE_HPP__
+#define __SLAVE_CHECKPOINT_STORE_HPP__
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+// Forward declaration.
+namespace leveldb {
+class DB;
+} // namespace leveldb {
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace state {
+
+// Keeps the small per-object checkpoints of the agent (the agent,
+// framework, executor and task infos, and the pids of executors) in a
+// single LevelDB database under the meta directory, instead of one file
+// per object. This is used when the agent runs with
+// `--checkpoint_store=leveldb`.
+//
+// The entries are keyed by the path of the file they replace, relative
+// to the meta directory, and hold the same bytes the file would hold.
+// The store is owned by the agent, which passes it to `state::checkpoint`,
+// `state::read` and `state::recover` for the paths it manages. All
+// entries are loaded into memory with a single sequential scan when the
+// store is opened, and recovery discovers the frameworks, executors,
+// runs and tasks from the keys (see `list`) rather than by listing the
+// meta directory.
+//
+// NOTE: The directories of the checkpoints are still created, since the
+// garbage collection of the agent removes them, which in turn drops
+// their entries when the store is opened next.
+class CheckpointStore
+{
+public:
+  // Opens (or creates) the store of the given meta directory. The
+  // checkpoint files found under the meta directory are imported into
+  // the store in a single batch and then removed, and the entries whose
+  // directory no longer exists (e.g., garbage collected executors) are
+  // dropped.
+  static Try<std::shared_ptr<CheckpointStore>> create(
+      const std::string& metaDir);
+
+  ~CheckpointStore();
+
+  // Returns whether the checkpoint at the given path is kept in this
+  // store rather than in a file.
+  bool manages(const std::string& path) const;
+
+  Option<std::string> get(const std::string& path) const;
+
+  // If `sync` is true, the write is flushed to disk before returning.
+  Try<Nothing> put(
+      const std::string& path,
+      const std::string& data,
+      bool sync);
+
+  // Writes the given checkpoints, keyed by path, in a single batch.
+  Try<Nothing> put(
+      const hashmap<std::string, std::string>& checkpoints,
+      bool sync);
+
+  Try<Nothing> remove(const std::string& path);
+
+  // Returns the paths of the subdirectories of the given directory
+  // which hold a checkpoint kept in this store, like `fs::list` would
+  // return them for `<directory>/*`.
+  std::list<std::string> list(const std::string& directory) const;
+
+private:
+  CheckpointStore(const std::string& metaDir, leveldb::DB* db);
+
+  CheckpointStore(const CheckpointStore&) = delete;
+  CheckpointStore& operator=(const CheckpointStore&) = delete;
+
+  Try<Nothing> load();
+  Try<Nothing> migrate();
+  Try<Nothing> prune();
+
+  // Returns the key of the given path, or None if the path is not
+  // managed by this store.
+  Option<std::string> key(const std::string& path) const;
+
+  // Returns the path of the given directory relative to the meta
+  // directory, or None if it is not under the meta directory.
+  Option<std::string> relative(const std::string& directory) const;
+
+  const std::string metaDir;
+
+  // The directory holding the checkpoints of the agents, with a
+  // trailing separator, and the names of the checkpoint files which
+  // are kept in the store.
+  const std::string prefix;
+  hashset<std::string> basenames;
+
+  leveldb::DB* db;
+
+  // Protects `entries`, as the store is read by the recovery, which
+  // runs outside of the agent actor.
+  //
+  // NOTE: The entries are ordered by key so that the entries of a
+  // directory are adjacent, which is what `list` relies on.
+  mutable std::mutex mutex;
+  std::map<std::string, std::string> entries;
+};
+
+} // namespace state {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_CHECKPOINT_STORE_HPP__
@@ -86,6 +86,13 @@ constexpr Duration DISK_WATCH_INTERVAL = Minutes(1);
 // Minimum free disk capacity enforced by the garbage collector.
 constexpr double GC_DISK_HEADROOM = 0.1;
 
+// Number of paths the garbage collector removes concurrently.
+constexpr size_t GC_REMOVAL_PARALLELISM = 4;
+
+// Number of scheduled paths the garbage collector measures at a time
+// under disk pressure, before evicting the largest of them.
+constexpr size_t GC_EVICTION_BATCH_SIZE = 16;
+
 // Maximum number of completed frameworks to store in memory.
 constexpr size_t MAX_COMPLETED_FRAMEWORKS = 50;
 
@@ -154,6 +161,15 @@ constexpr Duration DOCKER_INSPECT_TIMEOUT = Seconds(5);
 // in parallel to prevent hitting system's open file descriptor limit.
 constexpr size_t DOCKER_PS_MAX_INSPECT_CALLS = 100;
 
+// Number of Docker image layers the registry puller of the Mesos
+// containerizer extracts concurrently, across all the images pulled.
+constexpr size_t DOCKER_LAYER_EXTRACTION_PARALLELISM = 4;
+
+// Duration that the registry puller of the Mesos containerizer waits
+// for the `--docker_lazy_layer_mounter` to mount a layer, before it
+// kills the mounter and fails the pull.
+constexpr Duration DOCKER_LAZY_LAYER_MOUNT_TIMEOUT = Minutes(5);
+
 // Default duration that docker containerizer will wait to check
 // docker version.
 // TODO(tnachen): Make this a flag.
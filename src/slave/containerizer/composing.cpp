@@ -82,6 +82,8 @@ public:
   Future<ContainerStatus> status(
       const ContainerID& containerId);
 
+  Future<hashmap<ContainerID, vector<PerfStatistics>>> perfSamples();
+
   Future<Option<ContainerTermination>> wait(
       const ContainerID& containerId);
 
@@ -252,6 +254,13 @@ Future<hashset<ContainerID>> ComposingContainerizer::containers()
 }
 
 
+Future<hashmap<ContainerID, vector<PerfStatistics>>>
+ComposingContainerizer::perfSamples()
+{
+  return dispatch(process, &ComposingContainerizerProcess::perfSamples);
+}
+
+
 Future<Nothing> ComposingContainerizer::remove(const ContainerID& containerId)
 {
   return dispatch(process, &ComposingContainerizerProcess::remove, containerId);
@@ -654,6 +663,29 @@ Future<hashset<ContainerID>> ComposingContainerizerProcess::containers()
 }
 
 
+Future<hashmap<ContainerID, vector<PerfStatistics>>>
+ComposingContainerizerProcess::perfSamples()
+{
+  vector<Future<hashmap<ContainerID, vector<PerfStatistics>>>> futures;
+
+  foreach (Containerizer* containerizer, containerizers_) {
+    futures.push_back(containerizer->perfSamples());
+  }
+
+  return collect(futures)
+    .then([](const vector<hashmap<ContainerID, vector<PerfStatistics>>>&
+                 results) {
+      hashmap<ContainerID, vector<PerfStatistics>> samples;
+
+      foreach (const auto& result, results) {
+        samples.insert(result.begin(), result.end());
+      }
+
+      return samples;
+    });
+}
+
+
 Future<Nothing> ComposingContainerizerProcess::remove(
     const ContainerID& containerId)
 {
@@ -73,6 +73,9 @@ public:
   process::Future<ContainerStatus> status(
       const ContainerID& containerId) override;
 
+  process::Future<hashmap<ContainerID, std::vector<PerfStatistics>>>
+  perfSamples() override;
+
   process::Future<Option<mesos::slave::ContainerTermination>> wait(
       const ContainerID& containerId) override;
 
@@ -18,6 +18,7 @@
 #define __CONTAINERIZER_HPP__
 
 #include <map>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
@@ -32,6 +33,7 @@
 #include <process/process.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
@@ -135,6 +137,15 @@ public:
     return ContainerStatus();
   }
 
+  // Returns the recent perf samples of the containers, oldest first,
+  // if the containerizer samples perf events. Unlike `usage()`, this
+  // is not expected to query the isolators of every container.
+  virtual process::Future<hashmap<ContainerID, std::vector<PerfStatistics>>>
+  perfSamples()
+  {
+    return hashmap<ContainerID, std::vector<PerfStatistics>>();
+  }
+
   // Wait on the 'ContainerTermination'. If the executor terminates,
   // the containerizer should also destroy the containerized context.
   // The future may be failed if an error occurs during termination of
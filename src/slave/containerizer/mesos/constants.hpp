@@ -17,6 +17,8 @@
 #ifndef __MESOS_CONTAINERIZER_CONSTANTS_HPP__
 #define __MESOS_CONTAINERIZER_CONSTANTS_HPP__
 
+#include <stddef.h>
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -29,6 +31,14 @@ constexpr char MESOS_CONTAINERIZER[] = "mesos-containerizer.exe";
 
 constexpr char CGROUP_SEPARATOR[] = "mesos";
 
+// The number of concurrent readers of the checkpointed runtime
+// information of containers when the containerizer recovers.
+constexpr size_t RECOVERY_CHECKPOINT_READERS = 8;
+
+// The number of perf samples kept for each container, which are served
+// by the `/monitor/perf` endpoint of the agent.
+constexpr size_t PERF_EVENT_SAMPLES = 60;
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <memory>
 #include <set>
 #include <utility>
 
@@ -24,6 +25,7 @@
 
 #include <mesos/slave/isolator.hpp>
 
+#include <process/async.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/http.hpp>
@@ -70,6 +72,7 @@
 
 #include "slave/containerizer/mesos/constants.hpp"
 #include "slave/containerizer/mesos/containerizer.hpp"
+#include "slave/containerizer/mesos/isolator.hpp"
 #include "slave/containerizer/mesos/isolator_tracker.hpp"
 #include "slave/containerizer/mesos/launch.hpp"
 #include "slave/containerizer/mesos/launcher.hpp"
@@ -98,6 +101,7 @@
 
 #ifdef __linux__
 #include "slave/containerizer/mesos/linux_launcher.hpp"
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
 
 #include "slave/containerizer/mesos/isolators/appc/runtime.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/cgroups.hpp"
@@ -111,6 +115,7 @@
 #include "slave/containerizer/mesos/isolators/linux/nnp.hpp"
 #include "slave/containerizer/mesos/isolators/namespaces/ipc.hpp"
 #include "slave/containerizer/mesos/isolators/namespaces/pid.hpp"
+#include "slave/containerizer/mesos/isolators/network/bandwidth.hpp"
 #include "slave/containerizer/mesos/isolators/network/cni/cni.hpp"
 #include "slave/containerizer/mesos/isolators/volume/host_path.hpp"
 #include "slave/containerizer/mesos/isolators/volume/image.hpp"
@@ -133,7 +138,9 @@
 #include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
 #endif
 
+using process::await;
 using process::collect;
+using process::delay;
 using process::dispatch;
 using process::defer;
 
@@ -150,6 +157,7 @@ using process::http::Connection;
 using std::map;
 using std::pair;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -263,14 +271,17 @@ Try<MesosContainerizer*> MesosContainerizer::create(
   // The network isolator is responsible for preparing the network
   // namespace for containers. In general, one and only one `network`
   // isolator is required (e.g. `network/cni` and `network/port_mapping`
-  // cannot co-exist). However, since the `network/ports` isolator
-  // only deals with ports resources and does not configure any network
-  // namespaces, it doesn't count for the purposes of this check.
+  // cannot co-exist). However, since the `network/ports` and
+  // `network/bandwidth` isolators only deal with ports and bandwidth
+  // resources and do not configure any network namespaces, they don't
+  // count for the purposes of this check.
   switch (std::count_if(
       isolations->begin(),
       isolations->end(),
       [](const string& s) {
-        return strings::startsWith(s, "network/") && s != "network/ports";
+        return strings::startsWith(s, "network/") &&
+               s != "network/ports" &&
+               s != "network/bandwidth";
       })) {
     case 0:
       // If the user does not specify anything, the 'network/cni'
@@ -361,6 +372,17 @@ Try<MesosContainerizer*> MesosContainerizer::create(
 
   Shared<Provisioner> provisioner = _provisioner->share();
 
+  // The perf samples are added by the cgroups isolator and read by the
+  // containerizer, see `MesosContainerizer::perfSamples()`.
+  std::shared_ptr<PerfSamples> perfSamples(new PerfSamples());
+
+#ifdef __linux__
+  const lambda::function<Try<Isolator*>(const Flags&)> cgroupsCreator =
+    [perfSamples](const Flags& flags) -> Try<Isolator*> {
+      return CgroupsIsolatorProcess::create(flags, perfSamples);
+    };
+#endif // __linux__
+
   // Built-in isolator definitions.
   //
   // The order of the entries in this table specifies the ordering of the
@@ -422,17 +444,17 @@ Try<MesosContainerizer*> MesosContainerizer::create(
 #endif // __WINDOWS__
 
 #ifdef __linux__
-    {"cgroups/all", &CgroupsIsolatorProcess::create},
-    {"cgroups/blkio", &CgroupsIsolatorProcess::create},
-    {"cgroups/cpu", &CgroupsIsolatorProcess::create},
-    {"cgroups/cpuset", &CgroupsIsolatorProcess::create},
-    {"cgroups/devices", &CgroupsIsolatorProcess::create},
-    {"cgroups/hugetlb", &CgroupsIsolatorProcess::create},
-    {"cgroups/mem", &CgroupsIsolatorProcess::create},
-    {"cgroups/net_cls", &CgroupsIsolatorProcess::create},
-    {"cgroups/net_prio", &CgroupsIsolatorProcess::create},
-    {"cgroups/perf_event", &CgroupsIsolatorProcess::create},
-    {"cgroups/pids", &CgroupsIsolatorProcess::create},
+    {"cgroups/all", cgroupsCreator},
+    {"cgroups/blkio", cgroupsCreator},
+    {"cgroups/cpu", cgroupsCreator},
+    {"cgroups/cpuset", cgroupsCreator},
+    {"cgroups/devices", cgroupsCreator},
+    {"cgroups/hugetlb", cgroupsCreator},
+    {"cgroups/mem", cgroupsCreator},
+    {"cgroups/net_cls", cgroupsCreator},
+    {"cgroups/net_prio", cgroupsCreator},
+    {"cgroups/perf_event", cgroupsCreator},
+    {"cgroups/pids", cgroupsCreator},
 
     {"appc/runtime", &AppcRuntimeIsolatorProcess::create},
     {"docker/runtime", &DockerRuntimeIsolatorProcess::create},
@@ -507,6 +529,7 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     // Network isolators.
 
 #ifdef __linux__
+    {"network/bandwidth", &NetworkBandwidthIsolatorProcess::create},
     {"network/cni", &NetworkCniIsolatorProcess::create},
 #endif // __linux__
 
@@ -609,7 +632,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
       launcher,
       provisioner,
       isolators,
-      volumeGidManager);
+      volumeGidManager,
+      perfSamples);
 }
 
 
@@ -621,7 +645,8 @@ Try<MesosContainerizer*> MesosContainerizer::create(
     const Owned<Launcher>& launcher,
     const Shared<Provisioner>& provisioner,
     const vector<Owned<Isolator>>& isolators,
-    VolumeGidManager* volumeGidManager)
+    VolumeGidManager* volumeGidManager,
+    const std::shared_ptr<PerfSamples>& perfSamples)
 {
   // Add I/O switchboard to the isolator list.
   //
@@ -681,13 +706,16 @@ Try<MesosContainerizer*> MesosContainerizer::create(
           _isolators,
           volumeGidManager,
           initMemFd,
-          commandExecutorMemFd)));
+          commandExecutorMemFd)),
+      perfSamples);
 }
 
 
 MesosContainerizer::MesosContainerizer(
-    const Owned<MesosContainerizerProcess>& _process)
-  : process(_process)
+    const Owned<MesosContainerizerProcess>& _process,
+    const std::shared_ptr<PerfSamples>& _perfSamples)
+  : process(_process),
+    perfSamples_(_perfSamples)
 {
   spawn(process.get());
 }
@@ -762,6 +790,17 @@ Future<ContainerStatus> MesosContainerizer::status(
 }
 
 
+Future<hashmap<ContainerID, vector<PerfStatistics>>>
+MesosContainerizer::perfSamples()
+{
+  if (perfSamples_.get() == nullptr) {
+    return hashmap<ContainerID, vector<PerfStatistics>>();
+  }
+
+  return perfSamples_->get();
+}
+
+
 Future<Option<ContainerTermination>> MesosContainerizer::wait(
     const ContainerID& containerId)
 {
@@ -815,6 +854,83 @@ Future<Nothing> MesosContainerizer::pruneImages(
 }
 
 
+void MesosContainerizerProcess::initialize()
+{
+  if (flags.container_usage_interval.isSome()) {
+    delay(flags.container_usage_interval.get(),
+          self(),
+          &MesosContainerizerProcess::collectUsage);
+  }
+}
+
+
+Future<hashmap<ContainerID, MesosContainerizerProcess::RuntimeCheckpoint>>
+MesosContainerizerProcess::readRuntimeCheckpoints(
+    const string& runtimeDir,
+    const hashset<ContainerID>& containerIds)
+{
+  vector<vector<ContainerID>> batches(RECOVERY_CHECKPOINT_READERS);
+
+  size_t i = 0;
+  foreach (const ContainerID& containerId, containerIds) {
+    batches[i++ % batches.size()].push_back(containerId);
+  }
+
+  vector<Future<hashmap<ContainerID, RuntimeCheckpoint>>> futures;
+
+  foreach (const vector<ContainerID>& batch, batches) {
+    if (!batch.empty()) {
+      futures.push_back(
+          process::async(&Self::_readRuntimeCheckpoints, runtimeDir, batch));
+    }
+  }
+
+  return collect(futures)
+    .then([](const vector<hashmap<ContainerID, RuntimeCheckpoint>>& results) {
+      hashmap<ContainerID, RuntimeCheckpoint> checkpoints;
+      foreach (const auto& result, results) {
+        checkpoints.insert(result.begin(), result.end());
+      }
+
+      return checkpoints;
+    });
+}
+
+
+hashmap<ContainerID, MesosContainerizerProcess::RuntimeCheckpoint>
+MesosContainerizerProcess::_readRuntimeCheckpoints(
+    const string& runtimeDir,
+    const vector<ContainerID>& containerIds)
+{
+  hashmap<ContainerID, RuntimeCheckpoint> checkpoints;
+
+  foreach (const ContainerID& containerId, containerIds) {
+    RuntimeCheckpoint checkpoint;
+
+    checkpoint.config =
+      containerizer::paths::getContainerConfig(runtimeDir, containerId);
+
+    checkpoint.pid =
+      containerizer::paths::getContainerPid(runtimeDir, containerId);
+
+    checkpoint.launchInfo =
+      containerizer::paths::getContainerLaunchInfo(runtimeDir, containerId);
+
+    checkpoint.terminated = os::exists(path::join(
+        containerizer::paths::getRuntimePath(runtimeDir, containerId),
+        containerizer::paths::TERMINATION_FILE));
+
+    checkpoint.forceDestroyOnRecovery =
+      containerizer::paths::getContainerForceDestroyOnRecovery(
+          runtimeDir, containerId);
+
+    checkpoints.put(containerId, checkpoint);
+  }
+
+  return checkpoints;
+}
+
+
 Future<Nothing> MesosContainerizerProcess::recover(
     const Option<state::SlaveState>& state)
 {
@@ -904,9 +1020,65 @@ Future<Nothing> MesosContainerizerProcess::recover(
     }
   }
 
+  // Gather the containers in the runtime directory.
+  //
+  // NOTE: The returned vector guarantees that parent containers
+  // will always appear before their child containers (if any).
+  // This is particularly important for containers nested underneath
+  // standalone containers, because standalone containers are only
+  // added to the list of recoverable containers in `recoverContainers`,
+  // whereas normal parent containers are added in the prior loop.
+  Try<vector<ContainerID>> containerIds =
+    containerizer::paths::getContainerIds(flags.runtime_dir);
+
+  if (containerIds.isError()) {
+    return Failure(
+        "Failed to get container ids from the runtime directory: " +
+        containerIds.error());
+  }
+
+  hashset<ContainerID> checkpointed;
+
+  foreach (const ContainerState& state, recoverable) {
+    checkpointed.insert(state.container_id());
+  }
+
+  foreach (const ContainerID& containerId, containerIds.get()) {
+    checkpointed.insert(containerId);
+  }
+
+  // The launcher and the isolators share a single read of the mount
+  // table and the cgroups of the containers while they recover.
+  shared_ptr<RecoverySnapshot> snapshot;
+
+#ifdef __linux__
+  snapshot = std::make_shared<RecoverySnapshot>();
+#endif // __linux__
+
+  // The containers are independent, so their checkpointed runtime
+  // information is read concurrently before they are reconciled.
+  return metrics.recovery_checkpoints.time(
+      readRuntimeCheckpoints(flags.runtime_dir, checkpointed))
+    .then(defer(
+        self(),
+        &Self::recoverContainers,
+        recoverable,
+        containerIds.get(),
+        snapshot,
+        lambda::_1));
+}
+
+
+Future<Nothing> MesosContainerizerProcess::recoverContainers(
+    vector<ContainerState> recoverable,
+    const vector<ContainerID>& containerIds,
+    const shared_ptr<RecoverySnapshot>& snapshot,
+    const hashmap<ContainerID, RuntimeCheckpoint>& checkpoints)
+{
   // Recover the containers from 'SlaveState'.
   foreach (ContainerState& state, recoverable) {
     const ContainerID& containerId = state.container_id();
+    const RuntimeCheckpoint& checkpoint = checkpoints.at(containerId);
 
     // Contruct the structure for containers from the 'SlaveState'
     // first, to maintain the children list in the container.
@@ -921,8 +1093,7 @@ Future<Nothing> MesosContainerizerProcess::recover(
     container->directory = state.directory();
 
     // Attempt to read the launch config of the container.
-    Result<ContainerConfig> config =
-      containerizer::paths::getContainerConfig(flags.runtime_dir, containerId);
+    const Result<ContainerConfig>& config = checkpoint.config;
 
     if (config.isError()) {
       return Failure(
@@ -947,32 +1118,17 @@ Future<Nothing> MesosContainerizerProcess::recover(
   // TODO(gilbert): Draw the logic VENN Diagram here in comment.
   hashset<ContainerID> orphans;
 
-  // Recover the containers from the runtime directory.
-  //
-  // NOTE: The returned vector guarantees that parent containers
-  // will always appear before their child containers (if any).
-  // This is particularly important for containers nested underneath
-  // standalone containers, because standalone containers are only
-  // added to the list of recoverable containers in the following loop,
-  // whereas normal parent containers are added in the prior loop.
-  Try<vector<ContainerID>> containerIds =
-    containerizer::paths::getContainerIds(flags.runtime_dir);
-
-  if (containerIds.isError()) {
-    return Failure(
-        "Failed to get container ids from the runtime directory: " +
-        containerIds.error());
-  }
-
   // Reconcile the runtime containers with the containers from
   // `recoverable`. Treat discovered orphans as "known orphans"
   // that we aggregate with any orphans that get returned from
   // calling `launcher->recover`.
-  foreach (const ContainerID& containerId, containerIds.get()) {
+  foreach (const ContainerID& containerId, containerIds) {
     if (containers_.contains(containerId)) {
       continue;
     }
 
+    const RuntimeCheckpoint& checkpoint = checkpoints.at(containerId);
+
     // Determine the sandbox if this is a nested or standalone container.
     const bool isStandaloneContainer =
       containerizer::paths::isStandaloneContainer(
@@ -999,11 +1155,7 @@ Future<Nothing> MesosContainerizerProcess::recover(
     // top-level container. If they have already been destroyed, we
     // checkpoint their termination state, so the existence of this
     // checkpointed information means we can safely ignore them here.
-    const string terminationPath = path::join(
-        containerizer::paths::getRuntimePath(flags.runtime_dir, containerId),
-        containerizer::paths::TERMINATION_FILE);
-
-    if (os::exists(terminationPath)) {
+    if (checkpoint.terminated) {
       CHECK(containerId.has_parent());
 
       // Schedule the sandbox of the terminated nested container for garbage
@@ -1027,16 +1179,14 @@ Future<Nothing> MesosContainerizerProcess::recover(
     // upon exit, which means there is no record of the sandbox directory to GC.
 
     // Attempt to read the pid from the container runtime directory.
-    Result<pid_t> pid =
-      containerizer::paths::getContainerPid(flags.runtime_dir, containerId);
+    const Result<pid_t>& pid = checkpoint.pid;
 
     if (pid.isError()) {
       return Failure("Failed to get container pid: " + pid.error());
     }
 
     // Attempt to read the launch config of the container.
-    Result<ContainerConfig> config =
-      containerizer::paths::getContainerConfig(flags.runtime_dir, containerId);
+    const Result<ContainerConfig>& config = checkpoint.config;
 
     if (config.isError()) {
       return Failure("Failed to get container config: " + config.error());
@@ -1080,8 +1230,7 @@ Future<Nothing> MesosContainerizerProcess::recover(
       containers_.contains(rootContainerId) &&
       !orphans.contains(rootContainerId) &&
       pid.isSome() &&
-      !containerizer::paths::getContainerForceDestroyOnRecovery(
-          flags.runtime_dir, containerId);
+      !checkpoint.forceDestroyOnRecovery;
 
     const bool isRecoverableStandaloneContainer =
       isStandaloneContainer && pid.isSome();
@@ -1115,8 +1264,26 @@ Future<Nothing> MesosContainerizerProcess::recover(
     orphans.insert(containerId);
   }
 
+  // Recover containers' launch information.
+  foreach (const ContainerState& run, recoverable) {
+    const ContainerID& containerId = run.container_id();
+    const Result<ContainerLaunchInfo>& containerLaunchInfo =
+      checkpoints.at(containerId).launchInfo;
+
+    if (containerLaunchInfo.isError()) {
+      return Failure(
+          "Failed to recover launch information of container " +
+          stringify(containerId) + ": " + containerLaunchInfo.error());
+    }
+
+    if (containerLaunchInfo.isSome()) {
+      containers_[containerId]->launchInfo = containerLaunchInfo.get();
+    }
+  }
+
   // Try to recover the launcher first.
-  return launcher->recover(recoverable)
+  return metrics.recovery_launcher.time(
+      launcher->recover(recoverable, snapshot))
     .then(defer(self(), [=](
         const hashset<ContainerID>& launchedOrphans) -> Future<Nothing> {
       // For the extra part of launcher orphans, which are not included
@@ -1137,18 +1304,20 @@ Future<Nothing> MesosContainerizerProcess::recover(
         _orphans.insert(containerId);
       }
 
-      return _recover(recoverable, _orphans);
+      return _recover(recoverable, _orphans, snapshot);
     }));
 }
 
 
 Future<Nothing> MesosContainerizerProcess::_recover(
     const vector<ContainerState>& recoverable,
-    const hashset<ContainerID>& orphans)
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   // Recover isolators first then recover the provisioner, because of
   // possible cleanups on unknown containers.
-  return recoverIsolators(recoverable, orphans)
+  return metrics.recovery_isolators.time(
+      recoverIsolators(recoverable, orphans, snapshot))
     .then(defer(self(), &Self::recoverProvisioner, recoverable, orphans))
     .then(defer(self(), &Self::__recover, recoverable, orphans));
 }
@@ -1156,7 +1325,8 @@ Future<Nothing> MesosContainerizerProcess::_recover(
 
 Future<vector<Nothing>> MesosContainerizerProcess::recoverIsolators(
     const vector<ContainerState>& recoverable,
-    const hashset<ContainerID>& orphans)
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   LOG(INFO) << "Recovering isolators";
 
@@ -1185,7 +1355,24 @@ Future<vector<Nothing>> MesosContainerizerProcess::recoverIsolators(
       }
     }
 
-    futures.push_back(isolator->recover(_recoverable, _orphans));
+    // The isolators of the Mesos containerizer may read the state of
+    // the host from the snapshot, whereas isolator modules can only
+    // be recovered without it.
+    IsolatorTracker* tracker =
+      dynamic_cast<IsolatorTracker*>(isolator.get());
+
+    MesosIsolator* mesosIsolator =
+      dynamic_cast<MesosIsolator*>(isolator.get());
+
+    if (tracker != nullptr) {
+      futures.push_back(
+          tracker->recoverFromSnapshot(_recoverable, _orphans, snapshot));
+    } else if (mesosIsolator != nullptr) {
+      futures.push_back(
+          mesosIsolator->recoverFromSnapshot(_recoverable, _orphans, snapshot));
+    } else {
+      futures.push_back(isolator->recover(_recoverable, _orphans));
+    }
   }
 
   // If all isolators recover then continue.
@@ -1207,7 +1394,8 @@ Future<Nothing> MesosContainerizerProcess::recoverProvisioner(
     knownContainerIds.insert(state.container_id());
   }
 
-  return provisioner->recover(knownContainerIds);
+  return metrics.recovery_provisioner.time(
+      provisioner->recover(knownContainerIds));
 }
 
 
@@ -1215,26 +1403,6 @@ Future<Nothing> MesosContainerizerProcess::__recover(
     const vector<ContainerState>& recovered,
     const hashset<ContainerID>& orphans)
 {
-  // Recover containers' launch information.
-  foreach (const ContainerState& run, recovered) {
-    const ContainerID& containerId = run.container_id();
-
-    // Attempt to read container's launch information.
-    Result<ContainerLaunchInfo> containerLaunchInfo =
-      containerizer::paths::getContainerLaunchInfo(
-          flags.runtime_dir, containerId);
-
-    if (containerLaunchInfo.isError()) {
-      return Failure(
-          "Failed to recover launch information of container " +
-          stringify(containerId) + ": " + containerLaunchInfo.error());
-    }
-
-    if (containerLaunchInfo.isSome()) {
-      containers_[containerId]->launchInfo = containerLaunchInfo.get();
-    }
-  }
-
   foreach (const ContainerState& run, recovered) {
     const ContainerID& containerId = run.container_id();
 
@@ -2431,6 +2599,8 @@ Future<Nothing> MesosContainerizerProcess::update(
   // NOTE: We update container's resources before isolators are updated
   // so that subsequent containerizer->update can be handled properly.
   container->resources = resources;
+  container->usage = None();
+  container->usageGeneration++;
 
   // Update each isolator.
   vector<Future<Nothing>> futures;
@@ -2499,6 +2669,88 @@ Future<ResourceStatistics> MesosContainerizerProcess::usage(
     return Failure("Unknown container " + stringify(containerId));
   }
 
+  // Serve the request from the last sample taken by `collectUsage()`
+  // as long as it is not too stale, which avoids sampling the isolators
+  // (i.e. reading cgroup files) for each consumer of the statistics.
+  // The staleness is bounded by twice the interval since the next sample
+  // is taken one interval after the previous one completes.
+  const Option<ResourceStatistics>& sample =
+    containers_.at(containerId)->usage;
+
+  if (flags.container_usage_interval.isSome() && sample.isSome()) {
+    const double staleness = Clock::now().secs() - sample->timestamp();
+
+    if (staleness <= (flags.container_usage_interval.get() * 2).secs()) {
+      return sample.get();
+    }
+  }
+
+  return sampleUsage(containerId);
+}
+
+
+void MesosContainerizerProcess::collectUsage()
+{
+  vector<ContainerID> containerIds;
+  vector<uint64_t> generations;
+  vector<Future<ResourceStatistics>> futures;
+
+  foreachpair (const ContainerID& containerId,
+               const Owned<Container>& container,
+               containers_) {
+    if (container->state != RUNNING) {
+      continue;
+    }
+
+    containerIds.push_back(containerId);
+    generations.push_back(container->usageGeneration);
+
+    // A hung isolator must neither hold back the samples of the other
+    // containers nor stop the periodic collection, so each sample is
+    // bounded by the collection interval.
+    futures.push_back(sampleUsage(containerId)
+      .after(flags.container_usage_interval.get(),
+             [containerId](Future<ResourceStatistics> sample) {
+               sample.discard();
+
+               LOG(WARNING) << "Timed out sampling the resource usage of "
+                            << "container " << containerId;
+
+               return Failure("Timed out");
+             }));
+  }
+
+  metrics.container_usage_collection.time(await(futures))
+    .onAny(defer(self(), [=](
+        const Future<vector<Future<ResourceStatistics>>>& samples) {
+      if (samples.isReady()) {
+        for (size_t i = 0; i < containerIds.size(); i++) {
+          const ContainerID& containerId = containerIds[i];
+          const Future<ResourceStatistics>& sample = samples->at(i);
+
+          // The container might have been destroyed meanwhile, or
+          // updated, in which case the sample holds the old limits.
+          if (sample.isReady() &&
+              containers_.contains(containerId) &&
+              containers_.at(containerId)->usageGeneration ==
+                generations[i]) {
+            containers_.at(containerId)->usage = sample.get();
+          }
+        }
+      }
+
+      delay(flags.container_usage_interval.get(),
+            self(),
+            &MesosContainerizerProcess::collectUsage);
+    }));
+}
+
+
+Future<ResourceStatistics> MesosContainerizerProcess::sampleUsage(
+    const ContainerID& containerId)
+{
+  CHECK(containers_.contains(containerId));
+
   vector<Future<ResourceStatistics>> futures;
   foreach (const Owned<Isolator>& isolator, isolators) {
     if (!isSupportedByIsolator(
@@ -3261,15 +3513,32 @@ ContainerClass MesosContainerizerProcess::Container::containerClass()
 
 MesosContainerizerProcess::Metrics::Metrics()
   : container_destroy_errors(
-        "containerizer/mesos/container_destroy_errors")
+        "containerizer/mesos/container_destroy_errors"),
+    container_usage_collection(
+        "containerizer/mesos/container_usage_collection",
+        Hours(1)),
+    recovery_checkpoints("containerizer/mesos/recovery/checkpoints"),
+    recovery_launcher("containerizer/mesos/recovery/launcher"),
+    recovery_isolators("containerizer/mesos/recovery/isolators"),
+    recovery_provisioner("containerizer/mesos/recovery/provisioner")
 {
   process::metrics::add(container_destroy_errors);
+  process::metrics::add(container_usage_collection);
+  process::metrics::add(recovery_checkpoints);
+  process::metrics::add(recovery_launcher);
+  process::metrics::add(recovery_isolators);
+  process::metrics::add(recovery_provisioner);
 }
 
 
 MesosContainerizerProcess::Metrics::~Metrics()
 {
   process::metrics::remove(container_destroy_errors);
+  process::metrics::remove(container_usage_collection);
+  process::metrics::remove(recovery_checkpoints);
+  process::metrics::remove(recovery_launcher);
+  process::metrics::remove(recovery_isolators);
+  process::metrics::remove(recovery_provisioner);
 }
 
 
@@ -17,6 +17,7 @@
 #ifndef __MESOS_CONTAINERIZER_HPP__
 #define __MESOS_CONTAINERIZER_HPP__
 
+#include <memory>
 #include <vector>
 
 #include <mesos/secret/resolver.hpp>
@@ -31,7 +32,9 @@
 #include <process/time.hpp>
 
 #include <process/metrics/counter.hpp>
+#include <process/metrics/timer.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/multihashmap.hpp>
 #include <stout/os/int_fd.hpp>
@@ -42,6 +45,7 @@
 #include "slave/containerizer/containerizer.hpp"
 
 #include "slave/containerizer/mesos/launcher.hpp"
+#include "slave/containerizer/mesos/perf_samples.hpp"
 
 #include "slave/containerizer/mesos/io/switchboard.hpp"
 
@@ -85,7 +89,8 @@ public:
       const process::Owned<Launcher>& launcher,
       const process::Shared<Provisioner>& provisioner,
       const std::vector<process::Owned<mesos::slave::Isolator>>& isolators,
-      VolumeGidManager* volumeGidManager = nullptr);
+      VolumeGidManager* volumeGidManager = nullptr,
+      const std::shared_ptr<PerfSamples>& perfSamples = nullptr);
 
   ~MesosContainerizer() override;
 
@@ -111,6 +116,9 @@ public:
   process::Future<ContainerStatus> status(
       const ContainerID& containerId) override;
 
+  process::Future<hashmap<ContainerID, std::vector<PerfStatistics>>>
+  perfSamples() override;
+
   process::Future<Option<mesos::slave::ContainerTermination>> wait(
       const ContainerID& containerId) override;
 
@@ -129,10 +137,15 @@ public:
       const std::vector<Image>& excludedImages) override;
 
 private:
-  explicit MesosContainerizer(
-      const process::Owned<MesosContainerizerProcess>& process);
+  MesosContainerizer(
+      const process::Owned<MesosContainerizerProcess>& process,
+      const std::shared_ptr<PerfSamples>& perfSamples);
 
   process::Owned<MesosContainerizerProcess> process;
+
+  // The perf samples of the containers, which are read directly rather
+  // than through `process`, see `PerfSamples`.
+  const std::shared_ptr<PerfSamples> perfSamples_;
 };
 
 
@@ -183,6 +196,8 @@ public:
     }
   }
 
+  void initialize() override;
+
   virtual process::Future<Nothing> recover(
       const Option<state::SlaveState>& state);
 
@@ -241,13 +256,45 @@ private:
 
   friend std::ostream& operator<<(std::ostream& stream, const State& state);
 
+  // The information checkpointed in the runtime directory of a
+  // container, see `containerizer::paths`.
+  struct RuntimeCheckpoint
+  {
+    Result<mesos::slave::ContainerConfig> config = None();
+    Result<pid_t> pid = None();
+    Result<mesos::slave::ContainerLaunchInfo> launchInfo = None();
+    bool terminated = false;
+    bool forceDestroyOnRecovery = false;
+  };
+
+  // Reads the runtime checkpoints of the given containers, spread over
+  // up to `RECOVERY_CHECKPOINT_READERS` concurrent readers.
+  static process::Future<hashmap<ContainerID, RuntimeCheckpoint>>
+  readRuntimeCheckpoints(
+      const std::string& runtimeDir,
+      const hashset<ContainerID>& containerIds);
+
+  static hashmap<ContainerID, RuntimeCheckpoint> _readRuntimeCheckpoints(
+      const std::string& runtimeDir,
+      const std::vector<ContainerID>& containerIds);
+
+  // Reconciles the containers checkpointed by the agent with those in
+  // the runtime directory, and recovers the launcher.
+  process::Future<Nothing> recoverContainers(
+      std::vector<mesos::slave::ContainerState> recoverable,
+      const std::vector<ContainerID>& containerIds,
+      const std::shared_ptr<RecoverySnapshot>& snapshot,
+      const hashmap<ContainerID, RuntimeCheckpoint>& checkpoints);
+
   process::Future<Nothing> _recover(
       const std::vector<mesos::slave::ContainerState>& recoverable,
-      const hashset<ContainerID>& orphans);
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot);
 
   process::Future<std::vector<Nothing>> recoverIsolators(
       const std::vector<mesos::slave::ContainerState>& recoverable,
-      const hashset<ContainerID>& orphans);
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot);
 
   process::Future<Nothing> recoverProvisioner(
       const std::vector<mesos::slave::ContainerState>& recoverable,
@@ -336,6 +383,14 @@ private:
   process::Future<std::vector<process::Future<Nothing>>> cleanupIsolators(
       const ContainerID& containerId);
 
+  // Samples the resource usage of a container from the isolators.
+  process::Future<ResourceStatistics> sampleUsage(
+      const ContainerID& containerId);
+
+  // Periodically samples the resource usage of all running containers
+  // when `--container_usage_interval` is set, see `usage()`.
+  void collectUsage();
+
   const Flags flags;
   Fetcher* fetcher;
 
@@ -405,6 +460,15 @@ private:
     // the ResourceStatistics limits in usage().
     Resources resources;
 
+    // The last resource usage sampled by `collectUsage()`. It is reset
+    // when the resources of the container are updated, since the limits
+    // in the sample would be stale.
+    Option<ResourceStatistics> usage;
+
+    // Bumped whenever `usage` is reset, so that `collectUsage()` drops
+    // the samples it started taking before the reset.
+    uint64_t usageGeneration = 0;
+
     // The configuration for the container to be launched.
     // This can only be None if the underlying container is launched
     // before we checkpoint `ContainerConfig` in MESOS-6894.
@@ -456,6 +520,18 @@ private:
     ~Metrics();
 
     process::metrics::Counter container_destroy_errors;
+
+    // The time it takes to sample the resource usage of all running
+    // containers when `--container_usage_interval` is set.
+    process::metrics::Timer<Milliseconds> container_usage_collection;
+
+    // The time spent in each phase of the recovery: reading the runtime
+    // checkpoints of the containers, and recovering the launcher, the
+    // isolators and the provisioner.
+    process::metrics::Timer<Milliseconds> recovery_checkpoints;
+    process::metrics::Timer<Milliseconds> recovery_launcher;
+    process::metrics::Timer<Milliseconds> recovery_isolators;
+    process::metrics::Timer<Milliseconds> recovery_provisioner;
   } metrics;
 };
 
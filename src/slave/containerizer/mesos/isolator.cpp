@@ -20,6 +20,7 @@
 
 using namespace process;
 
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -69,6 +70,19 @@ Future<Nothing> MesosIsolator::recover(
 }
 
 
+Future<Nothing> MesosIsolator::recoverFromSnapshot(
+    const vector<ContainerState>& state,
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
+{
+  return dispatch(process.get(),
+                  &MesosIsolatorProcess::recoverFromSnapshot,
+                  state,
+                  orphans,
+                  snapshot);
+}
+
+
 Future<Option<ContainerLaunchInfo>> MesosIsolator::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
@@ -17,6 +17,9 @@
 #ifndef __ISOLATOR_HPP__
 #define __ISOLATOR_HPP__
 
+#include <memory>
+#include <vector>
+
 #include <mesos/slave/isolator.hpp>
 
 #include <process/owned.hpp>
@@ -28,8 +31,9 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
-// Forward declaration.
+// Forward declarations.
 class MesosIsolatorProcess;
+class RecoverySnapshot;
 
 
 // A wrapper class that implements the 'Isolator' interface which is
@@ -48,6 +52,12 @@ public:
       const std::vector<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans) override;
 
+  // See `MesosIsolatorProcess::recoverFromSnapshot`.
+  process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot);
+
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const mesos::slave::ContainerConfig& containerConfig) override;
@@ -99,6 +109,19 @@ public:
     return Nothing();
   }
 
+  // Recovers the isolator like `recover`, when the containerizer
+  // recovers. The isolators which check the recovered containers
+  // against the state of the host, e.g., the mount table or the
+  // cgroups, read it from the `snapshot`, which is shared with the
+  // launcher and the other isolators, and which is only set on Linux.
+  virtual process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot)
+  {
+    return recover(states, orphans);
+  }
+
   virtual process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const mesos::slave::ContainerConfig& containerConfig)
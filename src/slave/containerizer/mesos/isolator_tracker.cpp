@@ -20,6 +20,7 @@
 
 #include "slave/containerizer/mesos/isolator_tracker.hpp"
 
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -68,6 +69,23 @@ Future<Nothing> IsolatorTracker::recover(
 }
 
 
+Future<Nothing> IsolatorTracker::recoverFromSnapshot(
+    const vector<ContainerState>& state,
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
+{
+  MesosIsolator* mesosIsolator =
+    dynamic_cast<MesosIsolator*>(isolator.get());
+
+  return tracker->track(
+      mesosIsolator != nullptr
+        ? mesosIsolator->recoverFromSnapshot(state, orphans, snapshot)
+        : isolator->recover(state, orphans),
+      strings::format("%s::recover", isolatorName).get(),
+      COMPONENT_NAME_CONTAINERIZER);
+}
+
+
 Future<Option<ContainerLaunchInfo>> IsolatorTracker::prepare(
     const ContainerID& containerId,
     const ContainerConfig& containerConfig)
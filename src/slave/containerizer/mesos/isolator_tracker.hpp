@@ -17,11 +17,15 @@
 #ifndef __ISOLATOR_TRACKER_HPP__
 #define __ISOLATOR_TRACKER_HPP__
 
+#include <memory>
+
 #include <mesos/slave/isolator.hpp>
 
 #include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include "slave/containerizer/mesos/isolator.hpp"
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -41,6 +45,15 @@ public:
       const std::vector<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans) override;
 
+  // Recovers the tracked isolator, see
+  // `MesosIsolatorProcess::recoverFromSnapshot`. Isolators which are not
+  // backed by a `MesosIsolatorProcess`, e.g., isolator modules, are
+  // recovered without the snapshot.
+  process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot);
+
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const mesos::slave::ContainerConfig& containerConfig) override;
@@ -32,14 +32,17 @@
 #include "common/protobuf_utils.hpp"
 
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 #include "linux/fs.hpp"
 #include "linux/ns.hpp"
 #include "linux/systemd.hpp"
 
 #include "slave/containerizer/mesos/constants.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/cgroups.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups/cgroups2.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
 
 using mesos::internal::protobuf::slave::containerSymlinkOperation;
@@ -57,6 +60,7 @@ using process::Owned;
 using process::PID;
 
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -75,8 +79,24 @@ CgroupsIsolatorProcess::CgroupsIsolatorProcess(
 CgroupsIsolatorProcess::~CgroupsIsolatorProcess() {}
 
 
-Try<Isolator*> CgroupsIsolatorProcess::create(const Flags& flags)
+Try<Isolator*> CgroupsIsolatorProcess::create(
+    const Flags& flags,
+    const std::shared_ptr<PerfSamples>& perfSamples)
 {
+  // On the cgroups v2 unified hierarchy all the controllers share a
+  // single cgroup per container, which is managed by a separate
+  // isolator rather than by per-hierarchy `Subsystem`s.
+  Try<bool> unified = cgroups2::mounted(flags.cgroups_hierarchy);
+  if (unified.isError()) {
+    return Error(
+        "Failed to determine the cgroups version of " +
+        flags.cgroups_hierarchy + ": " + unified.error());
+  }
+
+  if (unified.get()) {
+    return Cgroups2IsolatorProcess::create(flags);
+  }
+
   // Hierarchy path -> subsystem object.
   multihashmap<string, Owned<Subsystem>> subsystems;
 
@@ -168,7 +188,7 @@ Try<Isolator*> CgroupsIsolatorProcess::create(const Flags& flags)
 
     // Create and load the subsystem.
     Try<Owned<Subsystem>> subsystem =
-      Subsystem::create(flags, subsystemName, hierarchy.get());
+      Subsystem::create(flags, subsystemName, hierarchy.get(), perfSamples);
 
     if (subsystem.isError()) {
       return Error(
@@ -202,6 +222,23 @@ Future<Nothing> CgroupsIsolatorProcess::recover(
     const vector<ContainerState>& states,
     const hashset<ContainerID>& orphans)
 {
+  return recoverFromSnapshot(
+      states, orphans, std::make_shared<RecoverySnapshot>());
+}
+
+
+Future<Nothing> CgroupsIsolatorProcess::recoverFromSnapshot(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
+{
+  // List the cgroups in each hierarchy up front, so that the checks for
+  // the cgroups of the active containers below are served from the
+  // snapshot. Errors are reported when listing the orphans.
+  foreach (const string& hierarchy, subsystems.keys()) {
+    snapshot->cgroups(hierarchy, flags.cgroups_root);
+  }
+
   // Recover active containers first.
   vector<Future<Nothing>> recovers;
   foreach (const ContainerState& state, states) {
@@ -212,7 +249,7 @@ Future<Nothing> CgroupsIsolatorProcess::recover(
       continue;
     }
 
-    recovers.push_back(___recover(state.container_id()));
+    recovers.push_back(___recover(state.container_id(), snapshot));
   }
 
   return await(recovers)
@@ -220,12 +257,14 @@ Future<Nothing> CgroupsIsolatorProcess::recover(
         PID<CgroupsIsolatorProcess>(this),
         &CgroupsIsolatorProcess::_recover,
         orphans,
+        snapshot,
         lambda::_1));
 }
 
 
 Future<Nothing> CgroupsIsolatorProcess::_recover(
     const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot,
     const vector<Future<Nothing>>& futures)
 {
   vector<string> errors;
@@ -248,7 +287,7 @@ Future<Nothing> CgroupsIsolatorProcess::_recover(
 
   foreach (const string& hierarchy, subsystems.keys()) {
     // TODO(jieyu): Use non-recursive version of `cgroups::get`.
-    Try<vector<string>> cgroups = cgroups::get(
+    Try<vector<string>> cgroups = snapshot->cgroups(
         hierarchy,
         flags.cgroups_root);
 
@@ -285,11 +324,11 @@ Future<Nothing> CgroupsIsolatorProcess::_recover(
   vector<Future<Nothing>> recovers;
 
   foreach (const ContainerID& containerId, knownOrphans) {
-    recovers.push_back(___recover(containerId));
+    recovers.push_back(___recover(containerId, snapshot));
   }
 
   foreach (const ContainerID& containerId, unknownOrphans) {
-    recovers.push_back(___recover(containerId));
+    recovers.push_back(___recover(containerId, snapshot));
   }
 
   return await(recovers)
@@ -332,7 +371,8 @@ Future<Nothing> CgroupsIsolatorProcess::__recover(
 
 
 Future<Nothing> CgroupsIsolatorProcess::___recover(
-    const ContainerID& containerId)
+    const ContainerID& containerId,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   const string cgroup = path::join(flags.cgroups_root, containerId.value());
 
@@ -341,7 +381,7 @@ Future<Nothing> CgroupsIsolatorProcess::___recover(
 
   // TODO(haosdent): Use foreachkey once MESOS-5037 is resolved.
   foreach (const string& hierarchy, subsystems.keys()) {
-    if (!cgroups::exists(hierarchy, cgroup)) {
+    if (!snapshot->exists(hierarchy, cgroup)) {
       // This may occur in two cases:
       // 1. If the executor has exited and the isolator has destroyed
       //    the cgroup but the agent dies before noticing this. This
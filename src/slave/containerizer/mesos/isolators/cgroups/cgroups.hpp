@@ -17,6 +17,7 @@
 #ifndef __CGROUPS_ISOLATOR_HPP__
 #define __CGROUPS_ISOLATOR_HPP__
 
+#include <memory>
 #include <string>
 
 #include <mesos/resources.hpp>
@@ -34,6 +35,7 @@
 #include "slave/flags.hpp"
 
 #include "slave/containerizer/mesos/isolator.hpp"
+#include "slave/containerizer/mesos/perf_samples.hpp"
 
 #include "slave/containerizer/mesos/isolators/cgroups/subsystem.hpp"
 
@@ -46,7 +48,9 @@ namespace slave {
 class CgroupsIsolatorProcess : public MesosIsolatorProcess
 {
 public:
-  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+  static Try<mesos::slave::Isolator*> create(
+      const Flags& flags,
+      const std::shared_ptr<PerfSamples>& perfSamples);
 
   ~CgroupsIsolatorProcess() override;
 
@@ -57,6 +61,11 @@ public:
       const std::vector<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans) override;
 
+  process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
+
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const mesos::slave::ContainerConfig& containerConfig) override;
@@ -106,6 +115,7 @@ private:
 
   process::Future<Nothing> _recover(
       const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot,
       const std::vector<process::Future<Nothing>>& futures);
 
   process::Future<Nothing> __recover(
@@ -113,7 +123,8 @@ private:
       const std::vector<process::Future<Nothing>>& futures);
 
   process::Future<Nothing> ___recover(
-      const ContainerID& containerId);
+      const ContainerID& containerId,
+      const std::shared_ptr<RecoverySnapshot>& snapshot);
 
   process::Future<Nothing> ____recover(
       const ContainerID& containerId,
@@ -0,0 +1,1007 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sched.h>
+
+#include <sys/mount.h>
+
+// This header include must be enclosed in an `extern "C"` block to
+// workaround a bug in glibc <= 2.12 (see MESOS-7378).
+//
+// TODO(gilbert): Remove this when we no longer support glibc <= 2.12.
+extern "C" {
+#include <sys/sysmacros.h>
+}
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/id.hpp>
+#include <process/pid.hpp>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "linux/cgroups2.hpp"
+
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups/cgroups2.hpp"
+#include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerLimitation;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::PID;
+
+using std::ostringstream;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+static void setPressure(
+    const cgroups2::pressure::Pressure& pressure,
+    PressureStallStatistics* statistics)
+{
+  auto setStall = [](
+      const cgroups2::pressure::Stall& stall,
+      PressureStallStatistics::Stall* _stall) {
+    _stall->set_avg10(stall.avg10);
+    _stall->set_avg60(stall.avg60);
+    _stall->set_avg300(stall.avg300);
+    _stall->set_total_secs(stall.total.secs());
+  };
+
+  setStall(pressure.some, statistics->mutable_some());
+
+  if (pressure.full.isSome()) {
+    setStall(pressure.full.get(), statistics->mutable_full());
+  }
+}
+
+
+Cgroups2IsolatorProcess::Cgroups2IsolatorProcess(
+    const Flags& _flags,
+    const set<string>& _controllers)
+  : ProcessBase(process::ID::generate("cgroups2-isolator")),
+    flags(_flags),
+    controllers(_controllers) {}
+
+
+Try<Isolator*> Cgroups2IsolatorProcess::create(const Flags& flags)
+{
+  // Isolator name -> controller.
+  const hashmap<string, string> isolatorMap = {
+    {"blkio", "io"},
+    {"cpu", "cpu"},
+    {"mem", "memory"},
+    {"pids", "pids"},
+  };
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+
+  Try<set<string>> available =
+    cgroups2::controllers::available(hierarchy, "/");
+
+  if (available.isError()) {
+    return Error(
+        "Failed to get the available controllers: " + available.error());
+  }
+
+  // The controllers to be enabled.
+  set<string> controllers;
+
+  if (strings::contains(flags.isolation, "cgroups/all")) {
+    foreachvalue (const string& controller, isolatorMap) {
+      if (available->count(controller) > 0) {
+        controllers.insert(controller);
+      }
+    }
+
+    if (controllers.empty()) {
+      return Error("No supported controllers are available in the kernel");
+    }
+
+    LOG(INFO) << "Automatically loading controllers: "
+              << stringify(controllers);
+  } else {
+    foreach (string isolator, strings::tokenize(flags.isolation, ",")) {
+      if (!strings::startsWith(isolator, "cgroups/")) {
+        // Skip when the isolator is not related to cgroups.
+        continue;
+      }
+
+      isolator = strings::remove(isolator, "cgroups/", strings::Mode::PREFIX);
+
+      if (!isolatorMap.contains(isolator)) {
+        return Error(
+            "Isolator 'cgroups/" + isolator + "' is not supported on the "
+            "cgroups v2 unified hierarchy");
+      }
+
+      const string& controller = isolatorMap.at(isolator);
+
+      if (available->count(controller) == 0) {
+        return Error(
+            "The '" + controller + "' controller required by isolator "
+            "'cgroups/" + isolator + "' is not available");
+      }
+
+      controllers.insert(controller);
+    }
+  }
+
+  CHECK(!controllers.empty());
+
+  if (!cgroups2::exists(hierarchy, flags.cgroups_root)) {
+    Try<Nothing> create =
+      cgroups2::create(hierarchy, flags.cgroups_root, true);
+
+    if (create.isError()) {
+      return Error("Failed to create the cgroups root: " + create.error());
+    }
+  }
+
+  // A controller is only available in a cgroup if it is enabled in
+  // the 'cgroup.subtree_control' of all of its ancestors, so enable
+  // the controllers from the hierarchy root down to the cgroups root,
+  // whose children are the cgroups of the containers.
+  vector<string> cgroups = {"/"};
+
+  foreach (const string& token, strings::tokenize(flags.cgroups_root, "/")) {
+    cgroups.push_back(path::join(cgroups.back(), token));
+  }
+
+  foreach (const string& cgroup, cgroups) {
+    Try<set<string>> enabled =
+      cgroups2::controllers::enabled(hierarchy, cgroup);
+
+    if (enabled.isError()) {
+      return Error(
+          "Failed to get the enabled controllers of cgroup '" + cgroup +
+          "': " + enabled.error());
+    }
+
+    set<string> missing;
+    std::set_difference(
+        controllers.begin(),
+        controllers.end(),
+        enabled->begin(),
+        enabled->end(),
+        std::inserter(missing, missing.begin()));
+
+    if (missing.empty()) {
+      continue;
+    }
+
+    Try<Nothing> enable =
+      cgroups2::controllers::enable(hierarchy, cgroup, missing);
+
+    if (enable.isError()) {
+      return Error(
+          "Failed to enable controllers in cgroup '" + cgroup + "': " +
+          enable.error());
+    }
+  }
+
+  Owned<MesosIsolatorProcess> process(
+      new Cgroups2IsolatorProcess(flags, controllers));
+
+  return new MesosIsolator(process);
+}
+
+
+bool Cgroups2IsolatorProcess::supportsNesting()
+{
+  return true;
+}
+
+
+bool Cgroups2IsolatorProcess::supportsStandalone()
+{
+  return true;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::recover(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  return recoverFromSnapshot(
+      states, orphans, std::make_shared<RecoverySnapshot>());
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::recoverFromSnapshot(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
+{
+  // List the cgroups up front, so that the checks for the cgroups of
+  // the active containers below are served from the snapshot.
+  Try<vector<string>> cgroups =
+    snapshot->cgroups(flags.cgroups_hierarchy, flags.cgroups_root, true);
+
+  if (cgroups.isError()) {
+    return Failure(
+        "Failed to list cgroups under '" + flags.cgroups_root + "': " +
+        cgroups.error());
+  }
+
+  foreach (const ContainerState& state, states) {
+    // Only top-level containers have cgroups created for them.
+    if (state.container_id().has_parent()) {
+      continue;
+    }
+
+    const ContainerID& containerId = state.container_id();
+    const string cgroup = path::join(flags.cgroups_root, containerId.value());
+
+    if (!snapshot->exists(flags.cgroups_hierarchy, cgroup)) {
+      // This may occur if the executor has exited and the isolator
+      // has destroyed the cgroup but the agent dies before noticing
+      // this. This will be detected when the containerizer tries to
+      // monitor the executor's pid.
+      LOG(WARNING) << "Couldn't find the cgroup '" << cgroup << "' "
+                   << "for container " << containerId;
+    }
+
+    infos[containerId] = Owned<Info>(new Info(containerId, cgroup));
+  }
+
+  hashset<ContainerID> unknownOrphans;
+
+  foreach (const string& cgroup, cgroups.get()) {
+    // Only the children of the cgroups root belong to containers.
+    if (Path(cgroup).dirname() != strings::trim(flags.cgroups_root, "/")) {
+      continue;
+    }
+
+    // Ignore the slave cgroup (see the --slave_subsystems flag).
+    if (cgroup == path::join(flags.cgroups_root, "slave")) {
+      continue;
+    }
+
+    ContainerID containerId;
+    containerId.set_value(Path(cgroup).basename());
+
+    if (infos.contains(containerId)) {
+      continue;
+    }
+
+    infos[containerId] = Owned<Info>(new Info(containerId, cgroup));
+
+    if (!orphans.contains(containerId)) {
+      unknownOrphans.insert(containerId);
+    }
+  }
+
+  // Known orphan cgroups will be destroyed by the containerizer using
+  // the normal cleanup path. See MESOS-2367 for details.
+  foreach (const ContainerID& containerId, unknownOrphans) {
+    LOG(INFO) << "Cleaning up unknown orphaned container " << containerId;
+    cleanup(containerId);
+  }
+
+  return Nothing();
+}
+
+
+Future<Option<ContainerLaunchInfo>> Cgroups2IsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ContainerConfig& containerConfig)
+{
+  // Only prepare cgroups for top-level containers. Nested container
+  // will inherit cgroups from its root container, so here we just
+  // need to do the container-specific cgroups mounts.
+  if (containerId.has_parent()) {
+    return _prepare(containerId, containerConfig);
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+  const string cgroup = path::join(flags.cgroups_root, containerId.value());
+  const string path = path::join(hierarchy, cgroup);
+
+  if (cgroups2::exists(hierarchy, cgroup)) {
+    return Failure("The cgroup at '" + path + "' already exists");
+  }
+
+  // We save 'Info' into 'infos' first so that even if 'prepare'
+  // fails, we can properly cleanup the *side effects* created below.
+  infos[containerId] = Owned<Info>(new Info(containerId, cgroup));
+
+  VLOG(1) << "Creating cgroup at '" << path << "' "
+          << "for container " << containerId;
+
+  Try<Nothing> create = cgroups2::create(hierarchy, cgroup);
+  if (create.isError()) {
+    return Failure(
+        "Failed to create the cgroup at '" + path + "': " + create.error());
+  }
+
+  // Chown the cgroup so the executor can create nested cgroups. Do
+  // not recurse so the control files are still owned by the agent
+  // user and thus cannot be changed by the executor.
+  //
+  // NOTE: See `CgroupsIsolatorProcess::prepare` for the user of a
+  // command task with a rootfs.
+  if (containerConfig.has_user()) {
+    Option<string> user;
+    if (containerConfig.has_task_info() && containerConfig.has_rootfs()) {
+      if (containerConfig.task_info().command().has_user()) {
+        user = containerConfig.task_info().command().user();
+      }
+    } else {
+      user = containerConfig.user();
+    }
+
+    if (user.isSome()) {
+      VLOG(1) << "Chown the cgroup at '" << path << "' to user "
+              << "'" << user.get() << "' for container " << containerId;
+
+      Try<Nothing> chown = os::chown(user.get(), path, false);
+      if (chown.isError()) {
+        return Failure(
+            "Failed to chown the cgroup at '" + path + "' "
+            "to user '" + user.get() + "': " + chown.error());
+      }
+    }
+  }
+
+  if (controllers.count("memory") > 0) {
+    // Kill all the processes of the container upon an OOM rather than
+    // a single one, which mirrors how the memory subsystem reports the
+    // OOM as a limitation of the whole container.
+    Try<Nothing> write =
+      cgroups2::write(hierarchy, cgroup, "memory.oom.group", "1");
+
+    if (write.isError()) {
+      return Failure("Failed to set 'memory.oom.group': " + write.error());
+    }
+
+    // Swap is only accounted if the kernel is built with swap
+    // accounting, in which case the memory limit also bounds swap.
+    if (flags.cgroups_limit_swap &&
+        os::exists(path::join(path, "memory.swap.max"))) {
+      write = cgroups2::write(hierarchy, cgroup, "memory.swap.max", "0");
+
+      if (write.isError()) {
+        return Failure("Failed to set 'memory.swap.max': " + write.error());
+      }
+    }
+  }
+
+  return update(containerId, containerConfig.resources())
+    .then(defer(
+        PID<Cgroups2IsolatorProcess>(this),
+        &Cgroups2IsolatorProcess::_prepare,
+        containerId,
+        containerConfig));
+}
+
+
+Future<Option<ContainerLaunchInfo>> Cgroups2IsolatorProcess::_prepare(
+    const ContainerID& containerId,
+    const ContainerConfig& containerConfig)
+{
+  // We will do container-specific cgroups mounts
+  // only for the container with rootfs.
+  if (!containerConfig.has_rootfs()) {
+    return None();
+  }
+
+  const ContainerID rootContainerId = protobuf::getRootContainerId(containerId);
+
+  CHECK(infos.contains(rootContainerId));
+
+  // Since all the controllers (including the cgroups of the Linux
+  // launcher) share one hierarchy, a single mount of the cgroup of the
+  // root container suffices, e.g.:
+  //   mount --bind /sys/fs/cgroup/mesos/<containerId> /sys/fs/cgroup
+  ContainerLaunchInfo launchInfo;
+  launchInfo.add_clone_namespaces(CLONE_NEWNS);
+
+  *launchInfo.add_mounts() = protobuf::slave::createContainerMount(
+      path::join(flags.cgroups_hierarchy, infos[rootContainerId]->cgroup),
+      path::join(containerConfig.rootfs(), "/sys/fs/cgroup"),
+      MS_BIND | MS_REC);
+
+  // NOTE: See `CgroupsIsolatorProcess::__prepare` for why the mounts
+  // of a command task are passed to the command executor.
+  if (containerConfig.has_task_info()) {
+    ContainerLaunchInfo _launchInfo;
+
+    _launchInfo.mutable_command()->add_arguments(
+        "--task_launch_info=" +
+        stringify(JSON::protobuf(launchInfo)));
+
+    return _launchInfo;
+  }
+
+  return launchInfo;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  // If we are a nested container, we inherit the cgroup from our parent.
+  const ContainerID rootContainerId = protobuf::getRootContainerId(containerId);
+
+  if (!infos.contains(rootContainerId)) {
+    return Failure("Failed to isolate the container: Unknown root container");
+  }
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+  const string& cgroup = infos[rootContainerId]->cgroup;
+
+  // The Linux launcher has already placed the process into a leaf
+  // cgroup under the cgroup of the root container, which must be kept
+  // so that the launcher can still destroy nested containers.
+  Result<string> current = cgroups2::cgroup(pid);
+  if (current.isError()) {
+    return Failure(
+        "Failed to get the cgroup of pid " + stringify(pid) + ": " +
+        current.error());
+  }
+
+  if (current.isSome() &&
+      strings::startsWith(current.get(), path::join("/", cgroup) + "/")) {
+    return Nothing();
+  }
+
+  const string leaf = path::join(cgroup, cgroups2::LEAF);
+
+  if (!cgroups2::exists(hierarchy, leaf)) {
+    Try<Nothing> create = cgroups2::create(hierarchy, leaf);
+    if (create.isError()) {
+      return Failure(
+          "Failed to create the cgroup at '" +
+          path::join(hierarchy, leaf) + "': " + create.error());
+    }
+  }
+
+  Try<Nothing> assign = cgroups2::assign(hierarchy, leaf, pid);
+  if (assign.isError()) {
+    string message =
+      "Failed to assign container " + stringify(containerId) +
+      " pid " + stringify(pid) + " to cgroup at '" +
+      path::join(hierarchy, leaf) + "': " + assign.error();
+
+    LOG(ERROR) << message;
+
+    return Failure(message);
+  }
+
+  return Nothing();
+}
+
+
+Future<ContainerLimitation> Cgroups2IsolatorProcess::watch(
+    const ContainerID& containerId)
+{
+  // Since we do not maintain cgroups for nested containers
+  // directly, we simply return a pending future here, indicating
+  // that the limit for the nested container will never be reached.
+  if (containerId.has_parent()) {
+    return Future<ContainerLimitation>();
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  if (controllers.count("memory") > 0) {
+    Try<hashmap<string, uint64_t>> events = cgroups2::stat(
+        flags.cgroups_hierarchy,
+        info->cgroup,
+        "memory.events");
+
+    if (events.isError()) {
+      return Failure("Failed to read 'memory.events': " + events.error());
+    }
+
+    // Ignore the OOM kills which happened before the agent recovered.
+    info->oomKills = events->get("oom_kill").getOrElse(0);
+
+    // NOTE: 'memory.events' is polled since the unified hierarchy has
+    // no eventfd based OOM notification like 'memory.oom_control'.
+    process::delay(
+        OOM_POLL_INTERVAL,
+        PID<Cgroups2IsolatorProcess>(this),
+        &Cgroups2IsolatorProcess::oomPoll,
+        containerId);
+  }
+
+  return info->limitation.future();
+}
+
+
+void Cgroups2IsolatorProcess::oomPoll(const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return;
+  }
+
+  const Owned<Info>& info = infos[containerId];
+
+  if (!info->limitation.future().isPending()) {
+    return;
+  }
+
+  Try<hashmap<string, uint64_t>> events = cgroups2::stat(
+      flags.cgroups_hierarchy,
+      info->cgroup,
+      "memory.events");
+
+  if (events.isError()) {
+    LOG(ERROR) << "Listening on OOM events failed for container "
+               << containerId << ": " << events.error();
+    return;
+  }
+
+  if (events->get("oom_kill").getOrElse(0) > info->oomKills) {
+    oom(containerId);
+    return;
+  }
+
+  process::delay(
+      OOM_POLL_INTERVAL,
+      PID<Cgroups2IsolatorProcess>(this),
+      &Cgroups2IsolatorProcess::oomPoll,
+      containerId);
+}
+
+
+void Cgroups2IsolatorProcess::oom(const ContainerID& containerId)
+{
+  CHECK(infos.contains(containerId));
+
+  LOG(INFO) << "OOM detected for container " << containerId;
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+  const string& cgroup = infos[containerId]->cgroup;
+
+  // Construct a "message" string to describe why the isolator
+  // destroyed the container's cgroup (in order to assist debugging).
+  ostringstream message;
+  message << "Memory limit exceeded: ";
+
+  Try<Option<Bytes>> limit = cgroups2::memory::max(hierarchy, cgroup);
+
+  if (limit.isError()) {
+    LOG(ERROR) << "Failed to read 'memory.max': " << limit.error();
+  } else if (limit->isSome()) {
+    message << "Requested: " << limit->get() << "\n";
+  }
+
+  // Output 'memory.stat' of the cgroup to help with debugging.
+  Try<string> read = cgroups2::read(hierarchy, cgroup, "memory.stat");
+
+  if (read.isError()) {
+    LOG(ERROR) << "Failed to read 'memory.stat': " << read.error();
+  } else {
+    message << "\nMEMORY STATISTICS: \n" << read.get() << "\n";
+  }
+
+  LOG(INFO) << strings::trim(message.str()); // Trim the extra '\n' at the end.
+
+  // NOTE: This is not accurate if the memory resource is from
+  // a non-star role or spans roles (e.g., "*" and "role"). Ideally,
+  // we should save the resources passed in and report it here.
+  Resources mem = Resources::parse(
+      "mem",
+      stringify(limit.isSome() && limit->isSome()
+        ? (double) limit->get().bytes() / Bytes::MEGABYTES : 0),
+      "*").get();
+
+  infos[containerId]->limitation.set(
+      protobuf::slave::createContainerLimitation(
+          mem,
+          message.str(),
+          TaskStatus::REASON_CONTAINER_LIMITATION_MEMORY));
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resources)
+{
+  if (containerId.has_parent()) {
+    return Failure("Not supported for nested containers");
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+  const string& cgroup = infos[containerId]->cgroup;
+
+  if (controllers.count("cpu") > 0) {
+    if (resources.cpus().isNone()) {
+      return Failure(
+          "Failed to update controller 'cpu': No cpus resource given");
+    }
+
+    double cpus = resources.cpus().get();
+
+    uint64_t weight;
+
+    if (flags.revocable_cpu_low_priority &&
+        resources.revocable().cpus().isSome()) {
+      weight = (uint64_t) (CPU_WEIGHT_PER_CPU_REVOCABLE * cpus);
+    } else {
+      weight = (uint64_t) (CPU_WEIGHT_PER_CPU * cpus);
+    }
+
+    weight = std::min(
+        std::max(weight, cgroups2::cpu::MIN_WEIGHT),
+        cgroups2::cpu::MAX_WEIGHT);
+
+    Try<Nothing> write = cgroups2::cpu::weight(hierarchy, cgroup, weight);
+
+    if (write.isError()) {
+      return Failure("Failed to update 'cpu.weight': " + write.error());
+    }
+
+    LOG(INFO) << "Updated 'cpu.weight' to " << weight
+              << " (cpus " << cpus << ")"
+              << " for container " << containerId;
+
+    if (flags.cgroups_enable_cfs) {
+      cgroups2::cpu::BandwidthLimit limit;
+      limit.quota = std::max(CPU_CFS_PERIOD * cpus, MIN_CPU_CFS_QUOTA);
+      limit.period = CPU_CFS_PERIOD;
+
+      write = cgroups2::cpu::max(hierarchy, cgroup, limit);
+
+      if (write.isError()) {
+        return Failure("Failed to update 'cpu.max': " + write.error());
+      }
+
+      LOG(INFO) << "Updated 'cpu.max' to " << limit.quota.get()
+                << " per " << limit.period
+                << " (cpus " << cpus << ")"
+                << " for container " << containerId;
+    }
+  }
+
+  if (controllers.count("memory") > 0) {
+    if (resources.mem().isNone()) {
+      return Failure(
+          "Failed to update controller 'memory': No memory resource given");
+    }
+
+    Bytes limit = std::max(resources.mem().get(), MIN_MEMORY);
+
+    // Always set the throttling limit. Like the soft limit of the
+    // memory subsystem, this reclaims the memory of a container whose
+    // allocation shrinks without risking an OOM kill.
+    Try<Nothing> write = cgroups2::memory::high(hierarchy, cgroup, limit);
+
+    if (write.isError()) {
+      return Failure("Failed to set 'memory.high': " + write.error());
+    }
+
+    LOG(INFO) << "Updated 'memory.high' to " << limit
+              << " for container " << containerId;
+
+    Try<Option<Bytes>> currentLimit = cgroups2::memory::max(hierarchy, cgroup);
+
+    if (currentLimit.isError()) {
+      return Failure("Failed to read 'memory.max': " + currentLimit.error());
+    }
+
+    // We only update the hard limit if this is the first time (i.e.,
+    // the cgroup is not limited yet) or when we're raising the existing
+    // limit, as decreasing it may induce an OOM if too much memory is
+    // in use.
+    if (currentLimit->isNone() || currentLimit->get() < limit) {
+      write = cgroups2::memory::max(hierarchy, cgroup, limit);
+
+      if (write.isError()) {
+        return Failure("Failed to set 'memory.max': " + write.error());
+      }
+
+      LOG(INFO) << "Updated 'memory.max' to " << limit
+                << " for container " << containerId;
+    }
+  }
+
+  return Nothing();
+}
+
+
+Future<ResourceStatistics> Cgroups2IsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (containerId.has_parent()) {
+    return Failure("Not supported for nested containers");
+  }
+
+  if (!infos.contains(containerId)) {
+    return Failure("Unknown container");
+  }
+
+  const string& hierarchy = flags.cgroups_hierarchy;
+  const string& cgroup = infos[containerId]->cgroup;
+
+  ResourceStatistics result;
+
+  if (controllers.count("cpu") > 0) {
+    Try<cgroups2::cpu::Stats> stats = cgroups2::cpu::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'cpu.stat': " + stats.error());
+    }
+
+    result.set_cpus_user_time_secs(stats->user.secs());
+    result.set_cpus_system_time_secs(stats->system.secs());
+
+    // Add the throttling information only if CFS is enabled.
+    if (flags.cgroups_enable_cfs) {
+      if (stats->periods.isSome()) {
+        result.set_cpus_nr_periods(stats->periods.get());
+      }
+
+      if (stats->throttled.isSome()) {
+        result.set_cpus_nr_throttled(stats->throttled.get());
+      }
+
+      if (stats->throttledTime.isSome()) {
+        result.set_cpus_throttled_time_secs(stats->throttledTime->secs());
+      }
+    }
+  }
+
+  if (controllers.count("memory") > 0) {
+    Try<Bytes> usage = cgroups2::memory::usage(hierarchy, cgroup);
+
+    if (usage.isError()) {
+      return Failure("Failed to read 'memory.current': " + usage.error());
+    }
+
+    result.set_mem_total_bytes(usage->bytes());
+
+    Try<Option<Bytes>> limit = cgroups2::memory::max(hierarchy, cgroup);
+
+    if (limit.isError()) {
+      return Failure("Failed to read 'memory.max': " + limit.error());
+    }
+
+    if (limit->isSome()) {
+      result.set_mem_limit_bytes(limit->get().bytes());
+    }
+
+    Try<hashmap<string, uint64_t>> stats =
+      cgroups2::memory::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'memory.stat': " + stats.error());
+    }
+
+    // The unified hierarchy reports anonymous memory as "anon" and
+    // the page cache as "file", which we also report as the "rss" and
+    // "cache" of the legacy 'memory.stat'.
+    Option<uint64_t> anon = stats->get("anon");
+    if (anon.isSome()) {
+      result.set_mem_anon_bytes(anon.get());
+      result.set_mem_rss_bytes(anon.get());
+    }
+
+    Option<uint64_t> file = stats->get("file");
+    if (file.isSome()) {
+      result.set_mem_file_bytes(file.get());
+      result.set_mem_cache_bytes(file.get());
+    }
+
+    Option<uint64_t> mapped = stats->get("file_mapped");
+    if (mapped.isSome()) {
+      result.set_mem_mapped_file_bytes(mapped.get());
+    }
+
+    Option<uint64_t> unevictable = stats->get("unevictable");
+    if (unevictable.isSome()) {
+      result.set_mem_unevictable_bytes(unevictable.get());
+    }
+
+    Result<Bytes> swap = cgroups2::memory::swap(hierarchy, cgroup);
+
+    if (swap.isError()) {
+      return Failure("Failed to read 'memory.swap.current': " + swap.error());
+    }
+
+    if (swap.isSome()) {
+      result.set_mem_swap_bytes(swap->bytes());
+    }
+  }
+
+  if (controllers.count("io") > 0) {
+    Try<vector<cgroups2::io::Stats>> stats =
+      cgroups2::io::stats(hierarchy, cgroup);
+
+    if (stats.isError()) {
+      return Failure("Failed to read 'io.stat': " + stats.error());
+    }
+
+    // The 'io.stat' of the unified hierarchy is reported as the
+    // throttling statistics, which are likewise not limited to a
+    // particular io scheduler.
+    CgroupInfo::Blkio::Statistics* blkio =
+      result.mutable_blkio_statistics();
+
+    CgroupInfo::Blkio::Throttling::Statistics total;
+
+    auto add = [](
+        CgroupInfo::Blkio::Throttling::Statistics* statistics,
+        CgroupInfo::Blkio::Operation op,
+        uint64_t ios,
+        uint64_t bytes) {
+      CgroupInfo::Blkio::Value* value = statistics->add_io_serviced();
+      value->set_op(op);
+      value->set_value(ios);
+
+      value = statistics->add_io_service_bytes();
+      value->set_op(op);
+      value->set_value(bytes);
+    };
+
+    uint64_t totalIos = 0;
+    uint64_t totalBytes = 0;
+
+    foreach (const cgroups2::io::Stats& device, stats.get()) {
+      CgroupInfo::Blkio::Throttling::Statistics* statistics =
+        blkio->add_throttling();
+
+      statistics->mutable_device()->set_major_number(major(device.device));
+      statistics->mutable_device()->set_minor_number(minor(device.device));
+
+      add(statistics,
+          CgroupInfo::Blkio::TOTAL,
+          device.rios + device.wios + device.dios,
+          device.rbytes + device.wbytes + device.dbytes);
+
+      add(statistics, CgroupInfo::Blkio::READ, device.rios, device.rbytes);
+      add(statistics, CgroupInfo::Blkio::WRITE, device.wios, device.wbytes);
+      add(statistics, CgroupInfo::Blkio::DISCARD, device.dios, device.dbytes);
+
+      totalIos += device.rios + device.wios + device.dios;
+      totalBytes += device.rbytes + device.wbytes + device.dbytes;
+    }
+
+    add(&total, CgroupInfo::Blkio::TOTAL, totalIos, totalBytes);
+
+    blkio->add_throttling()->CopyFrom(total);
+  }
+
+  if (controllers.count("pids") > 0) {
+    Try<uint64_t> current = cgroups2::pids::current(hierarchy, cgroup);
+
+    if (current.isError()) {
+      return Failure("Failed to read 'pids.current': " + current.error());
+    }
+
+    result.set_threads(current.get());
+  }
+
+  // Pressure stall information is reported for the enabled controllers
+  // if the kernel supports it.
+  const vector<string> resources = {"cpu", "memory", "io"};
+
+  foreach (const string& resource, resources) {
+    if (controllers.count(resource) == 0 ||
+        !os::exists(path::join(hierarchy, cgroup, resource + ".pressure"))) {
+      continue;
+    }
+
+    Try<cgroups2::pressure::Pressure> pressure =
+      cgroups2::pressure::read(hierarchy, cgroup, resource);
+
+    if (pressure.isError()) {
+      return Failure(
+          "Failed to read '" + resource + ".pressure': " + pressure.error());
+    }
+
+    if (resource == "cpu") {
+      setPressure(pressure.get(), result.mutable_cpu_pressure());
+    } else if (resource == "memory") {
+      setPressure(pressure.get(), result.mutable_mem_pressure());
+    } else {
+      setPressure(pressure.get(), result.mutable_io_pressure());
+    }
+  }
+
+  return result;
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  // If we are a nested container, we do not need to clean anything up
+  // since only top-level containers should have cgroups created for them.
+  if (containerId.has_parent()) {
+    return Nothing();
+  }
+
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup request for unknown container " << containerId;
+
+    return Nothing();
+  }
+
+  const string cgroup = infos[containerId]->cgroup;
+  const Duration timeout = flags.cgroups_destroy_timeout;
+
+  // NOTE: The cgroup is usually destroyed by the Linux launcher
+  // already, in which case this is a no-op.
+  return cgroups2::destroy(flags.cgroups_hierarchy, cgroup)
+    .after(timeout, [=](Future<Nothing> future) -> Future<Nothing> {
+      future.discard();
+      return Failure(
+          "Timed out after " + stringify(timeout) +
+          " destroying cgroup '" + cgroup + "'");
+    })
+    .then(defer(
+        PID<Cgroups2IsolatorProcess>(this),
+        &Cgroups2IsolatorProcess::_cleanup,
+        containerId));
+}
+
+
+Future<Nothing> Cgroups2IsolatorProcess::_cleanup(
+    const ContainerID& containerId)
+{
+  CHECK(infos.contains(containerId));
+
+  infos.erase(containerId);
+
+  return Nothing();
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
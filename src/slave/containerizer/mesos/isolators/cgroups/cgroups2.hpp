@@ -0,0 +1,142 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __CGROUPS2_ISOLATOR_HPP__
+#define __CGROUPS2_ISOLATOR_HPP__
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// This isolator manages the cgroups of containers on hosts where the
+// cgroups v2 "unified" hierarchy is mounted at `--cgroups_hierarchy`.
+// It is selected by `CgroupsIsolatorProcess::create` in place of the
+// per-subsystem isolator, and supports the `cgroups/cpu`,
+// `cgroups/mem`, `cgroups/blkio` (the 'io' controller) and
+// `cgroups/pids` isolation.
+//
+// A top-level container gets the cgroup `<cgroups_root>/<id>`, and its
+// processes are placed in the `cgroups2::LEAF` child of that cgroup, as
+// the unified hierarchy does not allow a cgroup with controllers
+// enabled for its children to hold processes itself. Nested containers
+// share the cgroup (and the limits) of their root container.
+class Cgroups2IsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  ~Cgroups2IsolatorProcess() override {}
+
+  bool supportsNesting() override;
+  bool supportsStandalone() override;
+
+  process::Future<Nothing> recover(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans) override;
+
+  process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
+
+  process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const mesos::slave::ContainerConfig& containerConfig) override;
+
+  process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid) override;
+
+  process::Future<mesos::slave::ContainerLimitation> watch(
+      const ContainerID& containerId) override;
+
+  process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resources) override;
+
+  process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId) override;
+
+  process::Future<Nothing> cleanup(
+      const ContainerID& containerId) override;
+
+private:
+  struct Info
+  {
+    Info(const ContainerID& _containerId, const std::string& _cgroup)
+      : containerId(_containerId), cgroup(_cgroup) {}
+
+    const ContainerID containerId;
+    const std::string cgroup;
+
+    // The number of OOM kills in the cgroup when the container was
+    // last checked, see `oomPoll`.
+    uint64_t oomKills = 0;
+
+    // This promise will complete if the container is impacted by a
+    // resource limitation and should be terminated.
+    process::Promise<mesos::slave::ContainerLimitation> limitation;
+  };
+
+  Cgroups2IsolatorProcess(
+      const Flags& flags,
+      const std::set<std::string>& controllers);
+
+  process::Future<Option<mesos::slave::ContainerLaunchInfo>> _prepare(
+      const ContainerID& containerId,
+      const mesos::slave::ContainerConfig& containerConfig);
+
+  process::Future<Nothing> _cleanup(const ContainerID& containerId);
+
+  // Checks 'memory.events' of the container for new OOM kills, and
+  // schedules the next check if there are none.
+  void oomPoll(const ContainerID& containerId);
+
+  void oom(const ContainerID& containerId);
+
+  const Flags flags;
+
+  // The controllers which are enabled for the cgroups of containers.
+  const std::set<std::string> controllers;
+
+  hashmap<ContainerID, process::Owned<Info>> infos;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __CGROUPS2_ISOLATOR_HPP__
@@ -34,10 +34,20 @@ const Duration CPU_CFS_PERIOD = Milliseconds(100); // Linux default.
 const Duration MIN_CPU_CFS_QUOTA = Milliseconds(1);
 
 
+// CPU controller constants of the unified hierarchy ('cpu.weight').
+const uint64_t CPU_WEIGHT_PER_CPU = 100;
+const uint64_t CPU_WEIGHT_PER_CPU_REVOCABLE = 1;
+
+
 // Memory subsystem constants.
 const Bytes MIN_MEMORY = Megabytes(32);
 
 
+// Interval at which 'memory.events' of the unified hierarchy is checked
+// for OOM kills.
+const Duration OOM_POLL_INTERVAL = Seconds(1);
+
+
 // Subsystem names.
 const std::string CGROUP_SUBSYSTEM_BLKIO_NAME = "blkio";
 const std::string CGROUP_SUBSYSTEM_CPU_NAME = "cpu";
@@ -18,6 +18,7 @@
 
 #include <stout/error.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
 
 #include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/subsystem.hpp"
@@ -68,9 +69,12 @@ string Subsystem::name() const
 Try<Owned<Subsystem>> Subsystem::create(
     const Flags& flags,
     const string& name,
-    const string& hierarchy)
+    const string& hierarchy,
+    const std::shared_ptr<PerfSamples>& perfSamples)
 {
-  hashmap<string, Try<Owned<SubsystemProcess>>(*)(const Flags&, const string&)>
+  hashmap<string,
+          lambda::function<Try<Owned<SubsystemProcess>>(
+              const Flags&, const string&)>>
     creators = {
     {CGROUP_SUBSYSTEM_BLKIO_NAME, &BlkioSubsystemProcess::create},
     {CGROUP_SUBSYSTEM_CPU_NAME, &CpuSubsystemProcess::create},
@@ -81,7 +85,11 @@ Try<Owned<Subsystem>> Subsystem::create(
     {CGROUP_SUBSYSTEM_MEMORY_NAME, &MemorySubsystemProcess::create},
     {CGROUP_SUBSYSTEM_NET_CLS_NAME, &NetClsSubsystemProcess::create},
     {CGROUP_SUBSYSTEM_NET_PRIO_NAME, &NetPrioSubsystemProcess::create},
-    {CGROUP_SUBSYSTEM_PERF_EVENT_NAME, &PerfEventSubsystemProcess::create},
+    {CGROUP_SUBSYSTEM_PERF_EVENT_NAME,
+      [perfSamples](const Flags& flags, const string& hierarchy) {
+        return PerfEventSubsystemProcess::create(
+            flags, hierarchy, perfSamples);
+      }},
     {CGROUP_SUBSYSTEM_PIDS_NAME, &PidsSubsystemProcess::create},
   };
 
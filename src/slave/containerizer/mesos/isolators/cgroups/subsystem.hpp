@@ -17,6 +17,7 @@
 #ifndef __CGROUPS_ISOLATOR_SUBSYSTEM_HPP__
 #define __CGROUPS_ISOLATOR_SUBSYSTEM_HPP__
 
+#include <memory>
 #include <string>
 
 #include <mesos/resources.hpp>
@@ -32,6 +33,8 @@
 
 #include "slave/flags.hpp"
 
+#include "slave/containerizer/mesos/perf_samples.hpp"
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -51,12 +54,15 @@ public:
    * @param flags `Flags` used to launch the agent.
    * @param name The name of cgroups subsystem.
    * @param hierarchy The hierarchy path of cgroups subsystem.
+   * @param perfSamples The perf samples of containers, which are
+   *     added by the perf_event subsystem.
    * @return A specific `Subsystem` object or an error if `create` fails.
    */
   static Try<process::Owned<Subsystem>> create(
       const Flags& flags,
       const std::string& name,
-      const std::string& hierarchy);
+      const std::string& hierarchy,
+      const std::shared_ptr<PerfSamples>& perfSamples);
 
   // We have unique ownership of the wrapped process and
   // enforce that objects of this class cannot be copied.
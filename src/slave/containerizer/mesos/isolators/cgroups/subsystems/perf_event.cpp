@@ -21,6 +21,7 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/path.hpp>
 
 #include "linux/perf.hpp"
 
@@ -42,13 +43,43 @@ namespace slave {
 
 Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
     const Flags& flags,
-    const string& hierarchy)
+    const string& hierarchy,
+    const std::shared_ptr<PerfSamples>& perfSamples)
 {
   // If the agent flag `--perf_events` is not specified, we will not do sampling
   // at all, so this subsystem is just like a no-op in this case.
   if (flags.perf_events.isNone()) {
     return Owned<SubsystemProcess>(
-        new PerfEventSubsystemProcess(flags, hierarchy, set<string>{}));
+        new PerfEventSubsystemProcess(
+            flags, hierarchy, set<string>{}, false, perfSamples));
+  }
+
+  set<string> events;
+  foreach (const string& event,
+           strings::tokenize(flags.perf_events.get(), ",")) {
+    events.insert(event);
+  }
+
+  // Count the events with perf_event_open(2) if possible, which keeps
+  // the counters open instead of running `perf stat` for every sample.
+  // We try to count in the root cgroup to find out whether the kernel
+  // (or the hypervisor) supports all the events.
+  if (perf::CgroupCounters::supported(events)) {
+    Try<Owned<perf::CgroupCounters>> counters =
+      perf::CgroupCounters::open(hierarchy, events);
+
+    if (counters.isSome()) {
+      LOG(INFO) << "perf_event subsystem will count "
+                << "every '" << flags.perf_interval << "' "
+                << "for events: " << stringify(events);
+
+      return Owned<SubsystemProcess>(
+          new PerfEventSubsystemProcess(
+              flags, hierarchy, events, true, perfSamples));
+    }
+
+    LOG(WARNING) << "Failed to count perf events natively, falling back "
+                 << "to 'perf stat': " << counters.error();
   }
 
   if (!perf::supported()) {
@@ -61,12 +92,6 @@ Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
         "interval (" + stringify(flags.perf_interval) + ") is not supported.");
   }
 
-  set<string> events;
-  foreach (const string& event,
-           strings::tokenize(flags.perf_events.get(), ",")) {
-    events.insert(event);
-  }
-
   if (!perf::valid(events)) {
     return Error("Invalid perf events: " + stringify(events));
   }
@@ -77,17 +102,22 @@ Try<Owned<SubsystemProcess>> PerfEventSubsystemProcess::create(
             << "for events: " << stringify(events);
 
   return Owned<SubsystemProcess>(
-      new PerfEventSubsystemProcess(flags, hierarchy, events));
+      new PerfEventSubsystemProcess(
+          flags, hierarchy, events, false, perfSamples));
 }
 
 
 PerfEventSubsystemProcess::PerfEventSubsystemProcess(
     const Flags& _flags,
     const string& _hierarchy,
-    const set<string>& _events)
+    const set<string>& _events,
+    bool _native,
+    const std::shared_ptr<PerfSamples>& _perfSamples)
   : ProcessBase(process::ID::generate("cgroups-perf-event-subsystem")),
     SubsystemProcess(_flags, _hierarchy),
-    events(_events) {}
+    events(_events),
+    native(_native),
+    perfSamples(_perfSamples) {}
 
 
 void PerfEventSubsystemProcess::initialize()
@@ -107,7 +137,10 @@ Future<Nothing> PerfEventSubsystemProcess::recover(
     return Failure("The subsystem '" + name() + "' has already been recovered");
   }
 
-  infos.put(containerId, Owned<Info>(new Info(cgroup)));
+  Owned<Info> info(new Info(cgroup));
+  open(info);
+
+  infos.put(containerId, info);
 
   return Nothing();
 }
@@ -121,7 +154,10 @@ Future<Nothing> PerfEventSubsystemProcess::prepare(
     return Failure("The subsystem '" + name() + "' has already been prepared");
   }
 
-  infos.put(containerId, Owned<Info>(new Info(cgroup)));
+  Owned<Info> info(new Info(cgroup));
+  open(info);
+
+  infos.put(containerId, info);
 
   return Nothing();
 }
@@ -137,8 +173,10 @@ Future<ResourceStatistics> PerfEventSubsystemProcess::usage(
         ": Unknown container");
   }
 
+  const Owned<Info>& info = infos[containerId];
+
   ResourceStatistics statistics;
-  statistics.mutable_perf()->CopyFrom(infos[containerId]->statistics);
+  statistics.mutable_perf()->CopyFrom(info->statistics);
 
   return statistics;
 }
@@ -156,13 +194,57 @@ Future<Nothing> PerfEventSubsystemProcess::cleanup(
   }
 
   infos.erase(containerId);
+  perfSamples->remove(containerId);
 
   return Nothing();
 }
 
 
+void PerfEventSubsystemProcess::open(const Owned<Info>& info)
+{
+  if (!native) {
+    return;
+  }
+
+  Try<Owned<perf::CgroupCounters>> counters =
+    perf::CgroupCounters::open(path::join(hierarchy, info->cgroup), events);
+
+  if (counters.isError()) {
+    LOG(WARNING) << "Failed to open the perf counters of cgroup '"
+                 << info->cgroup << "': " << counters.error();
+    return;
+  }
+
+  info->counters = counters.get();
+}
+
+
 void PerfEventSubsystemProcess::sample()
 {
+  if (native) {
+    // The counters count continuously, so a sample is the difference
+    // to the previous one and is available right away.
+    hashmap<string, PerfStatistics> statistics;
+
+    foreachvalue (const Owned<Info>& info, infos) {
+      if (info->counters.get() == nullptr) {
+        continue;
+      }
+
+      Try<PerfStatistics> sample = info->counters->read();
+      if (sample.isError()) {
+        LOG(ERROR) << "Failed to read the perf counters of cgroup '"
+                   << info->cgroup << "': " << sample.error();
+        continue;
+      }
+
+      statistics.put(info->cgroup, sample.get());
+    }
+
+    _sample(Clock::now() + flags.perf_interval, statistics);
+    return;
+  }
+
   // Collect a perf sample for all cgroups that are not being
   // destroyed. Since destroyal is asynchronous, 'perf stat' may
   // fail if the cgroup is destroyed before running perf.
@@ -207,9 +289,12 @@ void PerfEventSubsystemProcess::_sample(
   } else {
     // Store the latest statistics, note that cgroups added in the
     // interim will be picked up by the next sample.
-    foreachvalue (const Owned<Info>& info, infos) {
+    foreachpair (const ContainerID& containerId,
+                 const Owned<Info>& info,
+                 infos) {
       if (statistics->contains(info->cgroup)) {
         info->statistics = statistics->get(info->cgroup).get();
+        perfSamples->add(containerId, info->statistics);
       }
     }
   }
@@ -17,6 +17,7 @@
 #ifndef __CGROUPS_ISOLATOR_SUBSYSTEMS_PERF_EVENT_HPP__
 #define __CGROUPS_ISOLATOR_SUBSYSTEMS_PERF_EVENT_HPP__
 
+#include <memory>
 #include <set>
 #include <string>
 
@@ -29,8 +30,12 @@
 
 #include <stout/hashmap.hpp>
 
+#include "linux/perf.hpp"
+
 #include "slave/flags.hpp"
 
+#include "slave/containerizer/mesos/perf_samples.hpp"
+
 #include "slave/containerizer/mesos/isolators/cgroups/constants.hpp"
 #include "slave/containerizer/mesos/isolators/cgroups/subsystem.hpp"
 
@@ -46,7 +51,8 @@ class PerfEventSubsystemProcess: public SubsystemProcess
 public:
   static Try<process::Owned<SubsystemProcess>> create(
       const Flags& flags,
-      const std::string& hierarchy);
+      const std::string& hierarchy,
+      const std::shared_ptr<PerfSamples>& perfSamples);
 
   ~PerfEventSubsystemProcess() override = default;
 
@@ -78,7 +84,9 @@ private:
   PerfEventSubsystemProcess(
       const Flags& flags,
       const std::string& hierarchy,
-      const std::set<std::string>& events);
+      const std::set<std::string>& events,
+      bool native,
+      const std::shared_ptr<PerfSamples>& perfSamples);
 
   struct Info
   {
@@ -95,8 +103,14 @@ private:
 
     const std::string cgroup;
     PerfStatistics statistics;
+
+    // The counters of the cgroup, if sampled natively.
+    process::Owned<perf::CgroupCounters> counters;
   };
 
+  // Opens the counters of the container when sampling natively.
+  void open(const process::Owned<Info>& info);
+
   void sample();
 
   void _sample(
@@ -106,6 +120,14 @@ private:
   // Set of events to sample.
   std::set<std::string> events;
 
+  // Whether the events are counted with perf_event_open(2) rather than
+  // by running `perf stat`.
+  const bool native;
+
+  // The recent samples of the containers, which are kept for the
+  // `/monitor/perf` endpoint of the agent.
+  const std::shared_ptr<PerfSamples> perfSamples;
+
   // Stores cgroups associated information for container.
   hashmap<ContainerID, process::Owned<Info>> infos;
 };
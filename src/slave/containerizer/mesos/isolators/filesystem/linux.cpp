@@ -50,6 +50,7 @@
 
 #include "slave/containerizer/mesos/mount.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
 
 #include "slave/containerizer/mesos/isolators/filesystem/linux.hpp"
 
@@ -57,6 +58,7 @@ using namespace process;
 
 using std::ostringstream;
 using std::pair;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -584,6 +586,16 @@ bool LinuxFilesystemIsolatorProcess::supportsStandalone()
 Future<Nothing> LinuxFilesystemIsolatorProcess::recover(
     const vector<ContainerState>& states,
     const hashset<ContainerID>& orphans)
+{
+  return recoverFromSnapshot(
+      states, orphans, std::make_shared<RecoverySnapshot>());
+}
+
+
+Future<Nothing> LinuxFilesystemIsolatorProcess::recoverFromSnapshot(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   foreach (const ContainerState& state, states) {
     Option<ExecutorInfo> executorInfo;
@@ -599,7 +611,7 @@ Future<Nothing> LinuxFilesystemIsolatorProcess::recover(
   }
 
   // Remove orphaned persistent volume mounts.
-  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  Try<fs::MountInfoTable> table = snapshot->mountTable();
   if (table.isError()) {
     return Failure("Failed to get mount table: " + table.error());
   }
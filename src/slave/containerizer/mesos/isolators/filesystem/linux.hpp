@@ -17,6 +17,8 @@
 #ifndef __LINUX_FILESYSTEM_ISOLATOR_HPP__
 #define __LINUX_FILESYSTEM_ISOLATOR_HPP__
 
+#include <memory>
+
 #include <mesos/mesos.hpp>
 #include <mesos/resources.hpp>
 
@@ -57,6 +59,11 @@ public:
       const std::vector<mesos::slave::ContainerState>& states,
       const hashset<ContainerID>& orphans) override;
 
+  process::Future<Nothing> recoverFromSnapshot(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
+
   process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
       const ContainerID& containerId,
       const mesos::slave::ContainerConfig& containerConfig) override;
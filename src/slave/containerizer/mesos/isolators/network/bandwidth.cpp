@@ -0,0 +1,1054 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slave/containerizer/mesos/isolators/network/bandwidth.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include <process/collect.hpp>
+#include <process/defer.hpp>
+#include <process/id.hpp>
+#include <process/io.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "common/protobuf_utils.hpp"
+#include "common/values.hpp"
+
+#include "linux/cgroups.hpp"
+
+#include "linux/routing/queueing/statistics.hpp"
+
+using std::string;
+using std::vector;
+
+using process::Failure;
+using process::Future;
+using process::Owned;
+using process::Subprocess;
+using process::await;
+using process::defer;
+using process::subprocess;
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerLaunchInfo;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+using mesos::internal::values::rangesToIntervalSet;
+
+using namespace routing::queueing::statistics;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The major number of the HTB qdisc installed on the host interface.
+// The net_cls classid of a container is `HTB_MAJOR:minor`.
+constexpr uint16_t HTB_MAJOR = 0xbd;
+
+// The handle of the ingress qdisc, which is fixed by the kernel.
+constexpr char INGRESS_HANDLE[] = "ffff:";
+
+// The minor numbers of containers are below this offset, which is
+// added to the minor number to get the alternate priority of the
+// ingress filters of a container.
+constexpr uint16_t PRIORITY_OFFSET = 0x8000;
+
+// The ingress policer allows bursts of about 10ms worth of traffic at
+// the allocated rate, but never less than this.
+constexpr uint64_t MIN_BURST_BYTES = 64 * 1024;
+
+
+static string handle(uint16_t minor)
+{
+  return strings::format("%x:%x", HTB_MAJOR, minor).get();
+}
+
+
+// Returns the host interface the default route goes through, as
+// listed in `/proc/net/route`:
+//   Iface   Destination  Gateway   Flags  ...
+//   eth0    00000000     0102A8C0  0003   ...
+static Try<string> defaultInterface()
+{
+  Try<string> routes = os::read("/proc/net/route");
+  if (routes.isError()) {
+    return Error("Failed to read '/proc/net/route': " + routes.error());
+  }
+
+  foreach (const string& line, strings::tokenize(routes.get(), "\n")) {
+    vector<string> fields = strings::tokenize(line, " \t");
+    if (fields.size() > 1 && fields[1] == "00000000") {
+      return fields[0];
+    }
+  }
+
+  return Error("No default route found in '/proc/net/route'");
+}
+
+
+// Runs the given shell command asynchronously and returns its
+// standard output, or a failure carrying its standard error.
+static Future<string> execute(const string& command)
+{
+  Try<Subprocess> s = subprocess(
+      command,
+      Subprocess::PATH(os::DEV_NULL),
+      Subprocess::PIPE(),
+      Subprocess::PIPE());
+
+  if (s.isError()) {
+    return Failure("Failed to execute '" + command + "': " + s.error());
+  }
+
+  return await(
+      s->status(),
+      process::io::read(s->out().get()),
+      process::io::read(s->err().get()))
+    .then([command](const std::tuple<
+        Future<Option<int>>,
+        Future<string>,
+        Future<string>>& t) -> Future<string> {
+      const Future<Option<int>>& status = std::get<0>(t);
+      if (!status.isReady()) {
+        return Failure(
+            "Failed to get the exit status of '" + command + "': " +
+            (status.isFailed() ? status.failure() : "discarded"));
+      }
+
+      if (status->isNone()) {
+        return Failure("Failed to reap the status of '" + command + "'");
+      }
+
+      if (status->get() != 0) {
+        const Future<string>& error = std::get<2>(t);
+        return Failure(
+            "Failed to execute '" + command + "': " +
+            (error.isReady() ? error.get() : "unknown error"));
+      }
+
+      const Future<string>& output = std::get<1>(t);
+      if (!output.isReady()) {
+        return Failure(
+            "Failed to read the output of '" + command + "': " +
+            (output.isFailed() ? output.failure() : "discarded"));
+      }
+
+      return output.get();
+    });
+}
+
+
+// Splits a port range into the blocks that can each be matched by a
+// single u32 `dport` selector, i.e., a value and a prefix mask.
+static vector<std::pair<uint16_t, uint16_t>> portBlocks(
+    const IntervalSet<uint32_t>& ports)
+{
+  vector<std::pair<uint16_t, uint16_t>> blocks;
+
+  foreach (const Interval<uint32_t>& interval, ports) {
+    uint32_t begin = interval.lower();
+    const uint32_t end = std::min<uint32_t>(interval.upper(), 0x10000);
+
+    while (begin < end) {
+      uint32_t size = 1;
+      while (begin % (size * 2) == 0 && begin + size * 2 <= end) {
+        size *= 2;
+      }
+
+      blocks.emplace_back(begin, static_cast<uint16_t>(~(size - 1)));
+      begin += size;
+    }
+  }
+
+  return blocks;
+}
+
+
+// Returns whether the root qdisc of the interface, as listed by
+// `tc qdisc show dev <interface> root`, is the HTB qdisc of the
+// isolator, e.g.:
+//   qdisc htb bd: root refcnt 2 r2q 10 default 0 ...
+// as opposed to the default qdisc attached by the kernel, which has
+// the handle `0:`, e.g.:
+//   qdisc mq 0: root
+// Any other root qdisc was installed by the operator.
+static Try<bool> isIsolatorRootQdisc(const string& output)
+{
+  const string root = strings::format("htb %x: root", HTB_MAJOR).get();
+
+  if (strings::contains(output, root)) {
+    return true;
+  }
+
+  vector<string> tokens = strings::tokenize(output, " \t\n");
+  if (tokens.size() >= 4 && tokens[0] == "qdisc" && tokens[2] == "0:" &&
+      tokens[3] == "root") {
+    return false;
+  }
+
+  return Error("Unexpected root qdisc '" + strings::trim(output) + "'");
+}
+
+
+// Returns the command which installs the HTB qdisc shaping the egress
+// traffic of containers, classifying packets by the net_cls classid of
+// their socket, and the ingress qdisc policing their incoming traffic.
+// The HTB qdisc only replaces the default root qdisc.
+static string setUpCommand(const string& interface)
+{
+  const string root = strings::format("%x:", HTB_MAJOR).get();
+
+  return
+    "if ! tc qdisc show dev " + interface + " root | grep -q 'htb " + root +
+    " root'; then "
+    "  if ! tc qdisc show dev " + interface + " root | grep -q ' 0: root'; "
+    "  then "
+    "    echo 'Refusing to replace the root qdisc of " + interface +
+    "' >&2; exit 1; "
+    "  fi; "
+    "  tc qdisc add dev " + interface + " root handle " + root +
+    " htb default 0 || exit 1; "
+    "fi; "
+    "(tc filter show dev " + interface + " parent " + root +
+    " | grep -q cgroup || tc filter add dev " + interface + " parent " +
+    root + " protocol all prio 1 handle 1: cgroup) && "
+    "(tc qdisc show dev " + interface + " ingress | grep -q ingress || "
+    "tc qdisc add dev " + interface + " ingress)";
+}
+
+
+// Returns the command which removes the qdiscs installed by
+// `setUpCommand`, once the configuration of all the containers has
+// been removed. The ingress qdisc is kept if filters of the operator
+// are attached to it.
+static string tearDownCommand(const string& interface)
+{
+  const string root = strings::format("%x:", HTB_MAJOR).get();
+
+  return
+    "if tc qdisc show dev " + interface + " root | grep -q 'htb " + root +
+    " root'; then "
+    "  tc qdisc del dev " + interface + " root || exit 1; "
+    "fi; "
+    "if tc qdisc show dev " + interface + " ingress | grep -q ingress && "
+    "   ! tc filter show dev " + interface + " parent " + INGRESS_HANDLE +
+    " | grep -q .; then "
+    "  tc qdisc del dev " + interface + " ingress || exit 1; "
+    "fi";
+}
+
+
+// Returns the command which removes the ingress filters of the given
+// priority. Errors are ignored since the filters may not exist.
+static string removeFiltersCommand(const string& interface, uint16_t priority)
+{
+  return
+    "{ tc filter del dev " + interface + " parent " + INGRESS_HANDLE +
+    " protocol ip prio " + stringify(priority) + " 2>/dev/null; true; }";
+}
+
+
+// Returns the commands which remove the traffic control configuration
+// of the container given the `minor` number. Errors are ignored since
+// some of the configuration may not have been installed.
+static string removeCommands(const string& interface, uint16_t minor)
+{
+  return
+    removeFiltersCommand(interface, minor) + "; " +
+    removeFiltersCommand(interface, minor + PRIORITY_OFFSET) + "; "
+    "tc actions del action police index " + stringify(minor) +
+    " 2>/dev/null; "
+    "tc class del dev " + interface + " classid " + handle(minor) +
+    " 2>/dev/null; true";
+}
+
+
+// Parses a rate as printed by `tc`, e.g., `100Mbit`, in kbit/s. Note
+// that `tc` uses multiples of 1000 unless it is run with `-iec`.
+static Try<uint64_t> parseRate(const string& rate)
+{
+  const vector<std::pair<string, double>> units = {
+    {"Tbit", 1e9}, {"Gbit", 1e6}, {"Mbit", 1e3}, {"Kbit", 1}, {"bit", 1e-3}};
+
+  foreach (const auto& unit, units) {
+    if (!strings::endsWith(rate, unit.first)) {
+      continue;
+    }
+
+    Try<double> value = numify<double>(
+        strings::remove(rate, unit.first, strings::SUFFIX));
+
+    if (value.isError()) {
+      break;
+    }
+
+    return static_cast<uint64_t>(value.get() * unit.second + 0.5);
+  }
+
+  return Error("Unexpected rate '" + rate + "'");
+}
+
+
+// Returns the rates of the HTB classes listed by `tc class show`,
+// keyed by minor number, e.g.:
+//   class htb bd:1 root prio 0 rate 10Mbit ceil 10Mbit burst 1600b ...
+static hashmap<uint16_t, uint64_t> parseClassRates(const string& output)
+{
+  hashmap<uint16_t, uint64_t> rates;
+
+  const string prefix = strings::format("%x:", HTB_MAJOR).get();
+
+  foreach (const string& line, strings::tokenize(output, "\n")) {
+    vector<string> tokens = strings::tokenize(line, " \t");
+    if (tokens.size() < 3 ||
+        tokens[0] != "class" ||
+        tokens[1] != "htb" ||
+        !strings::startsWith(tokens[2], prefix)) {
+      continue;
+    }
+
+    Try<uint16_t> minor = numify<uint16_t>(
+        "0x" + strings::remove(tokens[2], prefix, strings::PREFIX));
+
+    if (minor.isError()) {
+      continue;
+    }
+
+    for (size_t i = 3; i + 1 < tokens.size(); i++) {
+      if (tokens[i] == "rate") {
+        Try<uint64_t> rate = parseRate(tokens[i + 1]);
+        if (rate.isSome()) {
+          rates[minor.get()] = rate.get();
+        }
+        break;
+      }
+    }
+  }
+
+  return rates;
+}
+
+
+// Returns the priorities of the filters listed by `tc filter show`,
+// e.g.:
+//   filter parent ffff: protocol ip pref 1 u32 chain 0 ...
+static hashset<uint16_t> parseFilterPriorities(const string& output)
+{
+  hashset<uint16_t> priorities;
+
+  vector<string> tokens = strings::tokenize(output, " \t\n");
+  for (size_t i = 0; i + 1 < tokens.size(); i++) {
+    if (tokens[i] == "pref") {
+      Try<uint16_t> priority = numify<uint16_t>(tokens[i + 1]);
+      if (priority.isSome()) {
+        priorities.insert(priority.get());
+      }
+    }
+  }
+
+  return priorities;
+}
+
+
+// Parses the statistics printed by `tc -s`, for example:
+//   Sent 1234 bytes 10 pkt (dropped 0, overlimits 0 requeues 0)
+//   backlog 0b 0p requeues 0
+static hashmap<string, uint64_t> parseStatistics(const string& output)
+{
+  hashmap<string, uint64_t> statistics;
+
+  vector<string> tokens = strings::tokenize(output, " \t\n(),");
+
+  for (size_t i = 0; i + 1 < tokens.size(); i++) {
+    const string& token = tokens[i];
+    const string& next = tokens[i + 1];
+
+    Option<string> key;
+    string value = next;
+
+    if (token == "Sent") {
+      key = BYTES;
+    } else if (token == "bytes") {
+      key = PACKETS;
+    } else if (token == "dropped") {
+      key = DROPS;
+    } else if (token == "overlimits") {
+      key = OVERLIMITS;
+    } else if (token == "requeues") {
+      key = REQUEUES;
+    } else if (token == "backlog" && strings::endsWith(next, "b")) {
+      key = BACKLOG;
+      value = strings::remove(next, "b", strings::SUFFIX);
+
+      if (i + 2 < tokens.size() && strings::endsWith(tokens[i + 2], "p")) {
+        Try<uint64_t> qlen = numify<uint64_t>(
+            strings::remove(tokens[i + 2], "p", strings::SUFFIX));
+
+        if (qlen.isSome()) {
+          statistics[QLEN] = qlen.get();
+        }
+      }
+    }
+
+    if (key.isNone() || statistics.contains(key.get())) {
+      continue;
+    }
+
+    Try<uint64_t> number = numify<uint64_t>(value);
+    if (number.isSome()) {
+      statistics[key.get()] = number.get();
+    }
+  }
+
+  return statistics;
+}
+
+
+static void addTrafficControlStatistics(
+    const string& id,
+    const hashmap<string, uint64_t>& statistics,
+    ResourceStatistics* result)
+{
+  TrafficControlStatistics* tc = result->add_net_traffic_control_statistics();
+
+  tc->set_id(id);
+
+  if (statistics.contains(BACKLOG)) {
+    tc->set_backlog(statistics.at(BACKLOG));
+  }
+  if (statistics.contains(BYTES)) {
+    tc->set_bytes(statistics.at(BYTES));
+  }
+  if (statistics.contains(DROPS)) {
+    tc->set_drops(statistics.at(DROPS));
+  }
+  if (statistics.contains(OVERLIMITS)) {
+    tc->set_overlimits(statistics.at(OVERLIMITS));
+  }
+  if (statistics.contains(PACKETS)) {
+    tc->set_packets(statistics.at(PACKETS));
+  }
+  if (statistics.contains(QLEN)) {
+    tc->set_qlen(statistics.at(QLEN));
+  }
+  if (statistics.contains(REQUEUES)) {
+    tc->set_requeues(statistics.at(REQUEUES));
+  }
+}
+
+
+Try<Isolator*> NetworkBandwidthIsolatorProcess::create(const Flags& flags)
+{
+  if (::geteuid() != 0) {
+    return Error("The 'network/bandwidth' isolator requires root privileges");
+  }
+
+  vector<string> isolators = strings::tokenize(flags.isolation, ",");
+  if (std::find(isolators.begin(), isolators.end(), "cgroups/net_cls") !=
+      isolators.end()) {
+    return Error(
+        "The 'network/bandwidth' isolator cannot be used together with "
+        "the 'cgroups/net_cls' isolator");
+  }
+
+  Try<string> hierarchy = cgroups::prepare(
+      flags.cgroups_hierarchy,
+      "net_cls",
+      flags.cgroups_root);
+
+  if (hierarchy.isError()) {
+    return Error(
+        "Failed to prepare the net_cls cgroup: " + hierarchy.error());
+  }
+
+  string interface;
+  if (flags.network_bandwidth_interface.isSome()) {
+    interface = flags.network_bandwidth_interface.get();
+  } else {
+    Try<string> _interface = defaultInterface();
+    if (_interface.isError()) {
+      return Error(
+          "Failed to determine the interface to shape: " +
+          _interface.error());
+    }
+
+    interface = _interface.get();
+  }
+
+  // The qdiscs are installed along with the first container, but we
+  // refuse to start if they would replace a root qdisc installed by
+  // the operator. The configuration is left in place if the agent
+  // restarts, hence the HTB qdisc of the isolator is accepted too.
+  Try<string> root = os::shell("tc qdisc show dev " + interface + " root");
+  if (root.isError()) {
+    return Error(
+        "Failed to get the root qdisc of interface '" + interface + "': " +
+        root.error());
+  }
+
+  Try<bool> installed = isIsolatorRootQdisc(root.get());
+  if (installed.isError()) {
+    return Error(
+        "Cannot shape the traffic on interface '" + interface + "': " +
+        installed.error() + ". Remove the qdisc or choose another "
+        "interface with --network_bandwidth_interface");
+  }
+
+  LOG(INFO) << "Shaping the traffic of containers on interface '"
+            << interface << "'";
+
+  return new MesosIsolator(process::Owned<MesosIsolatorProcess>(
+      new NetworkBandwidthIsolatorProcess(
+          flags,
+          interface,
+          hierarchy.get())));
+}
+
+
+NetworkBandwidthIsolatorProcess::NetworkBandwidthIsolatorProcess(
+    const Flags& _flags,
+    const string& _interface,
+    const string& _hierarchy)
+  : ProcessBase(process::ID::generate("network-bandwidth-isolator")),
+    flags(_flags),
+    interface(_interface),
+    hierarchy(_hierarchy)
+{
+  // The minor number 0 is the root of the HTB qdisc.
+  minors.set(0);
+}
+
+
+bool NetworkBandwidthIsolatorProcess::supportsNesting()
+{
+  return true;
+}
+
+
+string NetworkBandwidthIsolatorProcess::cgroup(
+    const ContainerID& containerId) const
+{
+  CHECK(!containerId.has_parent());
+
+  return path::join(flags.cgroups_root, containerId.value());
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::recover(
+    const vector<ContainerState>& states,
+    const hashset<ContainerID>& orphans)
+{
+  hashset<ContainerID> recovered;
+  foreach (const ContainerState& state, states) {
+    recovered.insert(state.container_id());
+  }
+
+  recovered.insert(orphans.begin(), orphans.end());
+
+  Try<vector<string>> cgroups = cgroups::get(hierarchy, flags.cgroups_root);
+  if (cgroups.isError()) {
+    return Failure(
+        "Failed to get the net_cls cgroups under '" + flags.cgroups_root +
+        "': " + cgroups.error());
+  }
+
+  vector<Future<Nothing>> removals;
+
+  foreach (const string& cgroup, cgroups.get()) {
+    // Only the top level containers have a cgroup of their own.
+    if (Path(cgroup).dirname() != flags.cgroups_root) {
+      continue;
+    }
+
+    ContainerID containerId;
+    containerId.set_value(Path(cgroup).basename());
+
+    Try<uint32_t> classid = cgroups::net_cls::classid(hierarchy, cgroup);
+    if (classid.isError()) {
+      return Failure(
+          "Failed to read the net_cls classid of container " +
+          stringify(containerId) + ": " + classid.error());
+    }
+
+    const uint16_t major = classid.get() >> 16;
+    const uint16_t minor = classid.get() & 0xffff;
+
+    if (major != HTB_MAJOR ||
+        minor == 0 ||
+        minor >= PRIORITY_OFFSET ||
+        minors.test(minor)) {
+      LOG(WARNING) << "Ignoring unexpected net_cls classid "
+                   << strings::format("0x%x", classid.get()).get()
+                   << " of container " << containerId;
+
+      removals.push_back(cgroups::destroy(
+          hierarchy, cgroup, flags.cgroups_destroy_timeout));
+      continue;
+    }
+
+    minors.set(minor);
+
+    if (!recovered.contains(containerId)) {
+      // The cgroup belongs to an unknown orphan container which the
+      // containerizer will not clean up, so we do it here.
+      LOG(INFO) << "Removing unknown orphaned container " << containerId;
+
+      removals.push_back(remove(containerId, minor));
+      continue;
+    }
+
+    infos.put(containerId, Owned<Info>(new Info(minor)));
+  }
+
+  // Restore the default root qdisc if the isolator is left without
+  // containers, e.g., if they all terminated while the agent was down.
+  if (infos.empty()) {
+    tearDown();
+
+    return process::collect(removals)
+      .then([]() { return Nothing(); });
+  }
+
+  // The traffic control configuration of the recovered containers is
+  // left in place. Their enforced bandwidth and the priority of their
+  // ingress filters are read back from it so that their usage keeps
+  // being reported. Their ports are not known until the next update,
+  // which then replaces their ingress filters.
+  return await(
+      execute("tc class show dev " + interface),
+      execute(
+          "tc filter show dev " + interface + " parent " + INGRESS_HANDLE))
+    .then(defer(self(), [=](const std::tuple<
+        Future<string>,
+        Future<string>>& t) -> Future<Nothing> {
+      const Future<string>& classes = std::get<0>(t);
+      const Future<string>& filters = std::get<1>(t);
+
+      if (!classes.isReady() || !filters.isReady()) {
+        const Future<string>& failed = classes.isReady() ? filters : classes;
+
+        LOG(WARNING) << "Failed to get the traffic control configuration of "
+                     << interface << ": "
+                     << (failed.isFailed() ? failed.failure() : "discarded");
+      } else {
+        const hashmap<uint16_t, uint64_t> rates =
+          parseClassRates(classes.get());
+
+        const hashset<uint16_t> priorities =
+          parseFilterPriorities(filters.get());
+
+        foreachpair (const ContainerID& containerId,
+                     const Owned<Info>& info,
+                     infos) {
+          if (!rates.contains(info->minor)) {
+            continue;
+          }
+
+          info->bandwidth = rates.at(info->minor);
+
+          if (priorities.contains(info->minor + PRIORITY_OFFSET)) {
+            info->priority = info->minor + PRIORITY_OFFSET;
+          }
+
+          VLOG(1) << "Recovered network bandwidth of "
+                  << info->bandwidth.get() << "kbit/s for container "
+                  << containerId;
+        }
+      }
+
+      return process::collect(removals)
+        .then([]() { return Nothing(); });
+    }));
+}
+
+
+Future<Option<ContainerLaunchInfo>> NetworkBandwidthIsolatorProcess::prepare(
+    const ContainerID& containerId,
+    const ContainerConfig& containerConfig)
+{
+  // Nested containers share the bandwidth of their root container.
+  if (containerId.has_parent()) {
+    return None();
+  }
+
+  if (infos.contains(containerId)) {
+    return Failure("Container has already been prepared");
+  }
+
+  // Allocate the first free minor number.
+  Option<uint16_t> minor;
+  for (size_t i = 1; i < PRIORITY_OFFSET; i++) {
+    if (!minors.test(i)) {
+      minor = static_cast<uint16_t>(i);
+      break;
+    }
+  }
+
+  if (minor.isNone()) {
+    return Failure("No free net_cls classid left");
+  }
+
+  Try<Nothing> create = cgroups::create(hierarchy, cgroup(containerId));
+  if (create.isError()) {
+    return Failure(
+        "Failed to create the net_cls cgroup: " + create.error());
+  }
+
+  const uint32_t classid = (HTB_MAJOR << 16) | minor.get();
+
+  Try<Nothing> write =
+    cgroups::net_cls::classid(hierarchy, cgroup(containerId), classid);
+
+  if (write.isError()) {
+    // The container is not known to `cleanup()` yet, so we remove the
+    // cgroup here. It is still empty since nothing was isolated in it.
+    Try<Nothing> remove = cgroups::remove(hierarchy, cgroup(containerId));
+    if (remove.isError()) {
+      LOG(ERROR) << "Failed to remove the net_cls cgroup of container "
+                 << containerId << ": " << remove.error();
+    }
+
+    return Failure(
+        "Failed to set the net_cls classid: " + write.error());
+  }
+
+  // The qdiscs are installed along with the first container. Since
+  // the commands are sequenced, this also waits for the qdiscs to be
+  // removed if the last container was just cleaned up.
+  Future<Nothing> setUp = infos.empty()
+    ? configure(setUpCommand(interface))
+    : Nothing();
+
+  minors.set(minor.get());
+  infos.put(containerId, Owned<Info>(new Info(minor.get())));
+
+  const Resources resources = containerConfig.resources();
+
+  return setUp
+    .then(defer(self(), [=]() {
+      return update(containerId, resources);
+    }))
+    .then([]() -> Future<Option<ContainerLaunchInfo>> {
+      return None();
+    });
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::isolate(
+    const ContainerID& containerId,
+    pid_t pid)
+{
+  // Nested containers are not forked from their parent, so they have
+  // to be moved into the cgroup of their root container explicitly.
+  const ContainerID rootContainerId =
+    protobuf::getRootContainerId(containerId);
+
+  if (!infos.contains(rootContainerId)) {
+    return Nothing();
+  }
+
+  Try<Nothing> assign =
+    cgroups::assign(hierarchy, cgroup(rootContainerId), pid);
+
+  if (assign.isError()) {
+    return Failure(
+        "Failed to assign container " + stringify(containerId) +
+        " to its net_cls cgroup: " + assign.error());
+  }
+
+  return Nothing();
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::update(
+    const ContainerID& containerId,
+    const Resources& resources)
+{
+  if (containerId.has_parent()) {
+    return Failure("Not supported for nested containers");
+  }
+
+  if (!infos.contains(containerId)) {
+    LOG(INFO) << "Ignoring update for unknown container " << containerId;
+    return Nothing();
+  }
+
+  const Owned<Info>& info = infos.at(containerId);
+
+  Option<uint64_t> bandwidth;
+
+  Option<Value::Scalar> scalar =
+    resources.get<Value::Scalar>("network_bandwidth");
+
+  if (scalar.isSome() && scalar->value() > 0) {
+    // The resource is expressed in Mbps.
+    bandwidth = static_cast<uint64_t>(scalar->value() * 1000 + 0.5);
+  }
+
+  IntervalSet<uint32_t> ports;
+
+  Option<Value::Ranges> ranges = resources.ports();
+  if (ranges.isSome()) {
+    Try<IntervalSet<uint32_t>> intervals =
+      rangesToIntervalSet<uint32_t>(ranges.get());
+
+    if (intervals.isError()) {
+      return Failure(
+          "Invalid ports resource " + stringify(ranges.get()) + ": " +
+          intervals.error());
+    }
+
+    ports = intervals.get();
+  }
+
+  if (bandwidth == info->bandwidth && ports == info->ports) {
+    return Nothing();
+  }
+
+  const uint16_t minor = info->minor;
+
+  if (bandwidth.isNone()) {
+    return configure(removeCommands(interface, minor))
+      .then(defer(self(), [=]() -> Future<Nothing> {
+        // The container may have been cleaned up in the meantime.
+        if (infos.contains(containerId)) {
+          infos.at(containerId)->bandwidth = None();
+          infos.at(containerId)->ports = IntervalSet<uint32_t>();
+        }
+
+        LOG(INFO) << "Removed the network bandwidth limit of container "
+                  << containerId;
+
+        return Nothing();
+      }));
+  }
+
+  const string rate = stringify(bandwidth.get()) + "kbit";
+
+  // `bandwidth` is in kbit/s, so 10ms worth of traffic in bytes is
+  // `bandwidth * 1000 / 8 / 100`.
+  const uint64_t burst =
+    std::max(MIN_BURST_BYTES, bandwidth.get() * 10 / 8);
+
+  // The class and the policer are changed in place, so the traffic of
+  // the container is shaped and policed throughout the update.
+  string command =
+    "tc class replace dev " + interface + " parent " +
+    strings::format("%x:", HTB_MAJOR).get() + " classid " +
+    handle(minor) + " htb rate " + rate + " ceil " + rate +
+    " && tc actions replace action police rate " + rate + " burst " +
+    stringify(burst) + "b drop index " + stringify(minor);
+
+  // The filters for the new ports are added at the alternate priority
+  // before the filters for the old ports are removed. Both sets use the
+  // same policer, so the ports present in both stay policed. If adding
+  // the filters fails, the old ones are left in place.
+  uint16_t priority = info->priority;
+
+  if (ports != info->ports || info->bandwidth.isNone()) {
+    const uint16_t previous = info->priority;
+
+    priority = previous == minor
+      ? static_cast<uint16_t>(minor + PRIORITY_OFFSET)
+      : minor;
+
+    string filters = removeFiltersCommand(interface, priority);
+
+    typedef std::pair<uint16_t, uint16_t> Block;
+    foreach (const Block& block, portBlocks(ports)) {
+      filters +=
+        " && tc filter add dev " + interface + " parent " +
+        INGRESS_HANDLE + " protocol ip prio " + stringify(priority) +
+        " u32 match ip dport " + stringify(block.first) + " " +
+        strings::format("0x%x", block.second).get() +
+        " action police index " + stringify(minor);
+    }
+
+    command +=
+      " && { " + filters + " || { " +
+      removeFiltersCommand(interface, priority) + "; false; }; }"
+      " && " + removeFiltersCommand(interface, previous);
+  }
+
+  return configure(command)
+    .then(defer(self(), [=]() -> Future<Nothing> {
+      // The container may have been cleaned up in the meantime.
+      if (!infos.contains(containerId)) {
+        return Nothing();
+      }
+
+      infos.at(containerId)->bandwidth = bandwidth;
+      infos.at(containerId)->ports = ports;
+      infos.at(containerId)->priority = priority;
+
+      LOG(INFO) << "Updated network bandwidth to " << bandwidth.get()
+                << "kbit/s for container " << containerId;
+
+      return Nothing();
+    }));
+}
+
+
+Future<ResourceStatistics> NetworkBandwidthIsolatorProcess::usage(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    return ResourceStatistics();
+  }
+
+  const Owned<Info>& info = infos.at(containerId);
+
+  if (info->bandwidth.isNone()) {
+    return ResourceStatistics();
+  }
+
+  const uint16_t minor = info->minor;
+
+  return await(
+      execute(
+          "tc -s class show dev " + interface + " classid " +
+          handle(minor)),
+      execute("tc -s actions get action police index " + stringify(minor)))
+    .then([](const std::tuple<Future<string>, Future<string>>& t) {
+      ResourceStatistics result;
+
+      // We don't set the timestamp here because the containerizer will
+      // set it on the merged statistics.
+      result.set_timestamp(0);
+
+      const Future<string>& egress = std::get<0>(t);
+      if (egress.isReady()) {
+        hashmap<string, uint64_t> statistics = parseStatistics(egress.get());
+        addTrafficControlStatistics("bw_egress", statistics, &result);
+
+        if (statistics.contains(BYTES)) {
+          result.set_net_tx_bytes(statistics.at(BYTES));
+        }
+        if (statistics.contains(PACKETS)) {
+          result.set_net_tx_packets(statistics.at(PACKETS));
+        }
+        if (statistics.contains(DROPS)) {
+          result.set_net_tx_dropped(statistics.at(DROPS));
+        }
+      } else {
+        LOG(WARNING) << "Failed to get the egress statistics: "
+                     << (egress.isFailed() ? egress.failure() : "discarded");
+      }
+
+      const Future<string>& ingress = std::get<1>(t);
+      if (ingress.isReady()) {
+        hashmap<string, uint64_t> statistics = parseStatistics(ingress.get());
+        addTrafficControlStatistics("bw_ingress", statistics, &result);
+
+        if (statistics.contains(BYTES)) {
+          result.set_net_rx_bytes(statistics.at(BYTES));
+        }
+        if (statistics.contains(PACKETS)) {
+          result.set_net_rx_packets(statistics.at(PACKETS));
+        }
+        if (statistics.contains(DROPS)) {
+          result.set_net_rx_dropped(statistics.at(DROPS));
+        }
+      } else {
+        LOG(WARNING) << "Failed to get the ingress statistics: "
+                     << (ingress.isFailed() ? ingress.failure() : "discarded");
+      }
+
+      return result;
+    });
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::cleanup(
+    const ContainerID& containerId)
+{
+  if (!infos.contains(containerId)) {
+    VLOG(1) << "Ignoring cleanup request for unknown container "
+            << containerId;
+
+    return Nothing();
+  }
+
+  const uint16_t minor = infos.at(containerId)->minor;
+  infos.erase(containerId);
+
+  return remove(containerId, minor);
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::remove(
+    const ContainerID& containerId,
+    uint16_t minor)
+{
+  const string cgroup = this->cgroup(containerId);
+
+  return configure(removeCommands(interface, minor))
+    .then(defer(self(), [=]() -> Future<Nothing> {
+      if (!cgroups::exists(hierarchy, cgroup)) {
+        return Nothing();
+      }
+
+      return cgroups::destroy(
+          hierarchy, cgroup, flags.cgroups_destroy_timeout);
+    }))
+    .then(defer(self(), [=]() -> Future<Nothing> {
+      // The minor number is only released once the classid can no
+      // longer be used by the processes of the container.
+      minors.reset(minor);
+
+      if (infos.empty()) {
+        tearDown();
+      }
+
+      return Nothing();
+    }));
+}
+
+
+Future<Nothing> NetworkBandwidthIsolatorProcess::configure(
+    const string& command)
+{
+  return sequence.add<string>([command]() { return execute(command); })
+    .then([]() { return Nothing(); });
+}
+
+
+void NetworkBandwidthIsolatorProcess::tearDown()
+{
+  LOG(INFO) << "Removing the traffic control configuration of interface '"
+            << interface << "'";
+
+  const string name = interface;
+
+  configure(tearDownCommand(interface))
+    .onFailed([name](const string& failure) {
+      LOG(WARNING) << "Failed to remove the traffic control configuration "
+                   << "of interface '" << name << "': " << failure;
+    });
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
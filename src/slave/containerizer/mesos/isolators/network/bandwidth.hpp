@@ -0,0 +1,156 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __NETWORK_BANDWIDTH_ISOLATOR_HPP__
+#define __NETWORK_BANDWIDTH_ISOLATOR_HPP__
+
+#include <stdint.h>
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+#include <process/sequence.hpp>
+
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/interval.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/isolator.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The `network/bandwidth` isolator enforces the `network_bandwidth`
+// resource (in Mbps) allocated to containers which share the host
+// network namespace.
+//
+// Each container is placed into a net_cls cgroup whose classid selects
+// an HTB class on the egress side of the host interface, which shapes
+// the outgoing traffic of the container to its allocation. The incoming
+// traffic destined to the `ports` allocated to the container is policed
+// to the same rate on the ingress side of the interface.
+//
+// Unlike the `network/port_mapping` isolator, traffic control is driven
+// through the `tc` command rather than `libnl`. Since the isolator
+// manages the net_cls cgroups of containers itself, it cannot be used
+// together with the `cgroups/net_cls` isolator.
+//
+// The qdiscs are only installed on the interface while there are
+// containers, and only in place of the default root qdisc attached by
+// the kernel, which is restored once the last container is cleaned up.
+// The isolator refuses to start if the operator installed another root
+// qdisc on the interface.
+class NetworkBandwidthIsolatorProcess : public MesosIsolatorProcess
+{
+public:
+  static Try<mesos::slave::Isolator*> create(const Flags& flags);
+
+  ~NetworkBandwidthIsolatorProcess() override {}
+
+  bool supportsNesting() override;
+
+  process::Future<Nothing> recover(
+      const std::vector<mesos::slave::ContainerState>& states,
+      const hashset<ContainerID>& orphans) override;
+
+  process::Future<Option<mesos::slave::ContainerLaunchInfo>> prepare(
+      const ContainerID& containerId,
+      const mesos::slave::ContainerConfig& containerConfig) override;
+
+  process::Future<Nothing> isolate(
+      const ContainerID& containerId,
+      pid_t pid) override;
+
+  process::Future<Nothing> update(
+      const ContainerID& containerId,
+      const Resources& resources) override;
+
+  process::Future<ResourceStatistics> usage(
+      const ContainerID& containerId) override;
+
+  process::Future<Nothing> cleanup(
+      const ContainerID& containerId) override;
+
+private:
+  NetworkBandwidthIsolatorProcess(
+      const Flags& _flags,
+      const std::string& _interface,
+      const std::string& _hierarchy);
+
+  struct Info
+  {
+    explicit Info(uint16_t _minor) : minor(_minor), priority(_minor) {}
+
+    // The minor number of the net_cls classid and of the HTB class of
+    // the container. It is also used as the index of the ingress
+    // policer of the container.
+    const uint16_t minor;
+
+    // The priority of the ingress filters of the container. It
+    // alternates between `minor` and `minor + 0x8000`, so the filters
+    // matching new ports are added before the old ones are removed.
+    uint16_t priority;
+
+    // The bandwidth (in kbit/s) and ports which are currently enforced,
+    // None if the traffic of the container is not shaped.
+    Option<uint64_t> bandwidth;
+    IntervalSet<uint32_t> ports;
+  };
+
+  // Returns the net_cls cgroup of the given top level container.
+  std::string cgroup(const ContainerID& containerId) const;
+
+  // Removes the traffic control configuration and the cgroup of a
+  // container which was given the `minor` number.
+  process::Future<Nothing> remove(
+      const ContainerID& containerId,
+      uint16_t minor);
+
+  // Runs the given traffic control command once the previous ones have
+  // completed, so the configuration of the interface is only changed by
+  // one command at a time.
+  process::Future<Nothing> configure(const std::string& command);
+
+  // Removes the qdiscs of the isolator from the interface, which
+  // restores the default root qdisc.
+  void tearDown();
+
+  const Flags flags;
+  const std::string interface;
+  const std::string hierarchy;
+
+  // The minor numbers which are allocated to containers.
+  std::bitset<0x10000> minors;
+
+  hashmap<ContainerID, process::Owned<Info>> infos;
+
+  process::Sequence sequence;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __NETWORK_BANDWIDTH_ISOLATOR_HPP__
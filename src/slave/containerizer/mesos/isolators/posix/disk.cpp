@@ -14,18 +14,27 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <errno.h>
+#include <fts.h>
 #include <signal.h>
 
 #ifdef __linux__
 #include <sys/prctl.h>
 #endif
+#include <sys/stat.h>
 #include <sys/types.h>
 
 #include <deque>
+#include <limits>
+#include <list>
+#include <set>
 #include <tuple>
+#include <utility>
 
 #include <glog/logging.h>
 
+#include <process/after.hpp>
+#include <process/async.hpp>
 #include <process/check.hpp>
 #include <process/collect.hpp>
 #include <process/defer.hpp>
@@ -38,6 +47,7 @@
 #include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/numify.hpp>
+#include <stout/os.hpp>
 #include <stout/strings.hpp>
 #include <stout/path.hpp>
 
@@ -45,14 +55,24 @@
 #include <stout/os/exists.hpp>
 #include <stout/os/killtree.hpp>
 #include <stout/os/stat.hpp>
+#include <stout/os/strerror.hpp>
 
 #include "common/protobuf_utils.hpp"
 
+#ifdef __linux__
+#include "linux/quota.hpp"
+#endif // __linux__
+
+#include "slave/paths.hpp"
+
 #include "slave/containerizer/mesos/isolators/posix/disk.hpp"
 
 namespace io = process::io;
 
 using std::deque;
+using std::list;
+using std::pair;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -64,6 +84,8 @@ using process::Process;
 using process::Promise;
 using process::Subprocess;
 
+using process::after;
+using process::async;
 using process::await;
 using process::defer;
 using process::delay;
@@ -86,8 +108,57 @@ Try<Isolator*> PosixDiskIsolatorProcess::create(const Flags& flags)
 {
   // TODO(jieyu): Check the availability of command 'du'.
 
+  IntervalSet<uint32_t> projectIds;
+
+#ifdef __linux__
+  if (flags.container_disk_usage_backend == "project_quota") {
+    Result<uid_t> uid = os::getuid();
+    CHECK_SOME(uid) << "getuid(2) doesn't fail";
+
+    if (uid.get() != 0) {
+      return Error("The `project_quota` disk usage backend requires running"
+                   " as root");
+    }
+
+    Try<Resource> projects =
+      Resources::parse("projects", flags.disk_project_range, "*");
+
+    if (projects.isError()) {
+      return Error(
+          "Failed to parse project range '" + flags.disk_project_range + "'");
+    }
+
+    if (projects->type() != Value::RANGES) {
+      return Error(
+          "Invalid project resource type " +
+          mesos::Value_Type_Name(projects->type()) +
+          ", expecting " +
+          mesos::Value_Type_Name(Value::RANGES));
+    }
+
+    foreach (const Value::Range& range, projects->ranges().range()) {
+      // Project ID 0 is used by the files which are not in a project.
+      if (range.begin() == 0) {
+        return Error("Project ID 0 is not allowed");
+      }
+
+      if (range.end() > std::numeric_limits<uint32_t>::max()) {
+        return Error(
+            "Project ID " + stringify(range.end()) + " is out of range");
+      }
+
+      projectIds += (Bound<uint32_t>::closed(range.begin()),
+                     Bound<uint32_t>::closed(range.end()));
+    }
+
+    if (projectIds.empty()) {
+      return Error("No project IDs in '" + flags.disk_project_range + "'");
+    }
+  }
+#endif // __linux__
+
   return new MesosIsolator(process::Owned<MesosIsolatorProcess>(
-        new PosixDiskIsolatorProcess(flags)));
+        new PosixDiskIsolatorProcess(flags, projectIds)));
 }
 
 
@@ -97,10 +168,16 @@ PosixDiskIsolatorProcess::Info::PathInfo::~PathInfo()
 }
 
 
-PosixDiskIsolatorProcess::PosixDiskIsolatorProcess(const Flags& _flags)
+PosixDiskIsolatorProcess::PosixDiskIsolatorProcess(
+    const Flags& _flags,
+    const IntervalSet<uint32_t>& projectIds)
   : ProcessBase(process::ID::generate("posix-disk-isolator")),
     flags(_flags),
-    collector(flags.container_disk_watch_interval) {}
+    collector(
+        flags.container_disk_watch_interval,
+        flags.container_disk_usage_backend != "du"),
+    totalProjectIds(projectIds),
+    freeProjectIds(projectIds) {}
 
 
 PosixDiskIsolatorProcess::~PosixDiskIsolatorProcess() {}
@@ -141,9 +218,115 @@ Future<Nothing> PosixDiskIsolatorProcess::recover(
       info->directories.insert(path);
     }
 
+#ifdef __linux__
+    if (!totalProjectIds.empty()) {
+      Try<bool> enabled = quota::isProjectQuotaEnabled(state.directory());
+      if (enabled.isError()) {
+        return Failure(
+            "Failed to check project quotas for '" + state.directory() +
+            "': " + enabled.error());
+      }
+
+      if (enabled.get()) {
+        Result<uint32_t> projectId = quota::getProjectId(state.directory());
+        if (projectId.isError()) {
+          return Failure(projectId.error());
+        }
+
+        // The sandbox might not have a project ID if the container was
+        // launched before the `project_quota` backend was enabled.
+        if (projectId.isSome()) {
+          Result<string> device = quota::getDevice(state.directory());
+          if (!device.isSome()) {
+            return Failure(
+                "Failed to find the device of '" + state.directory() + "'" +
+                (device.isError() ? ": " + device.error() : ""));
+          }
+
+          info->projectId = projectId.get();
+          info->device = device.get();
+          freeProjectIds -= projectId.get();
+        }
+      }
+    }
+#endif // __linux__
+
     infos.put(state.container_id(), info);
   }
 
+#ifdef __linux__
+  if (!totalProjectIds.empty()) {
+    Try<bool> enabled = quota::isProjectQuotaEnabled(flags.work_dir);
+    if (enabled.isError()) {
+      return Failure(
+          "Failed to check project quotas for '" + flags.work_dir + "': " +
+          enabled.error());
+    }
+
+    if (enabled.get()) {
+      // Reclaim the project IDs of the sandboxes of containers which
+      // we did not recover, e.g., because the agent was restarted
+      // with a new agent ID. This is best effort, as the sandboxes
+      // are going to be garbage collected anyway.
+      Try<list<string>> sandboxes = os::glob(path::join(
+          paths::getSandboxRootDir(flags.work_dir),
+          "*",
+          "frameworks",
+          "*",
+          "executors",
+          "*",
+          "runs",
+          "*"));
+
+      if (sandboxes.isError()) {
+        return Failure(
+            "Failed to scan sandbox directories: " + sandboxes.error());
+      }
+
+      hashset<string> recovered;
+      foreachvalue (const Owned<Info>& info, infos) {
+        recovered.insert(info->sandbox);
+      }
+
+      foreach (const string& sandbox, sandboxes.get()) {
+        // Skip the "latest" symlink.
+        if (os::stat::islink(sandbox) || recovered.contains(sandbox)) {
+          continue;
+        }
+
+        Result<uint32_t> projectId = quota::getProjectId(sandbox);
+        if (projectId.isError()) {
+          LOG(WARNING) << "Failed to get the project ID of '" << sandbox
+                       << "': " << projectId.error();
+          continue;
+        }
+
+        if (projectId.isNone() || !freeProjectIds.contains(projectId.get())) {
+          continue;
+        }
+
+        freeProjectIds -= projectId.get();
+
+        const uint32_t _projectId = projectId.get();
+
+        async(&quota::clearProjectId, sandbox)
+          .onAny(defer(self(), [=](const Future<Try<Nothing>>& cleared) {
+            if (!cleared.isReady() || cleared->isError()) {
+              LOG(ERROR) << "Failed to clear project ID " << _projectId
+                         << " of '" << sandbox << "': "
+                         << (cleared.isReady() ? cleared->error()
+                             : cleared.isFailed() ? cleared.failure()
+                             : "discarded");
+              return;
+            }
+
+            returnProjectId(_projectId);
+          }));
+      }
+    }
+  }
+#endif // __linux__
+
   return Nothing();
 }
 
@@ -170,6 +353,77 @@ Future<Option<ContainerLaunchInfo>> PosixDiskIsolatorProcess::prepare(
   }
 
   infos.put(containerId, info);
+
+#ifdef __linux__
+  if (!totalProjectIds.empty()) {
+    Try<bool> enabled = quota::isProjectQuotaEnabled(info->sandbox);
+    if (enabled.isError()) {
+      return Failure(
+          "Failed to check project quotas for '" + info->sandbox + "': " +
+          enabled.error());
+    }
+
+    // All the ephemeral directories are charged to the same project,
+    // so they must be on the same filesystem as the sandbox.
+    bool supported = enabled.get();
+
+    if (supported) {
+      Try<dev_t> device = os::stat::dev(info->sandbox);
+      if (device.isError()) {
+        return Failure(device.error());
+      }
+
+      foreach (const string& directory, info->directories) {
+        Try<dev_t> _device = os::stat::dev(directory);
+        if (_device.isError()) {
+          return Failure(_device.error());
+        }
+
+        supported = supported && _device.get() == device.get();
+      }
+    }
+
+    if (!supported) {
+      LOG(INFO) << "Project quotas are not available for the sandbox '"
+                << info->sandbox << "' of container " << containerId
+                << ", falling back to walking the directories";
+
+      return None();
+    }
+
+    // Resolve the device once, as every usage check queries it.
+    Result<string> device = quota::getDevice(info->sandbox);
+    if (!device.isSome()) {
+      return Failure(
+          "Failed to find the device of '" + info->sandbox + "'" +
+          (device.isError() ? ": " + device.error() : ""));
+    }
+
+    info->device = device.get();
+
+    Option<uint32_t> projectId = nextProjectId();
+    if (projectId.isNone()) {
+      return Failure("Failed to assign project ID, range exhausted");
+    }
+
+    // Keep a record of the project ID so that cleanup() can return it
+    // if we fail to assign it below.
+    info->projectId = projectId.get();
+
+    foreach (const string& directory, info->directories) {
+      Try<Nothing> status = quota::setProjectId(directory, projectId.get());
+      if (status.isError()) {
+        return Failure(
+            "Failed to assign project " + stringify(projectId.get()) +
+            ": " + status.error());
+      }
+
+      LOG(INFO) << "Assigned project " << projectId.get()
+                << " to '" << directory << "'";
+    }
+  }
+#endif // __linux__
+
   return None();
 }
 
@@ -266,8 +520,9 @@ Future<Nothing> PosixDiskIsolatorProcess::update(
 
   // If we still have a sandbox quota, include all the ephemeral
   // quota directories so we include them in the collection state
-  // updates below.
-  if (quotas.contains(info->sandbox)) {
+  // updates below. This is not needed if they are tracked by project
+  // quota, which charges them all to the sandbox.
+  if (quotas.contains(info->sandbox) && info->projectId.isNone()) {
     const Resources quota = quotas[info->sandbox];
     foreach (const string& path, info->directories) {
       quotas[path] = quota;
@@ -278,7 +533,8 @@ Future<Nothing> PosixDiskIsolatorProcess::update(
   // the disk usage collection.
   foreachpair (const string& path, const Resources& quota, quotas) {
     if (!info->paths.contains(path)) {
-      info->paths[path].usage = collect(containerId, path);
+      Future<Bytes> usage = collect(containerId, path);
+      info->paths[path].usage = usage;
     }
 
     info->paths[path].quota = quota;
@@ -305,6 +561,38 @@ Future<Bytes> PosixDiskIsolatorProcess::collect(
 
   const Owned<Info>& info = infos[containerId];
 
+#ifdef __linux__
+  if (info->projectId.isSome() && path == info->sandbox) {
+    CHECK_SOME(info->device);
+
+    const string device = info->device.get();
+    const uint32_t projectId = info->projectId.get();
+
+    // Reading the usage of a project is cheap, so we do not go through
+    // the DiskUsageCollector queue. The first check of a path is done
+    // right away, the later ones after the watch interval.
+    Duration wait = info->paths.contains(path)
+      ? flags.container_disk_watch_interval
+      : Duration::zero();
+
+    return after(wait)
+      .then(defer(self(), [device, projectId]() -> Future<Bytes> {
+        Try<Bytes> usage = quota::getProjectUsage(device, projectId);
+        if (usage.isError()) {
+          return Failure(usage.error());
+        }
+
+        return usage.get();
+      }))
+      .onAny(defer(
+          PID<PosixDiskIsolatorProcess>(this),
+          &PosixDiskIsolatorProcess::_collect,
+          containerId,
+          path,
+          lambda::_1));
+  }
+#endif // __linux__
+
   // Volume paths to exclude from sandbox disk usage calculation.
   //
   // TODO(jieyu): The 'excludes' list might change when a new
@@ -497,14 +785,73 @@ Future<Nothing> PosixDiskIsolatorProcess::cleanup(
     return Nothing();
   }
 
+#ifdef __linux__
+  const Owned<Info>& info = infos[containerId];
+
+  // The sandbox is kept until it is garbage collected, so we remove
+  // its project ID before reusing it, to not charge the sandbox to the
+  // next container. The other ephemeral directories are removed along
+  // with the container's root filesystem.
+  //
+  // NOTE: Symbolic links in the sandbox keep the project ID, as it
+  // cannot be changed through them. They stay charged to the project.
+  if (info->projectId.isSome()) {
+    const uint32_t projectId = info->projectId.get();
+    const string sandbox = info->sandbox;
+
+    async(&quota::clearProjectId, sandbox)
+      .onAny(defer(self(), [=](const Future<Try<Nothing>>& cleared) {
+        if (!cleared.isReady() || cleared->isError()) {
+          LOG(ERROR) << "Failed to clear project ID " << projectId
+                     << " of '" << sandbox << "': "
+                     << (cleared.isReady() ? cleared->error()
+                         : cleared.isFailed() ? cleared.failure()
+                         : "discarded");
+          return;
+        }
+
+        returnProjectId(projectId);
+      }));
+  }
+#endif // __linux__
+
   infos.erase(containerId);
 
   return Nothing();
 }
 
 
+Option<uint32_t> PosixDiskIsolatorProcess::nextProjectId()
+{
+  if (freeProjectIds.empty()) {
+    return None();
+  }
+
+  uint32_t projectId = freeProjectIds.begin()->lower();
+
+  freeProjectIds -= projectId;
+  return projectId;
+}
+
+
+void PosixDiskIsolatorProcess::returnProjectId(uint32_t projectId)
+{
+  // Only return this project ID to the free range if it is in the total
+  // range, which might have been changed by the operator since the
+  // project ID was assigned.
+  if (totalProjectIds.contains(projectId)) {
+    freeProjectIds += projectId;
+  }
+}
+
+
 Bytes PosixDiskIsolatorProcess::Info::ephemeralUsage() const
 {
+  // The project of the sandbox includes all the ephemeral directories.
+  if (projectId.isSome()) {
+    return paths.at(sandbox).lastUsage.getOrElse(0);
+  }
+
   Bytes usage;
 
   foreach (const string& path, directories) {
@@ -518,9 +865,10 @@ Bytes PosixDiskIsolatorProcess::Info::ephemeralUsage() const
 class DiskUsageCollectorProcess : public Process<DiskUsageCollectorProcess>
 {
 public:
-  DiskUsageCollectorProcess(const Duration& _interval)
+  DiskUsageCollectorProcess(const Duration& _interval, bool _walk)
     : ProcessBase(process::ID::generate("posix-disk-usage-collector")),
-      interval(_interval) {}
+      interval(_interval),
+      walk(_walk) {}
   ~DiskUsageCollectorProcess() override {}
 
   Future<Bytes> usage(
@@ -559,6 +907,10 @@ protected:
         os::killtree(entry->du->pid(), SIGKILL);
       }
 
+      if (entry->tree != nullptr) {
+        ::fts_close(entry->tree);
+      }
+
       entry->promise.fail("DiskUsageCollector is destroyed");
     }
   }
@@ -575,13 +927,20 @@ private:
     vector<string> excludes;
     Option<Subprocess> du;
     Promise<Bytes> promise;
+
+    // The state of an in-progress walk of 'path'.
+    FTS* tree = nullptr;
+    Bytes total;
+    set<pair<dev_t, ino_t>> links;
   };
 
   void discard(const string& path)
   {
     for (auto it = entries.begin(); it != entries.end(); ++it) {
       // We only cancel those checks whose 'du' haven't been launched.
-      if ((*it)->path == path && (*it)->du.isNone()) {
+      // An in-progress walk notices the discard between two batches.
+      if ((*it)->path == path && (*it)->du.isNone() &&
+          (*it)->tree == nullptr) {
         (*it)->promise.discard();
         entries.erase(it);
         break;
@@ -600,6 +959,11 @@ private:
       return;
     }
 
+    if (walk) {
+      _walk();
+      return;
+    }
+
     const Owned<Entry>& entry = entries.front();
 
     // Invoke 'du' and report number of 1K-byte blocks. We fix the
@@ -718,16 +1082,132 @@ private:
     delay(interval, self(), &Self::schedule);
   }
 
+  // Traverses the path of the first check by up to 'WALK_BATCH_SIZE'
+  // entries, and dispatches itself to continue until the traversal
+  // is done. This keeps the collector responsive to other messages
+  // (e.g., discards) while walking large directories. Like 'du', this
+  // counts the allocated blocks of each file, and hard links once.
+  void _walk()
+  {
+    CHECK(!entries.empty());
+
+    const Owned<Entry>& entry = entries.front();
+
+    if (entry->promise.future().hasDiscard()) {
+      if (entry->tree != nullptr) {
+        ::fts_close(entry->tree);
+        entry->tree = nullptr;
+      }
+
+      entry->promise.discard();
+
+      entries.pop_front();
+      delay(interval, self(), &Self::schedule);
+      return;
+    }
+
+    if (entry->tree == nullptr) {
+      char* paths[] = {const_cast<char*>(entry->path.c_str()), nullptr};
+
+      // We follow the path itself if it is a symlink (see
+      // 'PosixDiskIsolatorProcess::collect'), but not the ones in it.
+      entry->tree = ::fts_open(
+          paths, FTS_NOCHDIR | FTS_PHYSICAL | FTS_COMFOLLOW, nullptr);
+
+      if (entry->tree == nullptr) {
+        entry->promise.fail(
+            "Failed to open '" + entry->path + "': " + os::strerror(errno));
+
+        entries.pop_front();
+        delay(interval, self(), &Self::schedule);
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < WALK_BATCH_SIZE; i++) {
+      errno = 0;
+
+      FTSENT* node = ::fts_read(entry->tree);
+
+      if (node == nullptr) {
+        if (errno != 0) {
+          entry->promise.fail(
+              "Failed to traverse '" + entry->path + "': " +
+              os::strerror(errno));
+        } else {
+          entry->promise.set(entry->total);
+        }
+
+        ::fts_close(entry->tree);
+        entry->tree = nullptr;
+
+        entries.pop_front();
+        delay(interval, self(), &Self::schedule);
+        return;
+      }
+
+      if (node->fts_info != FTS_DP && excluded(*entry, node->fts_path)) {
+        ::fts_set(entry->tree, node, FTS_SKIP);
+        continue;
+      }
+
+      switch (node->fts_info) {
+        case FTS_D:
+          entry->total += Bytes(node->fts_statp->st_blocks * 512);
+          break;
+        case FTS_F:
+        case FTS_SL:
+        case FTS_SLNONE:
+        case FTS_DEFAULT: {
+          const struct stat& stat = *node->fts_statp;
+
+          if (stat.st_nlink > 1 &&
+              !entry->links.insert({stat.st_dev, stat.st_ino}).second) {
+            break;
+          }
+
+          entry->total += Bytes(stat.st_blocks * 512);
+          break;
+        }
+        default:
+          // The post-order visits of directories, which are counted
+          // in pre-order, and the entries which cannot be read. The
+          // latter are usually removed during the traversal, as the
+          // container keeps writing to its sandbox.
+          break;
+      }
+    }
+
+    dispatch(self(), &Self::_walk);
+  }
+
+  // Like 'du --exclude', an exclude matches the path if it is the path
+  // or its trailing path components.
+  static bool excluded(const Entry& entry, const string& path)
+  {
+    foreach (const string& exclude, entry.excludes) {
+      if (path == exclude || strings::endsWith(path, "/" + exclude)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // The maximum number of entries visited by '_walk()' at a time.
+  static constexpr size_t WALK_BATCH_SIZE = 4096;
+
   const Duration interval;
+  const bool walk;
 
   // A queue of pending checks.
   deque<Owned<Entry>> entries;
 };
 
 
-DiskUsageCollector::DiskUsageCollector(const Duration& interval)
+DiskUsageCollector::DiskUsageCollector(const Duration& interval, bool walk)
 {
-  process = new DiskUsageCollectorProcess(interval);
+  process = new DiskUsageCollectorProcess(interval, walk);
   spawn(process);
 }
 
@@ -17,6 +17,8 @@
 #ifndef __POSIX_DISK_ISOLATOR_HPP__
 #define __POSIX_DISK_ISOLATOR_HPP__
 
+#include <stdint.h>
+
 #include <string>
 
 #include <process/owned.hpp>
@@ -25,6 +27,7 @@
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
+#include <stout/interval.hpp>
 
 #include "slave/flags.hpp"
 
@@ -43,7 +46,11 @@ class DiskUsageCollectorProcess;
 class DiskUsageCollector
 {
 public:
-  DiskUsageCollector(const Duration& interval);
+  // If 'walk' is true, the paths are traversed within the agent in
+  // batches of entries instead of by running 'du'. This avoids forking
+  // a process for each check, and lets a check be cancelled while it
+  // is in progress.
+  explicit DiskUsageCollector(const Duration& interval, bool walk = false);
   ~DiskUsageCollector();
 
   // Returns the disk usage rooted at 'path'. The user can discard the
@@ -63,6 +70,12 @@ private:
 // much CPU usage and disk caching effects from running 'du' too
 // often.
 //
+// With `--container_disk_usage_backend=project_quota`, the sandbox of
+// each container is assigned a project ID from `--disk_project_range`
+// if its filesystem has project quotas enabled, and the ephemeral usage
+// is read from the kernel's quota accounting instead. Persistent
+// volumes are still checked by the DiskUsageCollector.
+//
 // NOTE: Currently all containers are processed in the same queue,
 // which means that when a container starts, it could take many disk
 // collection intervals until any data is available in the resource
@@ -107,7 +120,9 @@ public:
       const ContainerID& containerId) override;
 
 private:
-  PosixDiskIsolatorProcess(const Flags& flags);
+  PosixDiskIsolatorProcess(
+      const Flags& flags,
+      const IntervalSet<uint32_t>& projectIds);
 
   process::Future<Bytes> collect(
       const ContainerID& containerId,
@@ -118,9 +133,17 @@ private:
       const std::string& path,
       const process::Future<Bytes>& future);
 
+  Option<uint32_t> nextProjectId();
+  void returnProjectId(uint32_t projectId);
+
   const Flags flags;
   DiskUsageCollector collector;
 
+  // The project IDs which can be assigned to sandboxes. These are
+  // empty unless the `project_quota` backend is used.
+  const IntervalSet<uint32_t> totalProjectIds;
+  IntervalSet<uint32_t> freeProjectIds;
+
   struct Info
   {
     explicit Info(const std::string& _directory)
@@ -135,6 +158,17 @@ private:
 
     std::string sandbox;
 
+    // The project ID assigned to the sandbox and the other ephemeral
+    // directories, if their usage is tracked by project quota. In that
+    // case only the sandbox is kept in 'paths' below, with the usage of
+    // all the ephemeral directories.
+    Option<uint32_t> projectId;
+
+    // The block device of the filesystem of the sandbox, which is set
+    // along with 'projectId' so that the usage of the project can be
+    // queried without looking up the mount table on every check.
+    Option<std::string> device;
+
     process::Promise<mesos::slave::ContainerLimitation> limitation;
 
     // The keys of the hashmaps contain the executor working directory
@@ -39,6 +39,7 @@
 using namespace process;
 
 using std::map;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -55,7 +56,8 @@ Try<Launcher*> SubprocessLauncher::create(const Flags& flags)
 
 
 Future<hashset<ContainerID>> SubprocessLauncher::recover(
-    const vector<ContainerState>& states)
+    const vector<ContainerState>& states,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   foreach (const ContainerState& state, states) {
     const ContainerID& containerId = state.container_id();
@@ -20,6 +20,7 @@
 #include <sys/types.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -44,6 +45,9 @@ namespace mesos {
 namespace internal {
 namespace slave {
 
+class RecoverySnapshot;
+
+
 class Launcher
 {
 public:
@@ -51,9 +55,13 @@ public:
 
   // Recover the necessary state for each container listed in state.
   // Return the set of containers that are known to the launcher but
-  // not known to the slave (a.k.a. orphans).
+  // not known to the slave (a.k.a. orphans). The launcher may read
+  // the state of the host from the `snapshot`, which the containerizer
+  // shares with the isolators while it recovers, and which is only set
+  // on Linux.
   virtual process::Future<hashset<ContainerID>> recover(
-      const std::vector<mesos::slave::ContainerState>& states) = 0;
+      const std::vector<mesos::slave::ContainerState>& states,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) = 0;
 
   // Fork a new process in the containerized context. The child will
   // exec the binary at the given path with the given argv, flags and
@@ -96,7 +104,8 @@ public:
   ~SubprocessLauncher() override {}
 
   process::Future<hashset<ContainerID>> recover(
-      const std::vector<mesos::slave::ContainerState>& states) override;
+      const std::vector<mesos::slave::ContainerState>& states,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
 
   Try<pid_t> fork(
       const ContainerID& containerId,
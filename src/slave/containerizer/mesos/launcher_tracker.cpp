@@ -23,6 +23,7 @@
 #include "slave/containerizer/mesos/launcher_tracker.hpp"
 
 using std::map;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -40,10 +41,11 @@ LauncherTracker::LauncherTracker(
 
 
 Future<hashset<ContainerID>> LauncherTracker::recover(
-    const vector<mesos::slave::ContainerState>& states)
+    const vector<mesos::slave::ContainerState>& states,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   return tracker->track(
-      launcher->recover(states),
+      launcher->recover(states, snapshot),
       "launcher::recover",
       COMPONENT_NAME_CONTAINERIZER);
 }
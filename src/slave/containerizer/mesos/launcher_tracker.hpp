@@ -33,7 +33,8 @@ public:
       PendingFutureTracker* _tracker);
 
   process::Future<hashset<ContainerID>> recover(
-      const std::vector<mesos::slave::ContainerState>& states) override;
+      const std::vector<mesos::slave::ContainerState>& states,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
 
   Try<pid_t> fork(
       const ContainerID& containerId,
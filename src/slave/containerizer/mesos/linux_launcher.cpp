@@ -32,6 +32,7 @@
 #include <stout/stringify.hpp>
 
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 #include "linux/ns.hpp"
 #include "linux/systemd.hpp"
 
@@ -40,11 +41,13 @@
 #include "slave/containerizer/mesos/constants.hpp"
 #include "slave/containerizer/mesos/linux_launcher.hpp"
 #include "slave/containerizer/mesos/paths.hpp"
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
 
 using namespace process;
 
 using std::map;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -55,17 +58,19 @@ namespace internal {
 namespace slave {
 
 // Launcher for Linux systems with cgroups. Uses a freezer cgroup to
-// track pids.
+// track pids, or a cgroup of the unified hierarchy on cgroups v2.
 class LinuxLauncherProcess : public Process<LinuxLauncherProcess>
 {
 public:
   LinuxLauncherProcess(
       const Flags& flags,
-      const string& freezerHierarchy,
+      const string& hierarchy,
+      bool unified,
       const Option<string>& systemdHierarchy);
 
   virtual process::Future<hashset<ContainerID>> recover(
-      const vector<mesos::slave::ContainerState>& states);
+      const vector<mesos::slave::ContainerState>& states,
+      const shared_ptr<RecoverySnapshot>& snapshot);
 
   virtual Try<pid_t> fork(
       const ContainerID& containerId,
@@ -85,8 +90,9 @@ public:
 
 private:
   // Helper struct for storing information about each container. A
-  // "container" here means a cgroup in the freezer subsystem that is
-  // used to represent a collection of processes. This container may
+  // "container" here means a cgroup in the freezer subsystem (or in
+  // the unified hierarchy) that is used to represent a collection of
+  // processes. This container may
   // also have multiple namespaces associated with it but that is not
   // managed explicitly here.
   struct Container
@@ -111,7 +117,14 @@ private:
 
   static const string subsystem;
   const Flags flags;
-  const string freezerHierarchy;
+
+  // The freezer hierarchy, or the unified hierarchy if `unified` is
+  // set. In the latter case the processes of a container are placed
+  // in the `cgroups2::LEAF` child of its cgroup, so that the cgroups
+  // of its nested containers can be created next to it.
+  const string hierarchy;
+  const bool unified;
+
   const Option<string> systemdHierarchy;
   hashmap<ContainerID, Container> containers;
 };
@@ -119,6 +132,35 @@ private:
 
 Try<Launcher*> LinuxLauncher::create(const Flags& flags)
 {
+  Try<bool> unified = cgroups2::mounted(flags.cgroups_hierarchy);
+  if (unified.isError()) {
+    return Error(
+        "Failed to determine the cgroups version of " +
+        flags.cgroups_hierarchy + ": " + unified.error());
+  }
+
+  // On the unified hierarchy every cgroup can be killed and waited
+  // for, so no freezer (and no separate systemd) hierarchy is needed.
+  if (unified.get()) {
+    if (!cgroups2::exists(flags.cgroups_hierarchy, flags.cgroups_root)) {
+      Try<Nothing> create = cgroups2::create(
+          flags.cgroups_hierarchy,
+          flags.cgroups_root,
+          true);
+
+      if (create.isError()) {
+        return Error(
+            "Failed to create cgroup root under the unified hierarchy: " +
+            create.error());
+      }
+    }
+
+    LOG(INFO) << "Using " << flags.cgroups_hierarchy
+              << " as the unified hierarchy for the Linux launcher";
+
+    return new LinuxLauncher(flags, flags.cgroups_hierarchy, true, None());
+  }
+
   Try<string> freezerHierarchy = cgroups::prepare(
       flags.cgroups_hierarchy,
       "freezer",
@@ -180,6 +222,7 @@ Try<Launcher*> LinuxLauncher::create(const Flags& flags)
   return new LinuxLauncher(
       flags,
       freezerHierarchy.get(),
+      false,
       systemdHierarchy);
 }
 
@@ -188,9 +231,23 @@ bool LinuxLauncher::available()
 {
   // Make sure:
   //   1. Are running as root.
-  //   2. 'freezer' subsystem is enabled.
+  //   2. 'freezer' subsystem is enabled, or the unified hierarchy is
+  //      mounted.
+  if (::geteuid() != 0) {
+    return false;
+  }
+
   Try<bool> freezer = cgroups::enabled("freezer");
-  return ::geteuid() == 0 && freezer.isSome() && freezer.get();
+  if (freezer.isSome() && freezer.get()) {
+    return true;
+  }
+
+  // NOTE: This is used for the default of `--launcher`, i.e., before
+  // `--cgroups_hierarchy` is known, so we look for the unified hierarchy
+  // wherever it is mounted. `create` then uses it only if it is mounted
+  // at `--cgroups_hierarchy`.
+  Result<string> unified = cgroups2::hierarchy();
+  return unified.isSome();
 }
 
 
@@ -209,9 +266,14 @@ string LinuxLauncher::cgroup(
 
 LinuxLauncher::LinuxLauncher(
     const Flags& flags,
-    const string& freezerHierarchy,
+    const string& hierarchy,
+    bool unified,
     const Option<string>& systemdHierarchy)
-  : process(new LinuxLauncherProcess(flags, freezerHierarchy, systemdHierarchy))
+  : process(new LinuxLauncherProcess(
+        flags,
+        hierarchy,
+        unified,
+        systemdHierarchy))
 {
   process::spawn(process.get());
 }
@@ -225,9 +287,11 @@ LinuxLauncher::~LinuxLauncher()
 
 
 Future<hashset<ContainerID>> LinuxLauncher::recover(
-    const vector<mesos::slave::ContainerState>& states)
+    const vector<mesos::slave::ContainerState>& states,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
-  return dispatch(process.get(), &LinuxLauncherProcess::recover, states);
+  return dispatch(
+      process.get(), &LinuxLauncherProcess::recover, states, snapshot);
 }
 
 
@@ -273,15 +337,18 @@ Future<ContainerStatus> LinuxLauncher::status(
 // `_systemdHierarchy` is only set if running on a systemd environment.
 LinuxLauncherProcess::LinuxLauncherProcess(
     const Flags& _flags,
-    const string& _freezerHierarchy,
+    const string& _hierarchy,
+    bool _unified,
     const Option<string>& _systemdHierarchy)
   : flags(_flags),
-    freezerHierarchy(_freezerHierarchy),
+    hierarchy(_hierarchy),
+    unified(_unified),
     systemdHierarchy(_systemdHierarchy) {}
 
 
 Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
-    const vector<ContainerState>& states)
+    const vector<ContainerState>& states,
+    const shared_ptr<RecoverySnapshot>& snapshot)
 {
   LOG(INFO) << "Recovering Linux launcher";
 
@@ -291,22 +358,27 @@ Future<hashset<ContainerID>> LinuxLauncherProcess::recover(
   hashset<string> cgroups;
 
   Try<vector<string>> freezerCgroups =
-    cgroups::get(freezerHierarchy, flags.cgroups_root);
+    snapshot->cgroups(hierarchy, flags.cgroups_root, unified);
 
   if (freezerCgroups.isError()) {
     return Failure(
         "Failed to get cgroups from " +
-        path::join(freezerHierarchy, flags.cgroups_root) +
+        path::join(hierarchy, flags.cgroups_root) +
         ": "+ freezerCgroups.error());
   }
 
   foreach (const string& cgroup, freezerCgroups.get()) {
+    // The leaf cgroups only hold the processes of their parent.
+    if (unified && Path(cgroup).basename() == cgroups2::LEAF) {
+      continue;
+    }
+
     cgroups.insert(cgroup);
   }
 
   if (systemdHierarchy.isSome()) {
     Try<vector<string>> systemdCgroups =
-      cgroups::get(systemdHierarchy.get(), flags.cgroups_root);
+      snapshot->cgroups(systemdHierarchy.get(), flags.cgroups_root);
 
     if (systemdCgroups.isError()) {
       return Failure(
@@ -506,13 +578,34 @@ Try<pid_t> LinuxLauncherProcess::fork(
   // must be in the freezer cgroup.
   vector<Subprocess::ParentHook> parentHooks;
 
-  // Hook for creating and assigning the child into a freezer cgroup.
-  parentHooks.emplace_back(Subprocess::ParentHook([=](pid_t child) {
-    return cgroups::isolate(
-        freezerHierarchy,
-        LinuxLauncher::cgroup(this->flags.cgroups_root, containerId),
-        child);
-  }));
+  // Hook for creating and assigning the child into a freezer cgroup,
+  // or into the leaf of its cgroup in the unified hierarchy.
+  if (unified) {
+    parentHooks.emplace_back(Subprocess::ParentHook(
+        [=](pid_t child) -> Try<Nothing> {
+          const string leaf = path::join(
+              LinuxLauncher::cgroup(this->flags.cgroups_root, containerId),
+              cgroups2::LEAF);
+
+          if (!cgroups2::exists(hierarchy, leaf)) {
+            Try<Nothing> create = cgroups2::create(hierarchy, leaf, true);
+            if (create.isError()) {
+              return Error(
+                  "Failed to create cgroup '" + leaf + "': " +
+                  create.error());
+            }
+          }
+
+          return cgroups2::assign(hierarchy, leaf, child);
+        }));
+  } else {
+    parentHooks.emplace_back(Subprocess::ParentHook([=](pid_t child) {
+      return cgroups::isolate(
+          hierarchy,
+          LinuxLauncher::cgroup(this->flags.cgroups_root, containerId),
+          child);
+    }));
+  }
 
   // Hook for creating and assigning the child into a systemd cgroup.
   if (systemdHierarchy.isSome()) {
@@ -608,7 +701,9 @@ Future<Nothing> LinuxLauncherProcess::destroy(const ContainerID& containerId)
   // is considered partially destroyed if we have recovered it from
   // ContainerState but we don't have a freezer cgroup for it. If this
   // is a partially destroyed container than there is nothing to do.
-  if (!cgroups::exists(freezerHierarchy, cgroup)) {
+  if (unified
+        ? !cgroups2::exists(hierarchy, cgroup)
+        : !cgroups::exists(hierarchy, cgroup)) {
     LOG(WARNING) << "Couldn't find freezer cgroup for container "
                  << container->id << " so assuming partially destroyed";
 
@@ -616,15 +711,27 @@ Future<Nothing> LinuxLauncherProcess::destroy(const ContainerID& containerId)
   }
 
   LOG(INFO) << "Destroying cgroup '"
-            << path::join(freezerHierarchy, cgroup) << "'";
+            << path::join(hierarchy, cgroup) << "'";
 
   // TODO(benh): If this is the last container at a nesting level,
   // should we also delete the `CGROUP_SEPARATOR` cgroup too?
 
+  if (unified) {
+    const Duration timeout = flags.cgroups_destroy_timeout;
+
+    return cgroups2::destroy(hierarchy, cgroup)
+      .after(timeout, [=](Future<Nothing> future) -> Future<Nothing> {
+        future.discard();
+        return Failure(
+            "Timed out after " + stringify(timeout) +
+            " destroying cgroup '" + cgroup + "'");
+      });
+  }
+
   // TODO(benh): What if we fail to destroy the container? Should we
   // retry?
   return cgroups::destroy(
-      freezerHierarchy,
+      hierarchy,
       cgroup,
       flags.cgroups_destroy_timeout)
     .then(defer(
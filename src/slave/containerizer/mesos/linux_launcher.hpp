@@ -28,7 +28,8 @@ namespace slave {
 class LinuxLauncherProcess;
 
 // Launcher for Linux systems with cgroups. Uses a freezer cgroup to
-// track pids.
+// track pids, or a cgroup of the unified hierarchy if the cgroups v2
+// file system is mounted at `--cgroups_hierarchy`.
 class LinuxLauncher : public Launcher
 {
 public:
@@ -46,7 +47,8 @@ public:
   ~LinuxLauncher() override;
 
   process::Future<hashset<ContainerID>> recover(
-      const std::vector<mesos::slave::ContainerState>& states) override;
+      const std::vector<mesos::slave::ContainerState>& states,
+      const std::shared_ptr<RecoverySnapshot>& snapshot) override;
 
   Try<pid_t> fork(
       const ContainerID& containerId,
@@ -67,7 +69,8 @@ public:
 private:
   LinuxLauncher(
       const Flags& flags,
-      const std::string& freezerHierarchy,
+      const std::string& hierarchy,
+      bool unified,
       const Option<std::string>& systemdHierarchy);
 
   process::Owned<LinuxLauncherProcess> process;
@@ -0,0 +1,95 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MESOS_CONTAINERIZER_PERF_SAMPLES_HPP__
+#define __MESOS_CONTAINERIZER_PERF_SAMPLES_HPP__
+
+#include <mutex>
+#include <vector>
+
+#include <mesos/mesos.hpp>
+#include <mesos/type_utils.hpp>
+
+#include <stout/circular_buffer.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/synchronized.hpp>
+
+#include "slave/containerizer/mesos/constants.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// The most recent perf samples of each container, which are added by
+// the cgroups perf_event subsystem and served by the `/monitor/perf`
+// endpoint of the agent. They are kept out of `ResourceStatistics`, so
+// that the samples are not copied along with every usage of a container.
+//
+// NOTE: The samples are added and read from different actors, so all
+// the accesses are synchronized rather than dispatched, which keeps a
+// read of the endpoint from waiting behind the containerizer.
+class PerfSamples
+{
+public:
+  void add(const ContainerID& containerId, const PerfStatistics& sample)
+  {
+    synchronized (mutex) {
+      if (!samples.contains(containerId)) {
+        samples.put(
+            containerId,
+            circular_buffer<PerfStatistics>(PERF_EVENT_SAMPLES));
+      }
+
+      samples.at(containerId).push_back(sample);
+    }
+  }
+
+  void remove(const ContainerID& containerId)
+  {
+    synchronized (mutex) {
+      samples.erase(containerId);
+    }
+  }
+
+  // Returns the samples of each container, oldest first.
+  hashmap<ContainerID, std::vector<PerfStatistics>> get() const
+  {
+    hashmap<ContainerID, std::vector<PerfStatistics>> result;
+
+    synchronized (mutex) {
+      foreachpair (const ContainerID& containerId,
+                   const circular_buffer<PerfStatistics>& buffer,
+                   samples) {
+        result.put(
+            containerId,
+            std::vector<PerfStatistics>(buffer.begin(), buffer.end()));
+      }
+    }
+
+    return result;
+  }
+
+private:
+  mutable std::mutex mutex;
+  hashmap<ContainerID, circular_buffer<PerfStatistics>> samples;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MESOS_CONTAINERIZER_PERF_SAMPLES_HPP__
@@ -53,6 +53,12 @@ string getImageLayerPath(const string& storeDir, const string& layerId)
 Try<list<string>> listLayers(const string& storeDir)
 {
   const string layersDir = path::join(storeDir, "layers");
+
+  // The layers directory is only created along with the first layer.
+  if (!os::exists(layersDir)) {
+    return list<string>();
+  }
+
   return os::ls(layersDir);
 }
 
@@ -88,6 +94,22 @@ string getImageLayerRootfsPath(
 }
 
 
+string getImageLayerLazyRootfsPath(
+    const string& storeDir,
+    const string& layerId)
+{
+  return path::join(getImageLayerPath(storeDir, layerId), "rootfs.lazy");
+}
+
+
+string getImageLayerPrefetchListPath(
+    const string& storeDir,
+    const string& layerId)
+{
+  return path::join(getImageLayerPath(storeDir, layerId), "prefetch");
+}
+
+
 string getImageLayerTarPath(const string& layerPath)
 {
   return path::join(layerPath, "layer.tar");
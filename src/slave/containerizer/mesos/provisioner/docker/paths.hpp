@@ -40,6 +40,8 @@ namespace paths {
  *    |--layers
  *       |--<layer_id>
  *           |-- rootfs
+ *           |-- rootfs.lazy (mount point of a lazily pulled layer)
+ *           |-- prefetch (files accessed by previous lazy mounts)
  *           |-- json(manifest)
  *           |-- VERSION
  *    |--storedImages (file holding on cached images)
@@ -78,6 +80,21 @@ std::string getImageLayerRootfsPath(
     const std::string& backend);
 
 
+// The mount point of a layer mounted by the lazy layer mounter (see
+// the `--docker_lazy_layer_mounter` agent flag). Once mounted, the
+// overlay rootfs of the layer is a symlink to it.
+std::string getImageLayerLazyRootfsPath(
+    const std::string& storeDir,
+    const std::string& layerId);
+
+
+// The list of the files of a layer which were accessed through its
+// lazy mounts, which the lazy layer mounter fetches ahead of time.
+std::string getImageLayerPrefetchListPath(
+    const std::string& storeDir,
+    const std::string& layerId);
+
+
 std::string getImageLayerTarPath(
     const std::string& layerPath);
 
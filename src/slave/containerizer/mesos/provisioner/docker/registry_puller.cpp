@@ -14,6 +14,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef __WINDOWS__
+#include <unistd.h>
+#endif // __WINDOWS__
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 #include <glog/logging.h>
 
 #include <mesos/secret/resolver.hpp>
@@ -22,17 +33,44 @@
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
 #include <process/http.hpp>
-
+#include <process/subprocess.hpp>
+
+#include <process/metrics/metrics.hpp>
+#include <process/metrics/timer.hpp>
+
+#include <stout/archiver.hpp>
+#include <stout/foreach.hpp>
+#include <stout/fs.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/synchronized.hpp>
+
+#include <stout/os/constants.hpp>
+#include <stout/os/environment.hpp>
 #include <stout/os/exists.hpp>
+#include <stout/os/killtree.hpp>
 #include <stout/os/mkdir.hpp>
+#include <stout/os/realpath.hpp>
 #include <stout/os/rename.hpp>
 #include <stout/os/rm.hpp>
 #include <stout/os/write.hpp>
 
-#include "common/command_utils.hpp"
+#include "common/status_utils.hpp"
+
+#ifdef __linux__
+#include "linux/fs.hpp"
+#endif // __linux__
+
+#include "uri/utils.hpp"
 
 #include "uri/schemes/docker.hpp"
 
+#include "slave/constants.hpp"
+
+#include "slave/containerizer/mesos/provisioner/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/docker/paths.hpp"
 #include "slave/containerizer/mesos/provisioner/docker/registry_puller.hpp"
 
@@ -46,11 +84,14 @@ using process::Failure;
 using process::Future;
 using process::Owned;
 using process::Process;
+using process::Promise;
 using process::Shared;
+using process::Subprocess;
 
 using process::defer;
 using process::dispatch;
 using process::spawn;
+using process::subprocess;
 using process::wait;
 
 namespace mesos {
@@ -58,6 +99,92 @@ namespace internal {
 namespace slave {
 namespace docker {
 
+// Runs the extractions of layer tarballs on a fixed number of threads of
+// its own, so that their disk IO and decompression never block the
+// libprocess worker threads.
+//
+// NOTE: Like `ns::NamespaceRunner`, this uses a mutex and a condition
+// variable rather than a `process::Queue`, since its threads are not
+// managed by libprocess.
+class LayerExtractor
+{
+public:
+  explicit LayerExtractor(size_t parallelism) : finished(false)
+  {
+    for (size_t i = 0; i < parallelism; i++) {
+      threads.emplace_back(&LayerExtractor::loop, this);
+    }
+  }
+
+  ~LayerExtractor()
+  {
+    // The queued extractions are dropped, which abandons their futures.
+    std::queue<lambda::function<void()>> dropped;
+
+    synchronized (mutex) {
+      finished = true;
+      std::swap(queue, dropped);
+      cond.notify_all();
+    }
+
+    foreach (std::thread& thread, threads) {
+      thread.join();
+    }
+  }
+
+  Future<Duration> extract(const lambda::function<Try<Duration>()>& f)
+  {
+    std::shared_ptr<Promise<Duration>> promise(new Promise<Duration>());
+    Future<Duration> future = promise->future();
+
+    synchronized (mutex) {
+      queue.push([=]() {
+        Try<Duration> result = f();
+        if (result.isError()) {
+          promise->fail(result.error());
+        } else {
+          promise->set(result.get());
+        }
+      });
+
+      cond.notify_one();
+    }
+
+    return future;
+  }
+
+private:
+  void loop()
+  {
+    for (;;) {
+      lambda::function<void()> f;
+
+      synchronized (mutex) {
+        while (queue.empty() && !finished) {
+          synchronized_wait(&cond, &mutex);
+        }
+
+        if (finished) {
+          return;
+        }
+
+        f = std::move(queue.front());
+        queue.pop();
+      }
+
+      f();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::queue<lambda::function<void()>> queue;
+  bool finished;
+
+  vector<std::thread> threads;
+};
+
+
 class RegistryPullerProcess : public Process<RegistryPullerProcess>
 {
 public:
@@ -65,7 +192,9 @@ public:
       const string& _storeDir,
       const http::URL& _defaultRegistryUrl,
       const Shared<uri::Fetcher>& _fetcher,
-      SecretResolver* _secretResolver);
+      SecretResolver* _secretResolver,
+      const Option<string>& _lazyLayerMounter,
+      const Option<JSON::Object>& _dockerConfig);
 
   Future<Image> pull(
       const spec::ImageReference& reference,
@@ -86,44 +215,69 @@ private:
       const string& backend,
       const Option<Secret::Value>& config);
 
+  // Each layer is extracted as soon as its blob is fetched, while the
+  // blobs of the other layers are still being fetched.
   Future<Image> ___pull(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums,
-    const string& backend);
+      const spec::ImageReference& reference,
+      const spec::ImageReference& normalizedRef,
+      const string& directory,
+      const spec::v2::ImageManifest& manifest,
+      const string& backend,
+      const Option<Secret::Value>& config);
 
   Future<Image> ____pull(
-    const spec::ImageReference& reference,
-    const string& directory,
-    const spec::v2_2::ImageManifest& manifest,
-    const hashset<string>& digests,
-    const string& backend);
-
-  Future<hashset<string>> fetchBlobs(
-    const spec::ImageReference& normalizedRef,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const string& backend,
-    const Option<Secret::Value>& config);
-
-  Future<hashset<string>> fetchBlobs(
+      const spec::ImageReference& reference,
       const spec::ImageReference& normalizedRef,
       const string& directory,
       const spec::v2_2::ImageManifest& manifest,
       const string& backend,
       const Option<Secret::Value>& config);
 
-  Future<hashset<string>> fetchBlobs(
+  Try<URI> getBlobUri(
+      const spec::ImageReference& normalizedRef,
+      const string& digest);
+
+  Future<Nothing> fetchBlob(
       const spec::ImageReference& normalizedRef,
       const string& directory,
-      const hashset<string>& digests,
-      const string& backend,
+      const string& digest,
+      const Option<Secret::Value>& config);
+
+  Future<Nothing> extractLayer(const string& tar, const string& rootfs);
+
+  // Mounts the layer directly in the store with the lazy layer
+  // mounter, instead of fetching and extracting it.
+  Future<Nothing> mountLayer(
+      const spec::ImageReference& normalizedRef,
+      const string& digest,
       const Option<Secret::Value>& config);
 
   RegistryPullerProcess(const RegistryPullerProcess&) = delete;
   RegistryPullerProcess& operator=(const RegistryPullerProcess&) = delete;
 
+  struct Metrics
+  {
+    Metrics() :
+        layer_pull(
+          "containerizer/mesos/provisioner/docker_store/layer_pull", Hours(1)),
+        layer_extraction(
+          "containerizer/mesos/provisioner/docker_store/layer_extraction",
+          Hours(1))
+    {
+      process::metrics::add(layer_pull);
+      process::metrics::add(layer_extraction);
+    }
+
+    ~Metrics()
+    {
+      process::metrics::remove(layer_pull);
+      process::metrics::remove(layer_extraction);
+    }
+
+    process::metrics::Timer<Milliseconds> layer_pull;
+    process::metrics::Timer<Milliseconds> layer_extraction;
+  };
+
   const string storeDir;
 
   // If the user does not specify the registry url in the image
@@ -132,6 +286,19 @@ private:
 
   Shared<uri::Fetcher> fetcher;
   SecretResolver* secretResolver;
+
+  // The layers of all the images being pulled are extracted by this
+  // extractor, which bounds the number of concurrent extractions.
+  LayerExtractor extractor;
+
+  const Option<string> lazyLayerMounter;
+  const Option<JSON::Object> dockerConfig;
+
+  // The layers being mounted lazily, keyed by digest, as images being
+  // pulled at the same time may share layers.
+  hashmap<string, Future<Nothing>> mounting;
+
+  Metrics metrics;
 };
 
 
@@ -155,7 +322,9 @@ Try<Owned<Puller>> RegistryPuller::create(
           flags.docker_store_dir,
           defaultRegistryUrl.get(),
           fetcher,
-          secretResolver));
+          secretResolver,
+          flags.docker_lazy_layer_mounter,
+          flags.docker_config));
 
   return Owned<Puller>(new RegistryPuller(process));
 }
@@ -195,12 +364,17 @@ RegistryPullerProcess::RegistryPullerProcess(
     const string& _storeDir,
     const http::URL& _defaultRegistryUrl,
     const Shared<uri::Fetcher>& _fetcher,
-    SecretResolver* _secretResolver)
+    SecretResolver* _secretResolver,
+    const Option<string>& _lazyLayerMounter,
+    const Option<JSON::Object>& _dockerConfig)
   : ProcessBase(process::ID::generate("docker-provisioner-registry-puller")),
     storeDir(_storeDir),
     defaultRegistryUrl(_defaultRegistryUrl),
     fetcher(_fetcher),
-    secretResolver(_secretResolver) {}
+    secretResolver(_secretResolver),
+    extractor(DOCKER_LAYER_EXTRACTION_PARALLELISM),
+    lazyLayerMounter(_lazyLayerMounter),
+    dockerConfig(_dockerConfig) {}
 
 
 static spec::ImageReference normalize(
@@ -361,14 +535,13 @@ Future<Image> RegistryPullerProcess::__pull(
       return Failure("Failed to parse the manifest: " + manifest.error());
     }
 
-    return fetchBlobs(normalizedRef, directory, manifest.get(), backend, config)
-      .then(defer(self(),
-                  &Self::____pull,
-                  reference,
-                  directory,
-                  manifest.get(),
-                  lambda::_1,
-                  backend));
+    return ____pull(
+        reference,
+        normalizedRef,
+        directory,
+        manifest.get(),
+        backend,
+        config);
   }
 
   // By default treat the manifest format as schema 1.
@@ -383,23 +556,23 @@ Future<Image> RegistryPullerProcess::__pull(
     return Failure("'fsLayers' and 'history' have different size in manifest");
   }
 
-  return fetchBlobs(normalizedRef, directory, manifest.get(), backend, config)
-    .then(defer(self(),
-                &Self::___pull,
-                reference,
-                directory,
-                manifest.get(),
-                lambda::_1,
-                backend));
+  return ___pull(
+      reference,
+      normalizedRef,
+      directory,
+      manifest.get(),
+      backend,
+      config);
 }
 
 
 Future<Image> RegistryPullerProcess::___pull(
     const spec::ImageReference& reference,
+    const spec::ImageReference& normalizedRef,
     const string& directory,
     const spec::v2::ImageManifest& manifest,
-    const hashset<string>& blobSums,
-    const string& backend)
+    const string& backend,
+    const Option<Secret::Value>& config)
 {
   // Docker reads the layer ids from the disk:
   // https://github.com/docker/docker/blob/v1.13.0/layer/filestore.go#L310
@@ -423,6 +596,10 @@ Future<Image> RegistryPullerProcess::___pull(
   vector<string> layerIds;
   vector<Future<Nothing>> futures;
 
+  // NOTE: There might exist duplicated blob sums in 'fsLayers', e.g.,
+  // for empty layers. We just need to fetch one of them.
+  hashmap<string, Future<Nothing>> blobs;
+
   // The order of `fslayers` should be [child, parent, ...].
   //
   // The content in the parent will be overwritten by the child if
@@ -454,9 +631,6 @@ Future<Image> RegistryPullerProcess::___pull(
     const string rootfs = paths::getImageLayerRootfsPath(layerPath, backend);
     const string json = paths::getImageLayerManifestPath(layerPath);
 
-    VLOG(1) << "Extracting layer tar ball '" << tar
-            << " to rootfs '" << rootfs << "'";
-
     // NOTE: This will create 'layerPath' as well.
     Try<Nothing> mkdir = os::mkdir(rootfs, true);
     if (mkdir.isError()) {
@@ -472,13 +646,22 @@ Future<Image> RegistryPullerProcess::___pull(
           v1.id() + "': " + write.error());
     }
 
-    futures.push_back(command::untar(Path(tar), Path(rootfs)));
+    if (!blobs.contains(blobSum)) {
+      VLOG(1) << "Fetching blob '" << blobSum << "' for layer '"
+              << v1.id() << "' of image '" << normalizedRef << "'";
+
+      blobs[blobSum] = metrics.layer_pull.time(
+          fetchBlob(normalizedRef, directory, blobSum, config));
+    }
+
+    futures.push_back(blobs[blobSum]
+      .then(defer(self(), &Self::extractLayer, tar, rootfs)));
   }
 
   return collect(futures)
     .then([=]() -> Future<Image> {
       // Remove the tarballs after the extraction.
-      foreach (const string& blobSum, blobSums) {
+      foreachkey (const string& blobSum, blobs) {
         const string tar = path::join(directory, blobSum);
 
         Try<Nothing> rm = os::rm(tar);
@@ -502,15 +685,32 @@ Future<Image> RegistryPullerProcess::___pull(
 
 Future<Image> RegistryPullerProcess::____pull(
     const spec::ImageReference& reference,
+    const spec::ImageReference& normalizedRef,
     const string& directory,
     const spec::v2_2::ImageManifest& manifest,
-    const hashset<string>& digests,
-    const string& backend)
+    const string& backend,
+    const Option<Secret::Value>& config)
 {
   hashset<string> uniqueIds;
   vector<string> layerIds;
   vector<Future<Nothing>> futures;
 
+  // Lazily mounted layers are only supported by the overlay backend,
+  // which takes the layers as they are mounted.
+  const bool lazy =
+    lazyLayerMounter.isSome() && backend == OVERLAY_BACKEND;
+
+  const string& configDigest = manifest.config().digest();
+  if (!os::exists(paths::getImageLayerPath(storeDir, configDigest))) {
+    VLOG(1) << "Fetching config '" << configDigest << "' for image '"
+            << normalizedRef << "'";
+
+    futures.push_back(
+        fetchBlob(normalizedRef, directory, configDigest, config));
+  }
+
+  // NOTE: There might exist duplicated digests in 'layers'. We just
+  // need to fetch and extract one of them.
   for (int i = 0; i < manifest.layers_size(); i++) {
     const string& digest = manifest.layers(i).digest();
     if (uniqueIds.contains(digest)) {
@@ -525,54 +725,61 @@ Future<Image> RegistryPullerProcess::____pull(
       continue;
     }
 
+    if (lazy) {
+      futures.push_back(mountLayer(normalizedRef, digest, config));
+      continue;
+    }
+
     const string layerPath = path::join(directory, digest);
     const string originalTar = path::join(directory, digest);
     const string tar = path::join(directory, digest + "-archive");
     const string rootfs = paths::getImageLayerRootfsPath(layerPath, backend);
 
-    VLOG(1) << "Moving layer tar ball '" << originalTar
-            << "' to '" << tar << "'";
-
-    // Move layer tar ball to use its name for the extracted layer directory.
-    Try<Nothing> rename = os::rename(originalTar, tar);
-    if (rename.isError()) {
-      return Failure(
-          "Failed to move the layer tar ball from '" + originalTar +
-          "' to '" + tar + "': " + rename.error());
-    }
-
-    VLOG(1) << "Extracting layer tar ball '" << tar
-            << "' to rootfs '" << rootfs << "'";
-
-    // NOTE: This will create 'layerPath' as well.
-    Try<Nothing> mkdir = os::mkdir(rootfs, true);
-    if (mkdir.isError()) {
-      return Failure(
-          "Failed to create rootfs directory '" + rootfs + "' "
-          "for layer '" + digest + "': " + mkdir.error());
-    }
+    VLOG(1) << "Fetching layer '" << digest << "' for image '"
+            << normalizedRef << "'";
 
-    futures.push_back(command::untar(Path(tar), Path(rootfs)));
-  }
+    Future<Nothing> extracted = metrics.layer_pull.time(
+        fetchBlob(normalizedRef, directory, digest, config))
+      .then(defer(self(), [=]() -> Future<Nothing> {
+        VLOG(1) << "Moving layer tar ball '" << originalTar
+                << "' to '" << tar << "'";
 
-  return collect(futures)
-    .then([=]() -> Future<Image> {
-      // Remove the tarballs after the extraction.
-      foreach (const string& digest, digests) {
-        // Skip if the digest represents the image manifest config.
-        if (digest == manifest.config().digest()) {
-          continue;
+        // Move layer tar ball to use its name for the extracted layer
+        // directory.
+        Try<Nothing> rename = os::rename(originalTar, tar);
+        if (rename.isError()) {
+          return Failure(
+              "Failed to move the layer tar ball from '" + originalTar +
+              "' to '" + tar + "': " + rename.error());
         }
 
-        const string tar = path::join(directory, digest + "-archive");
+        // NOTE: This will create 'layerPath' as well.
+        Try<Nothing> mkdir = os::mkdir(rootfs, true);
+        if (mkdir.isError()) {
+          return Failure(
+              "Failed to create rootfs directory '" + rootfs + "' "
+              "for layer '" + digest + "': " + mkdir.error());
+        }
 
+        return extractLayer(tar, rootfs);
+      }))
+      .then([=]() -> Future<Nothing> {
+        // Remove the tarball right after the extraction, so the
+        // tarballs of a large image do not all take space at once.
         Try<Nothing> rm = os::rm(tar);
         if (rm.isError()) {
           return Failure(
               "Failed to remove '" + tar + "' after extraction: " + rm.error());
         }
-      }
 
+        return Nothing();
+      });
+
+    futures.push_back(extracted);
+  }
+
+  return collect(futures)
+    .then([=]() -> Future<Image> {
       Image image;
       image.set_config_digest(manifest.config().digest());
       image.mutable_reference()->CopyFrom(reference);
@@ -585,139 +792,267 @@ Future<Image> RegistryPullerProcess::____pull(
 }
 
 
-Future<hashset<string>> RegistryPullerProcess::fetchBlobs(
+Try<URI> RegistryPullerProcess::getBlobUri(
     const spec::ImageReference& normalizedRef,
-    const string& directory,
-    const spec::v2::ImageManifest& manifest,
-    const string& backend,
-    const Option<Secret::Value>& config)
+    const string& digest)
 {
-  // First, find all the blobs that need to be fetched.
-  //
-  // NOTE: There might exist duplicated blob sums in 'fsLayers'. We
-  // just need to fetch one of them.
-  hashset<string> blobSums;
-
-  for (int i = 0; i < manifest.fslayers_size(); i++) {
-    CHECK(manifest.history(i).has_v1());
-    const spec::v1::ImageManifest& v1 = manifest.history(i).v1();
+  if (normalizedRef.has_registry()) {
+    Result<int> port = spec::getRegistryPort(normalizedRef.registry());
+    if (port.isError()) {
+      return Error("Failed to get registry port: " + port.error());
+    }
 
-    // Check if the layer is in the store or not. If yes, skip the
-    // unnecessary fetching.
-    if (os::exists(
-        paths::getImageLayerRootfsPath(storeDir, v1.id(), backend))) {
-      continue;
+    Try<string> scheme = spec::getRegistryScheme(normalizedRef.registry());
+    if (scheme.isError()) {
+      return Error("Failed to get registry scheme: " + scheme.error());
     }
 
-    const string& blobSum = manifest.fslayers(i).blobsum();
+    // If users want to use the registry specified in '--docker_image',
+    // an URL scheme must be specified in '--docker_registry', because
+    // there is no scheme allowed in docker image name.
+    return uri::docker::blob(
+        normalizedRef.repository(),
+        digest,
+        spec::getRegistryHost(normalizedRef.registry()),
+        scheme.get(),
+        port.isSome() ? port.get() : Option<int>());
+  }
 
-    VLOG(1) << "Fetching blob '" << blobSum << "' for layer '"
-            << v1.id() << "' of image '" << normalizedRef << "'";
+  const string registry = defaultRegistryUrl.domain.isSome()
+    ? defaultRegistryUrl.domain.get()
+    : stringify(defaultRegistryUrl.ip.get());
 
-    blobSums.insert(blobSum);
-  }
+  const Option<int> port = defaultRegistryUrl.port.isSome()
+    ? static_cast<int>(defaultRegistryUrl.port.get())
+    : Option<int>();
 
-  return fetchBlobs(normalizedRef, directory, blobSums, backend, config);
+  return uri::docker::blob(
+      normalizedRef.repository(),
+      digest,
+      registry,
+      defaultRegistryUrl.scheme,
+      port);
 }
 
 
-Future<hashset<string>> RegistryPullerProcess::fetchBlobs(
+Future<Nothing> RegistryPullerProcess::fetchBlob(
     const spec::ImageReference& normalizedRef,
     const string& directory,
-    const spec::v2_2::ImageManifest& manifest,
-    const string& backend,
+    const string& digest,
     const Option<Secret::Value>& config)
 {
-  // First, find all the blobs that need to be fetched.
-  //
-  // NOTE: There might exist duplicated digests in 'layers'. We
-  // just need to fetch one of them.
-  hashset<string> digests;
+  Try<URI> blobUri = getBlobUri(normalizedRef, digest);
+  if (blobUri.isError()) {
+    return Failure(blobUri.error());
+  }
+
+  return fetcher->fetch(
+      blobUri.get(),
+      directory,
+      config.isSome() ? config->data() : Option<string>());
+}
 
-  const string& configDigest = manifest.config().digest();
-  if (!os::exists(paths::getImageLayerPath(storeDir, configDigest))) {
-    VLOG(1) << "Fetching config '" << configDigest << "' for image '"
-            << normalizedRef << "'";
 
-    digests.insert(configDigest);
+// Extracts the layer tarball with libarchive, rather than forking
+// `tar`. Like `tar`, the owners of the files are only restored when
+// running as root. Entries with '..' in their path or extracted
+// through a symlink are refused, so a layer cannot write outside of
+// its rootfs.
+static Try<Nothing> extract(const string& tar, const string& rootfs)
+{
+  int flags =
+    ARCHIVE_EXTRACT_TIME |
+    ARCHIVE_EXTRACT_PERM |
+    ARCHIVE_EXTRACT_SECURE_NODOTDOT |
+    ARCHIVE_EXTRACT_SECURE_SYMLINKS;
+
+#ifndef __WINDOWS__
+  if (::geteuid() == 0) {
+    flags |= ARCHIVE_EXTRACT_OWNER;
   }
+#endif // __WINDOWS__
 
-  for (int i = 0; i < manifest.layers_size(); i++) {
-    const string& digest = manifest.layers(i).digest();
+  // The symlinks check also applies to the rootfs path itself, so we
+  // resolve the symlinks in it, e.g., in the path of the store.
+  Result<string> realpath = os::realpath(rootfs);
+  if (!realpath.isSome()) {
+    return Error(
+        "Failed to resolve '" + rootfs + "': " +
+        (realpath.isError() ? realpath.error() : "No such directory"));
+  }
 
-    // Check if the layer is in the store or not. If yes, skip the unnecessary
-    // fetching.
-    if (os::exists(paths::getImageLayerRootfsPath(storeDir, digest, backend))) {
-      continue;
-    }
+  return archiver::extract(tar, realpath.get(), flags);
+}
 
-    VLOG(1) << "Fetching layer '" << digest << "' for image '"
-            << normalizedRef << "'";
 
-    digests.insert(digest);
-  }
+Future<Nothing> RegistryPullerProcess::extractLayer(
+    const string& tar,
+    const string& rootfs)
+{
+  VLOG(1) << "Extracting layer tar ball '" << tar
+          << "' to rootfs '" << rootfs << "'";
+
+  return extractor.extract([=]() -> Try<Duration> {
+      // Only the extraction itself is timed, not the time the layer
+      // waited for a thread of the extractor.
+      Stopwatch stopwatch;
+      stopwatch.start();
+
+      Try<Nothing> extraction = extract(tar, rootfs);
+      if (extraction.isError()) {
+        return Error(
+            "Failed to extract layer tar ball '" + tar + "': " +
+            extraction.error());
+      }
 
-  return fetchBlobs(normalizedRef, directory, digests, backend, config);
+      return stopwatch.elapsed();
+    })
+    .then(defer(self(), [this](const Duration& elapsed) {
+      metrics.layer_extraction.record(elapsed);
+      return Nothing();
+    }));
 }
 
 
-Future<hashset<string>> RegistryPullerProcess::fetchBlobs(
+Future<Nothing> RegistryPullerProcess::mountLayer(
     const spec::ImageReference& normalizedRef,
-    const string& directory,
-    const hashset<string>& digests,
-    const string& backend,
+    const string& digest,
     const Option<Secret::Value>& config)
 {
-  vector<Future<Nothing>> futures;
+  CHECK_SOME(lazyLayerMounter);
 
-  foreach (const string& digest, digests) {
-    URI blobUri;
+  if (mounting.contains(digest)) {
+    return mounting.at(digest);
+  }
+
+  Try<URI> blobUri = getBlobUri(normalizedRef, digest);
+  if (blobUri.isError()) {
+    return Failure(blobUri.error());
+  }
+
+  const string mountPoint =
+    paths::getImageLayerLazyRootfsPath(storeDir, digest);
+
+  const string prefetchList =
+    paths::getImageLayerPrefetchListPath(storeDir, digest);
+
+  const string rootfs =
+    paths::getImageLayerRootfsPath(storeDir, digest, OVERLAY_BACKEND);
+
+  // NOTE: This will create the layer directory in the store as well.
+  Try<Nothing> mkdir = os::mkdir(mountPoint);
+  if (mkdir.isError()) {
+    return Failure(
+        "Failed to create mount point '" + mountPoint + "' "
+        "for layer '" + digest + "': " + mkdir.error());
+  }
+
+  std::map<string, string> environment = os::environment();
+  if (config.isSome()) {
+    environment["MESOS_DOCKER_CONFIG"] = config->data();
+  } else if (dockerConfig.isSome()) {
+    environment["MESOS_DOCKER_CONFIG"] = stringify(dockerConfig.get());
+  }
+
+  VLOG(1) << "Mounting layer '" << digest << "' of image '"
+          << normalizedRef << "' lazily at '" << mountPoint << "'";
+
+  // The mounter is given the URL of the blob in the registry, built
+  // like the docker fetcher plugin does.
+  const URI url = uri::construct(
+      blobUri->has_fragment() ? blobUri->fragment() : "https",
+      strings::join("/", "/v2", blobUri->path(), "blobs", blobUri->query()),
+      blobUri->host(),
+      blobUri->has_port() ? Option<int>(blobUri->port()) : None());
+
+  const vector<string> argv = {
+    Path(lazyLayerMounter.get()).basename(),
+    stringify(url),
+    mountPoint,
+    prefetchList
+  };
+
+  // NOTE: The output of the mounter is not piped, since a mounter
+  // serving the layer from a background process would keep the pipes
+  // open after it exits.
+  Try<Subprocess> s = subprocess(
+      lazyLayerMounter.get(),
+      argv,
+      Subprocess::PATH(os::DEV_NULL),
+      Subprocess::FD(STDERR_FILENO),
+      Subprocess::FD(STDERR_FILENO),
+      nullptr,
+      environment);
+
+  if (s.isError()) {
+    return Failure("Failed to exec the lazy layer mounter: " + s.error());
+  }
 
-    if (normalizedRef.has_registry()) {
-      Result<int> port = spec::getRegistryPort(normalizedRef.registry());
-      if (port.isError()) {
-        return Failure("Failed to get registry port: " + port.error());
+  const pid_t pid = s->pid();
+
+  // A hung mounter would otherwise block the pulls of all the images
+  // sharing the layer, so it is killed after a timeout and the mount
+  // point is cleaned up below like for any other failure.
+  Future<Nothing> mounted = metrics.layer_pull.time(s->status()
+    .after(DOCKER_LAZY_LAYER_MOUNT_TIMEOUT,
+           [=](Future<Option<int>> future) -> Future<Option<int>> {
+      future.discard();
+      os::killtree(pid, SIGKILL);
+
+      return Failure(
+          "The lazy layer mounter timed out in " +
+          stringify(DOCKER_LAZY_LAYER_MOUNT_TIMEOUT) + " mounting layer '" +
+          digest + "'");
+    })
+    .then([=](const Option<int>& status) -> Future<Nothing> {
+      if (status.isNone()) {
+        return Failure("Failed to reap the lazy layer mounter");
       }
 
-      Try<string> scheme = spec::getRegistryScheme(normalizedRef.registry());
-      if (scheme.isError()) {
-        return Failure("Failed to get registry scheme: " + scheme.error());
+      if (!WSUCCEEDED(status.get())) {
+        return Failure(
+            "Failed to mount layer '" + digest + "': the lazy layer "
+            "mounter " + WSTRINGIFY(status.get()));
       }
 
-      // If users want to use the registry specified in '--docker_image',
-      // an URL scheme must be specified in '--docker_registry', because
-      // there is no scheme allowed in docker image name.
-      blobUri = uri::docker::blob(
-          normalizedRef.repository(),
-          digest,
-          spec::getRegistryHost(normalizedRef.registry()),
-          scheme.get(),
-          port.isSome() ? port.get() : Option<int>());
-    } else {
-      const string registry = defaultRegistryUrl.domain.isSome()
-        ? defaultRegistryUrl.domain.get()
-        : stringify(defaultRegistryUrl.ip.get());
-
-      const Option<int> port = defaultRegistryUrl.port.isSome()
-        ? static_cast<int>(defaultRegistryUrl.port.get())
-        : Option<int>();
-
-      blobUri = uri::docker::blob(
-          normalizedRef.repository(),
-          digest,
-          registry,
-          defaultRegistryUrl.scheme,
-          port);
-    }
+      // The rootfs of the layer only appears once the layer is
+      // mounted, so that a layer being mounted is never considered to
+      // be in the store.
+      Try<Nothing> symlink =
+        ::fs::symlink(Path(mountPoint).basename(), rootfs);
 
-    futures.push_back(fetcher->fetch(
-        blobUri,
-        directory,
-        config.isSome() ? config->data() : Option<string>()));
-  }
+      if (symlink.isError()) {
+        return Failure(
+            "Failed to symlink '" + rootfs + "' to the mount point of "
+            "layer '" + digest + "': " + symlink.error());
+      }
 
-  return collect(futures)
-    .then([digests]() -> hashset<string> { return digests; });
+      return Nothing();
+    })
+    .repair([=](const Future<Nothing>& future) -> Future<Nothing> {
+      // Remove the mount point, so the layer is mounted again by the
+      // next pull. The prefetch list is kept.
+#ifdef __linux__
+      // This fails if the mounter did not get to mount the layer.
+      fs::unmount(mountPoint, MNT_DETACH);
+#endif // __linux__
+
+      Try<Nothing> rmdir = os::rmdir(mountPoint, false);
+      if (rmdir.isError()) {
+        LOG(WARNING) << "Failed to remove mount point '" << mountPoint
+                     << "': " << rmdir.error();
+      }
+
+      return future;
+    }));
+
+  mounting[digest] = mounted;
+
+  mounted.onAny(defer(self(), [=](const Future<Nothing>&) {
+    mounting.erase(digest);
+  }));
+
+  return mounted;
 }
 
 } // namespace docker {
@@ -28,6 +28,8 @@
 #include <stout/json.hpp>
 #include <stout/os.hpp>
 
+#include <stout/os/realpath.hpp>
+
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/dispatch.hpp>
@@ -37,6 +39,10 @@
 #include <process/metrics/metrics.hpp>
 #include <process/metrics/timer.hpp>
 
+#ifdef __linux__
+#include "linux/fs.hpp"
+#endif // __linux__
+
 #include "slave/containerizer/mesos/provisioner/constants.hpp"
 #include "slave/containerizer/mesos/provisioner/utils.hpp"
 
@@ -260,8 +266,97 @@ Future<Nothing> Store::prune(
 }
 
 
+#ifdef __linux__
+// Removes the lazily mounted layers which are no longer mounted, e.g.,
+// after a reboot, or whose mounter died, so that they are pulled again
+// when used. Their prefetch lists are kept.
+static Try<Nothing> recoverLazyLayers(const string& storeDir)
+{
+  Try<list<string>> layerIds = paths::listLayers(storeDir);
+  if (layerIds.isError()) {
+    return Error("Failed to list layers: " + layerIds.error());
+  }
+
+  Try<fs::MountInfoTable> table = fs::MountInfoTable::read();
+  if (table.isError()) {
+    return Error("Failed to read mount table: " + table.error());
+  }
+
+  hashset<string> targets;
+  foreach (const fs::MountInfoTable::Entry& entry, table->entries) {
+    targets.insert(entry.target);
+  }
+
+  foreach (const string& layerId, layerIds.get()) {
+    const string mountPoint =
+      paths::getImageLayerLazyRootfsPath(storeDir, layerId);
+
+    const string rootfs =
+      paths::getImageLayerRootfsPath(storeDir, layerId, OVERLAY_BACKEND);
+
+    // NOTE: The mount table holds the real paths of the mount points,
+    // which we resolve through the layer directory, as the mount point
+    // of a dead mounter cannot be accessed.
+    Result<string> layerPath =
+      os::realpath(paths::getImageLayerPath(storeDir, layerId));
+
+    if (!layerPath.isSome()) {
+      continue;
+    }
+
+    const bool mounted = targets.contains(
+        path::join(layerPath.get(), Path(mountPoint).basename()));
+
+    const bool linked = os::stat::islink(rootfs);
+
+    if (!mounted && !linked && !os::exists(mountPoint)) {
+      continue;
+    }
+
+    if (mounted && linked && os::exists(mountPoint)) {
+      continue;
+    }
+
+    LOG(INFO) << "Removing lazily mounted layer '" << layerId
+              << "' which is no longer mounted";
+
+    if (linked) {
+      Try<Nothing> rm = os::rm(rootfs);
+      if (rm.isError()) {
+        return Error("Failed to remove '" + rootfs + "': " + rm.error());
+      }
+    }
+
+    if (mounted) {
+      Try<Nothing> unmount = fs::unmount(mountPoint, MNT_DETACH);
+      if (unmount.isError()) {
+        return Error(
+            "Failed to unmount '" + mountPoint + "': " + unmount.error());
+      }
+    }
+
+    Try<Nothing> rmdir = os::rmdir(mountPoint, false);
+    if (rmdir.isError()) {
+      return Error(
+          "Failed to remove '" + mountPoint + "': " + rmdir.error());
+    }
+  }
+
+  return Nothing();
+}
+#endif // __linux__
+
+
 Future<Nothing> StoreProcess::recover()
 {
+#ifdef __linux__
+  Try<Nothing> recover = recoverLazyLayers(flags.docker_store_dir);
+  if (recover.isError()) {
+    return Failure(
+        "Failed to recover lazily mounted layers: " + recover.error());
+  }
+#endif // __linux__
+
   return metadataManager->recover();
 }
 
@@ -615,6 +710,22 @@ Future<Nothing> StoreProcess::_prune(
       return Failure("Marking phase target '" + target + "' already exists");
     }
 
+#ifdef __linux__
+    // Lazily mounted layers are unmounted first, so that the removal
+    // does not descend into the mount.
+    const string mountPoint =
+      paths::getImageLayerLazyRootfsPath(flags.docker_store_dir, layerId);
+
+    if (os::stat::islink(paths::getImageLayerRootfsPath(
+            flags.docker_store_dir, layerId, OVERLAY_BACKEND))) {
+      Try<Nothing> unmount = fs::unmount(mountPoint, MNT_DETACH);
+      if (unmount.isError()) {
+        LOG(WARNING) << "Failed to unmount lazily mounted layer '"
+                     << layerId << "': " << unmount.error();
+      }
+    }
+#endif // __linux__
+
     VLOG(1) << "Marking layer '" << layerId << "' to gc by renaming '"
             << layerPath << "' to '" << target << "'";
 
@@ -0,0 +1,125 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <process/owned.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/exists.hpp>
+
+#include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
+
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
+
+using process::Owned;
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+RecoverySnapshot::Listing::Listing(
+    const string& _hierarchy,
+    const string& _cgroup,
+    const Try<vector<string>>& _cgroups)
+  : hierarchy(_hierarchy), cgroup(_cgroup), cgroups(_cgroups)
+{
+  if (cgroups.isSome()) {
+    lookup.insert(cgroups->begin(), cgroups->end());
+  }
+}
+
+
+Try<fs::MountInfoTable> RecoverySnapshot::mountTable()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (table.isNone()) {
+    table = fs::MountInfoTable::read();
+  }
+
+  return table.get();
+}
+
+
+Try<vector<string>> RecoverySnapshot::cgroups(
+    const string& hierarchy,
+    const string& _cgroup,
+    bool unified)
+{
+  const string cgroup = strings::trim(_cgroup, "/");
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  foreach (const Owned<Listing>& listing, listings) {
+    if (listing->hierarchy == hierarchy && listing->cgroup == cgroup) {
+      return listing->cgroups;
+    }
+  }
+
+  Owned<Listing> listing(new Listing(
+      hierarchy,
+      cgroup,
+      unified
+        ? cgroups2::get(hierarchy, cgroup)
+        : cgroups::get(hierarchy, cgroup)));
+
+  listings.push_back(listing);
+
+  return listing->cgroups;
+}
+
+
+bool RecoverySnapshot::exists(const string& hierarchy, const string& _cgroup)
+{
+  const string cgroup = strings::trim(_cgroup, "/");
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    foreach (const Owned<Listing>& listing, listings) {
+      if (listing->hierarchy != hierarchy || listing->cgroups.isError()) {
+        continue;
+      }
+
+      if (cgroup == listing->cgroup) {
+        return true;
+      }
+
+      // The listed cgroup is the root of the hierarchy, or an ancestor
+      // of the cgroup.
+      if (listing->cgroup.empty() ||
+          strings::startsWith(cgroup, listing->cgroup + "/")) {
+        return listing->lookup.contains(cgroup);
+      }
+    }
+  }
+
+  return os::exists(path::join(hierarchy, cgroup));
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
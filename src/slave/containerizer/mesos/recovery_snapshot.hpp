@@ -0,0 +1,91 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __MESOS_CONTAINERIZER_RECOVERY_SNAPSHOT_HPP__
+#define __MESOS_CONTAINERIZER_RECOVERY_SNAPSHOT_HPP__
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <process/owned.hpp>
+
+#include <stout/hashset.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "linux/fs.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// While the Mesos containerizer recovers, the Linux launcher and some
+// of the isolators read the same host state, e.g., the mount table and
+// the cgroups of all containers, and check every recovered container
+// against it. The containerizer creates one snapshot per recovery and
+// passes it to the launcher and the isolators, which read each piece
+// of that state once, on first use, and are served from the snapshot
+// afterwards, so the recovery does not scale with the number of
+// containers times the number of isolators.
+//
+// NOTE: The launcher and the isolators recover concurrently in their
+// own actors, hence the snapshot is thread-safe. It is only meant for
+// the `recover` methods, which run before any orphan is destroyed.
+class RecoverySnapshot
+{
+public:
+  // Returns the mount table of the agent, see `fs::MountInfoTable::read`.
+  Try<fs::MountInfoTable> mountTable();
+
+  // Returns all the cgroups under `cgroup` in the given hierarchy, see
+  // `cgroups::get`. Set `unified` for the cgroups v2 unified hierarchy.
+  Try<std::vector<std::string>> cgroups(
+      const std::string& hierarchy,
+      const std::string& cgroup,
+      bool unified = false);
+
+  // Returns whether the cgroup exists in the given hierarchy. This is
+  // answered from the snapshot if an ancestor of the cgroup is listed
+  // in the snapshot via `cgroups()`, and from the filesystem otherwise.
+  bool exists(const std::string& hierarchy, const std::string& cgroup);
+
+private:
+  // The cgroups under `cgroup` in `hierarchy`, as returned by
+  // `cgroups::get`, i.e., relative to the hierarchy.
+  struct Listing
+  {
+    Listing(
+        const std::string& _hierarchy,
+        const std::string& _cgroup,
+        const Try<std::vector<std::string>>& _cgroups);
+
+    const std::string hierarchy;
+    const std::string cgroup;
+    const Try<std::vector<std::string>> cgroups;
+    hashset<std::string> lookup;
+  };
+
+  std::mutex mutex;
+  Option<Try<fs::MountInfoTable>> table;
+  std::vector<process::Owned<Listing>> listings;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __MESOS_CONTAINERIZER_RECOVERY_SNAPSHOT_HPP__
@@ -239,6 +239,23 @@ mesos::internal::slave::Flags::Flags()
       "such as `WORKDIR`, `ENV` and `CMD` to the container.\n",
       false);
 
+  add(&Flags::docker_lazy_layer_mounter,
+      "docker_lazy_layer_mounter",
+      "(*Experimental*) Path of an executable mounting the layers of Docker\n"
+      "images lazily, so containers can start before their layers are fully\n"
+      "pulled. Only used for schema 2 images with the `overlay` backend.\n"
+      "Instead of fetching and extracting a layer, the Docker store runs\n"
+      "`<mounter> <blob URL> <mount point> <prefetch list>`, where the\n"
+      "mounter must mount a read-only view of the layer at the mount point,\n"
+      "with OverlayFS whiteouts, fetching the chunks of the blob on first\n"
+      "access, and exit once the layer is mounted. The prefetch list is a\n"
+      "file kept across the mounts of the layer, in which the mounter can\n"
+      "record the files accessed by containers and fetch them ahead of time\n"
+      "on the next mount. The docker config used to pull the image, if any,\n"
+      "is passed in the `MESOS_DOCKER_CONFIG` environment variable. A\n"
+      "mounter which does not exit within 5 minutes is killed and the pull\n"
+      "fails.");
+
   add(&Flags::default_role,
       "default_role",
       "Any resources in the `--resources` flag that\n"
@@ -506,6 +523,16 @@ mesos::internal::slave::Flags::Flags()
       "be a value between 0.0 and 1.0",
       GC_DISK_HEADROOM);
 
+  add(&Flags::gc_disk_watermark,
+      "gc_disk_watermark",
+      "Fraction of the disk that the garbage collector keeps free. If the\n"
+      "free space drops below it, which is checked every\n"
+      "`--disk_watch_interval` duration, the directories scheduled for\n"
+      "garbage collection are deleted right away, largest and oldest\n"
+      "first, until the watermark is reached again. Must be a value\n"
+      "between 0.0 and 1.0. If not set, directories are only deleted based\n"
+      "on their age (see `--gc_disk_headroom`).");
+
   add(&Flags::gc_non_executor_container_sandboxes,
       "gc_non_executor_container_sandboxes",
       "Determines whether nested container sandboxes created via the\n"
@@ -540,6 +567,33 @@ mesos::internal::slave::Flags::Flags()
       "           or executor upgrade.",
       "reconnect");
 
+  add(&Flags::checkpoint_store,
+      "checkpoint_store",
+      "Where the agent checkpoints the information about the agent,\n"
+      "frameworks, executors and tasks. `files` writes each object into its\n"
+      "own file under the meta directory. `leveldb` (not supported on\n"
+      "Windows) keeps them in a single LevelDB database under the meta\n"
+      "directory, which makes recovery a single sequential read instead of\n"
+      "opening a file per object. Existing checkpoint files are imported\n"
+      "into the database when the agent starts with `leveldb`; the database\n"
+      "is not exported back to files, so switching back to `files` requires\n"
+      "a new agent ID. Status update streams and resource checkpoints are\n"
+      "always kept in files.",
+      "files",
+      [](const string& value) -> Option<Error> {
+#ifndef __WINDOWS__
+        if (value == "leveldb") {
+          return None();
+        }
+#endif // __WINDOWS__
+
+        if (value != "files") {
+          return Error("Unknown `--checkpoint_store` '" + value + "'");
+        }
+
+        return None();
+      });
+
   add(&Flags::recovery_timeout,
       "recovery_timeout",
       "Amount of time allotted for the agent to recover. If the agent takes\n"
@@ -630,6 +684,12 @@ mesos::internal::slave::Flags::Flags()
       "handles that can be used with the primary handle. This will take\n"
       "effect only when the `--cgroups_net_cls_primary_handle is set.");
 
+  add(&Flags::network_bandwidth_interface,
+      "network_bandwidth_interface",
+      "The name of the host network interface on which the\n"
+      "`network/bandwidth` isolator shapes the traffic of containers.\n"
+      "If not specified, the interface of the default route is used.");
+
   add(&Flags::allowed_devices,
       "allowed_devices",
       "JSON array representing the devices that will be additionally\n"
@@ -697,7 +757,12 @@ mesos::internal::slave::Flags::Flags()
       "Run command `perf list` to see all events. Event names are\n"
       "sanitized by downcasing and replacing hyphens with underscores\n"
       "when reported in the PerfStatistics protobuf, e.g., `cpu-cycles`\n"
-      "becomes `cpu_cycles`; see the PerfStatistics protobuf for all names.");
+      "becomes `cpu_cycles`; see the PerfStatistics protobuf for all names.\n"
+      "If all events are generic hardware or software events (e.g.,\n"
+      "`cycles` or `context-switches`) and the kernel can count them, they\n"
+      "are counted with `perf_event_open(2)` instead of running `perf stat`,\n"
+      "and `--perf_duration` is ignored. The recent samples of each\n"
+      "container are served by the `/monitor/perf` endpoint.");
 
   add(&Flags::perf_interval,
       "perf_interval",
@@ -807,6 +872,14 @@ mesos::internal::slave::Flags::Flags()
       "default_ipc_mode",
       "`private` or `share_parent`"
       );
+
+  add(&Flags::disk_project_range,
+      "disk_project_range",
+      "The ranges of project IDs the `disk/du` isolator assigns to the\n"
+      "sandboxes of containers when `--container_disk_usage_backend` is\n"
+      "`project_quota`. These must not overlap with the project IDs used\n"
+      "by other tools on the same filesystem.",
+      "[5000-10000]");
 #endif
 
   add(&Flags::agent_features,
@@ -1272,6 +1345,51 @@ mesos::internal::slave::Flags::Flags()
       "used by the `disk/du` and `disk/xfs` isolators.",
       Seconds(15));
 
+  add(&Flags::container_disk_usage_backend,
+      "container_disk_usage_backend",
+      "How the `disk/du` isolator measures the disk usage of containers.\n"
+      "`du` runs the 'du' command for each path. `walk` traverses the\n"
+      "paths within the agent in small batches, without forking a process\n"
+      "for each check. `project_quota` (Linux only) assigns a project ID to\n"
+      "the sandbox of each container and reads its usage from the kernel's\n"
+      "project quota accounting, which is a constant time operation. It\n"
+      "requires a filesystem with project quotas enabled (e.g., ext4 mounted\n"
+      "with `prjquota` or XFS mounted with `pquota`), and falls back to\n"
+      "`walk` for containers whose sandbox is on another filesystem.\n"
+      "Persistent volumes are always measured with `walk` in that case.",
+      "du",
+      [](const string& value) -> Option<Error> {
+#ifdef __linux__
+        if (value == "project_quota") {
+          return None();
+        }
+#endif // __linux__
+
+        if (value != "du" && value != "walk") {
+          return Error(
+              "Unknown `--container_disk_usage_backend` '" + value + "'");
+        }
+
+        return None();
+      });
+
+  add(&Flags::container_usage_interval,
+      "container_usage_interval",
+      "If set, the Mesos containerizer samples the resource usage of all\n"
+      "running containers from the isolators at this interval, and serves\n"
+      "resource usage requests (e.g. from the `/monitor/statistics`\n"
+      "endpoint, the `GET_CONTAINERS` call, the resource estimator and the\n"
+      "QoS controller) from the last sample, as long as it was taken within\n"
+      "twice the interval. Otherwise, the resource usage of a container is\n"
+      "sampled upon each request.",
+      [](const Option<Duration>& value) -> Option<Error> {
+        if (value.isSome() && value.get() <= Duration::zero()) {
+          return Error("Expected `--container_usage_interval` to be positive");
+        }
+
+        return None();
+      });
+
   // TODO(jieyu): Consider enabling this flag by default. Remember
   // to update the user doc if we decide to do so.
   add(&Flags::enforce_container_disk_quota,
@@ -62,6 +62,7 @@ public:
   std::string docker_volume_checkpoint_dir;
   bool docker_volume_chown;
   bool docker_ignore_runtime;
+  Option<std::string> docker_lazy_layer_mounter;
 
   std::string default_role;
   Option<std::string> attributes;
@@ -94,6 +95,7 @@ public:
 #endif // USE_SSL_SOCKET
   Duration gc_delay;
   double gc_disk_headroom;
+  Option<double> gc_disk_watermark;
   bool gc_non_executor_container_sandboxes;
   Duration disk_watch_interval;
 
@@ -101,6 +103,7 @@ public:
 
   std::string reconfiguration_policy;
   std::string recover;
+  std::string checkpoint_store;
   Duration recovery_timeout;
   bool strict;
   Duration register_retry_interval_min;
@@ -113,6 +116,7 @@ public:
   bool cgroups_cpu_enable_pids_and_tids_count;
   Option<std::string> cgroups_net_cls_primary_handle;
   Option<std::string> cgroups_net_cls_secondary_handles;
+  Option<std::string> network_bandwidth_interface;
   Option<DeviceWhitelist> allowed_devices;
   Option<std::string> agent_subsystems;
   Option<std::string> host_path_volume_force_creation;
@@ -129,6 +133,7 @@ public:
   bool disallow_sharing_agent_ipc_namespace;
   bool disallow_sharing_agent_pid_namespace;
   Option<std::string> default_ipc_mode;
+  std::string disk_project_range;
 #endif
   Option<Firewall> firewall_rules;
   Option<Path> credential;
@@ -172,6 +177,8 @@ public:
   bool network_cni_root_dir_persist;
   bool network_cni_metrics;
   Duration container_disk_watch_interval;
+  std::string container_disk_usage_backend;
+  Option<Duration> container_usage_interval;
   bool enforce_container_disk_quota;
   Option<Modules> modules;
   Option<std::string> modulesDir;
@@ -16,9 +16,16 @@
 
 #include "slave/gc.hpp"
 
+#ifndef __WINDOWS__
+#include <fts.h>
+#endif // __WINDOWS__
+
+#include <algorithm>
 #include <list>
+#include <vector>
 
 #include <process/check.hpp>
+#include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
@@ -28,6 +35,8 @@
 #include <stout/adaptor.hpp>
 #include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
 
 #include <stout/os/rmdir.hpp>
 
@@ -46,6 +55,7 @@ using process::wait; // Necessary on some OS's to disambiguate.
 using std::list;
 using std::map;
 using std::string;
+using std::vector;
 
 using process::metrics::Counter;
 
@@ -61,11 +71,19 @@ GarbageCollectorProcess::Metrics::Metrics(GarbageCollectorProcess *gc)
       // basically has to be tracked as a member variable, which means we
       // can safely do concurrent reads while the map is being updated.
       return static_cast<double>(gc->paths.size());
-    })
+    }),
+    path_evictions("gc/path_evictions"),
+    bytes_reclaimed("gc/bytes_reclaimed"),
+    bytes_pending(
+        "gc/bytes_pending",
+        defer(gc, &GarbageCollectorProcess::_bytes_pending))
 {
   process::metrics::add(path_removals_succeeded);
   process::metrics::add(path_removals_failed);
   process::metrics::add(path_removals_pending);
+  process::metrics::add(path_evictions);
+  process::metrics::add(bytes_reclaimed);
+  process::metrics::add(bytes_pending);
 }
 
 
@@ -73,10 +91,52 @@ GarbageCollectorProcess::Metrics::~Metrics()
 {
   process::metrics::remove(path_removals_succeeded);
   process::metrics::remove(path_removals_failed);
+  process::metrics::remove(path_evictions);
+  process::metrics::remove(bytes_reclaimed);
 
-  // Wait for the metric to be removed to protect against asynchronous
+  // Wait for the metrics to be removed to protect against asynchronous
   // evaluation referencing a deleted object.
   process::metrics::remove(path_removals_pending).await();
+  process::metrics::remove(bytes_pending).await();
+}
+
+
+// Returns the disk space used by the files and directories under the
+// given path, without crossing into other filesystems.
+//
+// NOTE: Files with several hard links under the path are counted once
+// per link, so this may overestimate the space freed by a removal.
+static Try<Bytes> diskUsage(const string& path)
+{
+#ifdef __WINDOWS__
+  return Error("Not supported on Windows");
+#else
+  char* path_[] = {const_cast<char*>(path.c_str()), nullptr};
+
+  FTS* tree = ::fts_open(path_, FTS_NOCHDIR | FTS_PHYSICAL | FTS_XDEV, nullptr);
+  if (tree == nullptr) {
+    return ErrnoError("Failed to open '" + path + "'");
+  }
+
+  Bytes usage;
+
+  for (FTSENT* node = ::fts_read(tree);
+       node != nullptr; node = ::fts_read(tree)) {
+    // Count each entry once, i.e., directories in preorder only.
+    if (node->fts_info == FTS_F ||
+        node->fts_info == FTS_D ||
+        node->fts_info == FTS_SL) {
+      // `st_blocks` is in units of 512 bytes, see stat(2).
+      usage += Bytes(node->fts_statp->st_blocks * 512);
+    }
+  }
+
+  if (::fts_close(tree) != 0) {
+    return ErrnoError("Failed to stop traversing file system");
+  }
+
+  return usage;
+#endif // __WINDOWS__
 }
 
 
@@ -191,131 +251,160 @@ void GarbageCollectorProcess::remove(const Timeout& removalTime)
       }
 
       infos.push_back(info);
-
-      // Set `removing` to signify that the path is being cleaned up.
-      info->removing = true;
     }
 
-    Counter _succeeded = metrics.path_removals_succeeded;
-    Counter _failed = metrics.path_removals_failed;
-    const string _workDir = workDir;
+    removePaths(infos);
+  } else {
+    // This occurs when either:
+    //   1. The path(s) has already been removed (e.g. by prune()).
+    //   2. All paths under the removal time were unscheduled.
+    LOG(INFO) << "Ignoring gc event at " << removalTime.remaining()
+              << " as the paths were already removed, or were unscheduled";
+    reset();
+  }
+}
+
+
+void GarbageCollectorProcess::removePaths(
+    const list<Owned<PathInfo>>& infos)
+{
+  // Set `removing` to signify that the paths are being cleaned up.
+  foreach (const Owned<PathInfo>& info, infos) {
+    info->removing = true;
+  }
 
-    auto rmdirs =
-      [_succeeded, _failed, _workDir, infos]() mutable -> Future<Nothing> {
-      // Make mutable copies of the counters to work around MESOS-7907.
-      Counter succeeded = _succeeded;
-      Counter failed = _failed;
+  Counter _succeeded = metrics.path_removals_succeeded;
+  Counter _failed = metrics.path_removals_failed;
+  const string _workDir = workDir;
+
+  auto rmdirs = [_succeeded, _failed, _workDir](
+      list<Owned<PathInfo>> infos) -> Future<Nothing> {
+    // Make mutable copies of the counters to work around MESOS-7907.
+    Counter succeeded = _succeeded;
+    Counter failed = _failed;
 
 #ifdef __linux__
-      // Clear any possible persistent volume mount points in `infos`. See
-      // MESOS-8830.
-      Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
-      if (mountTable.isError()) {
-        LOG(ERROR) << "Skipping any path deletion because of failure on read "
-                      "MountInfoTable for agent process: "
-                   << mountTable.error();
-
-        foreach (const Owned<PathInfo>& info, infos) {
-          info->promise.fail(mountTable.error());
-          ++failed;
-        }
+    // Clear any possible persistent volume mount points in `infos`. See
+    // MESOS-8830.
+    Try<fs::MountInfoTable> mountTable = fs::MountInfoTable::read();
+    if (mountTable.isError()) {
+      LOG(ERROR) << "Skipping any path deletion because of failure on read "
+                    "MountInfoTable for agent process: "
+                 << mountTable.error();
 
-        return Failure(mountTable.error());
+      foreach (const Owned<PathInfo>& info, infos) {
+        info->promise.fail(mountTable.error());
+        ++failed;
       }
 
-      foreach (const fs::MountInfoTable::Entry& entry,
-               adaptor::reverse(mountTable->entries)) {
-        // Ignore mounts whose targets are not under `workDir`.
-        if (!strings::startsWith(
-                path::join(entry.target, ""),
-                path::join(_workDir, ""))) {
-                continue;
-        }
+      return Failure(mountTable.error());
+    }
 
-        for (auto it = infos.begin(); it != infos.end(); ) {
-          const Owned<PathInfo>& info = *it;
-          // TODO(zhitao): Validate that both `info->path` and `workDir` are
-          // real paths.
-          if (strings::startsWith(
-                path::join(entry.target, ""), path::join(info->path, ""))) {
-            LOG(WARNING)
-                << "Unmounting dangling mount point '" << entry.target
-                << "' of persistent volume '" << entry.root
-                << "' inside garbage collected path '" << info->path << "'";
-
-            Try<Nothing> unmount = fs::unmount(entry.target);
-            if (unmount.isError()) {
-              LOG(WARNING) << "Skipping deletion of '"
-                           << info->path << "' because unmount failed on '"
-                           << entry.target << "': " << unmount.error();
-
-              info->promise.fail(unmount.error());
-              ++failed;
-              it = infos.erase(it);
+    foreach (const fs::MountInfoTable::Entry& entry,
+             adaptor::reverse(mountTable->entries)) {
+      // Ignore mounts whose targets are not under `workDir`.
+      if (!strings::startsWith(
+              path::join(entry.target, ""),
+              path::join(_workDir, ""))) {
               continue;
-            } else {
-              break;
-            }
-          }
+      }
 
-          it++;
+      for (auto it = infos.begin(); it != infos.end(); ) {
+        const Owned<PathInfo>& info = *it;
+        // TODO(zhitao): Validate that both `info->path` and `workDir` are
+        // real paths.
+        if (strings::startsWith(
+              path::join(entry.target, ""), path::join(info->path, ""))) {
+          LOG(WARNING)
+              << "Unmounting dangling mount point '" << entry.target
+              << "' of persistent volume '" << entry.root
+              << "' inside garbage collected path '" << info->path << "'";
+
+          Try<Nothing> unmount = fs::unmount(entry.target);
+          if (unmount.isError()) {
+            LOG(WARNING) << "Skipping deletion of '"
+                         << info->path << "' because unmount failed on '"
+                         << entry.target << "': " << unmount.error();
+
+            info->promise.fail(unmount.error());
+            ++failed;
+            it = infos.erase(it);
+            continue;
+          } else {
+            break;
+          }
         }
+
+        it++;
       }
+    }
 #endif // __linux__
 
-      foreach (const Owned<PathInfo>& info, infos) {
-        // Run the removal operation with 'continueOnError = true'.
-        // It's possible for tasks and isolators to lay down files
-        // that are not deletable by GC. In the face of such errors
-        // GC needs to free up disk space wherever it can because the
-        // disk space has already been re-offered to frameworks.
-        LOG(INFO) << "Deleting " << info->path;
-        Try<Nothing> rmdir = os::rmdir(info->path, true, true, true);
-
-        if (rmdir.isError()) {
-          // TODO(zhitao): Change return value type of `rmdir` to
-          // `Try<Nothing, ErrnoError>` and check error type instead.
-          if (rmdir.error() == ErrnoError(ENOENT).message) {
-            LOG(INFO) << "Skipped '" << info->path << "' which does not exist";
-          } else {
-            LOG(WARNING) << "Failed to delete '" << info->path << "': "
-                         << rmdir.error();
-            info->promise.fail(rmdir.error());
-
-            ++failed;
-          }
+    foreach (const Owned<PathInfo>& info, infos) {
+      // Run the removal operation with 'continueOnError = true'.
+      // It's possible for tasks and isolators to lay down files
+      // that are not deletable by GC. In the face of such errors
+      // GC needs to free up disk space wherever it can because the
+      // disk space has already been re-offered to frameworks.
+      LOG(INFO) << "Deleting " << info->path;
+      Try<Nothing> rmdir = os::rmdir(info->path, true, true, true);
+
+      if (rmdir.isError()) {
+        // TODO(zhitao): Change return value type of `rmdir` to
+        // `Try<Nothing, ErrnoError>` and check error type instead.
+        if (rmdir.error() == ErrnoError(ENOENT).message) {
+          LOG(INFO) << "Skipped '" << info->path << "' which does not exist";
         } else {
-          LOG(INFO) << "Deleted '" << info->path << "'";
-          info->promise.set(rmdir.get());
+          LOG(WARNING) << "Failed to delete '" << info->path << "': "
+                       << rmdir.error();
+          info->promise.fail(rmdir.error());
 
-          ++succeeded;
+          ++failed;
         }
+      } else {
+        LOG(INFO) << "Deleted '" << info->path << "'";
+        info->promise.set(rmdir.get());
+
+        ++succeeded;
       }
+    }
 
-      return Nothing();
-    };
+    return Nothing();
+  };
 
-    // NOTE: All `rmdirs` calls are dispatched to one executor so that:
-    //   1. They do not block other dispatches (MESOS-6549).
-    //   2. They do not occupy all worker threads (MESOS-7964).
-    executor.execute(rmdirs)
-      .onAny(defer(self(), &Self::_remove, lambda::_1, infos));
-  } else {
-    // This occurs when either:
-    //   1. The path(s) has already been removed (e.g. by prune()).
-    //   2. All paths under the removal time were unscheduled.
-    LOG(INFO) << "Ignoring gc event at " << removalTime.remaining()
-              << " as the paths were already removed, or were unscheduled";
-    reset();
+  // NOTE: The `rmdirs` calls are dispatched to a fixed number of
+  // executors so that:
+  //   1. They do not block other dispatches (MESOS-6549).
+  //   2. They do not occupy all worker threads (MESOS-7964).
+  // The paths are spread across the executors round-robin, so that a
+  // large batch (e.g., under disk pressure) is removed in parallel.
+  vector<list<Owned<PathInfo>>> batches(executors.size());
+
+  size_t index = 0;
+  foreach (const Owned<PathInfo>& info, infos) {
+    batches[index++ % batches.size()].push_back(info);
+  }
+
+  vector<Future<Nothing>> futures;
+  for (size_t i = 0; i < batches.size(); i++) {
+    if (!batches[i].empty()) {
+      futures.push_back(executors[i]->execute(std::bind(rmdirs, batches[i])));
+    }
   }
+
+  await(futures)
+    .onAny(defer(self(), &Self::_remove, infos));
 }
 
 
-void GarbageCollectorProcess::_remove(const Future<Nothing>& result,
-                                      const list<Owned<PathInfo>> infos)
+void GarbageCollectorProcess::_remove(const list<Owned<PathInfo>> infos)
 {
   // Remove path records from `paths` and `timeouts` data structures.
   foreach (const Owned<PathInfo>& info, infos) {
+    if (info->promise.future().isReady() && info->size.isSome()) {
+      metrics.bytes_reclaimed += info->size->bytes();
+    }
+
     CHECK(paths.remove(timeouts[info->path], info));
     CHECK_EQ(timeouts.erase(info->path), 1u);
   }
@@ -324,6 +413,20 @@ void GarbageCollectorProcess::_remove(const Future<Nothing>& result,
 }
 
 
+double GarbageCollectorProcess::_bytes_pending()
+{
+  Bytes pending;
+
+  foreachvalue (const Owned<PathInfo>& info, paths) {
+    if (info->size.isSome()) {
+      pending += info->size.get();
+    }
+  }
+
+  return static_cast<double>(pending.bytes());
+}
+
+
 void GarbageCollectorProcess::prune(const Duration& d)
 {
   foreach (const Timeout& removalTime, paths.keys()) {
@@ -336,6 +439,182 @@ void GarbageCollectorProcess::prune(const Duration& d)
 }
 
 
+void GarbageCollectorProcess::evict(const Bytes& target)
+{
+  // The next disk check asks again if the space is still missing.
+  if (measuring) {
+    VLOG(1) << "Skipping eviction as the scheduled paths are being measured";
+    return;
+  }
+
+  // The space used by the paths which are being removed is about to be
+  // reclaimed, so it is deducted from the target. Otherwise every disk
+  // check would evict the whole target again while a large removal is
+  // in progress.
+  Bytes removing;
+
+  foreachvalue (const Owned<PathInfo>& info, paths) {
+    if (info->removing) {
+      removing += info->size.getOrElse(Bytes(0));
+    }
+  }
+
+  if (removing >= target) {
+    VLOG(1) << "Skipping eviction as " << removing << " are already being "
+            << "removed to reclaim " << target << " of disk space";
+    return;
+  }
+
+  _evict(target - removing);
+}
+
+
+// Returns whether one of the given paths is nested under the other.
+static bool nested(const string& left, const string& right)
+{
+  const string left_ = path::join(left, "");
+  const string right_ = path::join(right, "");
+
+  return strings::startsWith(left_, right_) ||
+         strings::startsWith(right_, left_);
+}
+
+
+void GarbageCollectorProcess::_evict(const Bytes& target)
+{
+  // The paths nested under, or containing, a path which is removed are
+  // skipped, as the space they use is already accounted for by that
+  // path, e.g., a framework directory and its executor directories.
+  vector<string> excluded;
+
+  auto overlaps = [&excluded](const string& path) {
+    foreach (const string& removed, excluded) {
+      if (nested(path, removed)) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  // NOTE: The paths are iterated in the order of their removal time,
+  // which is the order of their age, and the sort below is stable.
+  vector<Owned<PathInfo>> candidates;
+
+  foreachvalue (const Owned<PathInfo>& info, paths) {
+    if (info->removing) {
+      excluded.push_back(info->path);
+    } else if (info->size.isSome()) {
+      candidates.push_back(info);
+    }
+  }
+
+  std::stable_sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const Owned<PathInfo>& left, const Owned<PathInfo>& right) {
+        return left->size.get() > right->size.get();
+      });
+
+  list<Owned<PathInfo>> infos;
+  Bytes selected;
+
+  foreach (const Owned<PathInfo>& info, candidates) {
+    if (selected >= target) {
+      break;
+    }
+
+    if (overlaps(info->path)) {
+      continue;
+    }
+
+    infos.push_back(info);
+    excluded.push_back(info->path);
+    selected += info->size.get();
+  }
+
+  if (!infos.empty()) {
+    LOG(INFO) << "Evicting " << infos.size() << " directories using "
+              << selected << " to reclaim " << target << " of disk space";
+
+    metrics.path_evictions += infos.size();
+
+    removePaths(infos);
+  }
+
+  if (selected >= target) {
+    return;
+  }
+
+  // The disk space used by the paths is only measured under disk
+  // pressure, i.e., when eviction is enabled and needed, as it walks
+  // all the files of the paths. The oldest paths are measured first,
+  // a batch at a time, so that the eviction does not wait for all the
+  // scheduled paths to be measured.
+  vector<string> unmeasured;
+
+  foreachvalue (const Owned<PathInfo>& info, paths) {
+    if (unmeasured.size() >= GC_EVICTION_BATCH_SIZE) {
+      break;
+    }
+
+    if (!info->removing && info->size.isNone() && !overlaps(info->path)) {
+      unmeasured.push_back(info->path);
+    }
+  }
+
+  if (unmeasured.empty()) {
+    return;
+  }
+
+  measuring = true;
+
+  sizer.execute([unmeasured]() {
+      hashmap<string, Bytes> sizes;
+
+      foreach (const string& path, unmeasured) {
+        Try<Bytes> usage = diskUsage(path);
+        if (usage.isError()) {
+          VLOG(1) << "Failed to measure the disk usage of '" << path << "': "
+                  << usage.error();
+
+          // The path is not measured again by the next batches.
+          sizes[path] = Bytes(0);
+          continue;
+        }
+
+        sizes[path] = usage.get();
+      }
+
+      return sizes;
+    })
+    .onAny(defer(self(), &Self::__evict, target - selected, lambda::_1));
+}
+
+
+void GarbageCollectorProcess::__evict(
+    const Bytes& target,
+    const Future<hashmap<string, Bytes>>& sizes)
+{
+  measuring = false;
+
+  if (!sizes.isReady()) {
+    LOG(WARNING) << "Failed to measure the disk usage of the scheduled paths: "
+                 << (sizes.isFailed() ? sizes.failure() : "discarded");
+    return;
+  }
+
+  // The paths might have been removed or unscheduled meanwhile.
+  foreachvalue (const Owned<PathInfo>& info, paths) {
+    if (sizes->contains(info->path)) {
+      info->size = sizes->at(info->path);
+    }
+  }
+
+  _evict(target);
+}
+
+
 GarbageCollector::GarbageCollector(const string& workDir)
 {
   process = new GarbageCollectorProcess(workDir);
@@ -370,6 +649,12 @@ void GarbageCollector::prune(const Duration& d)
   dispatch(process, &GarbageCollectorProcess::prune, d);
 }
 
+
+void GarbageCollector::evict(const Bytes& target)
+{
+  dispatch(process, &GarbageCollectorProcess::evict, target);
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
@@ -22,6 +22,7 @@
 
 #include <process/future.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/nothing.hpp>
 
@@ -71,6 +72,12 @@ public:
   // is within the next 'd' duration of time.
   virtual void prune(const Duration& d);
 
+  // Deletes scheduled directories right away until at least `target`
+  // bytes of disk space are reclaimed. The largest directories are
+  // deleted first, and among those of the same size (or of a size
+  // which is not yet known) the oldest ones.
+  virtual void evict(const Bytes& target);
+
 private:
   GarbageCollectorProcess* process;
 };
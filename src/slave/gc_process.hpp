@@ -19,6 +19,7 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
 #include <process/executor.hpp>
 #include <process/future.hpp>
@@ -31,12 +32,16 @@
 #include <process/metrics/counter.hpp>
 #include <process/metrics/pull_gauge.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/multimap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/option.hpp>
 #include <stout/try.hpp>
 
+#include "slave/constants.hpp"
+
 namespace mesos {
 namespace internal {
 namespace slave {
@@ -48,7 +53,14 @@ public:
   explicit GarbageCollectorProcess(const std::string& _workDir)
     : ProcessBase(process::ID::generate("agent-garbage-collector")),
       metrics(this),
-      workDir(_workDir) {}
+      workDir(_workDir),
+      measuring(false)
+  {
+    for (size_t i = 0; i < GC_REMOVAL_PARALLELISM; i++) {
+      executors.push_back(process::Owned<process::Executor>(
+          new process::Executor()));
+    }
+  }
 
   ~GarbageCollectorProcess() override;
 
@@ -60,11 +72,15 @@ public:
 
   void prune(const Duration& d);
 
+  void evict(const Bytes& target);
+
 private:
   void reset();
 
   void remove(const process::Timeout& removalTime);
 
+  double _bytes_pending();
+
   struct PathInfo
   {
     PathInfo(const std::string& _path)
@@ -81,12 +97,27 @@ private:
     process::Promise<Nothing> promise;
 
     bool removing = false;
+
+    // The disk space used by the path, once measured for eviction.
+    Option<Bytes> size;
   };
 
-  // Callback for `remove` for bookkeeping after path removal.
-  void _remove(
-      const process::Future<Nothing>& result,
-      const std::list<process::Owned<PathInfo>> infos);
+  // Removes the given paths in the background, spread across the
+  // removal executors.
+  void removePaths(const std::list<process::Owned<PathInfo>>& infos);
+
+  // Callback for `removePaths` for bookkeeping after path removal.
+  void _remove(const std::list<process::Owned<PathInfo>> infos);
+
+  // Evicts the measured paths, largest first, and measures the next
+  // batch of paths if they do not cover the target.
+  void _evict(const Bytes& target);
+
+  // Continuation of `_evict` once the disk space used by a batch of
+  // paths is measured, keyed by path.
+  void __evict(
+      const Bytes& target,
+      const process::Future<hashmap<std::string, Bytes>>& sizes);
 
   struct Metrics
   {
@@ -96,6 +127,9 @@ private:
     process::metrics::Counter path_removals_succeeded;
     process::metrics::Counter path_removals_failed;
     process::metrics::PullGauge path_removals_pending;
+    process::metrics::Counter path_evictions;
+    process::metrics::Counter bytes_reclaimed;
+    process::metrics::PullGauge bytes_pending;
   } metrics;
 
   const std::string workDir;
@@ -111,8 +145,17 @@ private:
 
   process::Timer timer;
 
-  // For executing path removals in a separate actor.
-  process::Executor executor;
+  // For executing path removals in separate actors. Removals are
+  // spread across a fixed number of executors, so that they do not
+  // occupy all worker threads (MESOS-7964).
+  std::vector<process::Owned<process::Executor>> executors;
+
+  // For measuring the disk space used by scheduled paths, only when
+  // they are evicted.
+  process::Executor sizer;
+
+  // Whether the scheduled paths are being measured for an eviction.
+  bool measuring;
 };
 
 } // namespace slave {
@@ -2047,6 +2047,7 @@ Response Http::_statistics(
       entry.values["executor_id"] = info.executor_id().value();
       entry.values["executor_name"] = info.name();
       entry.values["source"] = info.source();
+
       entry.values["statistics"] = JSON::protobuf(executor.statistics());
 
       result.values.push_back(entry);
@@ -2057,6 +2058,123 @@ Response Http::_statistics(
 }
 
 
+string Http::PERF_HELP()
+{
+  return HELP(
+      TLDR(
+          "Retrieve the recent perf samples of containers."),
+      DESCRIPTION(
+          "Returns the most recent perf samples, oldest first, of the",
+          "containers running under this agent, if the agent samples perf",
+          "events (see the `--perf_events` flag).",
+          "",
+          "Query parameters:",
+          "",
+          ">        container_id=VALUE   Only return the samples of the",
+          ">                             container with the given ID.",
+          "",
+          "Example:",
+          "",
+          "```",
+          "[{",
+          "    \"container_id\":\"container\",",
+          "    \"executor_id\":\"executor\",",
+          "    \"framework_id\":\"framework\",",
+          "    \"samples\":",
+          "    [{",
+          "        \"context_switches\":1024,",
+          "        \"cycles\":4145823829,",
+          "        \"duration\":60.0,",
+          "        \"timestamp\":1388534400.0",
+          "    }]",
+          "}]",
+          "```"),
+      AUTHENTICATION(true),
+      AUTHORIZATION(
+          "The request principal should be authorized to query this endpoint.",
+          "See the authorization documentation for details."));
+}
+
+
+Future<Response> Http::perf(
+    const Request& request,
+    const Option<Principal>& principal) const
+{
+  if (request.method != "GET" && slave->authorizer.isSome()) {
+    return MethodNotAllowed({"GET"}, request.method);
+  }
+
+  Try<string> endpoint = extractEndpoint(request.url);
+  if (endpoint.isError()) {
+    return Failure("Failed to extract endpoint: " + endpoint.error());
+  }
+
+  return authorizeEndpoint(
+      endpoint.get(),
+      request.method,
+      slave->authorizer,
+      principal)
+    .then(defer(
+        slave->self(),
+        [this, request](bool authorized) -> Future<Response> {
+          if (!authorized) {
+            return Forbidden();
+          }
+
+          // NOTE: Unlike `/monitor/statistics`, this reads the samples
+          // kept by the containerizer rather than the usage of every
+          // container, which is why it is not rate limited.
+          return slave->containerizer->perfSamples()
+            .then(defer(slave->self(),
+                  [this, request](
+                      const hashmap<ContainerID, vector<PerfStatistics>>&
+                        samples) {
+              return _perf(samples, request);
+            }));
+        }));
+}
+
+
+Response Http::_perf(
+    const hashmap<ContainerID, vector<PerfStatistics>>& samples,
+    const Request& request) const
+{
+  Option<string> containerId = request.url.query.get("container_id");
+
+  JSON::Array result;
+
+  foreachvalue (const Framework* framework, slave->frameworks) {
+    foreachvalue (const Executor* executor, framework->executors) {
+      if (!samples.contains(executor->containerId) ||
+          samples.at(executor->containerId).empty()) {
+        continue;
+      }
+
+      if (containerId.isSome() &&
+          executor->containerId.value() != containerId.get()) {
+        continue;
+      }
+
+      JSON::Array _samples;
+      foreach (const PerfStatistics& sample,
+               samples.at(executor->containerId)) {
+        _samples.values.push_back(JSON::protobuf(sample));
+      }
+
+      JSON::Object entry;
+      entry.values["container_id"] = executor->containerId.value();
+      entry.values["framework_id"] = executor->frameworkId.value();
+      entry.values["executor_id"] = executor->id.value();
+      entry.values["samples"] = std::move(_samples);
+
+      result.values.push_back(entry);
+    }
+  }
+
+  return OK(result, request.url.query.get("jsonp"));
+}
+
+
 string Http::CONTAINERS_HELP()
 {
   return HELP(
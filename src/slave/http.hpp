@@ -17,12 +17,15 @@
 #ifndef __SLAVE_HTTP_HPP__
 #define __SLAVE_HTTP_HPP__
 
+#include <vector>
+
 #include <process/authenticator.hpp>
 #include <process/http.hpp>
 #include <process/future.hpp>
 #include <process/owned.hpp>
 #include <process/limiter.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/option.hpp>
 
@@ -75,6 +78,11 @@ public:
       const process::http::Request& request,
       const Option<process::http::authentication::Principal>& principal) const;
 
+  // /slave/monitor/perf
+  process::Future<process::http::Response> perf(
+      const process::http::Request& request,
+      const Option<process::http::authentication::Principal>& principal) const;
+
   // /slave/containers
   process::Future<process::http::Response> containers(
       const process::http::Request& request,
@@ -92,6 +100,7 @@ public:
   static std::string HEALTH_HELP();
   static std::string STATE_HELP();
   static std::string STATISTICS_HELP();
+  static std::string PERF_HELP();
   static std::string CONTAINERS_HELP();
   static std::string CONTAINERIZER_DEBUG_HELP();
 
@@ -114,6 +123,10 @@ private:
       const ResourceUsage& usage,
       const process::http::Request& request) const;
 
+  process::http::Response _perf(
+      const hashmap<ContainerID, std::vector<PerfStatistics>>& samples,
+      const process::http::Request& request) const;
+
   // Continuation for `/containers` endpoint
   process::Future<process::http::Response> _containers(
       const process::http::Request& request,
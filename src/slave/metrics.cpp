@@ -41,6 +41,14 @@ Metrics::Metrics(const Slave& slave)
         defer(slave, &Slave::_registered)),
     recovery_errors(
         "slave/recovery_errors"),
+    recovery_state(
+        "slave/recovery/state"),
+    recovery_task_status_updates(
+        "slave/recovery/task_status_updates"),
+    recovery_containerizer(
+        "slave/recovery/containerizer"),
+    recovery_executors(
+        "slave/recovery/executors"),
     frameworks_active(
         "slave/frameworks_active",
         defer(slave, &Slave::_frameworks_active)),
@@ -98,6 +106,10 @@ Metrics::Metrics(const Slave& slave)
   process::metrics::add(registered);
 
   process::metrics::add(recovery_errors);
+  process::metrics::add(recovery_state);
+  process::metrics::add(recovery_task_status_updates);
+  process::metrics::add(recovery_containerizer);
+  process::metrics::add(recovery_executors);
 
   process::metrics::add(frameworks_active);
 
@@ -187,6 +199,10 @@ Metrics::~Metrics()
   process::metrics::remove(registered);
 
   process::metrics::remove(recovery_errors);
+  process::metrics::remove(recovery_state);
+  process::metrics::remove(recovery_task_status_updates);
+  process::metrics::remove(recovery_containerizer);
+  process::metrics::remove(recovery_executors);
 
   process::metrics::remove(frameworks_active);
 
@@ -21,6 +21,7 @@
 
 #include <process/metrics/counter.hpp>
 #include <process/metrics/pull_gauge.hpp>
+#include <process/metrics/timer.hpp>
 
 
 namespace mesos {
@@ -43,6 +44,12 @@ struct Metrics
   process::metrics::Counter recovery_errors;
   Option<process::metrics::PullGauge> recovery_time_secs;
 
+  // The time spent in each phase of the recovery.
+  process::metrics::Timer<Milliseconds> recovery_state;
+  process::metrics::Timer<Milliseconds> recovery_task_status_updates;
+  process::metrics::Timer<Milliseconds> recovery_containerizer;
+  process::metrics::Timer<Milliseconds> recovery_executors;
+
   process::metrics::PullGauge frameworks_active;
 
   process::metrics::PullGauge tasks_staging;
@@ -75,11 +75,13 @@ const char VOLUME_GIDS_FILE[] = "volume_gids";
 
 
 const char CONTAINERS_DIR[] = "containers";
+const char CHECKPOINT_STORE_DIR[] = "checkpoints";
 const char CSI_DIR[] = "csi";
 const char SLAVES_DIR[] = "slaves";
 const char FRAMEWORKS_DIR[] = "frameworks";
 const char EXECUTORS_DIR[] = "executors";
 const char EXECUTOR_RUNS_DIR[] = "runs";
+const char TASKS_DIR[] = "tasks";
 const char RESOURCE_PROVIDER_REGISTRY[] = "resource_provider_registry";
 const char RESOURCE_PROVIDERS_DIR[] = "resource_providers";
 const char OPERATIONS_DIR[] = "operations";
@@ -161,6 +163,12 @@ string getBootIdPath(const string& rootDir)
 }
 
 
+string getCheckpointStorePath(const string& rootDir)
+{
+  return path::join(rootDir, CHECKPOINT_STORE_DIR);
+}
+
+
 string getLatestSlavePath(const string& rootDir)
 {
   return path::join(rootDir, SLAVES_DIR, LATEST_SYMLINK);
@@ -416,7 +424,7 @@ Try<list<string>> getTaskPaths(
           frameworkId,
           executorId,
           containerId),
-      "tasks",
+      TASKS_DIR,
       "*"));
 }
 
@@ -436,7 +444,7 @@ string getTaskPath(
           frameworkId,
           executorId,
           containerId),
-      "tasks",
+      TASKS_DIR,
       stringify(taskId));
 }
 
@@ -68,6 +68,7 @@ namespace paths {
 //   |                           |-- <container_id> (sandbox)
 //   |-- meta
 //   |   |-- boot_id
+//   |   |-- checkpoints (if '--checkpoint_store=leveldb')
 //   |   |-- resources
 //   |   |   |-- resources.info
 //   |   |   |-- resources.target
@@ -162,6 +163,9 @@ std::string getLatestSlavePath(const std::string& rootDir);
 std::string getBootIdPath(const std::string& rootDir);
 
 
+std::string getCheckpointStorePath(const std::string& rootDir);
+
+
 std::string getSlaveInfoPath(
     const std::string& rootDir,
     const SlaveID& slaveId);
@@ -479,6 +483,10 @@ std::string createResourceProviderDirectory(
 
 extern const char LIBPROCESS_PID_FILE[];
 extern const char HTTP_MARKER_FILE[];
+extern const char FRAMEWORKS_DIR[];
+extern const char EXECUTORS_DIR[];
+extern const char EXECUTOR_RUNS_DIR[];
+extern const char TASKS_DIR[];
 
 } // namespace paths {
 } // namespace slave {
@@ -0,0 +1,402 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <mesos/module/qos_controller.hpp>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+#include <stout/stringify.hpp>
+
+#include "slave/qos_controllers/pressure.hpp"
+
+using namespace mesos;
+using namespace process;
+
+using std::list;
+using std::string;
+using std::vector;
+
+using mesos::modules::Module;
+
+using mesos::slave::QoSController;
+using mesos::slave::QoSCorrection;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+class PressureQoSControllerProcess
+  : public Process<PressureQoSControllerProcess>
+{
+public:
+  PressureQoSControllerProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const PressureQoSController::Config& _config)
+    : ProcessBase(process::ID::generate("qos-pressure-controller")),
+      usage(_usage),
+      config(_config),
+      intervals(0) {}
+
+  Future<list<QoSCorrection>> corrections()
+  {
+    return usage().then(defer(self(), &Self::_corrections, lambda::_1));
+  }
+
+  Future<list<QoSCorrection>> _corrections(const ResourceUsage& usage)
+  {
+    hashmap<ContainerID, ResourceStatistics> statistics;
+    Option<string> interference;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      if (!executor.has_statistics()) {
+        continue;
+      }
+
+      statistics[executor.container_id()] = executor.statistics();
+
+      if (interference.isSome() || !protects(executor)) {
+        continue;
+      }
+
+      Option<string> reason = interferes(
+          executor.statistics(),
+          previous.get(executor.container_id()));
+
+      if (reason.isSome()) {
+        interference = "Executor '" +
+          stringify(executor.executor_info().executor_id()) +
+          "' of framework " +
+          stringify(executor.executor_info().framework_id()) + " " +
+          reason.get();
+      }
+    }
+
+    // Only the containers still running are kept, so the statistics of
+    // terminated ones do not accumulate.
+    previous = statistics;
+
+    if (interference.isNone()) {
+      intervals = 0;
+      return list<QoSCorrection>();
+    }
+
+    ++intervals;
+
+    LOG(INFO) << interference.get() << " (" << intervals << " of "
+              << config.interferenceIntervals << " intervals)";
+
+    if (intervals < config.interferenceIntervals) {
+      return list<QoSCorrection>();
+    }
+
+    vector<ResourceUsage::Executor> revocable;
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      if (!Resources(executor.allocated()).revocable().empty()) {
+        revocable.push_back(executor);
+      }
+    }
+
+    // Evict the executors with the most revocable cpus first, as they
+    // are the most likely to cause the interference.
+    std::stable_sort(
+        revocable.begin(),
+        revocable.end(),
+        [](const ResourceUsage::Executor& left,
+           const ResourceUsage::Executor& right) {
+          return Resources(left.allocated()).revocable().cpus().getOrElse(0) >
+            Resources(right.allocated()).revocable().cpus().getOrElse(0);
+        });
+
+    if (config.maxEvictions.isSome() &&
+        revocable.size() > config.maxEvictions.get()) {
+      revocable.resize(config.maxEvictions.get());
+    }
+
+    list<QoSCorrection> corrections;
+
+    foreach (const ResourceUsage::Executor& executor, revocable) {
+      QoSCorrection correction;
+
+      correction.set_type(mesos::slave::QoSCorrection_Type_KILL);
+      correction.mutable_kill()->mutable_framework_id()->CopyFrom(
+          executor.executor_info().framework_id());
+      correction.mutable_kill()->mutable_executor_id()->CopyFrom(
+          executor.executor_info().executor_id());
+      correction.mutable_kill()->mutable_container_id()->CopyFrom(
+          executor.container_id());
+
+      corrections.push_back(correction);
+    }
+
+    return corrections;
+  }
+
+private:
+  // Returns whether the executor is protected from interference, i.e.,
+  // it runs without revocable resources and, if configured, is labelled
+  // as latency sensitive.
+  bool protects(const ResourceUsage::Executor& executor) const
+  {
+    if (!Resources(executor.allocated()).revocable().empty()) {
+      return false;
+    }
+
+    if (config.latencySensitiveLabel.isNone()) {
+      return true;
+    }
+
+    auto labelled = [this](const Labels& labels) {
+      foreach (const Label& label, labels.labels()) {
+        if (label.key() == config.latencySensitiveLabel.get()) {
+          return true;
+        }
+      }
+
+      return false;
+    };
+
+    if (labelled(executor.executor_info().labels())) {
+      return true;
+    }
+
+    foreach (const ResourceUsage::Executor::Task& task, executor.tasks()) {
+      if (labelled(task.labels())) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Returns the reason if the statistics of a protected container show
+  // interference. Throttling and memory reclaims are counted since the
+  // previous correction, so they are only checked from the second
+  // correction the container is seen in.
+  Option<string> interferes(
+      const ResourceStatistics& current,
+      const Option<ResourceStatistics>& last) const
+  {
+    if (config.cpuThrottledThreshold.isSome() &&
+        last.isSome() &&
+        current.has_cpus_nr_periods() &&
+        current.has_cpus_nr_throttled() &&
+        current.cpus_nr_periods() > last->cpus_nr_periods()) {
+      const double throttled =
+        static_cast<double>(
+            current.cpus_nr_throttled() - last->cpus_nr_throttled()) /
+        (current.cpus_nr_periods() - last->cpus_nr_periods());
+
+      if (throttled > config.cpuThrottledThreshold.get()) {
+        return "was throttled in " + stringify(throttled * 100) +
+               "% of its cpu periods";
+      }
+    }
+
+    if (config.memoryReclaimThreshold.isSome() &&
+        last.isSome() &&
+        current.has_mem_low_pressure_counter() &&
+        current.mem_low_pressure_counter() >=
+          last->mem_low_pressure_counter()) {
+      const uint64_t reclaims =
+        current.mem_low_pressure_counter() - last->mem_low_pressure_counter();
+
+      if (reclaims > config.memoryReclaimThreshold.get()) {
+        return "reclaimed memory " + stringify(reclaims) + " times";
+      }
+    }
+
+    auto stalled = [](
+        const string& resource,
+        bool available,
+        const PressureStallStatistics& pressure,
+        const Option<double>& threshold) -> Option<string> {
+      if (threshold.isSome() &&
+          available &&
+          pressure.some().avg10() > threshold.get()) {
+        return "stalled on " + resource + " " +
+               stringify(pressure.some().avg10()) + "% of the time";
+      }
+
+      return None();
+    };
+
+    Option<string> reason = stalled(
+        "cpu",
+        current.has_cpu_pressure(),
+        current.cpu_pressure(),
+        config.cpuPressureThreshold);
+
+    if (reason.isNone()) {
+      reason = stalled(
+          "memory",
+          current.has_mem_pressure(),
+          current.mem_pressure(),
+          config.memoryPressureThreshold);
+    }
+
+    if (reason.isNone()) {
+      reason = stalled(
+          "io",
+          current.has_io_pressure(),
+          current.io_pressure(),
+          config.ioPressureThreshold);
+    }
+
+    return reason;
+  }
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const PressureQoSController::Config config;
+
+  // The statistics of the previous correction, and the number of
+  // consecutive corrections which have seen interference.
+  hashmap<ContainerID, ResourceStatistics> previous;
+  size_t intervals;
+};
+
+
+PressureQoSController::~PressureQoSController()
+{
+  if (process.get() != nullptr) {
+    terminate(process.get());
+    wait(process.get());
+  }
+}
+
+
+Try<Nothing> PressureQoSController::initialize(
+  const lambda::function<Future<ResourceUsage>()>& usage)
+{
+  if (process.get() != nullptr) {
+    return Error("Pressure QoS Controller has already been initialized");
+  }
+
+  process.reset(new PressureQoSControllerProcess(usage, config));
+
+  spawn(process.get());
+
+  return Nothing();
+}
+
+
+process::Future<list<QoSCorrection>> PressureQoSController::corrections()
+{
+  if (process.get() == nullptr) {
+    return Failure("Pressure QoS Controller is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &PressureQoSControllerProcess::corrections);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+
+template <typename T>
+static bool parse(const Parameter& parameter, Option<T>* value)
+{
+  Try<T> parsed = numify<T>(parameter.value());
+  if (parsed.isError()) {
+    LOG(ERROR) << "Failed to parse '" << parameter.key() << "': "
+               << parsed.error();
+    return false;
+  }
+
+  *value = parsed.get();
+  return true;
+}
+
+
+static QoSController* create(const Parameters& parameters)
+{
+  mesos::internal::slave::PressureQoSController::Config config;
+  Option<size_t> interferenceIntervals;
+
+  foreach (const Parameter& parameter, parameters.parameter()) {
+    bool parsed = true;
+
+    if (parameter.key() == "cpu_throttled_threshold") {
+      parsed = parse(parameter, &config.cpuThrottledThreshold);
+    } else if (parameter.key() == "memory_reclaim_threshold") {
+      parsed = parse(parameter, &config.memoryReclaimThreshold);
+    } else if (parameter.key() == "cpu_pressure_threshold") {
+      parsed = parse(parameter, &config.cpuPressureThreshold);
+    } else if (parameter.key() == "memory_pressure_threshold") {
+      parsed = parse(parameter, &config.memoryPressureThreshold);
+    } else if (parameter.key() == "io_pressure_threshold") {
+      parsed = parse(parameter, &config.ioPressureThreshold);
+    } else if (parameter.key() == "latency_sensitive_label") {
+      config.latencySensitiveLabel = parameter.value();
+    } else if (parameter.key() == "interference_intervals") {
+      parsed = parse(parameter, &interferenceIntervals);
+    } else if (parameter.key() == "max_evictions") {
+      parsed = parse(parameter, &config.maxEvictions);
+    }
+
+    if (!parsed) {
+      return nullptr;
+    }
+  }
+
+  if (config.cpuThrottledThreshold.isNone() &&
+      config.memoryReclaimThreshold.isNone() &&
+      config.cpuPressureThreshold.isNone() &&
+      config.memoryPressureThreshold.isNone() &&
+      config.ioPressureThreshold.isNone()) {
+    LOG(ERROR) << "No thresholds are configured for PressureQoSController";
+    return nullptr;
+  }
+
+  if (interferenceIntervals.isSome()) {
+    if (interferenceIntervals.get() == 0) {
+      LOG(ERROR) << "'interference_intervals' must be positive";
+      return nullptr;
+    }
+
+    config.interferenceIntervals = interferenceIntervals.get();
+  }
+
+  return new mesos::internal::slave::PressureQoSController(config);
+}
+
+
+Module<QoSController> org_apache_mesos_PressureQoSController(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Pressure QoS Controller Module.",
+    nullptr,
+    create);
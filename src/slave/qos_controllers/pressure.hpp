@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
+#define __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
+
+#include <list>
+#include <string>
+
+#include <mesos/slave/qos_controller.hpp>
+
+#include <stout/lambda.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include <process/future.hpp>
+#include <process/owned.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class PressureQoSControllerProcess;
+
+
+// The `PressureQoSController` protects the non-revocable executors
+// from interference by the revocable ones. Instead of looking at the
+// load of the whole agent, it looks at the statistics of each
+// non-revocable container and evicts revocable executors as soon as
+// one of them is throttled, reclaims memory or stalls on a resource
+// above the configured thresholds.
+//
+// The controller runs a simple control loop: on each correction it
+// compares the statistics with the ones of the previous correction,
+// and once the interference was seen for `interferenceIntervals`
+// consecutive corrections, it evicts up to `maxEvictions` revocable
+// executors, largest revocable cpu allocation first. If the
+// interference persists, more executors are evicted on the following
+// corrections.
+class PressureQoSController : public mesos::slave::QoSController
+{
+public:
+  struct Config
+  {
+    // The share of CFS periods (between 0 and 1) in which a container
+    // was throttled since the previous correction (`cpu.stat`).
+    Option<double> cpuThrottledThreshold;
+
+    // The number of low level memory pressure events, i.e., memory
+    // reclaims, of a container since the previous correction. This
+    // requires the `cgroups/mem` isolator with cgroups v1.
+    Option<uint64_t> memoryReclaimThreshold;
+
+    // The share of time (in percent) in which some tasks of a container
+    // were stalled on cpu, memory or io over the last 10 seconds. This
+    // requires pressure stall information (cgroups v2).
+    Option<double> cpuPressureThreshold;
+    Option<double> memoryPressureThreshold;
+    Option<double> ioPressureThreshold;
+
+    // If set, only non-revocable executors whose executor info, or one
+    // of whose tasks, carries a label with this key are protected.
+    // Otherwise all non-revocable executors are.
+    Option<std::string> latencySensitiveLabel;
+
+    // The number of consecutive corrections that have to see
+    // interference before revocable executors are evicted.
+    size_t interferenceIntervals = 1;
+
+    // The maximum number of revocable executors evicted per correction,
+    // or all of them if none.
+    Option<size_t> maxEvictions;
+  };
+
+  // NOTE: The usage is passed to `initialize` by the agent, which
+  // allows tests to drive the controller with simulated statistics.
+  explicit PressureQoSController(const Config& _config)
+    : config(_config) {}
+
+  ~PressureQoSController() override;
+
+  Try<Nothing> initialize(
+    const lambda::function<process::Future<ResourceUsage>()>& usage) override;
+
+  process::Future<std::list<mesos::slave::QoSCorrection>> corrections()
+    override;
+
+private:
+  const Config config;
+  process::Owned<PressureQoSControllerProcess> process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_QOS_CONTROLLERS_PRESSURE_HPP__
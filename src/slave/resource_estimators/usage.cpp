@@ -0,0 +1,388 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <mesos/module/resource_estimator.hpp>
+
+#include <mesos/slave/resource_estimator.hpp>
+
+#include <process/defer.hpp>
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/id.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/check.hpp>
+#include <stout/circular_buffer.hpp>
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/hashset.hpp>
+#include <stout/lambda.hpp>
+#include <stout/numify.hpp>
+#include <stout/option.hpp>
+
+#include "slave/resource_estimators/usage.hpp"
+
+using namespace mesos;
+using namespace process;
+
+using std::string;
+using std::vector;
+
+using mesos::modules::Module;
+
+using mesos::slave::ResourceEstimator;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Returns the given percentile of the samples (nearest rank).
+static double percentile(
+    const circular_buffer<double>& samples,
+    double percentile)
+{
+  CHECK(!samples.empty());
+
+  vector<double> values(samples.begin(), samples.end());
+
+  const size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100 * values.size()));
+
+  const size_t index = std::min(std::max(rank, size_t(1)), values.size()) - 1;
+
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+
+  return values[index];
+}
+
+
+class UsageResourceEstimatorProcess
+  : public Process<UsageResourceEstimatorProcess>
+{
+public:
+  UsageResourceEstimatorProcess(
+      const lambda::function<Future<ResourceUsage>()>& _usage,
+      const UsageResourceEstimator::Config& _config)
+    : ProcessBase(process::ID::generate("usage-resource-estimator")),
+      usage(_usage),
+      config(_config),
+      capacity(std::max(
+          static_cast<size_t>(
+              config.window.ns() / config.samplingInterval.ns()),
+          size_t(1))) {}
+
+  Future<Resources> oversubscribable()
+  {
+    return usage().then(defer(self(), &Self::_oversubscribable, lambda::_1));
+  }
+
+  Future<Resources> _oversubscribable(const ResourceUsage& usage)
+  {
+    double cpus = 0;
+    double mem = 0;
+    Resources allocatedRevocable;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      const Resources allocated = executor.allocated();
+
+      allocatedRevocable += allocated.revocable();
+
+      auto it = histories.find(executor.container_id());
+      if (it == histories.end()) {
+        continue;
+      }
+
+      const History& history = it->second;
+      const Resources nonRevocable = allocated.nonRevocable();
+
+      if (nonRevocable.cpus().isSome() &&
+          history.cpus.size() >= config.minSamples) {
+        double slack =
+          nonRevocable.cpus().get() * (1 - config.cpusMargin) -
+          percentile(history.cpus, config.percentile);
+
+        cpus += std::max(slack, 0.0);
+      }
+
+      if (nonRevocable.mem().isSome() &&
+          history.mem.size() >= config.minSamples) {
+        double slack =
+          nonRevocable.mem()->bytes() * (1 - config.memMargin) -
+          percentile(history.mem, config.percentile);
+
+        mem += std::max(slack, 0.0);
+      }
+    }
+
+    Resources total;
+
+    auto revocable = [](const string& name, double value) {
+      Resource resource;
+      resource.set_name(name);
+      resource.set_type(Value::SCALAR);
+      resource.mutable_scalar()->set_value(value);
+      resource.mutable_revocable();
+      return resource;
+    };
+
+    if (cpus > 0) {
+      total += revocable("cpus", cpus);
+    }
+
+    // Memory is offered in whole megabytes.
+    mem = std::floor(mem / Megabytes(1).bytes());
+    if (mem > 0) {
+      total += revocable("mem", mem);
+    }
+
+    allocatedRevocable.unallocate();
+
+    return total - allocatedRevocable;
+  }
+
+protected:
+  void initialize() override
+  {
+    sample();
+  }
+
+private:
+  // The usage history of a container. Only the samples in the window
+  // are kept, the cpu usage in cpus and the memory usage in bytes.
+  struct History
+  {
+    explicit History(size_t capacity) : cpus(capacity), mem(capacity) {}
+
+    // The timestamp and the total cpu time of the previous sample, to
+    // compute the cpu usage since then.
+    Option<double> timestamp;
+    double cpusTime = 0;
+
+    circular_buffer<double> cpus;
+    circular_buffer<double> mem;
+  };
+
+  void sample()
+  {
+    usage().onAny(defer(self(), &Self::_sample, lambda::_1));
+  }
+
+  void _sample(const Future<ResourceUsage>& usage)
+  {
+    if (usage.isReady()) {
+      record(usage.get());
+    } else {
+      LOG(WARNING) << "Failed to get resource usage: "
+                   << (usage.isFailed() ? usage.failure() : "discarded");
+    }
+
+    delay(config.samplingInterval, self(), &Self::sample);
+  }
+
+  void record(const ResourceUsage& usage)
+  {
+    hashset<ContainerID> containerIds;
+
+    foreach (const ResourceUsage::Executor& executor, usage.executors()) {
+      if (!executor.has_statistics()) {
+        continue;
+      }
+
+      const ContainerID& containerId = executor.container_id();
+      const ResourceStatistics& statistics = executor.statistics();
+
+      containerIds.insert(containerId);
+
+      if (!histories.contains(containerId)) {
+        histories.emplace(containerId, History(capacity));
+      }
+
+      History& history = histories.at(containerId);
+
+      if (statistics.has_cpus_user_time_secs() &&
+          statistics.has_cpus_system_time_secs()) {
+        const double cpusTime =
+          statistics.cpus_user_time_secs() +
+          statistics.cpus_system_time_secs();
+
+        if (history.timestamp.isSome() &&
+            statistics.timestamp() > history.timestamp.get()) {
+          history.cpus.push_back(std::max(
+              (cpusTime - history.cpusTime) /
+                (statistics.timestamp() - history.timestamp.get()),
+              0.0));
+        }
+
+        history.timestamp = statistics.timestamp();
+        history.cpusTime = cpusTime;
+      }
+
+      if (statistics.has_mem_total_bytes()) {
+        history.mem.push_back(statistics.mem_total_bytes());
+      } else if (statistics.has_mem_rss_bytes()) {
+        history.mem.push_back(statistics.mem_rss_bytes());
+      }
+    }
+
+    // Drop the histories of the containers which are gone.
+    foreach (const ContainerID& containerId, histories.keys()) {
+      if (!containerIds.contains(containerId)) {
+        histories.erase(containerId);
+      }
+    }
+  }
+
+  const lambda::function<Future<ResourceUsage>()> usage;
+  const UsageResourceEstimator::Config config;
+
+  // The number of samples kept per container.
+  const size_t capacity;
+
+  hashmap<ContainerID, History> histories;
+};
+
+
+UsageResourceEstimator::~UsageResourceEstimator()
+{
+  if (process.get() != nullptr) {
+    terminate(process.get());
+    wait(process.get());
+  }
+}
+
+
+Try<Nothing> UsageResourceEstimator::initialize(
+    const lambda::function<Future<ResourceUsage>()>& usage)
+{
+  if (process.get() != nullptr) {
+    return Error("Usage resource estimator has already been initialized");
+  }
+
+  process.reset(new UsageResourceEstimatorProcess(usage, config));
+  spawn(process.get());
+
+  return Nothing();
+}
+
+
+Future<Resources> UsageResourceEstimator::oversubscribable()
+{
+  if (process.get() == nullptr) {
+    return Failure("Usage resource estimator is not initialized");
+  }
+
+  return dispatch(
+      process.get(),
+      &UsageResourceEstimatorProcess::oversubscribable);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+
+static ResourceEstimator* create(const Parameters& parameters)
+{
+  mesos::internal::slave::UsageResourceEstimator::Config config;
+
+  foreach (const Parameter& parameter, parameters.parameter()) {
+    if (parameter.key() == "sampling_interval" ||
+        parameter.key() == "window") {
+      Try<Duration> duration = Duration::parse(parameter.value());
+      if (duration.isError() || duration.get() <= Duration::zero()) {
+        LOG(ERROR) << "Invalid '" << parameter.key() << "': "
+                   << parameter.value();
+        return nullptr;
+      }
+
+      if (parameter.key() == "sampling_interval") {
+        config.samplingInterval = duration.get();
+      } else {
+        config.window = duration.get();
+      }
+    } else if (parameter.key() == "percentile") {
+      Try<double> percentile = numify<double>(parameter.value());
+      if (percentile.isError() ||
+          percentile.get() <= 0 ||
+          percentile.get() > 100) {
+        LOG(ERROR) << "Invalid 'percentile': " << parameter.value();
+        return nullptr;
+      }
+
+      config.percentile = percentile.get();
+    } else if (parameter.key() == "cpus_margin" ||
+               parameter.key() == "mem_margin") {
+      Try<double> margin = numify<double>(parameter.value());
+      if (margin.isError() || margin.get() < 0 || margin.get() > 1) {
+        LOG(ERROR) << "Invalid '" << parameter.key() << "': "
+                   << parameter.value();
+        return nullptr;
+      }
+
+      if (parameter.key() == "cpus_margin") {
+        config.cpusMargin = margin.get();
+      } else {
+        config.memMargin = margin.get();
+      }
+    } else if (parameter.key() == "min_samples") {
+      Try<size_t> minSamples = numify<size_t>(parameter.value());
+      if (minSamples.isError()) {
+        LOG(ERROR) << "Invalid 'min_samples': " << parameter.value();
+        return nullptr;
+      }
+
+      config.minSamples = minSamples.get();
+    }
+  }
+
+  if (config.window < config.samplingInterval) {
+    LOG(ERROR) << "The 'window' must not be shorter than the "
+               << "'sampling_interval'";
+    return nullptr;
+  }
+
+  // A container is never oversubscribed if the window cannot hold
+  // enough samples.
+  const size_t capacity = static_cast<size_t>(
+      config.window.ns() / config.samplingInterval.ns());
+
+  if (config.minSamples > capacity) {
+    LOG(ERROR) << "The 'min_samples' (" << config.minSamples << ") must not "
+               << "exceed the number of samples in the 'window' ("
+               << capacity << ")";
+    return nullptr;
+  }
+
+  return new mesos::internal::slave::UsageResourceEstimator(config);
+}
+
+
+Module<ResourceEstimator> org_apache_mesos_UsageResourceEstimator(
+    MESOS_MODULE_API_VERSION,
+    MESOS_VERSION,
+    "Apache Mesos",
+    "modules@mesos.apache.org",
+    "Usage Resource Estimator Module.",
+    nullptr,
+    create);
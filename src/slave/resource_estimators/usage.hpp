@@ -0,0 +1,82 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef __SLAVE_RESOURCE_ESTIMATORS_USAGE_HPP__
+#define __SLAVE_RESOURCE_ESTIMATORS_USAGE_HPP__
+
+#include <mesos/slave/resource_estimator.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/lambda.hpp>
+
+#include <process/owned.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class UsageResourceEstimatorProcess;
+
+
+// A resource estimator which oversubscribes the resources allocated to
+// the non-revocable executors but not used by them. It samples the
+// usage of each container every `samplingInterval` and keeps the cpu
+// and memory usage over the last `window`, i.e., a bounded number of
+// samples per container. The estimated slack of an executor is its
+// allocation, minus a safety margin, minus the given percentile of its
+// usage over the window. Containers with fewer than `minSamples`
+// samples do not contribute any slack yet.
+class UsageResourceEstimator : public mesos::slave::ResourceEstimator
+{
+public:
+  struct Config
+  {
+    Duration samplingInterval = Seconds(1);
+    Duration window = Minutes(5);
+
+    // The percentile (between 0 and 100) of the usage which is
+    // considered used.
+    double percentile = 95;
+
+    // The share of the allocation (between 0 and 1) which is never
+    // oversubscribed.
+    double cpusMargin = 0.1;
+    double memMargin = 0.1;
+
+    size_t minSamples = 10;
+  };
+
+  explicit UsageResourceEstimator(const Config& _config)
+    : config(_config) {}
+
+  ~UsageResourceEstimator() override;
+
+  Try<Nothing> initialize(
+      const lambda::function<process::Future<ResourceUsage>()>& usage) override;
+
+  process::Future<Resources> oversubscribable() override;
+
+private:
+  const Config config;
+  process::Owned<UsageResourceEstimatorProcess> process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_RESOURCE_ESTIMATORS_USAGE_HPP__
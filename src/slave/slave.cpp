@@ -405,6 +405,14 @@ void Slave::initialize()
       << " for --gc_disk_headroom. Must be between 0.0 and 1.0";
   }
 
+  if (flags.gc_disk_watermark.isSome() &&
+      ((flags.gc_disk_watermark.get() < 0) ||
+       (flags.gc_disk_watermark.get() > 1))) {
+    EXIT(EXIT_FAILURE)
+      << "Invalid value '" << flags.gc_disk_watermark.get() << "'"
+      << " for --gc_disk_watermark. Must be between 0.0 and 1.0";
+  }
+
   Try<Nothing> initialize =
     resourceEstimator->initialize(defer(self(), &Self::usage));
 
@@ -827,6 +835,14 @@ void Slave::initialize()
           logRequest(request);
           return http.statistics(request, principal);
         });
+  route("/monitor/perf",
+        READONLY_HTTP_AUTHENTICATION_REALM,
+        Http::PERF_HELP(),
+        [this](const http::Request& request,
+               const Option<Principal>& principal) {
+          logRequest(request);
+          return http.perf(request, principal);
+        });
   route("/containers",
         READONLY_HTTP_AUTHENTICATION_REALM,
         Http::CONTAINERS_HELP(),
@@ -896,6 +912,22 @@ void Slave::initialize()
       << " Please run the agent with '--help' to see the valid options";
   }
 
+#ifndef __WINDOWS__
+  // Open the checkpoint store before recovery, so that the checkpoints
+  // are recovered from it.
+  if (flags.checkpoint_store == "leveldb") {
+    Try<std::shared_ptr<state::CheckpointStore>> store =
+      state::CheckpointStore::create(metaDir);
+
+    if (store.isError()) {
+      EXIT(EXIT_FAILURE)
+        << "Failed to open the checkpoint store: " << store.error();
+    }
+
+    checkpointStore = store.get();
+  }
+#endif // __WINDOWS__
+
   auto signalHandler = defer(self(), &Slave::signaled, lambda::_1, lambda::_2)
     .operator std::function<void(int, int)>();
 
@@ -912,9 +944,20 @@ void Slave::initialize()
 #endif  // __WINDOWS__
 
   // Do recovery.
-  async(&state::recover, metaDir, flags.strict)
+  //
+  // NOTE: The recovery holds a reference to the checkpoint store since
+  // it runs outside of the agent actor.
+  const string rootDir = metaDir;
+  const bool strict = flags.strict;
+  std::shared_ptr<state::CheckpointStore> store = checkpointStore;
+
+  metrics.recovery_state.time(async([rootDir, strict, store]() {
+      return state::recover(rootDir, strict, store.get());
+    }))
     .then(defer(self(), &Slave::recover, lambda::_1))
-    .then(defer(self(), &Slave::_recover))
+    .then(defer(self(), [this]() {
+      return metrics.recovery_executors.time(_recover());
+    }))
     .onAny(defer(self(), &Slave::__recover, lambda::_1));
 }
 
@@ -945,6 +988,10 @@ void Slave::finalize()
   // Explicitly tear down the resource provider manager to ensure that the
   // wrapped process is terminated and releases the underlying storage.
   resourceProviderManager.reset();
+
+  // Likewise, close the checkpoint store so that a restarted agent in
+  // the same process (e.g., in tests) can open it again.
+  checkpointStore.reset();
 }
 
 
@@ -1004,6 +1051,7 @@ void Slave::drain(
     << ", new drain config is " << drainSlaveMessage.config();
 
   CHECK_SOME(state::checkpoint(
+      checkpointStore.get(),
       paths::getDrainConfigPath(metaDir, info.id()),
       drainSlaveMessage.config()))
     << "Failed to checkpoint DrainConfig";
@@ -1610,7 +1658,7 @@ void Slave::registered(
 
       VLOG(1) << "Checkpointing SlaveInfo to '" << path << "'";
 
-      CHECK_SOME(state::checkpoint(path, info));
+      CHECK_SOME(state::checkpoint(checkpointStore.get(), path, info));
 
       // If we registered with this agent ID for the first time initialize
       // the resource provider manager with it; if the manager was already
@@ -3204,9 +3252,7 @@ void Slave::__run(
     }
     case Executor::REGISTERING:
       if (executor->checkpoint) {
-        foreach (const TaskInfo& _task, tasks) {
-          executor->checkpointTask(_task);
-        }
+        executor->checkpointTasks(tasks);
       }
 
       if (taskGroup.isSome()) {
@@ -3223,9 +3269,7 @@ void Slave::__run(
       break;
     case Executor::RUNNING: {
       if (executor->checkpoint) {
-        foreach (const TaskInfo& _task, tasks) {
-          executor->checkpointTask(_task);
-        }
+        executor->checkpointTasks(tasks);
       }
 
       // Queue tasks until the containerizer is updated
@@ -5393,7 +5437,8 @@ void Slave::registerExecutor(
 
         VLOG(1) << "Checkpointing executor pid '"
                 << executor->pid.get() << "' to '" << path << "'";
-        CHECK_SOME(state::checkpoint(path, executor->pid.get()));
+        CHECK_SOME(state::checkpoint(
+            checkpointStore.get(), path, executor->pid.get()));
       }
 
       // Here, we kill the executor if it no longer has any task to run
@@ -7464,6 +7509,28 @@ void Slave::_checkDiskUsage(const Future<double>& usage)
     // scheduled for deletion 'gc_delay' into the future, only directories
     // that are at least 'age' old are deleted.
     gc->prune(flags.gc_delay - executorDirectoryMaxAllowedAge);
+
+    // Under disk pressure, we additionally have the garbage collector
+    // reclaim the missing free space right away, starting with the
+    // largest directories.
+    const double free = 1.0 - usage.get();
+
+    if (flags.gc_disk_watermark.isSome() &&
+        free < flags.gc_disk_watermark.get()) {
+      Try<Bytes> size = ::fs::size(flags.work_dir);
+      if (size.isError()) {
+        LOG(ERROR) << "Failed to get disk size: " << size.error();
+      } else {
+        Bytes target = Bytes(static_cast<uint64_t>(
+            size->bytes() * (flags.gc_disk_watermark.get() - free)));
+
+        LOG(INFO) << "Free disk space is below the watermark of "
+                  << 100 * flags.gc_disk_watermark.get() << "%,"
+                  << " reclaiming " << target;
+
+        gc->evict(target);
+      }
+    }
   }
   delay(flags.disk_watch_interval, self(), &Slave::checkDiskUsage);
 }
@@ -7802,7 +7869,8 @@ Future<Nothing> Slave::_recoverVolumeGidManager(bool rebooted)
 Future<Option<SlaveState>> Slave::_recoverTaskStatusUpdates(
     const Option<SlaveState>& state)
 {
-  return taskStatusUpdateManager->recover(metaDir, state)
+  return metrics.recovery_task_status_updates.time(
+      taskStatusUpdateManager->recover(metaDir, state))
     .then([state]() -> Future<Option<SlaveState>> {
       return state;
     });
@@ -7812,7 +7880,7 @@ Future<Option<SlaveState>> Slave::_recoverTaskStatusUpdates(
 Future<Nothing> Slave::_recoverContainerizer(
     const Option<SlaveState>& state)
 {
-  return containerizer->recover(state);
+  return metrics.recovery_containerizer.time(containerizer->recover(state));
 }
 
 
@@ -9919,7 +9987,7 @@ void Slave::updateDrainStatus()
 
   const string drainConfigPath = paths::getDrainConfigPath(metaDir, info.id());
 
-  Try<Nothing> rm = os::rm(drainConfigPath);
+  Try<Nothing> rm = state::remove(checkpointStore.get(), drainConfigPath);
 
   if (rm.isError()) {
     EXIT(EXIT_FAILURE) << "Could not remove persisted drain configuration "
@@ -9961,13 +10029,17 @@ bool Framework::idle() const
 
 void Framework::checkpointFramework() const
 {
+  // The framework info and pid are written together into the checkpoint
+  // store, if any.
+  state::Checkpoints checkpoints(slave->checkpointStore.get());
+
   // Checkpoint the framework info.
   string path = paths::getFrameworkInfoPath(
       slave->metaDir, slave->info.id(), id());
 
   VLOG(1) << "Checkpointing FrameworkInfo to '" << path << "'";
 
-  CHECK_SOME(state::checkpoint(path, info));
+  CHECK_SOME(checkpoints.add(path, info));
 
   // Checkpoint the framework pid, note that we checkpoint a
   // UPID() when it is None (for HTTP schedulers) because
@@ -9980,7 +10052,8 @@ void Framework::checkpointFramework() const
           << " '" << pid.getOrElse(UPID()) << "'"
           << " to '" << path << "'";
 
-  CHECK_SOME(state::checkpoint(path, pid.getOrElse(UPID())));
+  CHECK_SOME(checkpoints.add(path, pid.getOrElse(UPID())));
+  CHECK_SOME(checkpoints.commit());
 }
 
 
@@ -10765,7 +10838,7 @@ void Executor::checkpointExecutor()
 
   VLOG(1) << "Checkpointing ExecutorInfo to '" << path << "'";
 
-  CHECK_SOME(state::checkpoint(path, info));
+  CHECK_SOME(state::checkpoint(slave->checkpointStore.get(), path, info));
 
   // Create the meta executor directory.
   // NOTE: This creates the 'latest' symlink in the meta directory.
@@ -10776,12 +10849,6 @@ void Executor::checkpointExecutor()
 }
 
 
-void Executor::checkpointTask(const TaskInfo& task)
-{
-  checkpointTask(protobuf::createTask(task, TASK_STAGING, frameworkId));
-}
-
-
 void Executor::checkpointTask(const Task& task)
 {
   CHECK(checkpoint);
@@ -10796,7 +10863,32 @@ void Executor::checkpointTask(const Task& task)
 
   VLOG(1) << "Checkpointing TaskInfo to '" << path << "'";
 
-  CHECK_SOME(state::checkpoint(path, task));
+  CHECK_SOME(state::checkpoint(slave->checkpointStore.get(), path, task));
+}
+
+
+void Executor::checkpointTasks(const vector<TaskInfo>& tasks)
+{
+  CHECK(checkpoint);
+
+  state::Checkpoints checkpoints(slave->checkpointStore.get());
+
+  foreach (const TaskInfo& task, tasks) {
+    const string path = paths::getTaskInfoPath(
+        slave->metaDir,
+        slave->info.id(),
+        frameworkId,
+        id,
+        containerId,
+        task.task_id());
+
+    VLOG(1) << "Checkpointing TaskInfo to '" << path << "'";
+
+    CHECK_SOME(checkpoints.add(
+        path, protobuf::createTask(task, TASK_STAGING, frameworkId)));
+  }
+
+  CHECK_SOME(checkpoints.commit());
 }
 
 
@@ -880,6 +880,10 @@ private:
   process::Owned<ResourceProviderManager> resourceProviderManager;
   process::Owned<LocalResourceProviderDaemon> localResourceProviderDaemon;
 
+  // The store of the checkpoints of the agent, or nullptr if the agent
+  // checkpoints into files (see `--checkpoint_store`).
+  std::shared_ptr<state::CheckpointStore> checkpointStore;
+
   // Local resource providers known by the agent.
   hashmap<ResourceProviderID, ResourceProvider*> resourceProviders;
 
@@ -950,9 +954,12 @@ public:
   Task* addLaunchedTask(const TaskInfo& task);
   void completeTask(const TaskID& taskId);
   void checkpointExecutor();
-  void checkpointTask(const TaskInfo& task);
   void checkpointTask(const Task& task);
 
+  // Checkpoints the given tasks together, i.e., in a single batch into
+  // the checkpoint store of the agent if there is one.
+  void checkpointTasks(const std::vector<TaskInfo>& tasks);
+
   void recoverTask(const state::TaskState& state, bool recheckpointTask);
 
   void addPendingTaskStatus(const TaskStatus& status);
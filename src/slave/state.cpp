@@ -16,6 +16,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include <process/pid.hpp>
@@ -23,6 +24,7 @@
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
+#include <stout/fs.hpp>
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 #include <stout/numify.hpp>
@@ -62,7 +64,28 @@ using std::max;
 using std::string;
 
 
-Try<State> recover(const string& rootDir, bool strict)
+// Returns the paths of the entries of the given directory of the meta
+// directory. With a checkpoint store, these are found from its keys
+// rather than by listing the directory, so only the entries holding a
+// checkpoint kept in the store are returned.
+static Try<list<string>> findPaths(
+    const CheckpointStore* store,
+    const string& directory)
+{
+#ifndef __WINDOWS__
+  if (store != nullptr) {
+    return store->list(directory);
+  }
+#endif // __WINDOWS__
+
+  return fs::list(path::join(directory, "*"));
+}
+
+
+Try<State> recover(
+    const string& rootDir,
+    bool strict,
+    const CheckpointStore* store)
 {
   LOG(INFO) << "Recovering state from '" << rootDir << "'";
 
@@ -125,7 +148,7 @@ Try<State> recover(const string& rootDir, bool strict)
   slaveId.set_value(Path(directory.get()).basename());
 
   Try<SlaveState> slave =
-    SlaveState::recover(rootDir, slaveId, strict, state.rebooted);
+    SlaveState::recover(rootDir, slaveId, strict, state.rebooted, store);
 
   if (slave.isError()) {
     return Error(slave.error());
@@ -141,21 +164,22 @@ Try<SlaveState> SlaveState::recover(
     const string& rootDir,
     const SlaveID& slaveId,
     bool strict,
-    bool rebooted)
+    bool rebooted,
+    const CheckpointStore* store)
 {
   SlaveState state;
   state.id = slaveId;
 
   // Read the slave info.
   const string path = paths::getSlaveInfoPath(rootDir, slaveId);
-  if (!os::exists(path)) {
+  if (!state::exists(store, path)) {
     // This could happen if the slave died before it registered with
     // the master.
     LOG(WARNING) << "Failed to find agent info file '" << path << "'";
     return state;
   }
 
-  Result<SlaveInfo> slaveInfo = state::read<SlaveInfo>(path);
+  Result<SlaveInfo> slaveInfo = state::read<SlaveInfo>(store, path);
 
   if (slaveInfo.isError()) {
     const string message = "Failed to read agent info from '" + path + "': " +
@@ -179,7 +203,9 @@ Try<SlaveState> SlaveState::recover(
   state.info = slaveInfo.get();
 
   // Find the frameworks.
-  Try<list<string>> frameworks = paths::getFrameworkPaths(rootDir, slaveId);
+  Try<list<string>> frameworks = findPaths(
+      store,
+      path::join(paths::getSlavePath(rootDir, slaveId), paths::FRAMEWORKS_DIR));
 
   if (frameworks.isError()) {
     return Error("Failed to find frameworks for agent " + slaveId.value() +
@@ -192,7 +218,8 @@ Try<SlaveState> SlaveState::recover(
     frameworkId.set_value(Path(path).basename());
 
     Try<FrameworkState> framework =
-      FrameworkState::recover(rootDir, slaveId, frameworkId, strict, rebooted);
+      FrameworkState::recover(
+          rootDir, slaveId, frameworkId, strict, rebooted, store);
 
     if (framework.isError()) {
       return Error("Failed to recover framework " + frameworkId.value() +
@@ -205,8 +232,9 @@ Try<SlaveState> SlaveState::recover(
 
   // Recover any drain state.
   const string drainConfigPath = paths::getDrainConfigPath(rootDir, slaveId);
-  if (os::exists(drainConfigPath)) {
-    Result<DrainConfig> drainConfig = state::read<DrainConfig>(drainConfigPath);
+  if (state::exists(store, drainConfigPath)) {
+    Result<DrainConfig> drainConfig =
+      state::read<DrainConfig>(store, drainConfigPath);
     if (drainConfig.isError()) {
       string message = "Failed to read agent state file '"
                        + drainConfigPath + "': " + drainConfig.error();
@@ -284,7 +312,8 @@ Try<FrameworkState> FrameworkState::recover(
     const SlaveID& slaveId,
     const FrameworkID& frameworkId,
     bool strict,
-    bool rebooted)
+    bool rebooted,
+    const CheckpointStore* store)
 {
   FrameworkState state;
   state.id = frameworkId;
@@ -292,7 +321,7 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework info.
   string path = paths::getFrameworkInfoPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!state::exists(store, path)) {
     // This could happen if the slave died after creating the
     // framework directory but before it checkpointed the framework
     // info.
@@ -300,7 +329,8 @@ Try<FrameworkState> FrameworkState::recover(
     return state;
   }
 
-  const Result<FrameworkInfo> frameworkInfo = state::read<FrameworkInfo>(path);
+  const Result<FrameworkInfo> frameworkInfo =
+    state::read<FrameworkInfo>(store, path);
 
   if (frameworkInfo.isError()) {
     message = "Failed to read framework info from '" + path + "': " +
@@ -326,14 +356,14 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework pid.
   path = paths::getFrameworkPidPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!state::exists(store, path)) {
     // This could happen if the slave died after creating the
     // framework info but before it checkpointed the framework pid.
     LOG(WARNING) << "Failed to framework pid file '" << path << "'";
     return state;
   }
 
-  Result<string> pid = state::read<string>(path);
+  Result<string> pid = state::read<string>(store, path);
 
   if (pid.isError()) {
     message =
@@ -358,8 +388,11 @@ Try<FrameworkState> FrameworkState::recover(
   state.pid = process::UPID(pid.get());
 
   // Find the executors.
-  Try<list<string>> executors =
-    paths::getExecutorPaths(rootDir, slaveId, frameworkId);
+  Try<list<string>> executors = findPaths(
+      store,
+      path::join(
+          paths::getFrameworkPath(rootDir, slaveId, frameworkId),
+          paths::EXECUTORS_DIR));
 
   if (executors.isError()) {
     return Error(
@@ -373,7 +406,7 @@ Try<FrameworkState> FrameworkState::recover(
     executorId.set_value(Path(path).basename());
 
     Try<ExecutorState> executor = ExecutorState::recover(
-        rootDir, slaveId, frameworkId, executorId, strict, rebooted);
+        rootDir, slaveId, frameworkId, executorId, strict, rebooted, store);
 
     if (executor.isError()) {
       return Error("Failed to recover executor '" + executorId.value() +
@@ -394,24 +427,47 @@ Try<ExecutorState> ExecutorState::recover(
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
     bool strict,
-    bool rebooted)
+    bool rebooted,
+    const CheckpointStore* store)
 {
   ExecutorState state;
   state.id = executorId;
   string message;
 
   // Find the runs.
-  Try<list<string>> runs = paths::getExecutorRunPaths(
-      rootDir,
-      slaveId,
-      frameworkId,
-      executorId);
+  Try<list<string>> runs = findPaths(
+      store,
+      path::join(
+          paths::getExecutorPath(rootDir, slaveId, frameworkId, executorId),
+          paths::EXECUTOR_RUNS_DIR));
 
   if (runs.isError()) {
     return Error("Failed to find runs for executor '" + executorId.value() +
                  "': " + runs.error());
   }
 
+#ifndef __WINDOWS__
+  // The checkpoint store does not know the latest run before the
+  // executor registers or a task is checkpointed, so we always include
+  // it along with its symlink.
+  const string latest = paths::getExecutorLatestRunPath(
+      rootDir, slaveId, frameworkId, executorId);
+
+  if (store != nullptr && os::exists(latest)) {
+    const Result<string> run = os::realpath(latest);
+    if (run.isSome()) {
+      const string runPath =
+        path::join(Path(latest).dirname(), Path(run.get()).basename());
+
+      if (std::find(runs->begin(), runs->end(), runPath) == runs->end()) {
+        runs->push_back(runPath);
+      }
+    }
+
+    runs->push_back(latest);
+  }
+#endif // __WINDOWS__
+
   // Recover the runs.
   foreach (const string& path, runs.get()) {
     if (Path(path).basename() == paths::LATEST_SYMLINK) {
@@ -440,7 +496,8 @@ Try<ExecutorState> ExecutorState::recover(
           executorId,
           containerId,
           strict,
-          rebooted);
+          rebooted,
+          store);
 
       if (run.isError()) {
         return Error(
@@ -466,14 +523,14 @@ Try<ExecutorState> ExecutorState::recover(
   // Read the executor info.
   const string path =
     paths::getExecutorInfoPath(rootDir, slaveId, frameworkId, executorId);
-  if (!os::exists(path)) {
+  if (!state::exists(store, path)) {
     // This could happen if the slave died after creating the executor
     // directory but before it checkpointed the executor info.
     LOG(WARNING) << "Failed to find executor info file '" << path << "'";
     return state;
   }
 
-  Result<ExecutorInfo> executorInfo = state::read<ExecutorInfo>(path);
+  Result<ExecutorInfo> executorInfo = state::read<ExecutorInfo>(store, path);
 
   if (executorInfo.isError()) {
     message = "Failed to read executor info from '" + path + "': " +
@@ -508,7 +565,8 @@ Try<RunState> RunState::recover(
     const ExecutorID& executorId,
     const ContainerID& containerId,
     bool strict,
-    bool rebooted)
+    bool rebooted,
+    const CheckpointStore* store)
 {
   RunState state;
   state.id = containerId;
@@ -524,12 +582,12 @@ Try<RunState> RunState::recover(
   state.completed = os::exists(path);
 
   // Find the tasks.
-  Try<list<string>> tasks = paths::getTaskPaths(
-      rootDir,
-      slaveId,
-      frameworkId,
-      executorId,
-      containerId);
+  Try<list<string>> tasks = findPaths(
+      store,
+      path::join(
+          paths::getExecutorRunPath(
+              rootDir, slaveId, frameworkId, executorId, containerId),
+          paths::TASKS_DIR));
 
   if (tasks.isError()) {
     return Error(
@@ -543,7 +601,14 @@ Try<RunState> RunState::recover(
     taskId.set_value(Path(path).basename());
 
     Try<TaskState> task = TaskState::recover(
-        rootDir, slaveId, frameworkId, executorId, containerId, taskId, strict);
+        rootDir,
+        slaveId,
+        frameworkId,
+        executorId,
+        containerId,
+        taskId,
+        strict,
+        store);
 
     if (task.isError()) {
       return Error(
@@ -618,8 +683,8 @@ Try<RunState> RunState::recover(
   path = paths::getLibprocessPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  if (os::exists(path)) {
-    pid = state::read<string>(path);
+  if (state::exists(store, path)) {
+    pid = state::read<string>(store, path);
 
     if (pid.isError()) {
       message = "Failed to read executor libprocess pid from '" + path +
@@ -674,7 +739,8 @@ Try<TaskState> TaskState::recover(
     const ExecutorID& executorId,
     const ContainerID& containerId,
     const TaskID& taskId,
-    bool strict)
+    bool strict,
+    const CheckpointStore* store)
 {
   TaskState state;
   state.id = taskId;
@@ -683,14 +749,14 @@ Try<TaskState> TaskState::recover(
   // Read the task info.
   string path = paths::getTaskInfoPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+  if (!state::exists(store, path)) {
     // This could happen if the slave died after creating the task
     // directory but before it checkpointed the task info.
     LOG(WARNING) << "Failed to find task info file '" << path << "'";
     return state;
   }
 
-  Result<Task> task = state::read<Task>(path);
+  Result<Task> task = state::read<Task>(store, path);
 
   if (task.isError()) {
     message = "Failed to read task info from '" + path + "': " + task.error();
@@ -21,6 +21,9 @@
 #include <unistd.h>
 #endif // __WINDOWS__
 
+#include <string.h>
+
+#include <string>
 #include <vector>
 
 #include <mesos/resources.hpp>
@@ -28,14 +31,17 @@
 
 #include <process/pid.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 #include <stout/utils.hpp>
 #include <stout/uuid.hpp>
 
+#include <stout/os/exists.hpp>
 #include <stout/os/mkdir.hpp>
 #include <stout/os/mktemp.hpp>
 #include <stout/os/rename.hpp>
@@ -46,12 +52,17 @@
 
 #include "messages/messages.hpp"
 
+#ifndef __WINDOWS__
+#include "slave/checkpoint_store.hpp"
+#endif // __WINDOWS__
+
 namespace mesos {
 namespace internal {
 namespace slave {
 namespace state {
 
 // Forward declarations.
+class CheckpointStore;
 struct State;
 struct SlaveState;
 struct ResourcesState;
@@ -71,7 +82,104 @@ struct TaskState;
 // while increasing the 'errors' count. Note that 'errors' on a struct
 // includes the 'errors' encountered recursively. In other words,
 // 'State.errors' is the sum total of all recovery errors.
-Try<State> recover(const std::string& rootDir, bool strict);
+//
+// If a checkpoint store is given, the checkpoints it manages are read
+// from it, and so are the frameworks, executors, runs and tasks found.
+Try<State> recover(
+    const std::string& rootDir,
+    bool strict,
+    const CheckpointStore* store = nullptr);
+
+
+namespace internal {
+
+// Parses a protobuf message from `data`, starting at `offset`, in the
+// format written by `::protobuf::write`, i.e., the size of the message
+// followed by its contents. Returns None at the end of `data`.
+template <typename T>
+struct Parse
+{
+  Result<T> operator()(const std::string& data, size_t* offset)
+  {
+    if (*offset == data.size()) {
+      return None();
+    }
+
+    uint32_t size;
+    if (data.size() - *offset < sizeof(size)) {
+      return Error("Failed to read size: hit end of data unexpectedly");
+    }
+
+    memcpy(&size, data.data() + *offset, sizeof(size));
+    *offset += sizeof(size);
+
+    if (data.size() - *offset < size) {
+      return Error("Failed to read message of size " + stringify(size) +
+                   " bytes: hit end of data unexpectedly");
+    }
+
+    T message;
+    if (!message.ParseFromArray(data.data() + *offset, size)) {
+      return Error("Failed to deserialize message");
+    }
+
+    *offset += size;
+
+    return message;
+  }
+};
+
+
+// Partial specialization to parse a sequence of protobuf messages.
+template <typename T>
+struct Parse<google::protobuf::RepeatedPtrField<T>>
+{
+  Result<google::protobuf::RepeatedPtrField<T>> operator()(
+      const std::string& data, size_t* offset)
+  {
+    google::protobuf::RepeatedPtrField<T> result;
+    for (;;) {
+      Result<T> message = Parse<T>()(data, offset);
+      if (message.isError()) {
+        return Error(message.error());
+      } else if (message.isNone()) {
+        break;
+      } else {
+        result.Add()->CopyFrom(message.get());
+      }
+    }
+    return result;
+  }
+};
+}  // namespace internal {
+
+
+// Returns whether there is a checkpoint at the given path, which is
+// an entry of the checkpoint store if there is one that manages the
+// path, or a file otherwise.
+inline bool exists(const CheckpointStore* store, const std::string& path)
+{
+#ifndef __WINDOWS__
+  if (store != nullptr && store->manages(path)) {
+    return store->get(path).isSome();
+  }
+#endif // __WINDOWS__
+
+  return os::exists(path);
+}
+
+
+// Removes the checkpoint at the given path.
+inline Try<Nothing> remove(CheckpointStore* store, const std::string& path)
+{
+#ifndef __WINDOWS__
+  if (store != nullptr && store->manages(path)) {
+    return store->remove(path);
+  }
+#endif // __WINDOWS__
+
+  return os::rm(path);
+}
 
 
 // Reads the protobuf message(s) from the given path.
@@ -118,6 +226,46 @@ inline Result<Resources> read<Resources>(const std::string& path)
 }
 
 
+// Reads the checkpoint at the given path from the checkpoint store if
+// there is one that keeps it, or from the file otherwise.
+template <typename T>
+Result<T> read(const CheckpointStore* store, const std::string& path)
+{
+#ifndef __WINDOWS__
+  Option<std::string> data = store != nullptr ? store->get(path) : None();
+
+  if (data.isSome()) {
+    size_t offset = 0;
+    Result<T> result = internal::Parse<T>()(data.get(), &offset);
+    if (result.isSome()) {
+      upgradeResources(&result.get());
+    }
+
+    return result;
+  }
+#endif // __WINDOWS__
+
+  return read<T>(path);
+}
+
+
+template <>
+inline Result<std::string> read<std::string>(
+    const CheckpointStore* store,
+    const std::string& path)
+{
+#ifndef __WINDOWS__
+  Option<std::string> data = store != nullptr ? store->get(path) : None();
+
+  if (data.isSome()) {
+    return data.get();
+  }
+#endif // __WINDOWS__
+
+  return read<std::string>(path);
+}
+
+
 namespace internal {
 
 inline Try<Nothing> checkpoint(
@@ -189,6 +337,73 @@ inline Try<Nothing> checkpoint(
   return checkpoint(path, messages, sync, downgrade);
 }
 
+
+// Serializes the instance of T into the bytes `checkpoint` above writes
+// to a file, which is what the checkpoint store keeps.
+inline Try<std::string> serialize(const std::string& message, bool downgrade)
+{
+  return message;
+}
+
+
+template <
+    typename T,
+    typename std::enable_if<
+        std::is_convertible<T*, google::protobuf::Message*>::value,
+        int>::type = 0>
+inline Try<std::string> serialize(T message, bool downgrade)
+{
+  if (downgrade) {
+    // See the comment in `checkpoint` above.
+    downgradeResources(&message);
+  }
+
+  if (!message.IsInitialized()) {
+    return Error(message.InitializationErrorString() +
+                 " is required but not initialized");
+  }
+
+  // Like `::protobuf::write`, we prefix the message with its size.
+  uint32_t size = message.ByteSize();
+  std::string data((char*) &size, sizeof(size));
+
+  if (!message.AppendToString(&data)) {
+    return Error("Failed to serialize message");
+  }
+
+  return data;
+}
+
+
+inline Try<std::string> serialize(
+    google::protobuf::RepeatedPtrField<Resource> resources,
+    bool downgrade)
+{
+  if (downgrade) {
+    // See the comment in `checkpoint` above.
+    downgradeResources(&resources);
+  }
+
+  std::string data;
+  foreach (const Resource& resource, resources) {
+    Try<std::string> serialized = serialize(resource, false);
+    if (serialized.isError()) {
+      return Error(serialized.error());
+    }
+
+    data += serialized.get();
+  }
+
+  return data;
+}
+
+
+inline Try<std::string> serialize(const Resources& resources, bool downgrade)
+{
+  const google::protobuf::RepeatedPtrField<Resource>& messages = resources;
+  return serialize(messages, downgrade);
+}
+
 }  // namespace internal {
 
 
@@ -260,6 +475,111 @@ Try<Nothing> checkpoint(
 }
 
 
+// Checkpoints an instance of T at the given path into the checkpoint
+// store if there is one that manages the path, which is atomic as well,
+// or into a file otherwise.
+//
+// NOTE: The directory of the path is created in either case, since the
+// garbage collection of the agent is driven by the directories.
+template <typename T>
+Try<Nothing> checkpoint(
+    CheckpointStore* store,
+    const std::string& path,
+    const T& t,
+    bool sync = false,
+    bool downgrade = true)
+{
+#ifndef __WINDOWS__
+  if (store != nullptr && store->manages(path)) {
+    std::string base = Path(path).dirname();
+
+    Try<Nothing> mkdir = os::mkdir(base, true, sync);
+    if (mkdir.isError()) {
+      return Error(
+          "Failed to create directory '" + base + "': " + mkdir.error());
+    }
+
+    Try<std::string> data = internal::serialize(t, downgrade);
+    if (data.isError()) {
+      return Error("Failed to serialize checkpoint '" + path + "': " +
+                   data.error());
+    }
+
+    Try<Nothing> put = store->put(path, data.get(), sync);
+    if (put.isError()) {
+      return Error("Failed to write checkpoint '" + path + "' to the "
+                   "checkpoint store: " + put.error());
+    }
+
+    return Nothing();
+  }
+#endif // __WINDOWS__
+
+  return checkpoint(path, t, sync, downgrade);
+}
+
+
+// Collects several checkpoints to write them together, i.e., in a
+// single batch into the checkpoint store for the paths it manages. The
+// other checkpoints are written into files as they are added.
+class Checkpoints
+{
+public:
+  explicit Checkpoints(CheckpointStore* _store, bool _sync = false)
+    : store(_store), sync(_sync) {}
+
+  template <typename T>
+  Try<Nothing> add(const std::string& path, const T& t, bool downgrade = true)
+  {
+#ifndef __WINDOWS__
+    if (store != nullptr && store->manages(path)) {
+      std::string base = Path(path).dirname();
+
+      Try<Nothing> mkdir = os::mkdir(base, true, sync);
+      if (mkdir.isError()) {
+        return Error(
+            "Failed to create directory '" + base + "': " + mkdir.error());
+      }
+
+      Try<std::string> data = internal::serialize(t, downgrade);
+      if (data.isError()) {
+        return Error("Failed to serialize checkpoint '" + path + "': " +
+                     data.error());
+      }
+
+      batch[path] = data.get();
+      return Nothing();
+    }
+#endif // __WINDOWS__
+
+    return checkpoint(path, t, sync, downgrade);
+  }
+
+  // Writes the checkpoints added to the checkpoint store.
+  Try<Nothing> commit()
+  {
+#ifndef __WINDOWS__
+    if (!batch.empty()) {
+      Try<Nothing> put = store->put(batch, sync);
+      if (put.isError()) {
+        return Error("Failed to write " + stringify(batch.size()) +
+                     " checkpoints to the checkpoint store: " + put.error());
+      }
+
+      batch.clear();
+    }
+#endif // __WINDOWS__
+
+    return Nothing();
+  }
+
+private:
+  CheckpointStore* store;
+  const bool sync;
+  hashmap<std::string, std::string> batch;
+};
+
+
 // NOTE: The *State structs (e.g., TaskState, RunState, etc) are
 // defined in reverse dependency order because many of them have
 // Option<*State> dependencies which means we need them declared in
@@ -277,7 +597,8 @@ struct TaskState
       const ExecutorID& executorId,
       const ContainerID& containerId,
       const TaskID& taskId,
-      bool strict);
+      bool strict,
+      const CheckpointStore* store);
 
   TaskID id;
   Option<Task> info;
@@ -298,7 +619,8 @@ struct RunState
       const ExecutorID& executorId,
       const ContainerID& containerId,
       bool strict,
-      bool rebooted);
+      bool rebooted,
+      const CheckpointStore* store);
 
   Option<ContainerID> id;
   hashmap<TaskID, TaskState> tasks;
@@ -326,7 +648,8 @@ struct ExecutorState
       const FrameworkID& frameworkId,
       const ExecutorID& executorId,
       bool strict,
-      bool rebooted);
+      bool rebooted,
+      const CheckpointStore* store);
 
   ExecutorID id;
   Option<ExecutorInfo> info;
@@ -345,7 +668,8 @@ struct FrameworkState
       const SlaveID& slaveId,
       const FrameworkID& frameworkId,
       bool strict,
-      bool rebooted);
+      bool rebooted,
+      const CheckpointStore* store);
 
   FrameworkID id;
   Option<FrameworkInfo> info;
@@ -381,7 +705,8 @@ struct SlaveState
       const std::string& rootDir,
       const SlaveID& slaveId,
       bool strict,
-      bool rebooted);
+      bool rebooted,
+      const CheckpointStore* store);
 
   SlaveID id;
   Option<SlaveInfo> info;
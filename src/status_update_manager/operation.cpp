@@ -33,14 +33,16 @@ using process::wait; // Necessary on some OS's to disambiguate.
 namespace mesos {
 namespace internal {
 
-OperationStatusUpdateManager::OperationStatusUpdateManager()
+OperationStatusUpdateManager::OperationStatusUpdateManager(
+    const Duration& commitInterval)
   : process(
         new StatusUpdateManagerProcess<
             id::UUID,
             UpdateOperationStatusRecord,
             UpdateOperationStatusMessage>(
                 "operation-status-update-manager",
-                "operation status update"))
+                "operation status update",
+                commitInterval))
 {
   spawn(process.get());
 }
@@ -25,6 +25,7 @@
 #include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/uuid.hpp>
@@ -47,7 +48,12 @@ public:
   // NOTE: Unless first paused, the status update manager will forward updates
   // as soon as possible; for example, during recovery or as soon as the first
   // status update is processed.
-  OperationStatusUpdateManager();
+  //
+  // The checkpointed updates and acknowledgements of all the streams written
+  // within `commitInterval` are synced to disk together, see
+  // `StatusUpdateManagerProcess`.
+  explicit OperationStatusUpdateManager(
+      const Duration& commitInterval = Duration::zero());
 
   ~OperationStatusUpdateManager();
 
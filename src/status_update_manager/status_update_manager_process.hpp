@@ -25,7 +25,9 @@
 #include <mesos/mesos.hpp>
 #include <mesos/type_utils.hpp>
 
+#include <process/defer.hpp>
 #include <process/delay.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/owned.hpp>
 #include <process/protobuf.hpp>
@@ -44,6 +46,7 @@
 #include <stout/utils.hpp>
 #include <stout/uuid.hpp>
 
+#include <stout/os/fsync.hpp>
 #include <stout/os/ftruncate.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -70,6 +73,15 @@ namespace internal {
 // possible; for example, during recovery or as soon as the first status update
 // is processed.
 //
+// Checkpointed updates and ACKs are synced to disk in groups: the records
+// written to any of the streams within `commitInterval` (or, if it is zero,
+// until the actor has processed the messages already in its queue) are
+// synced together. The futures returned by `update()` and `acknowledgement()`
+// are only completed once the corresponding record is durable, so that the
+// sender is not acknowledged before that. Likewise, checkpointed updates are
+// only forwarded once they are durable, so that an update seen (and possibly
+// acknowledged) by the receiver is never lost if the agent fails.
+//
 // This process does NOT garbage collect any checkpointed state. The users of it
 // are responsible for the garbage collection of the status updates files.
 //
@@ -112,9 +124,11 @@ public:
 
   StatusUpdateManagerProcess(
       const std::string& id,
-      const std::string& _statusUpdateType)
+      const std::string& _statusUpdateType,
+      const Duration& _commitInterval = Duration::zero())
     : process::ProcessBase(process::ID::generate(id)),
       statusUpdateType(_statusUpdateType),
+      commitInterval(_commitInterval),
       paused(false) {}
 
   StatusUpdateManagerProcess(const StatusUpdateManagerProcess& that) = delete;
@@ -213,27 +227,36 @@ public:
       return process::Failure(result.error());
     }
 
-    // This only happens if the status update is a duplicate.
+    // This only happens if the status update is a duplicate. The original
+    // update might not be durable yet, in which case we wait for it.
     if (!result.get()) {
+      if (uncommitted.contains(streamId)) {
+        return commitPromise->future();
+      }
+
       return Nothing();
     }
 
     // Forward the status update if this is at the front of the queue.
     // Subsequent status updates will be sent in `acknowledgement()`.
-    if (!paused && stream->pending.size() == 1) {
-      CHECK_NONE(stream->timeout);
-
-      const Result<UpdateType>& next = stream->next();
-      if (next.isError()) {
-        return process::Failure(next.error());
+    if (!stream->checkpointed()) {
+      Try<Nothing> forwarded = forwardNext(streamId);
+      if (forwarded.isError()) {
+        return process::Failure(forwarded.error());
       }
 
-      CHECK_SOME(next);
-      stream->timeout =
-        forward(stream, next.get(), slave::STATUS_UPDATE_RETRY_INTERVAL_MIN);
+      return Nothing();
     }
 
-    return Nothing();
+    return commit(streamId)
+      .then(process::defer(this->self(), [=]() -> process::Future<Nothing> {
+        Try<Nothing> forwarded = forwardNext(streamId);
+        if (forwarded.isError()) {
+          return process::Failure(forwarded.error());
+        }
+
+        return Nothing();
+      }));
   }
 
   // Process the acknowledgment of a status update.
@@ -275,6 +298,12 @@ public:
           "Duplicate " + statusUpdateType + " acknowledgement");
     }
 
+    // NOTE: This needs to happen before the stream is cleaned up below,
+    // as the commit keeps the stream (and its file) open until it is done.
+    process::Future<Nothing> committed = stream->checkpointed()
+      ? commit(streamId)
+      : Nothing();
+
     stream->timeout = None();
 
     // Get the next update in the queue.
@@ -290,13 +319,22 @@ public:
                      << " but updates are still pending";
       }
       cleanupStatusUpdateStream(streamId);
-    } else if (!paused && next.isSome()) {
-      // Forward the next queued status update.
-      stream->timeout =
-        forward(stream, next.get(), slave::STATUS_UPDATE_RETRY_INTERVAL_MIN);
+
+      return committed.then([]() { return false; });
     }
 
-    return !terminated;
+    // Forward the next queued status update. Since all the pending records
+    // are synced together, this also waits for the next update to be durable
+    // if it was received since the last sync.
+    return committed
+      .then(process::defer(this->self(), [=]() -> process::Future<bool> {
+        Try<Nothing> forwarded = forwardNext(streamId);
+        if (forwarded.isError()) {
+          return process::Failure(forwarded.error());
+        }
+
+        return true;
+      }));
   }
 
   // Recovers the status update manager's state using the supplied stream IDs.
@@ -399,12 +437,83 @@ public:
     }
   }
 
+protected:
+  void finalize() override
+  {
+    // Sync the pending records, so that they are durable even if the
+    // actor is terminated before the scheduled commit.
+    if (commitPromise.get() != nullptr) {
+      _commit();
+    }
+  }
+
 private:
   // Forward declarations.
   class StatusUpdateStream;
 
   // Helper methods.
 
+  // Adds the stream to the next group of streams to sync to disk, scheduling
+  // the sync if needed. Returns a future which is completed once the group
+  // is synced.
+  process::Future<Nothing> commit(const IDType& streamId)
+  {
+    CHECK(streams.contains(streamId));
+
+    if (commitPromise.get() == nullptr) {
+      commitPromise.reset(new process::Promise<Nothing>());
+
+      if (commitInterval == Duration::zero()) {
+        process::dispatch(this->self(), &StatusUpdateManagerProcess::_commit);
+      } else {
+        process::delay(
+            commitInterval,
+            this->self(),
+            &StatusUpdateManagerProcess::_commit);
+      }
+    }
+
+    // NOTE: This keeps the stream alive until the sync, even if it is
+    // cleaned up in the meantime.
+    uncommitted[streamId] = streams[streamId];
+
+    return commitPromise->future();
+  }
+
+  // Syncs the streams which were written to since the last sync.
+  void _commit()
+  {
+    if (commitPromise.get() == nullptr) {
+      // The records were already synced in `finalize()`.
+      return;
+    }
+
+    process::Owned<process::Promise<Nothing>> promise = commitPromise;
+    hashmap<IDType, process::Owned<StatusUpdateStream>> streams_ =
+      uncommitted;
+
+    commitPromise.reset();
+    uncommitted.clear();
+
+    VLOG(1) << "Syncing " << streams_.size() << " " << statusUpdateType
+            << " streams";
+
+    Option<std::string> error;
+
+    foreachvalue (process::Owned<StatusUpdateStream>& stream, streams_) {
+      Try<Nothing> sync = stream->sync();
+      if (sync.isError() && error.isNone()) {
+        error = sync.error();
+      }
+    }
+
+    if (error.isSome()) {
+      promise->fail(error.get());
+    } else {
+      promise->set(Nothing());
+    }
+  }
+
   // Creates a new status update stream, adding it to `streams`.
   Try<Nothing> createStatusUpdateStream(
       const IDType& streamId,
@@ -509,6 +618,33 @@ private:
     streams.erase(streamId);
   }
 
+  // Forwards the update at the front of the stream, unless the manager is
+  // paused, the stream was cleaned up or the update was already forwarded.
+  Try<Nothing> forwardNext(const IDType& streamId)
+  {
+    if (paused || !streams.contains(streamId)) {
+      return Nothing();
+    }
+
+    StatusUpdateStream* stream = streams[streamId].get();
+
+    if (stream->timeout.isSome()) {
+      return Nothing();
+    }
+
+    const Result<UpdateType>& next = stream->next();
+    if (next.isError()) {
+      return Error(next.error());
+    }
+
+    if (next.isSome()) {
+      stream->timeout =
+        forward(stream, next.get(), slave::STATUS_UPDATE_RETRY_INTERVAL_MIN);
+    }
+
+    return Nothing();
+  }
+
   // Forwards the status update and starts a timer based on the `duration` to
   // check for ACK.
   process::Timeout forward(
@@ -573,6 +709,9 @@ private:
   // update".
   const std::string statusUpdateType;
 
+  // The time to wait for more records before syncing the written ones.
+  const Duration commitInterval;
+
   lambda::function<void(UpdateType)> forwardCallback;
   lambda::function<const std::string(const IDType&)> getPath;
 
@@ -580,6 +719,12 @@ private:
   hashmap<FrameworkID, hashset<IDType>> frameworkStreams;
   bool paused;
 
+  // The streams with records which are written but not yet synced, and the
+  // promise to complete once they are. The promise is only set while there
+  // is a sync scheduled.
+  hashmap<IDType, process::Owned<StatusUpdateStream>> uncommitted;
+  process::Owned<process::Promise<Nothing>> commitPromise;
+
   // Handles the status updates and acknowledgements, checkpointing them if
   // necessary. It also holds the information about received, acknowledged and
   // pending status updates.
@@ -632,9 +777,12 @@ private:
         }
 
         // Open the updates file.
+        //
+        // NOTE: We don't use `O_SYNC` here, as the writes are synced to disk
+        // in groups, see `StatusUpdateManagerProcess::commit()`.
         Try<int_fd> result = os::open(
             path.get(),
-            O_CREAT | O_SYNC | O_WRONLY | O_CLOEXEC,
+            O_CREAT | O_WRONLY | O_CLOEXEC,
             S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
         if (result.isError()) {
@@ -672,7 +820,7 @@ private:
 #ifdef __WINDOWS__
           O_BINARY |
 #endif // __WINDOWS__
-          O_SYNC | O_RDWR | O_CLOEXEC);
+          O_RDWR | O_CLOEXEC);
 
       if (fd.isError()) {
         return Error("Failed to open '" + path + "': " + fd.error());
@@ -891,6 +1039,26 @@ private:
     // Returns `true` if the stream is checkpointed, `false` otherwise.
     bool checkpointed() { return path.isSome(); }
 
+    // Syncs the records written to the stream to disk.
+    Try<Nothing> sync()
+    {
+      CHECK_SOME(fd);
+
+      if (error.isSome()) {
+        return Error(error.get());
+      }
+
+      Try<Nothing> fsync = os::fsync(fd.get());
+      if (fsync.isError()) {
+        // We treat this like a failed write, as we cannot tell which of the
+        // records written since the last sync made it to disk.
+        error = "Failed to sync file '" + path.get() + "': " + fsync.error();
+        return Error(error.get());
+      }
+
+      return Nothing();
+    }
+
     const IDType streamId;
 
     bool terminated;
@@ -0,0 +1,407 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// This header include must be enclosed in an `extern "C"` block to
+// workaround a bug in glibc <= 2.12 (see MESOS-7378).
+//
+// TODO(gilbert): Remove this when we no longer support glibc <= 2.12.
+extern "C" {
+#include <sys/sysmacros.h>
+}
+
+#include <array>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mesos/resources.hpp>
+
+#include <mesos/slave/containerizer.hpp>
+#include <mesos/slave/isolator.hpp>
+
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/owned.hpp>
+#include <process/reap.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/gtest.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/result.hpp>
+#include <stout/try.hpp>
+#include <stout/uuid.hpp>
+
+#include <stout/os/pipe.hpp>
+
+#include <stout/tests/utils.hpp>
+
+#include "linux/cgroups2.hpp"
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/launcher.hpp"
+#include "slave/containerizer/mesos/linux_launcher.hpp"
+
+#include "slave/containerizer/mesos/isolators/cgroups/cgroups2.hpp"
+
+#include "tests/mesos.hpp"
+
+using mesos::internal::slave::Cgroups2IsolatorProcess;
+using mesos::internal::slave::Launcher;
+using mesos::internal::slave::LinuxLauncher;
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerIO;
+using mesos::slave::Isolator;
+
+using process::Future;
+using process::Owned;
+
+using std::set;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+TEST(Cgroups2Test, PressureParse)
+{
+  Try<cgroups2::pressure::Pressure> pressure = cgroups2::pressure::parse(
+      "some avg10=1.50 avg60=0.75 avg300=0.10 total=2500000\n"
+      "full avg10=0.50 avg60=0.25 avg300=0.00 total=1000\n");
+
+  ASSERT_SOME(pressure);
+
+  EXPECT_DOUBLE_EQ(1.5, pressure->some.avg10);
+  EXPECT_DOUBLE_EQ(0.75, pressure->some.avg60);
+  EXPECT_DOUBLE_EQ(0.1, pressure->some.avg300);
+  EXPECT_EQ(Seconds(2) + Milliseconds(500), pressure->some.total);
+
+  ASSERT_SOME(pressure->full);
+  EXPECT_DOUBLE_EQ(0.5, pressure->full->avg10);
+  EXPECT_EQ(Milliseconds(1), pressure->full->total);
+
+  // Kernels older than 5.13 do not report the "full" line for cpu.
+  pressure = cgroups2::pressure::parse(
+      "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+
+  ASSERT_SOME(pressure);
+  EXPECT_NONE(pressure->full);
+
+  EXPECT_ERROR(cgroups2::pressure::parse(
+      "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"));
+
+  EXPECT_ERROR(cgroups2::pressure::parse(
+      "some avg10=0.00 avg60=0.00 total=0\n"));
+}
+
+
+TEST(Cgroups2Test, IoStatParse)
+{
+  Try<vector<cgroups2::io::Stats>> stats = cgroups2::io::parse(
+      "8:16 rbytes=1459200 wbytes=314773504 rios=192 wios=353 "
+      "dbytes=0 dios=0\n"
+      "253:0 rbytes=4096 wbytes=0 rios=1 wios=0 dbytes=512 dios=2 "
+      "cost.vrate=100.00\n");
+
+  ASSERT_SOME(stats);
+  ASSERT_EQ(2u, stats->size());
+
+  EXPECT_EQ(makedev(8, 16), stats->at(0).device);
+  EXPECT_EQ(1459200u, stats->at(0).rbytes);
+  EXPECT_EQ(314773504u, stats->at(0).wbytes);
+  EXPECT_EQ(192u, stats->at(0).rios);
+  EXPECT_EQ(353u, stats->at(0).wios);
+
+  // Unknown keys, e.g. of the io cost controller, are skipped.
+  EXPECT_EQ(makedev(253, 0), stats->at(1).device);
+  EXPECT_EQ(512u, stats->at(1).dbytes);
+  EXPECT_EQ(2u, stats->at(1).dios);
+
+  EXPECT_ERROR(cgroups2::io::parse("8 rbytes=0\n"));
+  EXPECT_ERROR(cgroups2::io::parse("8:16 rbytes=abc\n"));
+}
+
+
+// The tests below operate on the unified hierarchy of the host, under a
+// cgroup of their own which is destroyed along with the test.
+class Cgroups2HierarchyTest : public TemporaryDirectoryTest
+{
+protected:
+  void SetUp() override
+  {
+    TemporaryDirectoryTest::SetUp();
+
+    Result<string> _hierarchy = cgroups2::hierarchy();
+    ASSERT_SOME(_hierarchy);
+
+    hierarchy = _hierarchy.get();
+    root = TEST_CGROUPS_ROOT + "_" + id::UUID::random().toString();
+  }
+
+  void TearDown() override
+  {
+    if (cgroups2::exists(hierarchy, root)) {
+      AWAIT_READY(cgroups2::destroy(hierarchy, root));
+    }
+
+    TemporaryDirectoryTest::TearDown();
+  }
+
+  // Forks a shell running the given command, which is only started
+  // once the shell has been assigned to the given cgroup.
+  Try<pid_t> spawn(const string& cgroup, const string& command)
+  {
+    Try<std::array<int, 2>> pipes = os::pipe();
+    if (pipes.isError()) {
+      return Error(pipes.error());
+    }
+
+    pid_t pid = ::fork();
+    if (pid == -1) {
+      return ErrnoError("Failed to fork");
+    }
+
+    if (pid == 0) {
+      ::close(pipes->at(1));
+
+      char dummy;
+      while (::read(pipes->at(0), &dummy, sizeof(dummy)) == -1 &&
+             errno == EINTR);
+
+      ::close(pipes->at(0));
+
+      ::execl("/bin/sh", "sh", "-c", command.c_str(), (char*) nullptr);
+      ::_exit(EXIT_FAILURE);
+    }
+
+    ::close(pipes->at(0));
+
+    Try<Nothing> assign = cgroups2::assign(hierarchy, cgroup, pid);
+
+    // Release the child, which is killed below if it was not assigned.
+    ::close(pipes->at(1));
+
+    if (assign.isError()) {
+      ::kill(pid, SIGKILL);
+      ::waitpid(pid, nullptr, 0);
+      return Error(assign.error());
+    }
+
+    return pid;
+  }
+
+  string hierarchy;
+  string root;
+};
+
+
+// This test verifies that a process can be placed into a cgroup, and
+// that destroying the cgroup kills the process and removes the cgroup
+// along with its descendants.
+TEST_F(Cgroups2HierarchyTest, ROOT_CGROUPS2_CreateKillDestroy)
+{
+  const string cgroup = path::join(root, "child");
+
+  ASSERT_SOME(cgroups2::create(hierarchy, cgroup, true));
+  EXPECT_TRUE(cgroups2::exists(hierarchy, root));
+  EXPECT_TRUE(cgroups2::exists(hierarchy, cgroup));
+
+  Try<vector<string>> cgroups = cgroups2::get(hierarchy, root);
+  ASSERT_SOME(cgroups);
+  EXPECT_EQ(vector<string>({cgroup}), cgroups.get());
+
+  Try<pid_t> pid = spawn(cgroup, "sleep 1000");
+  ASSERT_SOME(pid);
+
+  Future<Option<int>> status = process::reap(pid.get());
+
+  Try<set<pid_t>> pids = cgroups2::processes(hierarchy, cgroup);
+  ASSERT_SOME(pids);
+  EXPECT_EQ(1u, pids->count(pid.get()));
+
+  EXPECT_SOME_EQ("/" + cgroup, cgroups2::cgroup(pid.get()));
+  EXPECT_SOME_TRUE(cgroups2::populated(hierarchy, root));
+
+  AWAIT_READY(cgroups2::destroy(hierarchy, root));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  EXPECT_FALSE(cgroups2::exists(hierarchy, cgroup));
+  EXPECT_FALSE(cgroups2::exists(hierarchy, root));
+}
+
+
+// This test verifies that a cgroup whose processes keep forking is
+// destroyed, i.e., that no forked process escapes the kill.
+TEST_F(Cgroups2HierarchyTest, ROOT_CGROUPS2_DestroyForkingProcesses)
+{
+  ASSERT_SOME(cgroups2::create(hierarchy, root));
+
+  Try<pid_t> pid = spawn(root, "while true; do sleep 1 & sleep 0.01; done");
+  ASSERT_SOME(pid);
+
+  Future<Option<int>> status = process::reap(pid.get());
+
+  // Let the shell fork a few children.
+  os::sleep(Milliseconds(100));
+
+  Try<set<pid_t>> pids = cgroups2::processes(hierarchy, root);
+  ASSERT_SOME(pids);
+  EXPECT_LT(1u, pids->size());
+
+  AWAIT_READY(cgroups2::destroy(hierarchy, root));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  EXPECT_FALSE(cgroups2::exists(hierarchy, root));
+}
+
+
+// This test verifies that the cgroups v2 isolator applies the limits
+// of a container to its cgroup, places the container in the leaf of
+// that cgroup and removes the cgroup on cleanup.
+TEST_F(Cgroups2HierarchyTest, ROOT_CGROUPS2_Isolator)
+{
+  slave::Flags flags;
+  flags.isolation = "cgroups/cpu,cgroups/mem";
+  flags.cgroups_hierarchy = hierarchy;
+  flags.cgroups_root = root;
+
+  Try<Isolator*> _isolator = Cgroups2IsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+
+  Owned<Isolator> isolator(_isolator.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  ContainerConfig containerConfig;
+  containerConfig.mutable_resources()->CopyFrom(
+      Resources::parse("cpus:0.5;mem:64").get());
+  containerConfig.set_directory(sandbox.get());
+
+  AWAIT_READY(isolator->prepare(containerId, containerConfig));
+
+  const string cgroup = path::join(root, containerId.value());
+  ASSERT_TRUE(cgroups2::exists(hierarchy, cgroup));
+
+  EXPECT_SOME_EQ(50u, cgroups2::cpu::weight(hierarchy, cgroup));
+
+  Try<Option<Bytes>> limit = cgroups2::memory::max(hierarchy, cgroup);
+  ASSERT_SOME(limit);
+  EXPECT_SOME_EQ(Megabytes(64), limit.get());
+
+  // Start the process in the cgroup of the container, as if it was
+  // forked by a launcher which does not use the unified hierarchy.
+  Try<pid_t> pid = spawn(cgroup, "sleep 1000");
+  ASSERT_SOME(pid);
+
+  Future<Option<int>> status = process::reap(pid.get());
+
+  AWAIT_READY(isolator->isolate(containerId, pid.get()));
+
+  EXPECT_SOME_EQ(
+      "/" + path::join(cgroup, cgroups2::LEAF),
+      cgroups2::cgroup(pid.get()));
+
+  Future<ResourceStatistics> usage = isolator->usage(containerId);
+  AWAIT_READY(usage);
+  EXPECT_EQ(Megabytes(64).bytes(), usage->mem_limit_bytes());
+
+  AWAIT_READY(isolator->update(
+      containerId,
+      Resources::parse("cpus:1;mem:128").get()));
+
+  EXPECT_SOME_EQ(100u, cgroups2::cpu::weight(hierarchy, cgroup));
+
+  limit = cgroups2::memory::max(hierarchy, cgroup);
+  ASSERT_SOME(limit);
+  EXPECT_SOME_EQ(Megabytes(128), limit.get());
+
+  // The isolator expects the launcher to have killed the container.
+  AWAIT_READY(cgroups2::destroy(
+      hierarchy,
+      path::join(cgroup, cgroups2::LEAF)));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  AWAIT_READY(isolator->cleanup(containerId));
+
+  EXPECT_FALSE(cgroups2::exists(hierarchy, cgroup));
+}
+
+
+// This test verifies that the Linux launcher uses the unified
+// hierarchy when it is mounted at `--cgroups_hierarchy`, placing the
+// container in the leaf of its cgroup and destroying that cgroup.
+TEST_F(Cgroups2HierarchyTest, ROOT_CGROUPS2_LinuxLauncher)
+{
+  slave::Flags flags;
+  flags.cgroups_hierarchy = hierarchy;
+  flags.cgroups_root = root;
+
+  Try<Launcher*> _launcher = LinuxLauncher::create(flags);
+  ASSERT_SOME(_launcher);
+
+  Owned<Launcher> launcher(_launcher.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Try<pid_t> pid = launcher->fork(
+      containerId,
+      "/bin/sh",
+      vector<string>{"sh", "-c", "sleep 1000"},
+      ContainerIO(),
+      nullptr,
+      None(),
+      None(),
+      None(),
+      vector<int_fd>());
+
+  ASSERT_SOME(pid);
+
+  Future<Option<int>> status = process::reap(pid.get());
+
+  const string cgroup = LinuxLauncher::cgroup(root, containerId);
+
+  EXPECT_SOME_EQ(
+      "/" + path::join(cgroup, cgroups2::LEAF),
+      cgroups2::cgroup(pid.get()));
+
+  AWAIT_READY(launcher->destroy(containerId));
+
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, status);
+
+  EXPECT_FALSE(cgroups2::exists(hierarchy, cgroup));
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
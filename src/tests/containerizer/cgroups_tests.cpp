@@ -1046,6 +1046,98 @@ TEST_F(CgroupsAnyHierarchyWithPerfEventTest, ROOT_CGROUPS_PERF_PerfTest)
 }
 
 
+// This test verifies that the counters opened with perf_event_open(2)
+// count the processes of a cgroup, without running the `perf` binary,
+// and that each read returns the counts since the previous read.
+TEST_F(CgroupsAnyHierarchyWithPerfEventTest, ROOT_CGROUPS_CgroupCountersRead)
+{
+  string hierarchy = path::join(baseHierarchy, "perf_event");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  // NOTE: Only software events are counted here since the hardware
+  // counters may not be available, e.g., in virtual machines.
+  Try<Owned<perf::CgroupCounters>> counters = perf::CgroupCounters::open(
+      path::join(hierarchy, TEST_CGROUPS_ROOT),
+      {"task-clock", "context-switches"});
+
+  ASSERT_SOME(counters);
+
+  int pipes[2];
+  int dummy;
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    // In child process.
+    ::close(pipes[1]);
+
+    // Wait until parent has assigned us to the cgroup.
+    ssize_t len;
+    while ((len = ::read(pipes[0], &dummy, sizeof(dummy))) == -1 &&
+           errno == EINTR);
+    ASSERT_EQ((ssize_t) sizeof(dummy), len);
+    ::close(pipes[0]);
+
+    while (true) {
+      // Don't sleep so the counters can actually count something.
+    }
+
+    ABORT("Child should not reach here");
+  }
+
+  // In parent.
+  ::close(pipes[0]);
+
+  // Put child into the test cgroup.
+  ASSERT_SOME(cgroups::assign(hierarchy, TEST_CGROUPS_ROOT, pid));
+
+  ssize_t len;
+  while ((len = ::write(pipes[1], &dummy, sizeof(dummy))) == -1 &&
+         errno == EINTR);
+  ASSERT_EQ((ssize_t) sizeof(dummy), len);
+  ::close(pipes[1]);
+
+  os::sleep(Seconds(1));
+
+  Try<mesos::PerfStatistics> statistics = counters.get()->read();
+  ASSERT_SOME(statistics);
+
+  EXPECT_LT(0.0, statistics->duration());
+
+  // The child was busy for about a second, which is reported in
+  // milliseconds like `perf stat` does.
+  ASSERT_TRUE(statistics->has_task_clock());
+  EXPECT_LT(0.0, statistics->task_clock());
+  EXPECT_GT(2000.0, statistics->task_clock());
+
+  EXPECT_TRUE(statistics->has_context_switches());
+
+  // Kill the child process.
+  ASSERT_NE(-1, ::kill(pid, SIGKILL));
+
+  // Wait for the child process.
+  AWAIT_EXPECT_WTERMSIG_EQ(SIGKILL, reap(pid));
+
+  // Drain the counts of the child, after which the empty cgroup is
+  // expected to count nothing rather than to be left out.
+  ASSERT_SOME(counters.get()->read());
+
+  statistics = counters.get()->read();
+  ASSERT_SOME(statistics);
+
+  ASSERT_TRUE(statistics->has_task_clock());
+  EXPECT_EQ(0.0, statistics->task_clock());
+
+  counters->reset();
+
+  // Destroy the cgroup.
+  Future<Nothing> destroy = cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT);
+  AWAIT_READY(destroy);
+}
+
+
 class CgroupsAnyHierarchyMemoryPressureTest
   : public CgroupsAnyHierarchyTest
 {
@@ -23,7 +23,7 @@ namespace tests {
 
 ACTION_P(InvokeRecover, launcher)
 {
-  return launcher->real->recover(arg0);
+  return launcher->real->recover(arg0, arg1);
 }
 
 
@@ -46,9 +46,9 @@ TestLauncher::TestLauncher(const process::Owned<slave::Launcher>& _real)
   using testing::_;
   using testing::DoDefault;
 
-  ON_CALL(*this, recover(_))
+  ON_CALL(*this, recover(_, _))
     .WillByDefault(InvokeRecover(this));
-  EXPECT_CALL(*this, recover(_))
+  EXPECT_CALL(*this, recover(_, _))
     .WillRepeatedly(DoDefault());
 
   ON_CALL(*this, fork(_, _, _, _, _, _, _, _, _))
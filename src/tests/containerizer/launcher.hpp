@@ -18,6 +18,7 @@
 #define __TEST_LAUNCHER_HPP__
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -50,10 +51,11 @@ public:
 
   ~TestLauncher() override;
 
-  MOCK_METHOD1(
+  MOCK_METHOD2(
       recover,
       process::Future<hashset<ContainerID>>(
-          const std::vector<mesos::slave::ContainerState>& states));
+          const std::vector<mesos::slave::ContainerState>& states,
+          const std::shared_ptr<slave::RecoverySnapshot>& snapshot));
 
   MOCK_METHOD9(
       fork,
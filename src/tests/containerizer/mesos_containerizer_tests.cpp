@@ -45,6 +45,10 @@
 
 #include "slave/containerizer/mesos/provisioner/provisioner.hpp"
 
+#ifdef __linux__
+#include "slave/containerizer/mesos/recovery_snapshot.hpp"
+#endif // __linux__
+
 #include "tests/environment.hpp"
 #include "tests/flags.hpp"
 #include "tests/mesos.hpp"
@@ -300,6 +304,275 @@ TEST_F(MesosContainerizerTest, StatusWithContainerID)
 }
 
 
+// This test verifies that when `--container_usage_interval` is set,
+// the resource usage of containers is sampled periodically from the
+// isolators and usage requests are served from the last sample.
+TEST_F(MesosContainerizerTest, UsageCollection)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+  flags.container_usage_interval = Seconds(1);
+
+  Try<Launcher*> launcher_ = SubprocessLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  MockIsolator* isolator = new MockIsolator();
+
+  ResourceStatistics statistics;
+  statistics.set_cpus_user_time_secs(1.0);
+
+  Fetcher fetcher(flags);
+
+  Clock::pause();
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      nullptr,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator)});
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Future<Containerizer::LaunchResult> launch = containerizer->launch(
+      containerId,
+      createContainerConfig(
+          None(),
+          createExecutorInfo("executor", "sleep 1000", "cpus:1"),
+          sandbox.get()),
+      map<string, string>(),
+      None());
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  Future<Nothing> sampled;
+  EXPECT_CALL(*isolator, usage(containerId))
+    .WillOnce(DoAll(FutureSatisfy(&sampled),
+                    Return(statistics)));
+
+  Clock::advance(flags.container_usage_interval.get());
+
+  AWAIT_READY(sampled);
+  Clock::settle();
+
+  // Both requests are served from the sample taken above.
+  for (int i = 0; i < 2; i++) {
+    Future<ResourceStatistics> usage = containerizer->usage(containerId);
+    AWAIT_READY(usage);
+    EXPECT_EQ(statistics.cpus_user_time_secs(), usage->cpus_user_time_secs());
+    EXPECT_EQ(1.0, usage->cpus_limit());
+  }
+
+  Clock::resume();
+
+  Future<Option<ContainerTermination>> termination =
+    containerizer->destroy(containerId);
+
+  AWAIT_READY(termination);
+  ASSERT_SOME(termination.get());
+}
+
+
+// This test verifies that a sample taken by the periodic usage
+// collection before the container is updated is not served after the
+// update, since it holds the limits of the previous resources.
+TEST_F(MesosContainerizerTest, UsageCollectionDropsStaleSample)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+  flags.container_usage_interval = Seconds(1);
+
+  Try<Launcher*> launcher_ = SubprocessLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  MockIsolator* isolator = new MockIsolator();
+
+  Fetcher fetcher(flags);
+
+  Clock::pause();
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      nullptr,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator)});
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Future<Containerizer::LaunchResult> launch = containerizer->launch(
+      containerId,
+      createContainerConfig(
+          None(),
+          createExecutorInfo("executor", "sleep 1000", "cpus:1"),
+          sandbox.get()),
+      map<string, string>(),
+      None());
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  // Hold the sample of the periodic collection until the container
+  // has been updated.
+  Promise<ResourceStatistics> stale;
+  Future<Nothing> sampled;
+
+  ResourceStatistics statistics;
+  statistics.set_cpus_user_time_secs(1.0);
+
+  EXPECT_CALL(*isolator, usage(containerId))
+    .WillOnce(DoAll(FutureSatisfy(&sampled),
+                    Return(stale.future())))
+    .WillOnce(Return(statistics));
+
+  EXPECT_CALL(*isolator, update(containerId, _))
+    .WillOnce(Return(Nothing()));
+
+  Clock::advance(flags.container_usage_interval.get());
+
+  AWAIT_READY(sampled);
+
+  AWAIT_READY(containerizer->update(
+      containerId,
+      Resources::parse("cpus:2").get()));
+
+  stale.set(statistics);
+  Clock::settle();
+
+  // The stale sample is dropped, so the usage is sampled again with
+  // the updated limits.
+  Future<ResourceStatistics> usage = containerizer->usage(containerId);
+  AWAIT_READY(usage);
+  EXPECT_EQ(2.0, usage->cpus_limit());
+
+  Clock::resume();
+
+  Future<Option<ContainerTermination>> termination =
+    containerizer->destroy(containerId);
+
+  AWAIT_READY(termination);
+  ASSERT_SOME(termination.get());
+}
+
+
+// This test verifies that the periodic usage collection goes on when
+// sampling the usage from an isolator hangs or fails.
+TEST_F(MesosContainerizerTest, UsageCollectionHungIsolator)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.launcher = "posix";
+  flags.container_usage_interval = Seconds(1);
+
+  Try<Launcher*> launcher_ = SubprocessLauncher::create(flags);
+  ASSERT_SOME(launcher_);
+
+  Owned<Launcher> launcher(launcher_.get());
+
+  Try<Owned<Provisioner>> provisioner = Provisioner::create(flags);
+  ASSERT_SOME(provisioner);
+
+  MockIsolator* isolator = new MockIsolator();
+
+  Fetcher fetcher(flags);
+
+  Clock::pause();
+
+  Try<MesosContainerizer*> create = MesosContainerizer::create(
+      flags,
+      true,
+      &fetcher,
+      nullptr,
+      launcher,
+      provisioner->share(),
+      {Owned<Isolator>(isolator)});
+
+  ASSERT_SOME(create);
+
+  Owned<MesosContainerizer> containerizer(create.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  Future<Containerizer::LaunchResult> launch = containerizer->launch(
+      containerId,
+      createContainerConfig(
+          None(),
+          createExecutorInfo("executor", "sleep 1000", "cpus:1"),
+          sandbox.get()),
+      map<string, string>(),
+      None());
+
+  AWAIT_ASSERT_EQ(Containerizer::LaunchResult::SUCCESS, launch);
+
+  ResourceStatistics statistics;
+  statistics.set_cpus_user_time_secs(1.0);
+
+  Future<Nothing> hung;
+  Future<Nothing> failed;
+  Future<Nothing> sampled;
+
+  EXPECT_CALL(*isolator, usage(containerId))
+    .WillOnce(DoAll(FutureSatisfy(&hung),
+                    Return(Future<ResourceStatistics>())))
+    .WillOnce(DoAll(FutureSatisfy(&failed),
+                    Return(Failure("Injected failure"))))
+    .WillOnce(DoAll(FutureSatisfy(&sampled),
+                    Return(statistics)));
+
+  Clock::advance(flags.container_usage_interval.get());
+  AWAIT_READY(hung);
+
+  // The hung sample times out after an interval, and the next
+  // collection starts one interval later.
+  Clock::advance(flags.container_usage_interval.get());
+  Clock::settle();
+  Clock::advance(flags.container_usage_interval.get());
+  AWAIT_READY(failed);
+
+  Clock::settle();
+  Clock::advance(flags.container_usage_interval.get());
+  AWAIT_READY(sampled);
+
+  Clock::settle();
+
+  // The request is served from the sample taken above.
+  Future<ResourceStatistics> usage = containerizer->usage(containerId);
+  AWAIT_READY(usage);
+  EXPECT_EQ(statistics.cpus_user_time_secs(), usage->cpus_user_time_secs());
+
+  Clock::resume();
+
+  Future<Option<ContainerTermination>> termination =
+    containerizer->destroy(containerId);
+
+  AWAIT_READY(termination);
+  ASSERT_SOME(termination.get());
+}
+
+
 class MesosContainerizerIsolatorPreparationTest : public MesosTest
 {
 public:
@@ -1308,6 +1581,38 @@ TEST_F(MesosContainerizerRecoverTest, SkipRecoverNonMesosContainers)
 }
 
 
+#ifdef __linux__
+// This test checks that the cgroups listed in a recovery snapshot are
+// served from the snapshot, and that a new snapshot reads them again.
+TEST_F(MesosContainerizerRecoverTest, RecoverySnapshot)
+{
+  const string hierarchy = path::join(sandbox.get(), "hierarchy");
+
+  ASSERT_SOME(os::mkdir(path::join(hierarchy, "mesos", "c1", "mesos", "c2")));
+
+  slave::RecoverySnapshot snapshot;
+
+  Try<vector<string>> cgroups = snapshot.cgroups(hierarchy, "/mesos/");
+  ASSERT_SOME(cgroups);
+  EXPECT_EQ(3u, cgroups->size());
+
+  ASSERT_SOME(os::mkdir(path::join(hierarchy, "mesos", "c3")));
+
+  EXPECT_TRUE(snapshot.exists(hierarchy, "mesos/c1/mesos/c2"));
+  EXPECT_FALSE(snapshot.exists(hierarchy, "mesos/c3"));
+  EXPECT_SOME_EQ(cgroups.get(), snapshot.cgroups(hierarchy, "mesos"));
+
+  slave::RecoverySnapshot current;
+
+  EXPECT_TRUE(current.exists(hierarchy, "mesos/c3"));
+
+  cgroups = current.cgroups(hierarchy, "mesos");
+  ASSERT_SOME(cgroups);
+  EXPECT_EQ(4u, cgroups->size());
+}
+#endif // __linux__
+
+
 class MesosLauncherStatusTest : public MesosTest {};
 
 
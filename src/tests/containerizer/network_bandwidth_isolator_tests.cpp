@@ -0,0 +1,313 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <mesos/resources.hpp>
+
+#include <mesos/slave/isolator.hpp>
+
+#include <process/future.hpp>
+#include <process/gtest.hpp>
+#include <process/owned.hpp>
+
+#include <stout/duration.hpp>
+#include <stout/gtest.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include <stout/os/getcwd.hpp>
+
+#include "common/protobuf_utils.hpp"
+
+#include "linux/cgroups.hpp"
+
+#include "slave/flags.hpp"
+
+#include "slave/containerizer/mesos/containerizer.hpp"
+
+#include "slave/containerizer/mesos/isolators/network/bandwidth.hpp"
+
+#include "tests/mesos.hpp"
+
+using mesos::internal::slave::MesosContainerizer;
+using mesos::internal::slave::NetworkBandwidthIsolatorProcess;
+
+using mesos::slave::ContainerConfig;
+using mesos::slave::ContainerState;
+using mesos::slave::Isolator;
+
+using process::Future;
+using process::Owned;
+
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace tests {
+
+// The dummy interface shaped by the tests, so that they do not touch
+// the traffic control configuration of the host interfaces.
+const char* const INTERFACE = "mesos-bw0";
+
+
+class NetworkBandwidthIsolatorTest
+  : public ContainerizerTest<MesosContainerizer>
+{
+public:
+  static void SetUpTestCase()
+  {
+    ContainerizerTest<MesosContainerizer>::SetUpTestCase();
+
+    ASSERT_SOME(os::shell("which tc"))
+      << "-------------------------------------------------------------\n"
+      << "We cannot run any NetworkBandwidthIsolatorTests because 'tc'\n"
+      << "could not be found. You can either install 'iproute2', or\n"
+      << "disable this test case\n"
+      << "-------------------------------------------------------------";
+  }
+
+protected:
+  void SetUp() override
+  {
+    ContainerizerTest<MesosContainerizer>::SetUp();
+
+    // Remove the interface in case a previous run did not clean up.
+    os::shell(string("ip link del ") + INTERFACE + " 2>/dev/null");
+
+    ASSERT_SOME(
+        os::shell(string("ip link add ") + INTERFACE + " type dummy"));
+  }
+
+  void TearDown() override
+  {
+    os::shell(string("ip link del ") + INTERFACE);
+
+    ContainerizerTest<MesosContainerizer>::TearDown();
+  }
+
+  slave::Flags CreateSlaveFlags() override
+  {
+    slave::Flags flags =
+      ContainerizerTest<MesosContainerizer>::CreateSlaveFlags();
+
+    flags.isolation = "network/bandwidth";
+    flags.network_bandwidth_interface = INTERFACE;
+
+    return flags;
+  }
+
+  // Returns the output of `tc <arguments>` for the test interface.
+  static string tc(const string& object, const string& arguments = "")
+  {
+    Try<string> output =
+      os::shell("tc " + object + " show dev " + INTERFACE + " " + arguments);
+
+    EXPECT_SOME(output);
+
+    return output.isSome() ? output.get() : "";
+  }
+
+  static ContainerConfig createContainerConfig(const string& resources)
+  {
+    ContainerConfig containerConfig;
+    containerConfig.mutable_resources()->CopyFrom(
+        Resources::parse(resources).get());
+    containerConfig.set_directory(os::getcwd());
+
+    return containerConfig;
+  }
+};
+
+
+// This test verifies that the isolator installs the HTB class and the
+// ingress policer of a container at the allocated rate, updates them
+// along with the resources of the container, and restores the root
+// qdisc of the interface once the container is cleaned up.
+TEST_F(NetworkBandwidthIsolatorTest, ROOT_CGROUPS_NET_CLS_PrepareUpdateCleanup)
+{
+  slave::Flags flags = CreateSlaveFlags();
+
+  Try<Isolator*> _isolator = NetworkBandwidthIsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+
+  Owned<Isolator> isolator(_isolator.get());
+
+  // The qdiscs are only installed along with the first container.
+  EXPECT_FALSE(strings::contains(tc("qdisc"), "htb bd: root"));
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  AWAIT_READY(isolator->prepare(
+      containerId,
+      createContainerConfig("network_bandwidth:10;ports:[31000-31001]")));
+
+  string qdiscs = tc("qdisc");
+  EXPECT_TRUE(strings::contains(qdiscs, "htb bd: root")) << qdiscs;
+  EXPECT_TRUE(strings::contains(qdiscs, "ingress ffff:")) << qdiscs;
+
+  // The container is classified by the classid of its net_cls cgroup.
+  Try<uint32_t> classid = cgroups::net_cls::classid(
+      path::join(flags.cgroups_hierarchy, "net_cls"),
+      path::join(flags.cgroups_root, containerId.value()));
+
+  ASSERT_SOME(classid);
+  EXPECT_EQ(0xbd0001u, classid.get());
+
+  string classes = tc("class");
+  EXPECT_TRUE(strings::contains(classes, "class htb bd:1 ")) << classes;
+  EXPECT_TRUE(strings::contains(classes, "rate 10Mbit")) << classes;
+
+  Try<string> police = os::shell("tc actions get action police index 1");
+  ASSERT_SOME(police);
+  EXPECT_TRUE(strings::contains(police.get(), "rate 10Mbit")) << police.get();
+
+  // The ports [31000-31001] are matched by a single selector.
+  string filters = tc("filter", "parent ffff:");
+  EXPECT_TRUE(strings::contains(filters, "00007918/0000fffe")) << filters;
+
+  AWAIT_READY(isolator->update(
+      containerId,
+      Resources::parse("network_bandwidth:20;ports:[31002-31002]").get()));
+
+  classes = tc("class");
+  EXPECT_TRUE(strings::contains(classes, "class htb bd:1 ")) << classes;
+  EXPECT_TRUE(strings::contains(classes, "rate 20Mbit")) << classes;
+
+  police = os::shell("tc actions get action police index 1");
+  ASSERT_SOME(police);
+  EXPECT_TRUE(strings::contains(police.get(), "rate 20Mbit")) << police.get();
+
+  // The filters of the previous ports are replaced.
+  filters = tc("filter", "parent ffff:");
+  EXPECT_TRUE(strings::contains(filters, "0000791a/0000ffff")) << filters;
+  EXPECT_FALSE(strings::contains(filters, "00007918/0000fffe")) << filters;
+
+  Future<ResourceStatistics> usage = isolator->usage(containerId);
+  AWAIT_READY(usage);
+
+  ASSERT_EQ(2, usage->net_traffic_control_statistics_size());
+  EXPECT_EQ("bw_egress", usage->net_traffic_control_statistics(0).id());
+  EXPECT_EQ("bw_ingress", usage->net_traffic_control_statistics(1).id());
+
+  AWAIT_READY(isolator->cleanup(containerId));
+
+  EXPECT_FALSE(strings::contains(tc("class"), "bd:1 "));
+
+  // The root qdisc is restored asynchronously after the cleanup.
+  Duration waited = Duration::zero();
+  do {
+    qdiscs = tc("qdisc");
+    if (!strings::contains(qdiscs, "htb bd: root") &&
+        !strings::contains(qdiscs, "ingress ffff:")) {
+      break;
+    }
+
+    os::sleep(Milliseconds(100));
+    waited += Milliseconds(100);
+  } while (waited < Seconds(5));
+
+  EXPECT_FALSE(strings::contains(qdiscs, "htb bd: root")) << qdiscs;
+  EXPECT_FALSE(strings::contains(qdiscs, "ingress ffff:")) << qdiscs;
+}
+
+
+// This test verifies that a new isolator recovers the rate enforced
+// for a container by the isolator of a previous agent, so that the
+// usage of the container is reported without updating it.
+TEST_F(NetworkBandwidthIsolatorTest, ROOT_CGROUPS_NET_CLS_Recover)
+{
+  slave::Flags flags = CreateSlaveFlags();
+
+  Try<Isolator*> _isolator = NetworkBandwidthIsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+
+  Owned<Isolator> isolator(_isolator.get());
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  AWAIT_READY(isolator->prepare(
+      containerId,
+      createContainerConfig("network_bandwidth:10;ports:[31000-31001]")));
+
+  // Simulate an agent restart, which leaves the traffic control
+  // configuration and the net_cls cgroup of the container in place.
+  isolator.reset();
+
+  _isolator = NetworkBandwidthIsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+
+  isolator.reset(_isolator.get());
+
+  ContainerState state = protobuf::slave::createContainerState(
+      None(),
+      None(),
+      containerId,
+      ::getpid(),
+      os::getcwd());
+
+  AWAIT_READY(isolator->recover({state}, {}));
+
+  Future<ResourceStatistics> usage = isolator->usage(containerId);
+  AWAIT_READY(usage);
+
+  ASSERT_EQ(2, usage->net_traffic_control_statistics_size());
+  EXPECT_EQ("bw_egress", usage->net_traffic_control_statistics(0).id());
+
+  AWAIT_READY(isolator->update(
+      containerId,
+      Resources::parse("network_bandwidth:20;ports:[31000-31001]").get()));
+
+  string classes = tc("class");
+  EXPECT_TRUE(strings::contains(classes, "rate 20Mbit")) << classes;
+
+  // The recovered filters are replaced since the ports of the
+  // container are not known after recovery.
+  string filters = tc("filter", "parent ffff:");
+  EXPECT_TRUE(strings::contains(filters, "00007918/0000fffe")) << filters;
+
+  AWAIT_READY(isolator->cleanup(containerId));
+
+  EXPECT_FALSE(strings::contains(tc("class"), "bd:1 "));
+}
+
+
+// This test verifies that the isolator refuses to start rather than
+// replace a root qdisc installed by the operator.
+TEST_F(NetworkBandwidthIsolatorTest, ROOT_CGROUPS_NET_CLS_ForeignRootQdisc)
+{
+  ASSERT_SOME(os::shell(
+      string("tc qdisc add dev ") + INTERFACE + " root handle 1: pfifo"));
+
+  slave::Flags flags = CreateSlaveFlags();
+
+  Try<Isolator*> isolator = NetworkBandwidthIsolatorProcess::create(flags);
+  EXPECT_ERROR(isolator);
+
+  string qdiscs = tc("qdisc");
+  EXPECT_TRUE(strings::contains(qdiscs, "pfifo 1: root")) << qdiscs;
+}
+
+} // namespace tests {
+} // namespace internal {
+} // namespace mesos {
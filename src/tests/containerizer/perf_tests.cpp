@@ -68,6 +68,17 @@ TEST_F(PerfTest, ROOT_PERF_Sample)
 }
 
 
+TEST_F(PerfTest, CgroupCountersSupported)
+{
+  EXPECT_TRUE(perf::CgroupCounters::supported({}));
+  EXPECT_TRUE(perf::CgroupCounters::supported({"cycles", "task-clock"}));
+
+  // Hardware cache events can only be sampled with `perf stat`.
+  EXPECT_FALSE(perf::CgroupCounters::supported(
+      {"cycles", "task-clock", "L1-dcache-loads"}));
+}
+
+
 TEST_F(PerfTest, Parse)
 {
   // Parse multiple cgroups with uint64 and floats.
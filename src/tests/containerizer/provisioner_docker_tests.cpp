@@ -14,10 +14,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
 #include <gmock/gmock.h>
 
 #include <stout/duration.hpp>
+#include <stout/fs.hpp>
 #include <stout/gtest.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/json.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
@@ -26,13 +33,18 @@
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/owned.hpp>
+#include <process/shared.hpp>
 
 #include <mesos/docker/spec.hpp>
 
+#include <mesos/uri/fetcher.hpp>
+
 #ifdef __linux__
 #include "linux/fs.hpp"
 #endif // __linux__
 
+#include "slave/constants.hpp"
+
 #include "slave/containerizer/mesos/provisioner/constants.hpp"
 #include "slave/containerizer/mesos/provisioner/paths.hpp"
 
@@ -59,10 +71,12 @@ namespace spec = ::docker::spec;
 using std::string;
 using std::vector;
 
+using process::Clock;
 using process::Future;
 using process::Owned;
 using process::PID;
 using process::Promise;
+using process::Shared;
 
 using master::Master;
 
@@ -404,6 +418,492 @@ TEST_F(ProvisionerDockerLocalStoreTest, PullingSameImageSimutanuously)
 }
 
 
+#ifdef __linux__
+// A stand-in for a Docker registry, serving a schema 2 manifest and
+// the blobs it is given through the URI fetcher.
+class RegistryStandIn : public uri::Fetcher::Plugin
+{
+public:
+  RegistryStandIn(
+      const string& _manifest,
+      const hashmap<string, string>& _blobs)
+    : manifest(_manifest), blobs(_blobs) {}
+
+  std::set<string> schemes() const override
+  {
+    return {"docker-manifest", "docker-blob"};
+  }
+
+  string name() const override
+  {
+    return "registry-stand-in";
+  }
+
+  Future<Nothing> fetch(
+      const URI& uri,
+      const string& directory,
+      const Option<string>& data,
+      const Option<string>& outputFileName) const override
+  {
+    if (uri.scheme() == "docker-manifest") {
+      Try<Nothing> write =
+        os::write(path::join(directory, "manifest"), manifest);
+
+      if (write.isError()) {
+        return process::Failure(write.error());
+      }
+
+      return Nothing();
+    }
+
+    if (!blobs.contains(uri.query())) {
+      return process::Failure("Unknown blob '" + uri.query() + "'");
+    }
+
+    fetched->push_back(uri.query());
+
+    Try<Nothing> write =
+      os::write(path::join(directory, uri.query()), blobs.at(uri.query()));
+
+    if (write.isError()) {
+      return process::Failure(write.error());
+    }
+
+    return Nothing();
+  }
+
+  // The digests of the blobs fetched so far.
+  std::shared_ptr<vector<string>> fetched =
+    std::make_shared<vector<string>>();
+
+private:
+  const string manifest;
+  const hashmap<string, string> blobs;
+};
+
+
+// Returns a schema 2 manifest with the given config and layers.
+static string createManifest(const string& config, const vector<string>& layers)
+{
+  vector<string> entries;
+  foreach (const string& layer, layers) {
+    entries.push_back(
+        "{"
+        "  \"mediaType\": "
+        "    \"application/vnd.docker.image.rootfs.diff.tar.gzip\","
+        "  \"size\": 1024,"
+        "  \"digest\": \"" + layer + "\""
+        "}");
+  }
+
+  return
+    "{"
+    "  \"schemaVersion\": 2,"
+    "  \"mediaType\": "
+    "    \"application/vnd.docker.distribution.manifest.v2+json\","
+    "  \"config\": {"
+    "    \"mediaType\": \"application/vnd.docker.container.image.v1+json\","
+    "    \"size\": 2,"
+    "    \"digest\": \"" + config + "\""
+    "  },"
+    "  \"layers\": [" + strings::join(",", entries) + "]"
+    "}";
+}
+
+
+// Returns a digest made of the given hexadecimal digit.
+static string createDigest(char digit)
+{
+  return "sha256:" + string(64, digit);
+}
+
+
+class ProvisionerDockerRegistryPullerTest : public TemporaryDirectoryTest
+{
+protected:
+  // Pulls an image made of the given layer tarballs with the copy
+  // backend, through a registry stand-in.
+  Future<slave::docker::Image> pull(
+      const vector<string>& tarballs,
+      const string& directory)
+  {
+    const string config = createDigest('f');
+
+    hashmap<string, string> blobs = {{config, "{}"}};
+    vector<string> layers;
+
+    for (size_t i = 0; i < tarballs.size(); i++) {
+      Try<string> tarball = os::read(tarballs[i]);
+      if (tarball.isError()) {
+        return process::Failure(tarball.error());
+      }
+
+      const string layer = createDigest(static_cast<char>('0' + i));
+
+      blobs[layer] = tarball.get();
+      layers.push_back(layer);
+    }
+
+    Shared<uri::Fetcher> fetcher(new uri::Fetcher(
+        vector<Owned<uri::Fetcher::Plugin>>{Owned<uri::Fetcher::Plugin>(
+            new RegistryStandIn(createManifest(config, layers), blobs))}));
+
+    slave::Flags flags;
+    flags.docker_registry = "http://localhost:5000";
+    flags.docker_store_dir = path::join(os::getcwd(), "store");
+
+    Try<Owned<Puller>> _puller =
+      RegistryPuller::create(flags, fetcher, nullptr);
+
+    if (_puller.isError()) {
+      return process::Failure(_puller.error());
+    }
+
+    puller = _puller.get();
+
+    Try<spec::ImageReference> reference = spec::parseImageReference("abc");
+    if (reference.isError()) {
+      return process::Failure(reference.error());
+    }
+
+    return puller->pull(reference.get(), directory, COPY_BACKEND, None());
+  }
+
+  // The puller is kept until the end of the test for its metrics.
+  Owned<Puller> puller;
+};
+
+
+// This test verifies that with a lazy layer mounter, the registry
+// puller mounts the layers of a schema 2 image in the store instead of
+// fetching them, and that the store removes the layers which are no
+// longer mounted on recovery.
+TEST_F(ProvisionerDockerRegistryPullerTest, LazyLayerMounter)
+{
+  const string layer =
+    "sha256:"
+    "4b3a1a0a4d1d4e1f8c1c7f3f1b9f3c8e2d5a6b7c8d9e0f1a2b3c4d5e6f7a8b9c";
+
+  const string config =
+    "sha256:"
+    "9f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a0";
+
+  const string manifest = createManifest(config, {layer});
+
+  RegistryStandIn* registry =
+    new RegistryStandIn(manifest, {{config, "{}"}, {layer, "unused"}});
+
+  std::shared_ptr<vector<string>> fetched = registry->fetched;
+
+  Shared<uri::Fetcher> fetcher(new uri::Fetcher(
+      vector<Owned<uri::Fetcher::Plugin>>{
+        Owned<uri::Fetcher::Plugin>(registry)}));
+
+  // The mounter records its arguments and creates a file where it
+  // would mount the layer.
+  const string args = path::join(os::getcwd(), "args");
+  const string mounter = path::join(os::getcwd(), "mounter");
+
+  ASSERT_SOME(os::write(
+      mounter,
+      "#!/bin/sh\n"
+      "echo \"$@\" >> " + args + "\n"
+      "echo lazy > \"$2/file\"\n"));
+
+  ASSERT_SOME(os::chmod(mounter, S_IRWXU));
+
+  slave::Flags flags;
+  flags.docker_registry = "http://localhost:5000";
+  flags.docker_store_dir = path::join(os::getcwd(), "store");
+  flags.docker_lazy_layer_mounter = mounter;
+
+  Try<Owned<Puller>> puller = RegistryPuller::create(flags, fetcher, nullptr);
+  ASSERT_SOME(puller);
+
+  Try<spec::ImageReference> reference = spec::parseImageReference("abc");
+  ASSERT_SOME(reference);
+
+  const string staging = path::join(os::getcwd(), "staging");
+  ASSERT_SOME(os::mkdir(staging));
+
+  Future<slave::docker::Image> image =
+    puller.get()->pull(reference.get(), staging, OVERLAY_BACKEND, None());
+
+  AWAIT_READY(image);
+  ASSERT_EQ(1, image->layer_ids_size());
+  EXPECT_EQ(layer, image->layer_ids(0));
+
+  // Only the config is fetched.
+  EXPECT_EQ(vector<string>({config}), *fetched);
+
+  const string mountPoint =
+    paths::getImageLayerLazyRootfsPath(flags.docker_store_dir, layer);
+
+  const string rootfs = paths::getImageLayerRootfsPath(
+      flags.docker_store_dir, layer, OVERLAY_BACKEND);
+
+  const string prefetchList =
+    paths::getImageLayerPrefetchListPath(flags.docker_store_dir, layer);
+
+  EXPECT_TRUE(os::stat::islink(rootfs));
+  EXPECT_SOME_EQ("lazy\n", os::read(path::join(rootfs, "file")));
+
+  EXPECT_SOME_EQ(
+      "http://localhost:5000/v2/abc/blobs/" + layer + " " +
+        mountPoint + " " + prefetchList + "\n",
+      os::read(args));
+
+  // The layer is not mounted again once it is in the store.
+  image =
+    puller.get()->pull(reference.get(), staging, OVERLAY_BACKEND, None());
+
+  AWAIT_READY(image);
+  EXPECT_SOME_EQ(
+      "http://localhost:5000/v2/abc/blobs/" + layer + " " +
+        mountPoint + " " + prefetchList + "\n",
+      os::read(args));
+
+  // The layer was never actually mounted, so it is removed from the
+  // store on recovery, as it would be after a reboot. The prefetch
+  // list is kept for the next mount.
+  ASSERT_SOME(os::rm(path::join(mountPoint, "file")));
+  ASSERT_SOME(os::write(prefetchList, "/file\n"));
+
+  Try<Owned<slave::Store>> store =
+    Store::create(flags, Owned<Puller>(new MockPuller()));
+
+  ASSERT_SOME(store);
+  AWAIT_READY(store.get()->recover());
+
+  EXPECT_FALSE(os::stat::islink(rootfs));
+  EXPECT_FALSE(os::exists(mountPoint));
+  EXPECT_SOME_EQ("/file\n", os::read(prefetchList));
+}
+
+
+// This test verifies that a hung lazy layer mounter is killed after a
+// timeout, and that the layer is mounted again by the next pull.
+TEST_F(ProvisionerDockerRegistryPullerTest, LazyLayerMounterTimeout)
+{
+  const string layer =
+    "sha256:"
+    "4b3a1a0a4d1d4e1f8c1c7f3f1b9f3c8e2d5a6b7c8d9e0f1a2b3c4d5e6f7a8b9c";
+
+  const string config =
+    "sha256:"
+    "9f8e7d6c5b4a39281706f5e4d3c2b1a09f8e7d6c5b4a39281706f5e4d3c2b1a0";
+
+  const string manifest = createManifest(config, {layer});
+
+  Shared<uri::Fetcher> fetcher(new uri::Fetcher(
+      vector<Owned<uri::Fetcher::Plugin>>{
+        Owned<uri::Fetcher::Plugin>(new RegistryStandIn(
+            manifest, {{config, "{}"}, {layer, "unused"}}))}));
+
+  // The mounter hangs the first time it is run.
+  const string hung = path::join(os::getcwd(), "hung");
+  const string mounter = path::join(os::getcwd(), "mounter");
+
+  ASSERT_SOME(os::write(
+      mounter,
+      "#!/bin/sh\n"
+      "if [ ! -e " + hung + " ]; then\n"
+      "  touch " + hung + "\n"
+      "  exec sleep 1000\n"
+      "fi\n"
+      "echo lazy > \"$2/file\"\n"));
+
+  ASSERT_SOME(os::chmod(mounter, S_IRWXU));
+
+  slave::Flags flags;
+  flags.docker_registry = "http://localhost:5000";
+  flags.docker_store_dir = path::join(os::getcwd(), "store");
+  flags.docker_lazy_layer_mounter = mounter;
+
+  Try<Owned<Puller>> puller = RegistryPuller::create(flags, fetcher, nullptr);
+  ASSERT_SOME(puller);
+
+  Try<spec::ImageReference> reference = spec::parseImageReference("abc");
+  ASSERT_SOME(reference);
+
+  const string staging = path::join(os::getcwd(), "staging");
+  ASSERT_SOME(os::mkdir(staging));
+
+  Clock::pause();
+
+  Future<slave::docker::Image> image =
+    puller.get()->pull(reference.get(), staging, OVERLAY_BACKEND, None());
+
+  // Wait for the mounter to be started, which happens after its
+  // timeout is set.
+  Duration waited = Duration::zero();
+  while (!os::exists(hung) && waited < process::TEST_AWAIT_TIMEOUT) {
+    os::sleep(Milliseconds(10));
+    waited += Milliseconds(10);
+  }
+
+  ASSERT_TRUE(os::exists(hung));
+  EXPECT_TRUE(image.isPending());
+
+  Clock::advance(slave::DOCKER_LAZY_LAYER_MOUNT_TIMEOUT);
+  Clock::resume();
+
+  AWAIT_FAILED(image);
+
+  const string mountPoint =
+    paths::getImageLayerLazyRootfsPath(flags.docker_store_dir, layer);
+
+  const string rootfs = paths::getImageLayerRootfsPath(
+      flags.docker_store_dir, layer, OVERLAY_BACKEND);
+
+  EXPECT_FALSE(os::stat::islink(rootfs));
+  EXPECT_FALSE(os::exists(mountPoint));
+
+  // The layer is no longer being mounted, so the next pull runs the
+  // mounter again rather than waiting for the killed one.
+  image =
+    puller.get()->pull(reference.get(), staging, OVERLAY_BACKEND, None());
+
+  AWAIT_READY(image);
+
+  EXPECT_TRUE(os::stat::islink(rootfs));
+  EXPECT_SOME_EQ("lazy\n", os::read(path::join(rootfs, "file")));
+}
+
+
+// This test verifies that the registry puller extracts the layers like
+// `tar` would, i.e., keeping the permissions of the files and, when
+// running as root, their owners. It also verifies that the tarballs are
+// removed once extracted and that the pull and extraction of the layers
+// are timed.
+TEST_F(ProvisionerDockerRegistryPullerTest, ExtractLayers)
+{
+  const string layer1 = path::join(os::getcwd(), "layer1");
+  ASSERT_SOME(os::mkdir(path::join(layer1, "bin")));
+  ASSERT_SOME(os::write(path::join(layer1, "bin", "tool"), "tool"));
+  ASSERT_SOME(os::chmod(path::join(layer1, "bin", "tool"), 0755));
+  ASSERT_SOME(os::write(path::join(layer1, "config"), "config"));
+  ASSERT_SOME(os::chmod(path::join(layer1, "config"), 0640));
+
+  const string layer2 = path::join(os::getcwd(), "layer2");
+  ASSERT_SOME(os::mkdir(layer2));
+  ASSERT_SOME(os::write(path::join(layer2, "data"), "data"));
+
+  ASSERT_SOME(os::shell(
+      "tar -C " + layer1 + " --numeric-owner --owner=1234 --group=1234 "
+      "-czf layer1.tar.gz ."));
+
+  ASSERT_SOME(os::shell("tar -C " + layer2 + " -czf layer2.tar.gz ."));
+
+  const string staging = path::join(os::getcwd(), "staging");
+  ASSERT_SOME(os::mkdir(staging));
+
+  Future<slave::docker::Image> image =
+    pull({"layer1.tar.gz", "layer2.tar.gz"}, staging);
+
+  AWAIT_READY(image);
+  ASSERT_EQ(2, image->layer_ids_size());
+
+  const string rootfs1 = paths::getImageLayerRootfsPath(
+      path::join(staging, image->layer_ids(0)), COPY_BACKEND);
+
+  const string rootfs2 = paths::getImageLayerRootfsPath(
+      path::join(staging, image->layer_ids(1)), COPY_BACKEND);
+
+  EXPECT_SOME_EQ("tool", os::read(path::join(rootfs1, "bin", "tool")));
+  EXPECT_SOME_EQ("config", os::read(path::join(rootfs1, "config")));
+  EXPECT_SOME_EQ("data", os::read(path::join(rootfs2, "data")));
+
+  Try<mode_t> mode = os::stat::mode(path::join(rootfs1, "bin", "tool"));
+  ASSERT_SOME(mode);
+  EXPECT_EQ(0755u, mode.get() & 07777);
+
+  mode = os::stat::mode(path::join(rootfs1, "config"));
+  ASSERT_SOME(mode);
+  EXPECT_EQ(0640u, mode.get() & 07777);
+
+  Try<uid_t> uid = os::stat::uid(path::join(rootfs1, "config"));
+  ASSERT_SOME(uid);
+
+  if (::geteuid() == 0) {
+    EXPECT_EQ(1234u, uid.get());
+  } else {
+    EXPECT_EQ(::geteuid(), uid.get());
+  }
+
+  // The tarballs are removed once extracted.
+  foreach (const string& layer, image->layer_ids()) {
+    EXPECT_FALSE(os::exists(path::join(staging, layer + "-archive")));
+  }
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(
+      2,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/layer_pull_ms/count"]);
+
+  EXPECT_EQ(
+      2,
+      metrics.values[
+          "containerizer/mesos/provisioner/docker_store/"
+          "layer_extraction_ms/count"]);
+}
+
+
+// This test verifies that the registry puller refuses to extract a
+// layer with an entry outside of its rootfs.
+TEST_F(ProvisionerDockerRegistryPullerTest, RefuseDotDotLayer)
+{
+  const string layer = path::join(os::getcwd(), "layer");
+  ASSERT_SOME(os::mkdir(path::join(layer, "rootfs")));
+  ASSERT_SOME(os::write(path::join(layer, "escaped"), "escaped"));
+
+  // `-P` keeps the leading '../' in the name of the entry.
+  ASSERT_SOME(os::shell(
+      "cd " + path::join(layer, "rootfs") + " && "
+      "tar -cPf " + path::join(os::getcwd(), "layer.tar") + " ../escaped"));
+
+  const string staging = path::join(os::getcwd(), "staging");
+  ASSERT_SOME(os::mkdir(staging));
+
+  AWAIT_FAILED(pull({"layer.tar"}, staging));
+
+  EXPECT_FALSE(os::exists(path::join(staging, createDigest('0'), "escaped")));
+}
+
+
+// This test verifies that the registry puller refuses to extract a
+// layer with an entry written through a symlink of the layer, which
+// could otherwise point anywhere on the host.
+TEST_F(ProvisionerDockerRegistryPullerTest, RefuseSymlinkLayer)
+{
+  const string outside = path::join(os::getcwd(), "outside");
+  ASSERT_SOME(os::mkdir(outside));
+
+  // The layer has a symlink to the directory outside of its rootfs,
+  // followed by an entry with the same path as the symlink.
+  const string link = path::join(os::getcwd(), "link");
+  ASSERT_SOME(os::mkdir(link));
+  ASSERT_SOME(::fs::symlink(outside, path::join(link, "dir")));
+
+  const string file = path::join(os::getcwd(), "file");
+  ASSERT_SOME(os::mkdir(path::join(file, "dir")));
+  ASSERT_SOME(os::write(path::join(file, "dir", "escaped"), "escaped"));
+
+  ASSERT_SOME(os::shell(
+      "tar -cf layer.tar -C " + link + " dir -C " + file + " dir/escaped"));
+
+  const string staging = path::join(os::getcwd(), "staging");
+  ASSERT_SOME(os::mkdir(staging));
+
+  AWAIT_FAILED(pull({"layer.tar"}, staging));
+
+  EXPECT_FALSE(os::exists(path::join(outside, "escaped")));
+}
+#endif // __linux__
+
+
 #ifdef __linux__
 class ProvisionerDockerTest
   : public MesosTest,
@@ -40,6 +40,7 @@
 #include "common/values.hpp"
 
 #include "linux/fs.hpp"
+#include "linux/quota.hpp"
 
 #include "master/master.hpp"
 
@@ -52,6 +53,8 @@
 
 #include "slave/containerizer/mesos/containerizer.hpp"
 
+#include "slave/containerizer/mesos/isolators/posix/disk.hpp"
+
 #include "slave/containerizer/mesos/isolators/xfs/disk.hpp"
 #include "slave/containerizer/mesos/isolators/xfs/utils.hpp"
 
@@ -80,6 +83,7 @@ using mesos::internal::slave::Fetcher;
 using mesos::internal::slave::GarbageCollectorProcess;
 using mesos::internal::slave::MesosContainerizer;
 using mesos::internal::slave::MesosContainerizerProcess;
+using mesos::internal::slave::PosixDiskIsolatorProcess;
 using mesos::internal::slave::Slave;
 using mesos::internal::slave::XfsDiskIsolatorProcess;
 
@@ -89,6 +93,9 @@ using mesos::internal::values::rangesToIntervalSet;
 
 using mesos::master::detector::MasterDetector;
 
+using mesos::slave::ContainerConfig;
+using mesos::slave::Isolator;
+
 namespace mesos {
 namespace internal {
 namespace tests {
@@ -2280,6 +2287,7 @@ TEST_F(ROOT_XFS_QuotaTest, IsolatorFlags)
 TEST_F(ROOT_XFS_NoQuota, CheckQuotaEnabled)
 {
   EXPECT_SOME_EQ(false, xfs::isQuotaEnabled(mountPoint.get()));
+  EXPECT_SOME_EQ(false, quota::isProjectQuotaEnabled(mountPoint.get()));
   EXPECT_ERROR(XfsDiskIsolatorProcess::create(CreateSlaveFlags()));
 }
 
@@ -2289,6 +2297,7 @@ TEST_F(ROOT_XFS_NoQuota, CheckQuotaEnabled)
 TEST_F(ROOT_XFS_NoProjectQuota, CheckQuotaEnabled)
 {
   EXPECT_SOME_EQ(false, xfs::isQuotaEnabled(mountPoint.get()));
+  EXPECT_SOME_EQ(false, quota::isProjectQuotaEnabled(mountPoint.get()));
   EXPECT_ERROR(XfsDiskIsolatorProcess::create(CreateSlaveFlags()));
 }
 
@@ -2297,6 +2306,114 @@ TEST_F(ROOT_XFS_NoProjectQuota, CheckQuotaEnabled)
 TEST_F(ROOT_XFS_QuotaTest, CheckQuotaEnabled)
 {
   EXPECT_SOME_EQ(true, xfs::isQuotaEnabled(mountPoint.get()));
+  EXPECT_SOME_EQ(true, quota::isProjectQuotaEnabled(mountPoint.get()));
+}
+
+
+// Verify that the filesystem-independent project quota helpers used
+// by the `project_quota` disk usage backend assign, inherit, account
+// and clear project IDs.
+TEST_F(ROOT_XFS_QuotaTest, ProjectQuotaHelpers)
+{
+  const uint32_t projectId = 300;
+  const string root = "project";
+
+  ASSERT_SOME(os::mkdir(path::join(root, "depth1"), true));
+  EXPECT_SOME(mkfile(path::join(root, "depth1/file1"), Megabytes(1)));
+
+  // The device is what quotactl(2) expects, i.e., the loop device.
+  Result<string> device = quota::getDevice(root);
+  ASSERT_SOME_EQ(loopDevice.get(), device);
+
+  EXPECT_NONE(quota::getProjectId(root));
+  EXPECT_ERROR(quota::setProjectId(root, 0));
+
+  ASSERT_SOME(quota::setProjectId(root, projectId));
+
+  EXPECT_SOME_EQ(projectId, quota::getProjectId(root));
+  EXPECT_SOME_EQ(
+      projectId,
+      quota::getProjectId(path::join(root, "depth1/file1")));
+
+  // New files inherit the project of their directory.
+  EXPECT_SOME(mkfile(path::join(root, "depth1/file2"), Megabytes(1)));
+  EXPECT_SOME_EQ(
+      projectId,
+      quota::getProjectId(path::join(root, "depth1/file2")));
+
+  EXPECT_SOME_EQ(
+      Megabytes(2),
+      quota::getProjectUsage(device.get(), projectId));
+
+  ASSERT_SOME(quota::clearProjectId(root));
+
+  EXPECT_NONE(quota::getProjectId(root));
+  EXPECT_NONE(quota::getProjectId(path::join(root, "depth1/file2")));
+
+  EXPECT_SOME_EQ(
+      Megabytes(0),
+      quota::getProjectUsage(device.get(), projectId));
+}
+
+
+// Verify that the `project_quota` disk usage backend of the `disk/du`
+// isolator charges the sandbox to a project of `--disk_project_range`
+// and reports the usage of that project.
+TEST_F(ROOT_XFS_QuotaTest, ProjectQuotaDiskUsageBackend)
+{
+  slave::Flags flags = CreateSlaveFlags();
+  flags.isolation = "disk/du";
+  flags.container_disk_usage_backend = "project_quota";
+  flags.container_disk_watch_interval = Milliseconds(10);
+  flags.disk_project_range = "[5000-5010]";
+
+  Try<Isolator*> _isolator = PosixDiskIsolatorProcess::create(flags);
+  ASSERT_SOME(_isolator);
+
+  Owned<Isolator> isolator(_isolator.get());
+
+  const string directory = path::join(mountPoint.get(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  ContainerID containerId;
+  containerId.set_value(id::UUID::random().toString());
+
+  ContainerConfig containerConfig;
+  containerConfig.mutable_resources()->CopyFrom(
+      Resources::parse("disk:10").get());
+  containerConfig.set_directory(directory);
+
+  AWAIT_READY(isolator->prepare(containerId, containerConfig));
+
+  Result<uint32_t> projectId = quota::getProjectId(directory);
+  ASSERT_SOME(projectId);
+  EXPECT_LE(5000u, projectId.get());
+  EXPECT_GE(5010u, projectId.get());
+
+  EXPECT_SOME(mkfile(path::join(directory, "file"), Megabytes(1)));
+
+  AWAIT_READY(isolator->update(containerId, containerConfig.resources()));
+
+  // The usage is collected asynchronously.
+  Future<ResourceStatistics> usage;
+  Duration waited = Duration::zero();
+
+  do {
+    usage = isolator->usage(containerId);
+    AWAIT_READY(usage);
+
+    if (usage->disk_used_bytes() >= Megabytes(1).bytes()) {
+      break;
+    }
+
+    os::sleep(Milliseconds(10));
+    waited += Milliseconds(10);
+  } while (waited < process::TEST_AWAIT_TIMEOUT);
+
+  EXPECT_LE(Megabytes(1).bytes(), usage->disk_used_bytes());
+  EXPECT_EQ(Megabytes(10).bytes(), usage->disk_limit_bytes());
+
+  AWAIT_READY(isolator->cleanup(containerId));
 }
 
 
@@ -176,6 +176,42 @@ TEST_F(DiskUsageCollectorTest, ExcludeRelativePath)
 #endif
 
 
+// This test verifies the usage of a directory when the collector
+// walks it instead of running 'du': hard links are counted once and
+// the excluded paths are skipped.
+TEST_F(DiskUsageCollectorTest, Walk)
+{
+  string dir = path::join(os::getcwd(), "dir");
+  string file1 = path::join(dir, "file1");
+  string file2 = path::join(dir, "file2");
+  string link = path::join(dir, "link");
+
+  string volume = path::join(os::getcwd(), "volume");
+  string file3 = path::join(volume, "file3");
+
+  ASSERT_SOME(os::mkdir(dir));
+  ASSERT_SOME(os::mkdir(volume));
+
+  ASSERT_SOME(os::write(file1, string(Kilobytes(64).bytes(), 'x')));
+  ASSERT_SOME(os::write(file2, string(Kilobytes(8).bytes(), 'y')));
+  ASSERT_SOME(os::write(file3, string(Kilobytes(128).bytes(), 'z')));
+
+  ASSERT_EQ(0, ::link(file1.c_str(), link.c_str()));
+
+  DiskUsageCollector collector(Milliseconds(1), true);
+
+  Future<Bytes> usage1 = collector.usage(os::getcwd(), {volume});
+  AWAIT_READY(usage1);
+  EXPECT_GE(usage1.get(), Kilobytes(72));
+  EXPECT_LT(usage1.get(), Kilobytes(128));
+
+  Future<Bytes> usage2 = collector.usage(os::getcwd(), {});
+  AWAIT_READY(usage2);
+  EXPECT_GE(usage2.get(), Kilobytes(200));
+  EXPECT_LT(usage2.get(), Kilobytes(264));
+}
+
+
 class DiskQuotaTest : public MesosTest {};
 
 
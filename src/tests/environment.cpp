@@ -59,6 +59,7 @@
 
 #ifdef __linux__
 #include "linux/cgroups.hpp"
+#include "linux/cgroups2.hpp"
 #include "linux/fs.hpp"
 #include "linux/perf.hpp"
 #endif
@@ -218,6 +219,47 @@ private:
 };
 
 
+class Cgroups2Filter : public TestFilter
+{
+public:
+  Cgroups2Filter()
+  {
+#ifdef __linux__
+    Result<string> hierarchy = cgroups2::hierarchy();
+    if (!hierarchy.isSome()) {
+      std::cerr
+        << "-------------------------------------------------------------\n"
+        << "We cannot run any cgroups v2 tests because the unified\n"
+        << "hierarchy is not mounted"
+        << (hierarchy.isError() ? ": " + hierarchy.error() : "") << "\n"
+        << "-------------------------------------------------------------"
+        << std::endl;
+
+      error = hierarchy.isError()
+        ? Error(hierarchy.error())
+        : Error("Unified hierarchy not mounted");
+    }
+#endif // __linux__
+  }
+
+  bool disable(const ::testing::TestInfo* test) const override
+  {
+    if (matches(test, "CGROUPS2_")) {
+#ifdef __linux__
+      return error.isSome();
+#else
+      return true;
+#endif // __linux__
+    }
+
+    return false;
+  }
+
+private:
+  Option<Error> error;
+};
+
+
 class CurlFilter : public TestFilter
 {
 public:
@@ -1090,6 +1132,7 @@ Environment::Environment(const Flags& _flags)
             std::make_shared<BenchmarkFilter>(),
             std::make_shared<CfsFilter>(),
             std::make_shared<CgroupsFilter>(),
+            std::make_shared<Cgroups2Filter>(),
             std::make_shared<CurlFilter>(),
             std::make_shared<DockerFilter>(),
             std::make_shared<DtypeFilter>(),
@@ -288,6 +288,95 @@ TEST_F(GarbageCollectorTest, Prune)
 }
 
 
+// This test verifies that eviction deletes the largest scheduled
+// directories first, regardless of their removal time, and that it
+// does not evict more directories while a previous eviction is still
+// in progress.
+TEST_F(GarbageCollectorTest, Evict)
+{
+  GarbageCollector gc("work_dir");
+
+  const string& small = "small";
+  const string& large = "large";
+
+  ASSERT_SOME(os::mkdir(small));
+  ASSERT_SOME(os::mkdir(large));
+
+  ASSERT_SOME(os::write(
+      path::join(small, "file"), string(Kilobytes(4).bytes(), 'a')));
+
+  ASSERT_SOME(os::write(
+      path::join(large, "file"), string(Megabytes(1).bytes(), 'a')));
+
+  Clock::pause();
+
+  Future<Nothing> scheduleSmall = gc.schedule(Seconds(10), small);
+  Future<Nothing> scheduleLarge = gc.schedule(Seconds(15), large);
+
+  // The second eviction is skipped, as the directories are measured
+  // and then removed for the first one, which covers its target.
+  gc.evict(Bytes(1));
+  gc.evict(Bytes(1));
+
+  AWAIT_READY(scheduleLarge);
+
+  Clock::settle();
+  ASSERT_TRUE(scheduleSmall.isPending());
+
+  EXPECT_TRUE(os::exists(small));
+  EXPECT_FALSE(os::exists(large));
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_SOME_EQ(1u, metrics.at<JSON::Number>("gc/path_evictions"));
+  EXPECT_SOME_EQ(1u, metrics.at<JSON::Number>("gc/path_removals_pending"));
+
+  Clock::resume();
+}
+
+
+// This test verifies that eviction does not count the disk space of a
+// directory twice when both the directory and a directory nested under
+// it are scheduled, e.g., a framework and one of its executors.
+TEST_F(GarbageCollectorTest, EvictNested)
+{
+  GarbageCollector gc("work_dir");
+
+  const string& framework = "framework";
+  const string& executor = path::join(framework, "executor");
+
+  ASSERT_SOME(os::mkdir(executor));
+
+  ASSERT_SOME(os::write(
+      path::join(framework, "file"), string(Kilobytes(4).bytes(), 'a')));
+
+  ASSERT_SOME(os::write(
+      path::join(executor, "file"), string(Megabytes(1).bytes(), 'a')));
+
+  Clock::pause();
+
+  Future<Nothing> scheduleExecutor = gc.schedule(Seconds(10), executor);
+  Future<Nothing> scheduleFramework = gc.schedule(Seconds(15), framework);
+
+  // The framework directory is the largest, and covers the executor
+  // directory, which is then not evicted on its own.
+  gc.evict(Megabytes(2));
+
+  AWAIT_READY(scheduleFramework);
+
+  Clock::settle();
+  ASSERT_TRUE(scheduleExecutor.isPending());
+
+  EXPECT_FALSE(os::exists(framework));
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_SOME_EQ(1u, metrics.at<JSON::Number>("gc/path_evictions"));
+
+  Clock::resume();
+}
+
+
 class GarbageCollectorIntegrationTest : public MesosTest {};
 
 
@@ -14,6 +14,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sys/resource.h>
+
 #include <atomic>
 #include <limits>
 #include <memory>
@@ -34,6 +36,7 @@
 #include <process/protobuf.hpp>
 #include <process/statistics.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/stopwatch.hpp>
 
@@ -200,8 +203,12 @@ public:
 
   Future<Nothing> reregister()
   {
+    // NOTE: A new promise is created for every re-registration so that
+    // the same agent can reregister with a failed over master.
+    promise.reset(new Promise<Nothing>());
+
     send(masterPid, message);
-    return promise.future();
+    return promise->future();
   }
 
   TestSlaveProcess(const TestSlaveProcess& other) = delete;
@@ -210,7 +217,9 @@ public:
 private:
   void reregistered(const SlaveReregisteredMessage&)
   {
-    promise.set(Nothing());
+    if (promise.get() != nullptr) {
+      promise->set(Nothing());
+    }
   }
 
   // We need to answer pings to keep the agent registered.
@@ -227,7 +236,7 @@ private:
   const size_t tasksPerCompletedFramework;
 
   ReregisterSlaveMessage message;
-  Promise<Nothing> promise;
+  Owned<Promise<Nothing>> promise;
 };
 
 
@@ -285,11 +294,14 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Values(
         make_tuple(2000, 5, 10, 5, 10),
         make_tuple(2000, 5, 20, 0, 0),
+        make_tuple(5000, 5, 2, 0, 0),
         make_tuple(20000, 1, 5, 0, 0)));
 
 
 // This test measures the time from all agents start to reregister to
-// to when all have received `SlaveReregisteredMessage`.
+// to when all have received `SlaveReregisteredMessage`, as well as the
+// peak memory usage of the test process (which hosts the master and the
+// artificial agents).
 TEST_P(MasterFailover_BENCHMARK_Test, AgentReregistrationDelay)
 {
   size_t agentCount;
@@ -353,6 +365,150 @@ TEST_P(MasterFailover_BENCHMARK_Test, AgentReregistrationDelay)
        << completedFrameworksPerAgent * tasksPerCompletedFramework * agentCount
        << " completed tasks in "
        << watch.elapsed() << endl;
+
+  struct rusage usage;
+  ASSERT_EQ(0, ::getrusage(RUSAGE_SELF, &usage));
+
+  // NOTE: `ru_maxrss` is in kilobytes on Linux.
+  cout << "Peak resident set size: " << Kilobytes(usage.ru_maxrss) << endl;
+}
+
+
+class MasterFailoverRecovery_BENCHMARK_Test
+  : public MesosTest,
+    public WithParamInterface<tuple<size_t, size_t, size_t, Option<string>>> {};
+
+
+// The value tuples are defined as:
+// - agentCount
+// - frameworksPerAgent
+// - tasksPerFramework (per agent)
+// - agent re-registration rate limit (see
+//   `--agent_reregistration_rate_limit`), if any
+INSTANTIATE_TEST_CASE_P(
+    AgentFrameworkTaskCount,
+    MasterFailoverRecovery_BENCHMARK_Test,
+    ::testing::Values(
+        make_tuple(2000, 5, 10, Option<string>::none()),
+        make_tuple(2000, 5, 10, Option<string>("1000/1secs")),
+        make_tuple(20000, 1, 5, Option<string>::none()),
+        make_tuple(20000, 1, 5, Option<string>("5000/1secs"))));
+
+
+// This test measures the end-to-end time it takes a failed over master
+// to recover all agents known to the registry, i.e., from the start of
+// the new master until every agent has received its
+// `SlaveReregisteredMessage`. While agents reregister, the response
+// time of the lightweight '/health' endpoint is probed as an indicator
+// of how responsive the master actor stays during the storm.
+TEST_P(MasterFailoverRecovery_BENCHMARK_Test, RecoveryTime)
+{
+  size_t agentCount;
+  size_t frameworksPerAgent;
+  size_t tasksPerFramework;
+  Option<string> rateLimit;
+
+  tie(agentCount, frameworksPerAgent, tasksPerFramework, rateLimit) =
+    GetParam();
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.authenticate_agents = false;
+  masterFlags.agent_reregistration_rate_limit = rateLimit;
+
+  // Use replicated log so that the registry survives the master
+  // failover and better simulates the production scenario.
+  masterFlags.registry = "replicated_log";
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  vector<Owned<TestSlave>> slaves;
+
+  for (size_t i = 0; i < agentCount; i++) {
+    SlaveID slaveId;
+    slaveId.set_value("agent" + stringify(i));
+
+    slaves.push_back(Owned<TestSlave>(new TestSlave(
+        master.get()->pid,
+        slaveId,
+        frameworksPerAgent,
+        tasksPerFramework,
+        0,
+        0)));
+  }
+
+  // Admit all agents to the registry of the first master.
+  vector<Future<Nothing>> reregistered;
+  foreach (const Owned<TestSlave>& slave, slaves) {
+    reregistered.push_back(slave->reregister());
+  }
+
+  await(reregistered).await();
+
+  // Fail over the master. The new master recovers all agents from
+  // the registry and waits for them to reregister.
+  master->reset();
+
+  Stopwatch watch;
+  watch.start();
+
+  master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  // Probe the '/health' endpoint until all agents have reregistered.
+  atomic_bool stop = { false };
+
+  const UPID masterPid = master.get()->pid;
+
+  Future<vector<Duration>> probes = async([masterPid, &stop]() {
+    vector<Duration> durations;
+
+    while (!stop.load()) {
+      Stopwatch probe;
+      probe.start();
+
+      Future<http::Response> response = http::get(masterPid, "health");
+      response.await();
+
+      probe.stop();
+
+      EXPECT_TRUE(response.isReady());
+      durations.push_back(probe.elapsed());
+    }
+
+    return durations;
+  });
+
+  reregistered.clear();
+  foreach (const Owned<TestSlave>& slave, slaves) {
+    reregistered.push_back(slave->reregister());
+  }
+
+  await(reregistered).await();
+
+  watch.stop();
+
+  stop.store(true);
+  probes.await();
+  CHECK_READY(probes);
+
+  cout << "Recovered " << agentCount << " agents with a total of "
+       << frameworksPerAgent * tasksPerFramework * agentCount
+       << " running tasks "
+       << (rateLimit.isSome()
+           ? "at a re-registration rate limit of " + rateLimit.get()
+           : "without re-registration rate limit")
+       << " in " << watch.elapsed() << endl;
+
+  Option<Statistics<Duration>> s =
+    Statistics<Duration>::from(probes->cbegin(), probes->cend());
+
+  if (s.isSome()) {
+    cout << "'/health' response times [min, p25, p50, p75, p90, max]: "
+         << "[" << s->min << ", " << s->p25 << ", " << s->p50 << ", "
+         << s->p75 << ", " << s->p90 << ", " << s->max << "]"
+         << " from " << s->count << " measurements" << endl;
+  }
 }
 
 
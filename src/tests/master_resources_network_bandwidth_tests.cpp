@@ -24,6 +24,7 @@
 
 #include "master/resources/network_bandwidth.hpp"
 
+#include <mesos/attributes.hpp>
 #include <mesos/resources.hpp>
 
 #include <stout/gtest.hpp>
@@ -38,6 +39,7 @@ using std::string;
 
 using google::protobuf::RepeatedPtrField;
 
+using mesos::resources::NetworkBandwidthPolicy;
 using mesos::resources::enforceNetworkBandwidthAllocation;
 
 namespace {
@@ -316,6 +318,93 @@ TEST(MasterResourcesNetworkBandwidthTest, DivisonByZero) {
             "Cannot deduce network bandwidth.", result.get().message);
 }
 
+
+// Given the policy uses the agent share formula with a floor,
+// When agents declare network bandwidth or not,
+// Then tasks get their share of the bandwidth of the agent, or of the floor.
+TEST(MasterResourcesNetworkBandwidthTest, AgentShareFormula) {
+  NetworkBandwidthPolicy policy(NetworkBandwidthPolicy::AGENT_SHARE, 1000);
+
+  SlaveInfo slaveInfo1;
+  slaveInfo1.mutable_id()->set_value("agent1");
+
+  Resources totalSlaveResources1;
+  totalSlaveResources1 += resources::CPU(4);
+  totalSlaveResources1 += resources::NetworkBandwidth(10000);
+
+  policy.addSlave(slaveInfo1, totalSlaveResources1);
+
+  SlaveInfo slaveInfo2;
+  slaveInfo2.mutable_id()->set_value("agent2");
+
+  Resources totalSlaveResources2;
+  totalSlaveResources2 += resources::CPU(4);
+
+  policy.addSlave(slaveInfo2, totalSlaveResources2);
+
+  Offer::Operation operation;
+  operation.set_type(Offer::Operation::LAUNCH_GROUP);
+  TaskInfo* taskInfo =
+    operation.mutable_launch_group()->mutable_task_group()->add_tasks();
+  taskInfo->mutable_resources()->Add()->CopyFrom(resources::CPU(1));
+
+  Offer::Operation operation2 = operation;
+
+  ASSERT_NONE(policy.enforce(slaveInfo1.id(), operation));
+  ASSERT_HAS_NETWORK_BANDWIDTH(
+    operation.launch_group().task_group().tasks(0).resources(),
+    resources::NetworkBandwidth(2500));
+
+  ASSERT_NONE(policy.enforce(slaveInfo2.id(), operation2));
+  ASSERT_HAS_NETWORK_BANDWIDTH(
+    operation2.launch_group().task_group().tasks(0).resources(),
+    resources::NetworkBandwidth(250));
+}
+
+
+// Given an agent overrides the formula and the floor with attributes,
+// When its total resources are updated,
+// Then the bandwidth of tasks follows the attributes and the new total.
+TEST(MasterResourcesNetworkBandwidthTest, AgentAttributes) {
+  NetworkBandwidthPolicy policy;
+
+  SlaveInfo slaveInfo;
+  slaveInfo.mutable_id()->set_value("agent");
+  slaveInfo.mutable_attributes()->CopyFrom(Attributes::parse(
+    "network_bandwidth_formula:floor_share;network_bandwidth_floor:800"));
+
+  Resources totalSlaveResources;
+  totalSlaveResources += resources::CPU(4);
+  totalSlaveResources += resources::NetworkBandwidth(10000);
+
+  policy.addSlave(slaveInfo, totalSlaveResources);
+
+  Offer::Operation operation;
+  operation.set_type(Offer::Operation::LAUNCH);
+  TaskInfo* taskInfo = operation.mutable_launch()->add_task_infos();
+  taskInfo->mutable_resources()->Add()->CopyFrom(resources::CPU(1));
+
+  Offer::Operation operation2 = operation;
+
+  ASSERT_NONE(policy.enforce(slaveInfo.id(), operation));
+  ASSERT_HAS_NETWORK_BANDWIDTH(
+    operation.launch().task_infos(0).resources(),
+    resources::NetworkBandwidth(200));
+
+  // Doubling the CPUs of the agent halves the share of the task.
+  totalSlaveResources += resources::CPU(4);
+  policy.addSlave(slaveInfo, totalSlaveResources);
+
+  ASSERT_NONE(policy.enforce(slaveInfo.id(), operation2));
+  ASSERT_HAS_NETWORK_BANDWIDTH(
+    operation2.launch().task_infos(0).resources(),
+    resources::NetworkBandwidth(100));
+
+  policy.removeSlave(slaveInfo.id());
+
+  ASSERT_SOME(policy.enforce(slaveInfo.id(), operation2));
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
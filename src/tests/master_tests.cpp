@@ -109,6 +109,7 @@ using process::PID;
 using process::Promise;
 
 using process::http::Accepted;
+using process::http::BadRequest;
 using process::http::InternalServerError;
 using process::http::OK;
 using process::http::Response;
@@ -2344,6 +2345,13 @@ TEST_F(MasterTest, MetricsInMetricsEndpoint)
   EXPECT_EQ(1u, snapshot.values.count("master/event_queue_messages"));
   EXPECT_EQ(1u, snapshot.values.count("master/event_queue_dispatches"));
   EXPECT_EQ(1u, snapshot.values.count("master/event_queue_http_requests"));
+  EXPECT_EQ(1u, snapshot.values.count("master/ingestion/decode_queued"));
+  EXPECT_EQ(1u, snapshot.values.count("master/ingestion/apply_queued"));
+
+  // Agent re-registration admission metrics.
+  EXPECT_EQ(
+      1u, snapshot.values.count("master/slave_reregistrations_in_progress"));
+  EXPECT_EQ(1u, snapshot.values.count("master/slave_reregistrations_queued"));
 
   // Slave observer metrics.
   EXPECT_EQ(1u, snapshot.values.count("master/slave_unreachable_scheduled"));
@@ -4507,6 +4515,385 @@ TEST_F(MasterTest, TasksEndpoint)
 }
 
 
+// This test verifies that the '/master/tasks' endpoint can filter
+// tasks by state, and that the task state index used for this (and
+// for the task state metrics) follows the state transitions of tasks.
+TEST_F(MasterTest, TasksEndpointStateFilter)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  process::Queue<Offer> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillRepeatedly(EnqueueOffers(&offers));
+
+  driver.start();
+
+  Future<Offer> offer = offers.get();
+  AWAIT_READY(offer);
+
+  TaskInfo task1;
+  task1.set_name("test1");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_slave_id()->MergeFrom(offer->slave_id());
+  task1.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:0.1;mem:12").get());
+  task1.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  TaskInfo task2;
+  task2.set_name("test2");
+  task2.mutable_task_id()->set_value("2");
+  task2.mutable_slave_id()->MergeFrom(offer->slave_id());
+  task2.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:0.1;mem:12").get());
+  task2.mutable_executor()->MergeFrom(DEFAULT_EXECUTOR_INFO);
+
+  ExecutorDriver* execDriver;
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .WillOnce(SaveArg<0>(&execDriver));
+
+  // The first task is reported as running, the second one as starting.
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING))
+    .WillOnce(SendStatusUpdateFromTask(TASK_STARTING));
+
+  Future<TaskStatus> status1, status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  driver.launchTasks(offer->id(), {task1, task2});
+
+  AWAIT_READY(status1);
+  AWAIT_READY(status2);
+
+  auto queryTaskIds = [&master](const string& state) -> Try<vector<string>> {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "tasks?state=" + state,
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    response.await();
+    if (!response.isReady() || response->status != OK().status) {
+      return Error("Unexpected response for state '" + state + "'");
+    }
+
+    Try<JSON::Object> object = JSON::parse<JSON::Object>(response->body);
+    if (object.isError()) {
+      return Error(object.error());
+    }
+
+    Result<JSON::Array> tasks = object->find<JSON::Array>("tasks");
+    if (!tasks.isSome()) {
+      return Error("Missing 'tasks' in response");
+    }
+
+    vector<string> taskIds;
+    foreach (const JSON::Value& task, tasks->values) {
+      Result<JSON::String> id =
+        task.as<JSON::Object>().find<JSON::String>("id");
+      if (!id.isSome()) {
+        return Error("Missing 'id' in task");
+      }
+
+      taskIds.push_back(id->value);
+    }
+
+    return taskIds;
+  };
+
+  Try<vector<string>> running = queryTaskIds("TASK_RUNNING");
+  ASSERT_SOME(running);
+  EXPECT_EQ(vector<string>({"1"}), running.get());
+
+  Try<vector<string>> starting = queryTaskIds("TASK_STARTING");
+  ASSERT_SOME(starting);
+  EXPECT_EQ(vector<string>({"2"}), starting.get());
+
+  Try<vector<string>> finished = queryTaskIds("TASK_FINISHED");
+  ASSERT_SOME(finished);
+  EXPECT_TRUE(finished->empty());
+
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(1, metrics.values["master/tasks_running"]);
+  EXPECT_EQ(1, metrics.values["master/tasks_starting"]);
+  EXPECT_EQ(0, metrics.values["master/tasks_staging"]);
+
+  // Transition the second task to running.
+  Future<TaskStatus> status3;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status3));
+
+  TaskStatus status;
+  status.mutable_task_id()->set_value("2");
+  status.set_state(TASK_RUNNING);
+  execDriver->sendStatusUpdate(status);
+
+  AWAIT_READY(status3);
+  EXPECT_EQ(TASK_RUNNING, status3->state());
+
+  running = queryTaskIds("TASK_RUNNING");
+  ASSERT_SOME(running);
+  EXPECT_EQ(2u, running->size());
+
+  starting = queryTaskIds("TASK_STARTING");
+  ASSERT_SOME(starting);
+  EXPECT_TRUE(starting->empty());
+
+  metrics = Metrics();
+  EXPECT_EQ(2, metrics.values["master/tasks_running"]);
+  EXPECT_EQ(0, metrics.values["master/tasks_starting"]);
+
+  // An unknown state is rejected.
+  {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "tasks?state=TASK_BOGUS",
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(BadRequest().status, response);
+  }
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that with `--parallel_message_ingestion` the
+// master still handles agent updates, scheduler calls and operator API
+// calls, which are then decoded and validated on worker threads.
+TEST_F(MasterTest, ParallelMessageIngestion)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.parallel_message_ingestion = true;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  TestContainerizer containerizer(&exec);
+
+  Future<UpdateSlaveMessage> updateSlaveMessage =
+    FUTURE_PROTOBUF(UpdateSlaveMessage(), _, master.get()->pid);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get(), &containerizer);
+  ASSERT_SOME(slave);
+
+  AWAIT_READY(updateSlaveMessage);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  TaskInfo task = createTask(offers->front(), "", DEFAULT_EXECUTOR_ID);
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers->front().id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  {
+    ContentType contentType = ContentType::PROTOBUF;
+
+    v1::master::Call call;
+    call.set_type(v1::master::Call::GET_TASKS);
+
+    process::http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+    headers["Accept"] = stringify(contentType);
+
+    Future<Response> response = process::http::post(
+        master.get()->pid,
+        "api/v1",
+        headers,
+        serialize(contentType, call),
+        stringify(contentType));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<v1::master::Response> v1Response =
+      deserialize<v1::master::Response>(contentType, response->body);
+
+    ASSERT_SOME(v1Response);
+    ASSERT_EQ(1, v1Response->get_tasks().tasks().size());
+    EXPECT_EQ(v1::TASK_RUNNING, v1Response->get_tasks().tasks(0).state());
+  }
+
+  // Wait for all events to be applied before checking the metrics.
+  Clock::pause();
+  Clock::settle();
+
+  JSON::Object metrics = Metrics();
+
+  EXPECT_EQ(0, metrics.values["master/ingestion/decode_queued"]);
+  EXPECT_EQ(0, metrics.values["master/ingestion/apply_queued"]);
+  EXPECT_EQ(1u, metrics.values.count("master/ingestion/decode_latency_ms"));
+  EXPECT_EQ(1u, metrics.values.count("master/ingestion/apply_latency_ms"));
+
+  Clock::resume();
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
+// This test verifies that with `--parallel_message_ingestion` calls to
+// the HTTP endpoints of the master, both the operator API and the other
+// endpoints, do not overtake the scheduler calls which the master
+// received before them, even while those are still being decoded.
+TEST_F(MasterTest, ParallelMessageIngestionOrder)
+{
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.parallel_message_ingestion = true;
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+  Try<Owned<cluster::Slave>> slave = StartSlave(detector.get());
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  // Decline the offer, and call the operator API as soon as the master
+  // has received the `DECLINE` call.
+  Future<mesos::scheduler::Call> declineCall = FUTURE_CALL(
+      mesos::scheduler::Call(), mesos::scheduler::Call::DECLINE, _, _);
+
+  Filters filters;
+  filters.set_refuse_seconds(Days(1).secs());
+
+  driver.declineOffer(offers->front().id(), filters);
+
+  AWAIT_READY(declineCall);
+
+  {
+    ContentType contentType = ContentType::PROTOBUF;
+
+    v1::master::Call call;
+    call.set_type(v1::master::Call::GET_FRAMEWORKS);
+
+    process::http::Headers headers = createBasicAuthHeaders(DEFAULT_CREDENTIAL);
+    headers["Accept"] = stringify(contentType);
+
+    Future<Response> response = process::http::post(
+        master.get()->pid,
+        "api/v1",
+        headers,
+        serialize(contentType, call),
+        stringify(contentType));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<v1::master::Response> v1Response =
+      deserialize<v1::master::Response>(contentType, response->body);
+
+    ASSERT_SOME(v1Response);
+    ASSERT_EQ(1, v1Response->get_frameworks().frameworks().size());
+    EXPECT_EQ(0, v1Response->get_frameworks().frameworks(0).offers().size());
+  }
+
+  // Tear the framework down, and query the `/frameworks` endpoint as
+  // soon as the master has received the `TEARDOWN` call.
+  Future<mesos::scheduler::Call> teardownCall = FUTURE_CALL(
+      mesos::scheduler::Call(), mesos::scheduler::Call::TEARDOWN, _, _);
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(teardownCall);
+
+  {
+    Future<Response> response = process::http::get(
+        master.get()->pid,
+        "frameworks",
+        None(),
+        createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+    AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+
+    Try<JSON::Object> object = JSON::parse<JSON::Object>(response->body);
+    ASSERT_SOME(object);
+
+    Result<JSON::Array> frameworks =
+      object->find<JSON::Array>("frameworks");
+    ASSERT_SOME(frameworks);
+    EXPECT_TRUE(frameworks->values.empty());
+
+    Result<JSON::Array> completed =
+      object->find<JSON::Array>("completed_frameworks");
+    ASSERT_SOME(completed);
+    ASSERT_EQ(1u, completed->values.size());
+
+    Result<JSON::String> id =
+      completed->values[0].as<JSON::Object>().find<JSON::String>("id");
+    EXPECT_SOME_EQ(JSON::String(frameworkId->value()), id);
+  }
+}
+
+
 // This test verifies that the master will strip ephemeral ports
 // resource from offers so that frameworks cannot see it.
 TEST_F(MasterTest, IgnoreEphemeralPortsResource)
@@ -4673,6 +5060,88 @@ TEST_F(MasterTest, OfferTimeout)
 }
 
 
+// This test verifies that offers sent together share their offer
+// timeout, and that removing one of them (here by declining it) does
+// not prevent the others from being rescinded when the timeout elapses.
+TEST_F(MasterTest, OfferTimeoutSharedByBatch)
+{
+  Clock::pause();
+
+  master::Flags masterFlags = MesosTest::CreateMasterFlags();
+  masterFlags.offer_timeout = Seconds(30);
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  slave::Flags slaveFlags = CreateSlaveFlags();
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage1 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Try<Owned<cluster::Slave>> slave1 = StartSlave(detector.get(), slaveFlags);
+  ASSERT_SOME(slave1);
+
+  Clock::advance(slaveFlags.registration_backoff_factor);
+  AWAIT_READY(slaveRegisteredMessage1);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage2 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  Try<Owned<cluster::Slave>> slave2 = StartSlave(detector.get(), slaveFlags);
+  ASSERT_SOME(slave2);
+
+  Clock::advance(slaveFlags.registration_backoff_factor);
+  AWAIT_READY(slaveRegisteredMessage2);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  // Both agents are offered in the allocation triggered by the
+  // framework's registration.
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(2u, offers->size());
+
+  // The agent-specific part of the offers is filled in.
+  foreach (const Offer& offer, offers.get()) {
+    EXPECT_TRUE(offer.has_hostname());
+    EXPECT_TRUE(offer.has_url());
+  }
+
+  EXPECT_NE(offers->at(0).slave_id(), offers->at(1).slave_id());
+
+  // Decline the first offer, the second one is expected to be
+  // rescinded once the timeout elapses.
+  Future<OfferID> offerRescinded;
+  EXPECT_CALL(sched, offerRescinded(&driver, _))
+    .WillOnce(FutureArg<1>(&offerRescinded));
+
+  Filters filters;
+  filters.set_refuse_seconds(Days(1).secs());
+
+  driver.declineOffer(offers->at(0).id(), filters);
+  Clock::settle();
+
+  Clock::advance(masterFlags.offer_timeout.get());
+
+  AWAIT_READY(offerRescinded);
+  EXPECT_EQ(offers->at(1).id(), offerRescinded.get());
+
+  driver.stop();
+  driver.join();
+}
+
+
 // Offer should not be rescinded if it's accepted.
 TEST_F(MasterTest, OfferNotRescindedOnceUsed)
 {
@@ -7962,6 +8431,85 @@ TEST_F(MasterTest, AgentRestartNoReregisterRateLimit)
 }
 
 
+// This test verifies that agent re-registrations are admitted at the
+// rate configured by `--agent_reregistration_rate_limit`, and that
+// re-registrations exceeding that rate are queued rather than dropped.
+TEST_F(MasterTest, AgentReregistrationRateLimit)
+{
+  Clock::pause();
+
+  master::Flags masterFlags = CreateMasterFlags();
+  masterFlags.agent_reregistration_rate_limit = "1/1mins";
+
+  Try<Owned<cluster::Master>> master = StartMaster(masterFlags);
+  ASSERT_SOME(master);
+
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  // Registrations are not subject to the rate limit.
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage1 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  slave::Flags slaveFlags1 = CreateSlaveFlags();
+  Try<Owned<cluster::Slave>> slave1 = StartSlave(&detector, slaveFlags1);
+  ASSERT_SOME(slave1);
+
+  Clock::advance(slaveFlags1.registration_backoff_factor);
+  AWAIT_READY(slaveRegisteredMessage1);
+
+  Future<SlaveRegisteredMessage> slaveRegisteredMessage2 =
+    FUTURE_PROTOBUF(SlaveRegisteredMessage(), _, _);
+
+  slave::Flags slaveFlags2 = CreateSlaveFlags();
+  Try<Owned<cluster::Slave>> slave2 = StartSlave(&detector, slaveFlags2);
+  ASSERT_SOME(slave2);
+
+  Clock::advance(slaveFlags2.registration_backoff_factor);
+  AWAIT_READY(slaveRegisteredMessage2);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage1 =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, slave1.get()->pid);
+
+  Future<SlaveReregisteredMessage> slaveReregisteredMessage2 =
+    FUTURE_PROTOBUF(SlaveReregisteredMessage(), _, slave2.get()->pid);
+
+  // Simulate a new master detected event on both agents, so that
+  // they attempt to reregister at the same time.
+  detector.appoint(master.get()->pid);
+
+  Clock::advance(slaveFlags1.registration_backoff_factor);
+  Clock::settle();
+
+  // Only one of the agents should have been admitted, the
+  // other one should be waiting for a permit.
+  EXPECT_NE(
+      slaveReregisteredMessage1.isReady(),
+      slaveReregisteredMessage2.isReady());
+
+  // The queued re-registration is not in progress until admitted.
+  JSON::Object metrics = Metrics();
+  EXPECT_EQ(1, metrics.values["master/slave_reregistrations_queued"]);
+  EXPECT_EQ(0, metrics.values["master/slave_reregistrations_in_progress"]);
+
+  // Once the next permit is available, the queued re-registration
+  // should be admitted.
+  Clock::advance(Minutes(1));
+
+  AWAIT_READY(slaveReregisteredMessage1);
+  AWAIT_READY(slaveReregisteredMessage2);
+
+  Clock::settle();
+
+  metrics = Metrics();
+  EXPECT_EQ(0, metrics.values["master/slave_reregistrations_queued"]);
+  EXPECT_EQ(0, metrics.values["master/slave_reregistrations_in_progress"]);
+  EXPECT_EQ(
+      1u,
+      metrics.values.count(
+          "master/slave_reregistration_admission_delay_ms"));
+}
+
+
 // This test ensures that a multi-role framework can receive offers
 // for different roles it subscribes with. We start two slaves and
 // launch one multi-role framework with two roles. The framework should
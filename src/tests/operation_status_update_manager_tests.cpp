@@ -14,13 +14,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <iostream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <mesos/v1/mesos.hpp>
 
 #include <process/clock.hpp>
+#include <process/collect.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/owned.hpp>
@@ -29,6 +34,7 @@
 #include <stout/os.hpp>
 #include <stout/path.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/uuid.hpp>
 
 #include <stout/os/ftruncate.hpp>
@@ -49,7 +55,13 @@ using process::Future;
 using process::Owned;
 using process::Promise;
 
+using std::cout;
+using std::endl;
 using std::string;
+using std::vector;
+
+using testing::Values;
+using testing::WithParamInterface;
 
 namespace mesos {
 namespace internal {
@@ -906,6 +918,165 @@ TEST_F(OperationStatusUpdateManagerTest, UpdateLatestWhenResending)
   AWAIT_EXPECT_EQ(expectedStatusUpdate, forwardedStatusUpdate3);
 }
 
+
+// This test verifies that with a commit interval, checkpointed updates are
+// only forwarded, and updates and acknowledgements only reported as handled,
+// once the interval elapsed and the stream files were synced.
+TEST_F(OperationStatusUpdateManagerTest, CommitInterval)
+{
+  const Duration commitInterval = Milliseconds(10);
+
+  statusUpdateManager.reset(new OperationStatusUpdateManager(commitInterval));
+
+  Future<UpdateOperationStatusMessage> forwardedStatusUpdate;
+  EXPECT_CALL(statusUpdateProcessor, update(_))
+    .WillOnce(FutureArg<0>(&forwardedStatusUpdate));
+
+  const function<void(const UpdateOperationStatusMessage&)> forward =
+    [&](const UpdateOperationStatusMessage& update) {
+      statusUpdateProcessor.update(update);
+    };
+
+  statusUpdateManager->initialize(
+      forward, OperationStatusUpdateManagerTest::getPath);
+
+  const id::UUID operationUuid = id::UUID::random();
+  const id::UUID statusUuid = id::UUID::random();
+
+  UpdateOperationStatusMessage statusUpdate =
+    createUpdateOperationStatusMessage(
+        statusUuid, operationUuid, OperationState::OPERATION_FINISHED);
+
+  Future<Nothing> update = statusUpdateManager->update(statusUpdate, true);
+
+  // The update is neither forwarded nor reported as handled until it
+  // is synced.
+  Clock::settle();
+  EXPECT_TRUE(forwardedStatusUpdate.isPending());
+  EXPECT_TRUE(update.isPending());
+
+  // A duplicate of the update is not reported as handled either.
+  Future<Nothing> duplicate = statusUpdateManager->update(statusUpdate, true);
+
+  Clock::settle();
+  EXPECT_TRUE(duplicate.isPending());
+
+  Clock::advance(commitInterval);
+
+  AWAIT_READY(forwardedStatusUpdate);
+  AWAIT_READY(update);
+  AWAIT_READY(duplicate);
+
+  Future<bool> acknowledgement =
+    statusUpdateManager->acknowledgement(operationUuid, statusUuid);
+
+  Clock::settle();
+  EXPECT_TRUE(acknowledgement.isPending());
+
+  Clock::advance(commitInterval);
+
+  // The update is terminal, so the stream is cleaned up once acknowledged.
+  AWAIT_EXPECT_FALSE(acknowledgement);
+}
+
+
+class OperationStatusUpdateManager_BENCHMARK_Test
+  : public TemporaryDirectoryTest,
+    public WithParamInterface<std::tuple<size_t, Duration>> {};
+
+
+// The operation status update manager benchmark tests are parameterized by
+// the number of streams (each with a single update) and the commit interval.
+INSTANTIATE_TEST_CASE_P(
+    StreamsAndCommitInterval,
+    OperationStatusUpdateManager_BENCHMARK_Test,
+    ::testing::Combine(
+        Values(1000U, 10000U),
+        Values(Duration::zero(), Milliseconds(1), Milliseconds(10))));
+
+
+// This benchmark measures the throughput and latency of checkpointing
+// many status updates and acknowledgements at once, e.g., when a large
+// number of operations finish together.
+TEST_P(OperationStatusUpdateManager_BENCHMARK_Test, UpdateAndAcknowledge)
+{
+  size_t streamCount;
+  Duration commitInterval;
+  std::tie(streamCount, commitInterval) = GetParam();
+
+  OperationStatusUpdateManager statusUpdateManager(commitInterval);
+
+  const string directory = os::getcwd();
+
+  statusUpdateManager.initialize(
+      [](const UpdateOperationStatusMessage&) {},
+      [directory](const id::UUID& operationUuid) {
+        return path::join(directory, "streams", operationUuid.toString());
+      });
+
+  vector<UpdateOperationStatusMessage> updates;
+  for (size_t i = 0; i < streamCount; i++) {
+    UpdateOperationStatusMessage update;
+
+    update.mutable_operation_uuid()->CopyFrom(
+        protobuf::createUUID(id::UUID::random()));
+
+    OperationStatus* status = update.mutable_status();
+    status->set_state(OperationState::OPERATION_FINISHED);
+    status->mutable_uuid()->CopyFrom(protobuf::createUUID(id::UUID::random()));
+
+    updates.push_back(update);
+  }
+
+  // The latency of each update, from sending it to it being reported as
+  // handled. The callbacks write to distinct elements.
+  vector<Duration> latencies(streamCount);
+
+  Stopwatch watch;
+  watch.start();
+
+  vector<Future<Nothing>> handled;
+  for (size_t i = 0; i < streamCount; i++) {
+    Stopwatch latency;
+    latency.start();
+
+    handled.push_back(statusUpdateManager.update(updates[i])
+      .onReady([&latencies, latency, i]() mutable {
+        latencies[i] = latency.elapsed();
+      }));
+  }
+
+  AWAIT_READY_FOR(process::collect(handled), Minutes(5));
+
+  watch.stop();
+
+  std::sort(latencies.begin(), latencies.end());
+
+  cout << "Checkpointed " << streamCount << " status updates with a commit"
+       << " interval of " << commitInterval << " in " << watch.elapsed()
+       << " (" << streamCount / watch.elapsed().secs() << " updates/s,"
+       << " median latency " << latencies[streamCount / 2]
+       << ", 99th percentile latency " << latencies[streamCount * 99 / 100]
+       << ")" << endl;
+
+  watch.start();
+
+  vector<Future<bool>> acknowledged;
+  foreach (const UpdateOperationStatusMessage& update, updates) {
+    acknowledged.push_back(statusUpdateManager.acknowledgement(
+        id::UUID::fromBytes(update.operation_uuid().value()).get(),
+        id::UUID::fromBytes(update.status().uuid().value()).get()));
+  }
+
+  AWAIT_READY_FOR(process::collect(acknowledged), Minutes(5));
+
+  watch.stop();
+
+  cout << "Checkpointed " << streamCount << " acknowledgements with a commit"
+       << " interval of " << commitInterval << " in " << watch.elapsed()
+       << " (" << streamCount / watch.elapsed().secs() << " acks/s)" << endl;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
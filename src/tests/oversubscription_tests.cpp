@@ -45,6 +45,9 @@
 #include "slave/flags.hpp"
 #include "slave/slave.hpp"
 #include "slave/qos_controllers/load.hpp"
+#include "slave/qos_controllers/pressure.hpp"
+
+#include "slave/resource_estimators/usage.hpp"
 
 #include "tests/flags.hpp"
 #include "tests/containerizer.hpp"
@@ -60,7 +63,9 @@ using mesos::internal::master::Master;
 using mesos::internal::protobuf::createLabel;
 
 using mesos::internal::slave::LoadQoSController;
+using mesos::internal::slave::PressureQoSController;
 using mesos::internal::slave::Slave;
+using mesos::internal::slave::UsageResourceEstimator;
 
 using mesos::master::detector::MasterDetector;
 using mesos::master::detector::StandaloneMasterDetector;
@@ -1513,6 +1518,189 @@ TEST_F(OversubscriptionTest, LoadQoSController)
 }
 
 
+// This test verifies the functionality of the Pressure QoS Controller
+// with simulated statistics: revocable executors should be evicted once
+// a latency sensitive executor is throttled or stalled for the
+// configured number of consecutive corrections, largest first.
+TEST_F(OversubscriptionTest, PressureQoSController)
+{
+  PressureQoSController::Config config;
+  config.cpuThrottledThreshold = 0.1;
+  config.cpuPressureThreshold = 20;
+  config.latencySensitiveLabel = "latency_sensitive";
+  config.interferenceIntervals = 2;
+  config.maxEvictions = 1;
+
+  PressureQoSController controller(config);
+
+  // The statistics of the latency sensitive executor and of a regular
+  // non-revocable executor, which is not protected.
+  ResourceStatistics sensitive = createResourceStatistics();
+  ResourceStatistics regular = createResourceStatistics();
+
+  controller.initialize([&]() -> Future<ResourceUsage> {
+    ResourceUsage usage;
+
+    auto addExecutor = [&](
+        const string& executorId,
+        const Resources& resources,
+        const ResourceStatistics& statistics) {
+      ResourceUsage::Executor* executor = usage.add_executors();
+      executor->mutable_executor_info()->CopyFrom(
+          createExecutorInfo("framework", executorId));
+      executor->mutable_allocated()->CopyFrom(resources);
+      executor->mutable_statistics()->CopyFrom(statistics);
+      executor->mutable_container_id()->set_value(executorId);
+      return executor;
+    };
+
+    ResourceUsage::Executor* executor = addExecutor(
+        "sensitive", Resources::parse("cpus:2;mem:128").get(), sensitive);
+
+    Label* label = executor->add_tasks()->mutable_labels()->add_labels();
+    label->set_key("latency_sensitive");
+
+    addExecutor("regular", Resources::parse("cpus:2;mem:128").get(), regular);
+
+    addExecutor(
+        "revocable1",
+        createRevocableResources("cpus", "1"),
+        createResourceStatistics());
+
+    addExecutor(
+        "revocable2",
+        createRevocableResources("cpus", "7"),
+        createResourceStatistics());
+
+    return usage;
+  });
+
+  // The first correction has no previous statistics to compare with.
+  Future<list<QoSCorrection>> qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  // The latency sensitive executor gets throttled in half of its cpu
+  // periods, which has to be seen twice before evicting.
+  sensitive.set_cpus_nr_periods(200);
+  sensitive.set_cpus_nr_throttled(52);
+
+  qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  sensitive.set_cpus_nr_periods(300);
+  sensitive.set_cpus_nr_throttled(102);
+
+  qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  ASSERT_EQ(1u, qosCorrections->size());
+  EXPECT_EQ(
+      "revocable2", qosCorrections->front().kill().executor_id().value());
+  EXPECT_EQ(
+      "revocable2", qosCorrections->front().kill().container_id().value());
+
+  // The throttling stops, and the regular executor stalling on cpu does
+  // not cause any eviction.
+  sensitive.set_cpus_nr_periods(400);
+  regular.mutable_cpu_pressure()->mutable_some()->set_avg10(80);
+
+  qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  // The latency sensitive executor stalling on cpu does, once it was
+  // seen for two corrections again.
+  sensitive.mutable_cpu_pressure()->mutable_some()->set_avg10(30);
+
+  qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  EXPECT_TRUE(qosCorrections->empty());
+
+  qosCorrections = controller.corrections();
+  AWAIT(qosCorrections);
+  ASSERT_EQ(1u, qosCorrections->size());
+  EXPECT_EQ(
+      "revocable2", qosCorrections->front().kill().executor_id().value());
+}
+
+
+// This test verifies that the usage resource estimator oversubscribes
+// the allocation of the non-revocable executors minus the safety margin
+// and the percentile of their sampled usage, once enough samples were
+// taken, and that the allocated revocable resources are subtracted.
+TEST_F(OversubscriptionTest, UsageResourceEstimator)
+{
+  Clock::pause();
+
+  UsageResourceEstimator::Config config;
+  config.samplingInterval = Seconds(1);
+  config.window = Seconds(10);
+  config.percentile = 90;
+  config.cpusMargin = 0.1;
+  config.memMargin = 0.1;
+  config.minSamples = 5;
+
+  UsageResourceEstimator estimator(config);
+
+  // Simulate an executor using one cpu and 256MB, sampled every second.
+  double seconds = 0;
+
+  estimator.initialize([&]() -> Future<ResourceUsage> {
+    ResourceUsage usage;
+
+    ResourceStatistics statistics;
+    statistics.set_timestamp(seconds);
+    statistics.set_cpus_user_time_secs(seconds);
+    statistics.set_cpus_system_time_secs(0);
+    statistics.set_mem_rss_bytes(Megabytes(256).bytes());
+
+    seconds += 1;
+
+    ResourceUsage::Executor* executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor1"));
+    executor->mutable_allocated()->CopyFrom(
+        Resources::parse("cpus:4;mem:1024").get());
+    executor->mutable_statistics()->CopyFrom(statistics);
+    executor->mutable_container_id()->set_value("container1");
+
+    executor = usage.add_executors();
+    executor->mutable_executor_info()->CopyFrom(
+        createExecutorInfo("framework", "executor2"));
+    executor->mutable_allocated()->CopyFrom(
+        createRevocableResources("cpus", "0.5"));
+    executor->mutable_container_id()->set_value("container2");
+
+    return usage;
+  });
+
+  Clock::settle();
+
+  // Nothing is oversubscribed until enough samples were taken.
+  Future<Resources> resources = estimator.oversubscribable();
+  AWAIT_READY(resources);
+  EXPECT_TRUE(resources->empty());
+
+  for (int i = 0; i < 10; i++) {
+    Clock::advance(config.samplingInterval);
+    Clock::settle();
+  }
+
+  resources = estimator.oversubscribable();
+  AWAIT_READY(resources);
+
+  // The slack is 4 * 0.9 - 1 cpus, minus the 0.5 revocable cpus which
+  // are already allocated, and 1024MB * 0.9 - 256MB, rounded down.
+  EXPECT_EQ(
+      createRevocableResources("cpus", "2.1") +
+        createRevocableResources("mem", "665"),
+      resources.get());
+
+  Clock::resume();
+}
+
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -392,6 +392,71 @@ TEST_F(RegistrarTest, MarkUnreachable)
 }
 
 
+// Verify that a batch of reregistering slaves is applied like the
+// corresponding `UpdateSlave` and `MarkSlaveReachable` operations.
+TEST_F(RegistrarTest, ReadmitSlaves)
+{
+  SlaveInfo info1;
+  info1.set_hostname("localhost");
+  info1.mutable_id()->set_value("1");
+
+  SlaveInfo info2;
+  info2.set_hostname("localhost");
+  info2.mutable_id()->set_value("2");
+
+  SlaveInfo info3;
+  info3.set_hostname("localhost");
+  info3.mutable_id()->set_value("3");
+
+  // This slave is neither admitted nor unreachable.
+  SlaveInfo info4;
+  info4.set_hostname("localhost");
+  info4.mutable_id()->set_value("4");
+
+  {
+    Registrar registrar(flags, state);
+    AWAIT_READY(registrar.recover(master));
+
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new AdmitSlave(info1))));
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new AdmitSlave(info2))));
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new AdmitSlave(info3))));
+
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new MarkSlaveUnreachable(info2, protobuf::getCurrentTime()))));
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new MarkSlaveUnreachable(info3, protobuf::getCurrentTime()))));
+
+    // Slaves which are admitted already, or more than once in the
+    // batch, are only marked reachable once.
+    info1.set_hostname("changed");
+    AWAIT_TRUE(registrar.apply(Owned<RegistryOperation>(
+        new ReadmitSlaves({info1}, {info2, info4, info2, info1}))));
+  }
+
+  {
+    Registrar registrar(flags, state);
+    Future<Registry> registry = registrar.recover(master);
+    AWAIT_READY(registry);
+
+    ASSERT_EQ(3, registry->slaves().slaves().size());
+    EXPECT_EQ(info1.id(), registry->slaves().slaves(0).info().id());
+    EXPECT_EQ("changed", registry->slaves().slaves(0).info().hostname());
+    EXPECT_EQ(info2.id(), registry->slaves().slaves(1).info().id());
+    EXPECT_EQ(info4.id(), registry->slaves().slaves(2).info().id());
+
+    ASSERT_EQ(1, registry->unreachable().slaves().size());
+    EXPECT_EQ(info3.id(), registry->unreachable().slaves(0).id());
+
+    // Updating a slave which is not admitted fails the whole batch.
+    AWAIT_FALSE(registrar.apply(Owned<RegistryOperation>(
+        new ReadmitSlaves({info3, info1}, {}))));
+  }
+}
+
+
 // Verify that an admitted slave can be marked as gone.
 TEST_F(RegistrarTest, MarkGone)
 {
@@ -2099,6 +2164,21 @@ TEST_P(Registrar_BENCHMARK_Test, MarkUnreachableThenReachable)
   AWAIT_READY_FOR(result, Minutes(5));
   cout << "Marked " << slaveCount << " agents reachable in "
        << watch.elapsed() << endl;
+
+  // Mark all slaves unreachable again, and then reachable in a single
+  // batch, as the master does for agents which reregister concurrently.
+  foreach (const SlaveInfo& info, infos) {
+    result = registrar.apply(Owned<RegistryOperation>(
+        new MarkSlaveUnreachable(info, unreachableTime)));
+  }
+  AWAIT_READY_FOR(result, Minutes(5));
+
+  watch.start();
+  result = registrar.apply(Owned<RegistryOperation>(
+      new ReadmitSlaves(vector<SlaveInfo>(), infos)));
+  AWAIT_READY_FOR(result, Minutes(5));
+  cout << "Marked " << slaveCount << " agents reachable in a single batch in "
+       << watch.elapsed() << endl;
 }
 
 
@@ -14,6 +14,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,7 @@
 
 #include <stout/check.hpp>
 #include <stout/gtest.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
@@ -28,6 +30,10 @@
 #include <mesos/resource_quantities.hpp>
 #include <mesos/values.hpp>
 
+#include "common/resource_names.hpp"
+
+using std::cout;
+using std::endl;
 using std::pair;
 using std::string;
 using std::vector;
@@ -355,6 +361,89 @@ TEST(QuantitiesTest, Sum)
 }
 
 
+// Custom resource names are kept apart from the first-class ones,
+// but iteration must still visit all names in alphabetical order.
+TEST(QuantitiesTest, CustomNames)
+{
+  ResourceQuantities quantities = CHECK_NOTERROR(ResourceQuantities::fromString(
+      "zones:1;cpus:2;foo:3;network_bandwidth:4;a:5;mem:6"));
+
+  vector<pair<string, double>> expected = {
+    {"a", 5},
+    {"cpus", 2},
+    {"foo", 3},
+    {"mem", 6},
+    {"network_bandwidth", 4},
+    {"zones", 1}
+  };
+  EXPECT_EQ(expected, toVector(quantities));
+  EXPECT_EQ(6u, quantities.size());
+
+  EXPECT_EQ(3, quantities.get("foo").value());
+  EXPECT_EQ(0, quantities.get("bar").value());
+
+  // The order of insertion does not matter.
+  EXPECT_EQ(
+      quantities,
+      CHECK_NOTERROR(ResourceQuantities::fromString(
+          "mem:6;a:5;network_bandwidth:4;foo:3;cpus:2;zones:1")));
+
+  ResourceQuantities custom =
+    CHECK_NOTERROR(ResourceQuantities::fromString("foo:1;zones:1"));
+
+  quantities -= custom;
+  expected = {
+    {"a", 5},
+    {"cpus", 2},
+    {"foo", 2},
+    {"mem", 6},
+    {"network_bandwidth", 4}
+  };
+  EXPECT_EQ(expected, toVector(quantities));
+  EXPECT_FALSE(quantities.contains(custom));
+
+  quantities += custom;
+  EXPECT_TRUE(quantities.contains(custom));
+
+  quantities -= quantities;
+  EXPECT_TRUE(quantities.empty());
+}
+
+
+// Looking up a name which was never interned must not intern it, so
+// that arbitrary lookups do not grow the registry of resource names,
+// which is shared with `Resources`.
+TEST(QuantitiesTest, LookupDoesNotIntern)
+{
+  const string name = "quantities_test_lookup_only";
+
+  ResourceQuantities quantities =
+    CHECK_NOTERROR(ResourceQuantities::fromString("cpus:1"));
+
+  ResourceLimits limits = CHECK_NOTERROR(ResourceLimits::fromString("cpus:1"));
+
+  EXPECT_EQ(0, quantities.get(name).value());
+  EXPECT_NONE(limits.get(name));
+  EXPECT_NONE(ResourceNames::lookup(name));
+
+  Resources resources = CHECK_NOTERROR(Resources::parse(name + ":1"));
+
+  Option<ResourceNames::Name> interned = ResourceNames::lookup(name);
+  ASSERT_SOME(interned);
+  EXPECT_EQ(ResourceNames::intern(name).id, interned->id);
+  EXPECT_EQ(name, *interned->name);
+
+  // The reserved names are always interned.
+  Option<ResourceNames::Name> cpus = ResourceNames::lookup("cpus");
+  ASSERT_SOME(cpus);
+
+  EXPECT_SOME_EQ(1.0, quantities.find(cpus->id));
+  EXPECT_SOME_EQ(1.0, limits.find(cpus->id));
+  EXPECT_NONE(quantities.find(interned->id));
+  EXPECT_NONE(limits.find(interned->id));
+}
+
+
 static vector<pair<string, double>> toVector(
   const ResourceLimits& limits)
 {
@@ -574,6 +663,89 @@ TEST(LimitsTest, SubtractQuantities)
 }
 
 
+class ResourceQuantities_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<string> {};
+
+
+// The benchmark is parameterized by the quantities to operate on,
+// with and without custom resource names.
+INSTANTIATE_TEST_CASE_P(
+    Quantities,
+    ResourceQuantities_BENCHMARK_Test,
+    ::testing::Values(
+        "cpus:1;mem:128;disk:256;gpus:1",
+        "cpus:1;mem:128;disk:256;gpus:1;network_bandwidth:100",
+        "cpus:1;mem:128;disk:256;ports:100;custom_a:1;custom_b:1"));
+
+
+TEST_P(ResourceQuantities_BENCHMARK_Test, Arithmetic)
+{
+  const ResourceQuantities quantities =
+    CHECK_NOTERROR(ResourceQuantities::fromString(GetParam()));
+
+  const size_t totalOperations = 1000000;
+
+  ResourceQuantities total;
+  Stopwatch watch;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total += quantities;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total += q' operations"
+       << " on " << quantities << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    if (!total.contains(quantities)) {
+      break;
+    }
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total.contains(q)'"
+       << " operations on " << quantities << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total -= quantities;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total -= q' operations"
+       << " on " << quantities << endl;
+
+  ASSERT_TRUE(total.empty()) << total;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total = total + quantities;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total = total + q'"
+       << " operations on " << quantities << endl;
+
+  watch.start();
+  for (size_t i = 0; i < totalOperations; i++) {
+    total = total - quantities;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed()
+       << " to perform " << totalOperations << " 'total = total - q'"
+       << " operations on " << quantities << endl;
+
+  ASSERT_TRUE(total.empty()) << total;
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
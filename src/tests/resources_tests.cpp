@@ -33,6 +33,7 @@
 
 #include <mesos/v1/resources.hpp>
 
+#include "common/resources_index.hpp"
 #include "common/resources_utils.hpp"
 
 #include "internal/evolve.hpp"
@@ -2353,6 +2354,35 @@ TEST(ReservedResourcesTest, AdditionDynamicallyReservedWithSameLabels)
 }
 
 
+// Labels are compared irrespective of their order, so reservations
+// whose labels only differ in their order must be combined.
+TEST(ReservedResourcesTest, AdditionDynamicallyReservedWithReorderedLabels)
+{
+  Labels labels1;
+  labels1.add_labels()->CopyFrom(createLabel("foo", "bar"));
+  labels1.add_labels()->CopyFrom(createLabel("baz", "qux"));
+
+  Labels labels2;
+  labels2.add_labels()->CopyFrom(createLabel("baz", "qux"));
+  labels2.add_labels()->CopyFrom(createLabel("foo", "bar"));
+
+  Resources left = createReservedResource(
+      "cpus", "8", createDynamicReservationInfo("role", "principal", labels1));
+  Resources right = createReservedResource(
+      "cpus", "4", createDynamicReservationInfo("role", "principal", labels2));
+
+  Resources sum = left + right;
+
+  EXPECT_EQ(1u, sum.size());
+  EXPECT_EQ(12, sum.cpus().get());
+  EXPECT_TRUE(sum.contains(right));
+
+  sum -= right;
+
+  EXPECT_EQ(left, sum);
+}
+
+
 TEST(ReservedResourcesTest, AdditionDynamicallyReservedWithDistinctLabels)
 {
   Labels labels1;
@@ -3121,6 +3151,138 @@ TEST(ResourcesOperationTest, FlattenResources)
 }
 
 
+// This test verifies that `ResourcesIndex` checks containment with the
+// same semantics as `Resources`.
+TEST(ResourcesIndexTest, Contains)
+{
+  Resources total = Resources::parse("cpus:4;mem:1024;ports:[1000-2000]").get();
+  total += createReservedResource(
+      "cpus", "2", createDynamicReservationInfo("role", "principal"));
+
+  Resource volume1 = createDiskResource("64", "role", "1", "path1");
+  Resource volume2 = createDiskResource("64", "role", "2", "path2");
+  Resource shared = createDiskResource(
+      "64", "role", "3", "path3", None(), true);
+
+  total += volume1;
+  total += shared;
+  total += Resources::parse("disk(role):128").get();
+
+  ResourcesIndex index(total);
+
+  vector<Resources> candidates = {
+    Resources::parse("cpus:1;mem:512;ports:[1500-1600]").get(),
+    Resources::parse("cpus:5").get(),
+    Resources::parse("ports:[1900-2100]").get(),
+    Resources::parse("gpus:1").get(),
+    createReservedResource(
+        "cpus", "2", createDynamicReservationInfo("role", "principal")),
+    createReservedResource(
+        "cpus", "1", createDynamicReservationInfo("role", "other")),
+    volume1,
+    volume2,
+    Resources(volume1) + Resources::parse("disk(role):128").get(),
+    Resources(shared) + shared,
+    Resources::parse("disk(role):256").get()
+  };
+
+  foreach (const Resources& candidate, candidates) {
+    EXPECT_EQ(total.contains(candidate), index.contains(candidate))
+      << candidate;
+  }
+
+  EXPECT_TRUE(index.contains(total));
+  EXPECT_FALSE(index.contains(total + volume2));
+}
+
+
+// This test verifies that `ResourcesIndex` arithmetic matches the
+// arithmetic of `Resources`.
+TEST(ResourcesIndexTest, Arithmetic)
+{
+  Resources total = Resources::parse("cpus:4;mem:1024;ports:[1000-2000]").get();
+
+  Resource volume = createDiskResource("64", "role", "1", "path1");
+  Resource shared = createDiskResource(
+      "64", "role", "2", "path2", None(), true);
+
+  total += volume;
+  total += shared;
+  total += shared;
+
+  ResourcesIndex index(total);
+  EXPECT_EQ(total, index.resources());
+
+  Resources consumed = Resources::parse("cpus:1;ports:[1000-1099]").get();
+  consumed += volume;
+  consumed += shared;
+
+  index -= consumed;
+  EXPECT_EQ(total - consumed, index.resources());
+  EXPECT_EQ((total - consumed).shared(), index.shared());
+  EXPECT_EQ((total - consumed).nonShared(), index.nonShared());
+
+  index += consumed;
+  EXPECT_EQ(total, index.resources());
+
+  index -= total;
+  EXPECT_TRUE(index.empty());
+}
+
+
+// This test verifies that applying conversions to a `ResourcesIndex`
+// matches `Resources::apply()` and leaves the index unchanged on error.
+TEST(ResourcesIndexTest, Apply)
+{
+  Resources total = Resources::parse("cpus:4;mem:1024;disk(role):1000").get();
+
+  Resources reserved = createReservedResource(
+      "cpus", "1", createDynamicReservationInfo("role", "principal"));
+
+  vector<ResourceConversion> reserve = {
+    ResourceConversion(reserved.toUnreserved(), reserved)
+  };
+
+  Resource volume = createDiskResource("200", "role", "1", "path");
+
+  vector<ResourceConversion> create = {
+    ResourceConversion(
+        Resources::parse("disk(role):200").get(), Resources(volume))
+  };
+
+  Try<Resources> expected = total.apply(reserve);
+  ASSERT_SOME(expected);
+  expected = expected->apply(create);
+  ASSERT_SOME(expected);
+
+  // Applying the conversions one at a time and all at once must
+  // both yield the same result as `Resources::apply()`.
+  ResourcesIndex index(total);
+
+  EXPECT_SOME(index.apply(reserve));
+  EXPECT_SOME(index.apply(create));
+  EXPECT_EQ(expected.get(), index.resources());
+
+  ResourcesIndex batch(total);
+
+  EXPECT_SOME(batch.apply({reserve[0], create[0]}));
+  EXPECT_EQ(expected.get(), batch.resources());
+
+  // Check the case of insufficient unreserved resources.
+  Resources reserved2 = createReservedResource(
+      "cpus", "8", createDynamicReservationInfo("role", "principal"));
+
+  EXPECT_ERROR(index.apply(
+      {ResourceConversion(reserved2.toUnreserved(), reserved2)}));
+
+  EXPECT_ERROR(index.apply(
+      {ResourceConversion(reserved.toUnreserved(), reserved),
+       ResourceConversion(reserved2.toUnreserved(), reserved2)}));
+
+  EXPECT_EQ(expected.get(), index.resources());
+}
+
+
 // Helper for creating a revocable resource.
 static Resource createRevocableResource(
     const string& name,
@@ -3584,6 +3746,92 @@ TEST(ResourcesTest, Count)
 }
 
 
+// Copies of `Resources` share their resources until one of them is
+// mutated, so mutating a copy must leave the original intact, and
+// vice versa.
+TEST(ResourcesTest, CopyIsolation)
+{
+  const Resources expected =
+    Resources::parse("cpus:1;mem:128;ports:[31000-31009]").get();
+
+  Resources original = expected;
+
+  // `+=` of resources which are merged with the existing ones.
+  Resources copy = original;
+  copy += Resources::parse("cpus:2;ports:[31010-31019]").get();
+
+  EXPECT_EQ(expected, original);
+  EXPECT_EQ(
+      Resources::parse("cpus:3;mem:128;ports:[31000-31019]").get(), copy);
+
+  // `+=` of a single resource.
+  copy = original;
+  copy += Resources::parse("mem", "64", "*").get();
+
+  EXPECT_EQ(expected, original);
+  EXPECT_SOME_EQ(Megabytes(192), copy.mem());
+
+  // `-=` of resources which are partially subtracted.
+  copy = original;
+  copy -= Resources::parse("cpus:0.5;ports:[31000-31004]").get();
+
+  EXPECT_EQ(expected, original);
+  EXPECT_EQ(
+      Resources::parse("cpus:0.5;mem:128;ports:[31005-31009]").get(), copy);
+
+  // `-=` of a single resource which is entirely subtracted.
+  copy = original;
+  copy -= Resources::parse("cpus", "1", "*").get();
+
+  EXPECT_EQ(expected, original);
+  EXPECT_NONE(copy.cpus());
+
+  // In-place mutators.
+  copy = original;
+  copy.allocate("role");
+
+  EXPECT_EQ(expected, original);
+  EXPECT_NE(expected, copy);
+
+  foreach (const Resource& resource, original) {
+    EXPECT_FALSE(resource.has_allocation_info());
+  }
+
+  foreach (const Resource& resource, copy) {
+    EXPECT_TRUE(resource.has_allocation_info());
+  }
+
+  copy.unallocate();
+
+  EXPECT_EQ(expected, copy);
+
+  // Mutating the original leaves the copy intact.
+  copy = original;
+  original += Resources::parse("cpus:1").get();
+  original.allocate("role");
+
+  EXPECT_EQ(expected, copy);
+
+  // Shared resources are counted in place.
+  Resource disk = createDiskResource(
+      "100", "role1", "1", "path1", None(), true);
+
+  const Resources shared(disk);
+
+  copy = shared;
+  copy += disk;
+
+  EXPECT_EQ(1u, shared.count(disk));
+  EXPECT_EQ(2u, copy.count(disk));
+
+  copy -= disk;
+  copy -= disk;
+
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(1u, shared.count(disk));
+}
+
+
 TEST(ResourcesTest, Evolve)
 {
   string resourcesString = "cpus(role1):2;mem(role1):10;cpus:4;mem:20";
@@ -4137,6 +4385,127 @@ TEST_F(Resources_Filter_BENCHMARK_Test, Filters)
 }
 
 
+class Resources_Copy_BENCHMARK_Test : public ::testing::Test {};
+
+
+// This benchmark stores copies of the resources of 50k tasks, similar
+// to what the master does for tasks, frameworks and agents, and then
+// mutates the copies, which is when the resources of each copy are
+// actually copied.
+TEST_F(Resources_Copy_BENCHMARK_Test, Copy)
+{
+  const size_t tasks = 50000;
+
+  Resources resources =
+    Resources::parse("cpus:1;gpus:1;mem:128;disk:256;ports:[31000-31009]")
+      .get();
+
+  resources.allocate("role");
+
+  vector<Resources> copies;
+  copies.reserve(tasks);
+
+  Stopwatch watch;
+
+  watch.start();
+  for (size_t i = 0; i < tasks; i++) {
+    copies.push_back(resources);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to store " << tasks
+       << " copies of " << stringify(resources) << endl;
+
+  Resources total;
+
+  watch.start();
+  foreach (const Resources& copy, copies) {
+    total += copy;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to sum up " << tasks
+       << " copies of " << stringify(resources) << endl;
+
+  watch.start();
+  foreach (Resources& copy, copies) {
+    copy.unallocate();
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to unallocate " << tasks
+       << " copies of " << stringify(resources) << endl;
+
+  // The original resources must not be affected by the mutations.
+  Resources unallocated = resources;
+  unallocated.unallocate();
+
+  EXPECT_EQ(unallocated, copies.back());
+  EXPECT_NE(resources, copies.back());
+}
+
+
+class ResourceFormat_BENCHMARK_Test
+  : public ::testing::Test,
+    public ::testing::WithParamInterface<ResourceFormat> {};
+
+
+// The benchmark is parameterized by the format of the resources in
+// the message to upgrade.
+INSTANTIATE_TEST_CASE_P(
+    ResourceFormats,
+    ResourceFormat_BENCHMARK_Test,
+    ::testing::Values(PRE_RESERVATION_REFINEMENT, POST_RESERVATION_REFINEMENT));
+
+
+// This benchmark measures the conversion of the resources within a
+// `ReregisterSlaveMessage` of 10k resources, which is what the master
+// does upon agent reregistration.
+TEST_P(ResourceFormat_BENCHMARK_Test, ReregisterSlaveMessage)
+{
+  const size_t tasks = 2500;
+  const size_t iterations = 10;
+
+  Resources resources =
+    Resources::parse("cpus(role):1;mem(role):128;disk:256").get() +
+    Resources::parse("ports:[31000-31001]").get().pushReservation(
+        createDynamicReservationInfo("role", "principal"));
+
+  RepeatedPtrField<Resource> taskResources = resources;
+  convertResourceFormat(&taskResources, GetParam());
+
+  ReregisterSlaveMessage message;
+
+  for (size_t i = 0; i < tasks; i++) {
+    Task* task = message.add_tasks();
+    task->set_name("task-" + stringify(i));
+    task->mutable_resources()->CopyFrom(taskResources);
+  }
+
+  vector<ReregisterSlaveMessage> messages(iterations, message);
+
+  Stopwatch watch;
+
+  watch.start();
+  foreach (ReregisterSlaveMessage& message, messages) {
+    upgradeResources(&message);
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() / iterations << " to upgrade "
+       << tasks * resources.size() << " resources of a message" << endl;
+
+  watch.start();
+  foreach (ReregisterSlaveMessage& message, messages) {
+    ASSERT_SOME(downgradeResources(&message));
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() / iterations << " to downgrade "
+       << tasks * resources.size() << " resources of a message" << endl;
+}
+
+
 struct ContainsParameter
 {
   Resources subset;
@@ -4424,6 +4793,61 @@ TEST_P(Resources_Ranges_BENCHMARK_Test, ArithmeticOverlapping)
   printResult("a - b", watch.elapsed());
 }
 
+
+// This test benchmarks the offer computation of an agent advertising
+// `ports:[1025-65000]` which runs tasks with fragmented port sets. Here
+// the parameter is the number of tasks, each of which uses two ports.
+TEST_P(Resources_Ranges_BENCHMARK_Test, FragmentedAgentPorts)
+{
+  const size_t tasks = GetParam();
+
+  const Resources total = Resources::parse("ports:[1025-65000]").get();
+
+  vector<Resources> used;
+  used.reserve(tasks);
+
+  // Spread the ports of the tasks over the whole range, so that each
+  // task fragments the ports of the agent further.
+  const uint64_t stride = (65000 - 1025) / tasks;
+
+  for (size_t i = 0; i < tasks; i++) {
+    const uint64_t port = 1025 + i * stride;
+
+    Value::Ranges ranges;
+    *ranges.add_range() = createRange(port, port);
+    *ranges.add_range() = createRange(port + stride / 2, port + stride / 2);
+
+    used.push_back(createPorts(ranges));
+  }
+
+  Stopwatch watch;
+
+  // Compute the available ports as the tasks are launched.
+  Resources available = total;
+
+  watch.start();
+  foreach (const Resources& resources, used) {
+    ASSERT_TRUE(available.contains(resources));
+    available -= resources;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to launch " << tasks
+       << " tasks on " << total << endl;
+
+  // Compute the available ports as the tasks terminate.
+  watch.start();
+  foreach (const Resources& resources, used) {
+    available += resources;
+  }
+  watch.stop();
+
+  cout << "Took " << watch.elapsed() << " to terminate " << tasks
+       << " tasks on " << total << endl;
+
+  EXPECT_EQ(total, available);
+}
+
 } // namespace tests {
 } // namespace internal {
 } // namespace mesos {
@@ -14,10 +14,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
 #include <mesos/http.hpp>
+#include <mesos/resource_quantities.hpp>
 #include <mesos/roles.hpp>
 
 #include <process/clock.hpp>
@@ -30,6 +32,8 @@
 #include <stout/none.hpp>
 #include <stout/nothing.hpp>
 
+#include "master/role_tree.hpp"
+
 #include "tests/containerizer.hpp"
 #include "tests/mesos.hpp"
 #include "tests/resources_utils.hpp"
@@ -1204,6 +1208,55 @@ TEST_F(RoleTest, Ancestors)
 }
 
 
+// This test checks that the master's role tree aggregates resources
+// over role subtrees and drops roles once their resources are gone.
+TEST_F(RoleTest, RoleTreeAggregation)
+{
+  master::RoleTree tree;
+
+  const Resources unreserved = Resources::parse("cpus:2;mem:10").get();
+  const Resources reserved = Resources::parse("cpus(a/b):1").get();
+
+  tree.addAllocated(allocatedResources(unreserved, "a/b"));
+  tree.addAllocated(allocatedResources(unreserved, "a/c"));
+  tree.addReserved(reserved);
+
+  EXPECT_EQ(vector<string>({"a", "a/b", "a/c"}), [&]() {
+    vector<string> roles = tree.roles();
+    std::sort(roles.begin(), roles.end());
+    return roles;
+  }());
+
+  EXPECT_EQ(
+      ResourceQuantities::fromString("cpus:4;mem:20").get(),
+      tree.get("a").allocated);
+
+  EXPECT_EQ(
+      ResourceQuantities::fromString("cpus:2;mem:10").get(),
+      tree.get("a/b").allocated);
+
+  EXPECT_EQ(
+      ResourceQuantities::fromString("cpus:1").get(),
+      tree.get("a").reserved);
+
+  EXPECT_TRUE(tree.get("a/c").reserved.empty());
+  EXPECT_TRUE(tree.get("unknown").empty());
+
+  tree.removeAllocated(allocatedResources(unreserved, "a/c"));
+
+  EXPECT_EQ(vector<string>({"a", "a/b"}), [&]() {
+    vector<string> roles = tree.roles();
+    std::sort(roles.begin(), roles.end());
+    return roles;
+  }());
+
+  tree.removeAllocated(allocatedResources(unreserved, "a/b"));
+  tree.removeReserved(reserved);
+
+  EXPECT_TRUE(tree.roles().empty());
+}
+
+
 // This tests the validate functions of roles. Keep in mind that
 // roles::validate returns Option<Error>, so it will return None() when
 // validation succeeds, or Error() when validation fails.
@@ -157,6 +157,105 @@ TEST_F(SlaveStateTest, CheckpointRepeatedProtobufMessages)
 }
 
 
+#ifndef __WINDOWS__
+TEST_F(SlaveStateTest, CheckpointStore)
+{
+  const string metaDir = paths::getMetaRootDir(os::getcwd());
+
+  SlaveID slaveId;
+  slaveId.set_value("agent1");
+
+  FrameworkID frameworkId;
+  frameworkId.set_value("framework1");
+
+  SlaveInfo slaveInfo;
+  slaveInfo.set_hostname("localhost");
+  slaveInfo.mutable_id()->CopyFrom(slaveId);
+
+  const string slaveInfoPath = paths::getSlaveInfoPath(metaDir, slaveId);
+  const string frameworkInfoPath =
+    paths::getFrameworkInfoPath(metaDir, slaveId, frameworkId);
+  const string frameworkPidPath =
+    paths::getFrameworkPidPath(metaDir, slaveId, frameworkId);
+
+  // Checkpoint into files, which are imported when the store is opened.
+  ASSERT_SOME(slave::state::checkpoint(slaveInfoPath, slaveInfo));
+  ASSERT_SOME(slave::state::checkpoint(frameworkPidPath, string("pid")));
+
+  Try<std::shared_ptr<slave::state::CheckpointStore>> store =
+    slave::state::CheckpointStore::create(metaDir);
+
+  ASSERT_SOME(store);
+
+  EXPECT_FALSE(os::exists(slaveInfoPath));
+  EXPECT_FALSE(os::exists(frameworkPidPath));
+  EXPECT_TRUE(slave::state::exists(store->get(), slaveInfoPath));
+  EXPECT_SOME_EQ(
+      slaveInfo,
+      slave::state::read<SlaveInfo>(store->get(), slaveInfoPath));
+  EXPECT_SOME_EQ(
+      "pid",
+      slave::state::read<string>(store->get(), frameworkPidPath));
+
+  // The frameworks are found from the keys of the store.
+  EXPECT_EQ(
+      std::list<string>{paths::getFrameworkPath(metaDir, slaveId, frameworkId)},
+      store->get()->list(path::join(
+          paths::getSlavePath(metaDir, slaveId), paths::FRAMEWORKS_DIR)));
+
+  // Checkpoints which are not kept in the store still go to files.
+  const string resourcesPath = paths::getResourcesInfoPath(metaDir);
+  const Resources resources = Resources::parse("cpus:2;mem:512").get();
+
+  ASSERT_SOME(
+      slave::state::checkpoint(store->get(), resourcesPath, resources));
+  EXPECT_TRUE(os::exists(resourcesPath));
+  EXPECT_SOME_EQ(resources, slave::state::read<Resources>(resourcesPath));
+
+  // Updates, batches and removals are persisted across reopening the
+  // store.
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.mutable_id()->CopyFrom(frameworkId);
+
+  slave::state::Checkpoints checkpoints(store->get());
+  ASSERT_SOME(checkpoints.add(frameworkInfoPath, frameworkInfo));
+  ASSERT_SOME(checkpoints.add(frameworkPidPath, string("pid2")));
+
+  // Nothing is written to the store before the batch is committed.
+  EXPECT_FALSE(slave::state::exists(store->get(), frameworkInfoPath));
+
+  ASSERT_SOME(checkpoints.commit());
+
+  ASSERT_SOME(slave::state::remove(store->get(), slaveInfoPath));
+  EXPECT_FALSE(slave::state::exists(store->get(), slaveInfoPath));
+
+  store->reset();
+
+  store = slave::state::CheckpointStore::create(metaDir);
+  ASSERT_SOME(store);
+
+  EXPECT_FALSE(slave::state::exists(store->get(), slaveInfoPath));
+  EXPECT_SOME_EQ(
+      frameworkInfo,
+      slave::state::read<FrameworkInfo>(store->get(), frameworkInfoPath));
+  EXPECT_SOME_EQ(
+      "pid2",
+      slave::state::read<string>(store->get(), frameworkPidPath));
+
+  // The entries of removed directories are dropped on the next open.
+  ASSERT_SOME(os::rmdir(
+      paths::getFrameworkPath(metaDir, slaveId, frameworkId)));
+
+  store->reset();
+
+  store = slave::state::CheckpointStore::create(metaDir);
+  ASSERT_SOME(store);
+
+  EXPECT_FALSE(slave::state::exists(store->get(), frameworkPidPath));
+}
+#endif // __WINDOWS__
+
+
 template <typename T>
 class SlaveRecoveryTest : public ContainerizerTest<T>
 {
@@ -816,6 +915,155 @@ TYPED_TEST(SlaveRecoveryTest, ReconnectExecutor)
 }
 
 
+#ifndef __WINDOWS__
+// This test verifies that an agent which keeps its checkpoints in the
+// checkpoint store recovers the framework, executor and task from the
+// store when it restarts, and that the executor reregisters with it.
+TYPED_TEST(SlaveRecoveryTest, ReconnectExecutorWithCheckpointStore)
+{
+  Try<Owned<cluster::Master>> master = this->StartMaster();
+  ASSERT_SOME(master);
+
+  slave::Flags flags = this->CreateSlaveFlags();
+  flags.checkpoint_store = "leveldb";
+
+  Fetcher fetcher(flags);
+
+  Try<TypeParam*> _containerizer = TypeParam::create(flags, true, &fetcher);
+  ASSERT_SOME(_containerizer);
+  Owned<slave::Containerizer> containerizer(_containerizer.get());
+
+  Owned<MasterDetector> detector = master.get()->createDetector();
+
+  Try<Owned<cluster::Slave>> slave =
+    this->StartSlave(detector.get(), containerizer.get(), flags);
+  ASSERT_SOME(slave);
+
+  // Enable checkpointing for the framework.
+  FrameworkInfo frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.set_checkpoint(true);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  FrameworkID frameworkId;
+  EXPECT_CALL(sched, registered(_, _, _))
+    .WillOnce(SaveArg<1>(&frameworkId));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  SlaveID slaveId = offers.get()[0].slave_id();
+
+  TaskInfo task = createTask(offers.get()[0], SLEEP_COMMAND(1000));
+
+  EXPECT_CALL(sched, statusUpdate(_, _))
+    .WillRepeatedly(Return()); // Ignore the updates.
+
+  Future<Message> registerExecutorMessage =
+    FUTURE_MESSAGE(Eq(RegisterExecutorMessage().GetTypeName()), _, _);
+
+  Future<Nothing> _statusUpdateAcknowledgement =
+    FUTURE_DISPATCH(_, &Slave::_statusUpdateAcknowledgement);
+
+  driver.launchTasks(offers.get()[0].id(), {task});
+
+  AWAIT_READY(registerExecutorMessage);
+
+  RegisterExecutorMessage registerExecutor;
+  registerExecutor.ParseFromString(registerExecutorMessage->body);
+  ExecutorID executorId = registerExecutor.executor_id();
+  UPID libprocessPid = registerExecutorMessage->from;
+
+  // Wait for the ACK to be checkpointed.
+  AWAIT_READY(_statusUpdateAcknowledgement);
+
+  slave.get()->terminate();
+
+  // The checkpoints of the stopped agent are recovered from the store,
+  // which the agent closed when it terminated.
+  const string metaDir = paths::getMetaRootDir(flags.work_dir);
+
+  {
+    Try<std::shared_ptr<slave::state::CheckpointStore>> store =
+      slave::state::CheckpointStore::create(metaDir);
+
+    ASSERT_SOME(store);
+
+    Result<slave::state::State> recover =
+      slave::state::recover(metaDir, true, store->get());
+
+    ASSERT_SOME(recover);
+    ASSERT_SOME(recover->slave);
+
+    slave::state::SlaveState state = recover->slave.get();
+
+    ASSERT_EQ(slaveId, state.id);
+    ASSERT_SOME(state.info);
+
+    ASSERT_TRUE(state.frameworks.contains(frameworkId));
+    ASSERT_TRUE(state.frameworks[frameworkId].executors.contains(executorId));
+
+    slave::state::ExecutorState executor =
+      state.frameworks[frameworkId].executors[executorId];
+
+    ASSERT_SOME(executor.info);
+    ASSERT_SOME(executor.latest);
+    ASSERT_TRUE(executor.runs.contains(executor.latest.get()));
+
+    slave::state::RunState run = executor.runs[executor.latest.get()];
+
+    EXPECT_SOME_EQ(libprocessPid, run.libprocessPid);
+    ASSERT_TRUE(run.tasks.contains(task.task_id()));
+    EXPECT_SOME(run.tasks[task.task_id()].info);
+
+    // The task info is kept in the store rather than in a file.
+    EXPECT_FALSE(os::exists(paths::getTaskInfoPath(
+        metaDir,
+        slaveId,
+        frameworkId,
+        executorId,
+        executor.latest.get(),
+        task.task_id())));
+  }
+
+  Future<ReregisterExecutorMessage> reregisterExecutor =
+    FUTURE_PROTOBUF(ReregisterExecutorMessage(), _, _);
+
+  Future<ReregisterSlaveMessage> reregisterSlave =
+    FUTURE_PROTOBUF(ReregisterSlaveMessage(), _, _);
+
+  // Restart the slave (use same flags) with a new containerizer.
+  _containerizer = TypeParam::create(flags, true, &fetcher);
+  ASSERT_SOME(_containerizer);
+  containerizer.reset(_containerizer.get());
+
+  slave = this->StartSlave(detector.get(), containerizer.get(), flags);
+  ASSERT_SOME(slave);
+
+  // Ensure the executor reregisters.
+  AWAIT_READY(reregisterExecutor);
+
+  // The agent reregisters with the recovered task.
+  AWAIT_READY(reregisterSlave);
+  EXPECT_EQ(slaveId, reregisterSlave->slave().id());
+  ASSERT_EQ(1, reregisterSlave->tasks_size());
+  EXPECT_EQ(task.task_id(), reregisterSlave->tasks(0).task_id());
+
+  driver.stop();
+  driver.join();
+}
+#endif // __WINDOWS__
+
+
 // This ensures that when the executor reconnect retry is enabled,
 // the agent will retry the reconnect messages until the executor
 // responds. We then ensure that any duplicate re-registration
@@ -48,6 +48,7 @@
 #include <process/reap.hpp>
 #include <process/subprocess.hpp>
 
+#include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/json.hpp>
 #include <stout/none.hpp>
@@ -2436,6 +2437,158 @@ TEST_F(SlaveTest, StatisticsEndpointRunningExecutor)
 }
 
 
+// A containerizer which reports the same perf samples for each of its
+// containers.
+class PerfSamplesContainerizer : public TestContainerizer
+{
+public:
+  PerfSamplesContainerizer(
+      MockExecutor* executor,
+      const vector<PerfStatistics>& _samples)
+    : TestContainerizer(executor),
+      samples(_samples) {}
+
+  Future<hashmap<ContainerID, vector<PerfStatistics>>> perfSamples() override
+  {
+    const vector<PerfStatistics> samples = this->samples;
+
+    return containers()
+      .then([samples](const hashset<ContainerID>& containerIds) {
+        hashmap<ContainerID, vector<PerfStatistics>> result;
+
+        foreach (const ContainerID& containerId, containerIds) {
+          result.put(containerId, samples);
+        }
+
+        return result;
+      });
+  }
+
+private:
+  const vector<PerfStatistics> samples;
+};
+
+
+// This test verifies that the perf endpoint returns the perf samples
+// kept by the containerizer for each executor, without collecting the
+// resource usage of the containers.
+TEST_F(SlaveTest, PerfEndpoint)
+{
+  Try<Owned<cluster::Master>> master = StartMaster();
+  ASSERT_SOME(master);
+
+  PerfStatistics sample1;
+  sample1.set_timestamp(1388534400.0);
+  sample1.set_duration(60.0);
+  sample1.set_cycles(1000);
+
+  PerfStatistics sample2;
+  sample2.set_timestamp(1388534460.0);
+  sample2.set_duration(60.0);
+  sample2.set_cycles(2000);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+  PerfSamplesContainerizer containerizer(&exec, {sample1, sample2});
+  StandaloneMasterDetector detector(master.get()->pid);
+
+  Try<Owned<cluster::Slave>> slave = StartSlave(&detector, &containerizer);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get()->pid, DEFAULT_CREDENTIAL);
+
+  Future<FrameworkID> frameworkId;
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .WillOnce(FutureArg<1>(&frameworkId));
+
+  EXPECT_CALL(exec, registered(_, _, _, _));
+
+  Future<vector<Offer>> offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(frameworkId);
+
+  AWAIT_READY(offers);
+  ASSERT_FALSE(offers->empty());
+
+  TaskInfo task = createTask(
+      offers->front().slave_id(),
+      Resources::parse("cpus:0.1;mem:32").get(),
+      SLEEP_COMMAND(1000),
+      exec.id);
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status));
+
+  driver.launchTasks(offers->front().id(), {task});
+
+  AWAIT_READY(status);
+  EXPECT_EQ(TASK_RUNNING, status->state());
+
+  // The endpoint should not go through the usage of the containers.
+  EXPECT_CALL(containerizer, usage(_))
+    .Times(0);
+
+  Future<hashset<ContainerID>> containerIds = containerizer.containers();
+  AWAIT_READY(containerIds);
+  ASSERT_EQ(1u, containerIds->size());
+
+  const ContainerID containerId = *containerIds->begin();
+
+  Future<Response> response = process::http::get(
+      slave.get()->pid,
+      "monitor/perf",
+      None(),
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(APPLICATION_JSON, "Content-Type", response);
+
+  Try<JSON::Value> value = JSON::parse(response->body);
+  ASSERT_SOME(value);
+
+  // The samples are returned oldest first.
+  Try<JSON::Value> expected = JSON::parse(strings::format(
+      "[{"
+          "\"container_id\":\"%s\","
+          "\"executor_id\":\"%s\","
+          "\"framework_id\":\"%s\","
+          "\"samples\":[{\"cycles\":1000},{\"cycles\":2000}]"
+      "}]",
+      containerId.value(),
+      exec.id.value(),
+      frameworkId->value()).get());
+
+  ASSERT_SOME(expected);
+  EXPECT_TRUE(value->contains(expected.get()));
+
+  // The samples of other containers are filtered out.
+  response = process::http::get(
+      slave.get()->pid,
+      "monitor/perf",
+      "container_id=unknown",
+      createBasicAuthHeaders(DEFAULT_CREDENTIAL));
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("[]", response);
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+}
+
+
 // This test confirms that an agent's statistics endpoint is
 // authenticated. We rely on the agent implicitly having HTTP
 // authentication enabled.
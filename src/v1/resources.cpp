@@ -16,6 +16,8 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <mutex>
 #include <ostream>
 #include <set>
 #include <string>
@@ -38,9 +40,12 @@
 #include <stout/lambda.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/strings.hpp>
+#include <stout/synchronized.hpp>
 #include <stout/unreachable.hpp>
 
+#include "common/resource_names.hpp"
 #include "common/resources_utils.hpp"
+#include "common/values.hpp"
 
 using std::make_shared;
 using std::map;
@@ -349,6 +354,156 @@ bool operator!=(const Resource& left, const Resource& right)
 
 namespace internal {
 
+// Interns the keys built by `internMetadata` below into dense, non-zero
+// identifiers which are shared by all threads. Each thread caches the
+// identifiers it has looked up, so that the shared table and its lock
+// are only consulted for keys which are new to the thread. Resource
+// names are interned by `ResourceNames::intern` instead.
+//
+// NOTE: Identifiers are never released, which is fine since the number
+// of distinct resource metadata in a cluster is small.
+static uint32_t internMetadataKey(const string& key)
+{
+  thread_local hashmap<string, uint32_t> cache;
+
+  auto cached = cache.find(key);
+  if (cached != cache.end()) {
+    return cached->second;
+  }
+
+  static std::mutex* mutex = new std::mutex();
+  static hashmap<string, uint32_t>* ids = new hashmap<string, uint32_t>();
+
+  uint32_t id;
+
+  synchronized (mutex) {
+    auto it = ids->find(key);
+    if (it != ids->end()) {
+      id = it->second;
+    } else {
+      id = static_cast<uint32_t>(ids->size() + 1);
+      ids->emplace(key, id);
+    }
+  }
+
+  cache.emplace(key, id);
+  return id;
+}
+
+
+// Appends a length-prefixed `value` to `key`, so that the
+// concatenation of several values is unambiguous.
+static void appendKey(string* key, const string& value)
+{
+  const uint32_t size = static_cast<uint32_t>(value.size());
+  key->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  key->append(value);
+}
+
+
+// Returns the interned identifier of the metadata of `resource` which
+// is compared by `addable` and `subtractable` below (except for the
+// name, which is interned separately), or zero if the metadata cannot
+// be interned.
+//
+// Equal identifiers must imply addability (and subtractability), while
+// different identifiers must imply the opposite. Since `Labels` are
+// compared irrespective of their order, we intern them in sorted order
+// and do not intern duplicate labels, for which the comparison is not
+// a set comparison.
+static uint32_t internMetadata(const Resource& resource)
+{
+  // Disk and shared resources have additional rules for combining
+  // them (e.g., for persistent volumes or MOUNT disks), so we always
+  // compare their protobufs.
+  if (resource.has_disk() || resource.has_shared()) {
+    return 0;
+  }
+
+  // Most resources are constructed without any metadata, e.g., when
+  // parsing resources or building offers. Their identifier only depends
+  // on the type, so we resolve it once per type instead of building and
+  // hashing the key below, whose value it is.
+  if (!resource.has_allocation_info() &&
+      resource.reservations_size() == 0 &&
+      !resource.has_revocable() &&
+      !resource.has_provider_id()) {
+    static const vector<uint32_t>* ids = []() {
+      vector<uint32_t>* ids = new vector<uint32_t>();
+
+      for (int type = 0; type < Value::Type_ARRAYSIZE; ++type) {
+        ids->push_back(internMetadataKey(
+            string(1, static_cast<char>(type)) + "--"));
+      }
+
+      return ids;
+    }();
+
+    return ids->at(resource.type());
+  }
+
+  string key;
+  key += static_cast<char>(resource.type());
+
+  if (!resource.has_allocation_info()) {
+    key += '-';
+  } else if (!resource.allocation_info().has_role()) {
+    key += 'a';
+  } else {
+    key += 'A';
+    appendKey(&key, resource.allocation_info().role());
+  }
+
+  foreach (const Resource::ReservationInfo& reservation,
+           resource.reservations()) {
+    key += 'R';
+    key += static_cast<char>(reservation.type());
+    appendKey(&key, reservation.role());
+
+    if (reservation.has_principal()) {
+      key += 'P';
+      appendKey(&key, reservation.principal());
+    } else {
+      key += '-';
+    }
+
+    if (reservation.has_labels()) {
+      vector<pair<string, string>> labels;
+      labels.reserve(reservation.labels().labels_size());
+
+      foreach (const Label& label, reservation.labels().labels()) {
+        labels.emplace_back(label.key(), label.value());
+      }
+
+      std::sort(labels.begin(), labels.end());
+
+      if (std::adjacent_find(labels.begin(), labels.end()) != labels.end()) {
+        return 0;
+      }
+
+      key += 'L';
+      appendKey(&key, stringify(labels.size()));
+
+      foreach (const auto& label, labels) {
+        appendKey(&key, label.first);
+        appendKey(&key, label.second);
+      }
+    } else {
+      key += '-';
+    }
+  }
+
+  key += resource.has_revocable() ? 'r' : '-';
+
+  if (resource.has_provider_id()) {
+    key += 'p';
+    appendKey(&key, resource.provider_id().value());
+  }
+
+  return internMetadataKey(key);
+}
+
+
 // Tests if we can add two Resource objects together resulting in one
 // valid Resource object. For example, two Resource objects with
 // different name, type or role are not addable.
@@ -1358,6 +1513,14 @@ bool Resources::Resource_::isEmpty() const
     return true;
   }
 
+  if (resource.type() == Value::SCALAR) {
+    return scalar == 0;
+  }
+
+  if (resource.type() == Value::RANGES) {
+    return ranges.empty();
+  }
+
   return Resources::isEmpty(resource);
 }
 
@@ -1377,8 +1540,21 @@ bool Resources::Resource_::contains(const Resource_& that) const
            resource == that.resource;
   }
 
-  // For non-shared resources just compare the protobufs.
-  return mesos::v1::contains(resource, that.resource);
+  // For non-shared resources, 'subtractable' is a necessary condition
+  // for 'contains', see `mesos::v1::contains()`.
+  if (!subtractable(that)) {
+    return false;
+  }
+
+  switch (resource.type()) {
+    case Value::SCALAR: return that.scalar <= scalar;
+    case Value::RANGES:
+      return mesos::internal::values::contains(ranges, that.ranges);
+    case Value::SET:    return that.resource.set() <= resource.set();
+    case Value::TEXT:   return false;
+  }
+
+  UNREACHABLE();
 }
 
 
@@ -1387,7 +1563,17 @@ Resources::Resource_& Resources::Resource_::operator+=(const Resource_& that)
   // This function assumes that the 'resource' fields are addable.
 
   if (!isShared()) {
-    resource += that.resource;
+    if (resource.type() == Value::SCALAR) {
+      scalar += that.scalar;
+      resource.mutable_scalar()->set_value(
+          mesos::internal::values::convertToFloating(scalar));
+    } else if (resource.type() == Value::RANGES) {
+      ranges = mesos::internal::values::add(ranges, that.ranges);
+      mesos::internal::values::fromFlatRanges(
+          ranges, resource.mutable_ranges());
+    } else {
+      resource += that.resource;
+    }
   } else {
     // 'addable' makes sure both 'resource' fields are shared and
     // equal, so we just need to sum up the counters here.
@@ -1406,7 +1592,17 @@ Resources::Resource_& Resources::Resource_::operator-=(const Resource_& that)
   // This function assumes that the 'resource' fields are subtractable.
 
   if (!isShared()) {
-    resource -= that.resource;
+    if (resource.type() == Value::SCALAR) {
+      scalar -= that.scalar;
+      resource.mutable_scalar()->set_value(
+          mesos::internal::values::convertToFloating(scalar));
+    } else if (resource.type() == Value::RANGES) {
+      ranges = mesos::internal::values::subtract(ranges, that.ranges);
+      mesos::internal::values::fromFlatRanges(
+          ranges, resource.mutable_ranges());
+    } else {
+      resource -= that.resource;
+    }
   } else {
     // 'subtractable' makes sure both 'resource' fields are shared and
     // equal, so we just need to subtract the counters here.
@@ -1442,6 +1638,53 @@ bool Resources::Resource_::operator!=(const Resource_& that) const
 }
 
 
+void Resources::Resource_::intern()
+{
+  nameId = mesos::internal::ResourceNames::intern(resource.name()).id;
+  metadataId = internal::internMetadata(resource);
+}
+
+
+void Resources::Resource_::cacheValue()
+{
+  scalar = resource.type() == Value::SCALAR
+    ? mesos::internal::values::convertToFixed(resource.scalar().value())
+    : 0;
+
+  ranges = resource.type() == Value::RANGES
+    ? mesos::internal::values::toFlatRanges(resource.ranges())
+    : mesos::internal::values::FlatRanges();
+}
+
+
+bool Resources::Resource_::addable(const Resource_& that) const
+{
+  if (nameId != that.nameId) {
+    return false;
+  }
+
+  if (metadataId != 0 && that.metadataId != 0) {
+    return metadataId == that.metadataId;
+  }
+
+  return internal::addable(resource, that.resource);
+}
+
+
+bool Resources::Resource_::subtractable(const Resource_& that) const
+{
+  if (nameId != that.nameId) {
+    return false;
+  }
+
+  if (metadataId != 0 && that.metadataId != 0) {
+    return metadataId == that.metadataId;
+  }
+
+  return internal::subtractable(resource, that.resource);
+}
+
+
 Resources::Resources(const Resource& resource)
 {
   // NOTE: Invalid and zero Resource object will be ignored.
@@ -1592,6 +1835,7 @@ void Resources::allocate(const string& role)
       resource_ = make_shared<Resource_>(*resource_);
     }
     resource_->resource.mutable_allocation_info()->set_role(role);
+    resource_->intern();
   }
 }
 
@@ -1607,6 +1851,7 @@ void Resources::unallocate()
         resource_ = make_shared<Resource_>(*resource_);
       }
       resource_->resource.clear_allocation_info();
+      resource_->intern();
     }
   }
 }
@@ -1738,6 +1983,7 @@ Resources Resources::pushReservation(
       resourcesNoMutationWithoutExclusiveOwnership) {
     Resource_ r_ = *resource_;
     r_.resource.add_reservations()->CopyFrom(reservation);
+    r_.intern();
     Option<Error> validationError = Resources::validate(r_.resource);
     CHECK_NONE(validationError)
       << "Invalid resource " << r_ << ": " << validationError.get();
@@ -1759,6 +2005,7 @@ Resources Resources::popReservation() const
     CHECK_GT(resource_->resource.reservations_size(), 0);
     Resource_ r_ = *resource_;
     r_.resource.mutable_reservations()->RemoveLast();
+    r_.intern();
     result.add(std::move(r_));
   }
 
@@ -1776,6 +2023,7 @@ Resources Resources::toUnreserved() const
     if (isReserved(resource_->resource)) {
       Resource_ r_ = *resource_;
       r_.resource.clear_reservations();
+      r_.intern();
       result.add(std::move(r_));
     } else {
       result.add(resource_);
@@ -2210,7 +2458,7 @@ void Resources::add(const Resource_& that)
   foreach (
       Resource_Unsafe& resource_,
       resourcesNoMutationWithoutExclusiveOwnership) {
-    if (internal::addable(resource_->resource, that.resource)) {
+    if (resource_->addable(that)) {
       // Copy-on-write (if more than 1 reference).
       if (resource_.use_count() > 1) {
         resource_ = make_shared<Resource_>(*resource_);
@@ -2240,7 +2488,7 @@ void Resources::add(Resource_&& that)
   foreach (
       Resource_Unsafe& resource_,
       resourcesNoMutationWithoutExclusiveOwnership) {
-    if (internal::addable(resource_->resource, that.resource)) {
+    if (resource_->addable(that)) {
       // Copy-on-write (if more than 1 reference).
       if (resource_.use_count() > 1) {
         that += *resource_;
@@ -2272,7 +2520,7 @@ void Resources::add(const Resource_Unsafe& that)
   foreach (
       Resource_Unsafe& resource_,
       resourcesNoMutationWithoutExclusiveOwnership) {
-    if (internal::addable(resource_->resource, that->resource)) {
+    if (resource_->addable(*that)) {
       // Copy-on-write (if more than 1 reference).
       if (resource_.use_count() > 1) {
         resource_ = make_shared<Resource_>(*resource_);
@@ -2378,7 +2626,7 @@ void Resources::subtract(const Resource_& that)
     Resource_Unsafe& resource_ =
       resourcesNoMutationWithoutExclusiveOwnership[i];
 
-    if (internal::subtractable(resource_->resource, that)) {
+    if (resource_->subtractable(that)) {
       // Copy-on-write (if more than 1 reference).
       if (resource_.use_count() > 1) {
         resource_ = make_shared<Resource_>(*resource_);
@@ -2398,7 +2646,7 @@ void Resources::subtract(const Resource_& that)
       bool negative =
         (resource_->isShared() && resource_->sharedCount.get() < 0) ||
         (resource_->resource.type() == Value::SCALAR &&
-         resource_->resource.scalar().value() < 0);
+         resource_->scalar < 0);
 
       if (negative || resource_->isEmpty()) {
         // As `resources` is not ordered, and erasing an element
@@ -2695,5 +2943,6 @@ Try<Resources> ResourceConversion::apply(const Resources& resources) const
   return result;
 }
 
+
 } // namespace v1 {
 } // namespace mesos {